@@ -47,6 +47,24 @@ nnlayer::nnlayer (int dimension, int num_weights)
 	}
 }
 
+// Copy constructor.
+
+nnlayer::nnlayer (const nnlayer& other)
+{
+	size = other.size;
+	weights = other.weights;
+	nodes = new neuron [size];
+	assert (nodes);
+
+	for (int j = 0; j < size; j++) {
+		nodes [j].weights = new float [weights];
+		assert (nodes [j].weights);
+		for (int i = 0; i < weights; i++)
+			nodes [j].weights [i] = other.nodes [j].weights [i];
+		nodes [j].output = other.nodes [j].output;
+	}
+}
+
 // Destructor. 
 
 nnlayer::~nnlayer ()
@@ -38,6 +38,7 @@ class nnlayer {
 public:
 	neuron *nodes;
 	nnlayer (int, int);		// Number of nodes in the layer.
+	nnlayer (const nnlayer&);	// Copies nodes and weights.
 	~nnlayer ();
 private:
 	int size;
@@ -82,6 +82,18 @@ nnwork::nnwork (char *filename)
 		cerr << "Error: File failed to load." << endl;
 }
 
+// Copy constructor: copies the weights of another network.
+
+nnwork::nnwork (const nnwork& other)
+{
+	input_size = other.input_size;
+	hidden_size = other.hidden_size;
+	output_size = other.output_size;
+
+	hidden_nodes = other.hidden_nodes ? new nnlayer (*other.hidden_nodes) : 0;
+	output_nodes = other.output_nodes ? new nnlayer (*other.output_nodes) : 0;
+}
+
 // Destructor: destroys the network.
 
 nnwork::~nnwork ()
@@ -43,6 +43,7 @@ public:
 	nnwork (int, int, int);
 	nnwork ();
 	nnwork (char*);
+	nnwork (const nnwork&);
 	~nnwork ();
 	
 	
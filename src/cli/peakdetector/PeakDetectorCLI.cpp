@@ -22,6 +22,7 @@ void PeakDetectorCLI::processOptions(int argc, char* argv[]) {
 							"I?quantileIntensity: Specify required percentage of peaks above the intensity threshold <float>",
                             "j?saveEicJson: Enter non-zero integer to save EIC JSON in the output folder <int>",
 							"k?charge: Enter the magnitude of charge on each compound <int>",
+							"l?clusterGroups: Enter max retention time difference for clustering groups, 0 to skip clustering <float>",
 							"m?model: Enter full path to the model file <string>",
 							"n?eicMaxGroups: Enter maximum number of groups reported per compound <int>",
 							"o?outputdir: Enter full path to output folder <string>",
@@ -29,7 +30,7 @@ void PeakDetectorCLI::processOptions(int argc, char* argv[]) {
 							"q?minQuality: Enter min peak quality threshold for a group <float>",
 							"Q?quantileQuality: Specify required percentage of peaks above quality threshold <float>",
 							"r?rtStepSize: Enter retention time window for untargeted peak detection <float>",
-                            "s?savemzroll: Enter non-zero integer to save mzroll in the output folder <int>",
+                            "s?savemzroll: Enter non-zero integer to save mzroll in the output folder, 2 to also save a binary .mzrollb peak table <int>",
                             "v?ionizationMode: Enter 0, -1 or 1 ionization mode <int>",
 							"w?minPeakWidth: Enter min peak width threshold in a group <int>",
 							"x?xml: Enter full path to the config file <string>",
@@ -117,6 +118,10 @@ void PeakDetectorCLI::processOptions(int argc, char* argv[]) {
 			mavenParameters->charge = atoi(optarg);
 			break;
 
+		case 'l':
+			clusterMaxRtDiff = atof(optarg);
+			break;
+
 		case 'm':
 			clsfModelFilename = optarg;
 			break;
@@ -169,6 +174,7 @@ void PeakDetectorCLI::processOptions(int argc, char* argv[]) {
         case 's':
         	saveMzrollFile = true;
 			if (atoi(optarg) == 0) saveMzrollFile = false;
+			saveBinaryPeakTable = (atoi(optarg) == 2);
 			break;
 
         case 'v' : 
@@ -497,6 +503,12 @@ void PeakDetectorCLI::processGeneralArgsXML(xml_node& generalArgs) {
 
         	saveMzrollFile = true;
 			if (atoi(node.attribute("value").value()) == 0) saveMzrollFile = false;
+			saveBinaryPeakTable = (atoi(node.attribute("value").value()) == 2);
+
+		}
+		else if (strcmp(node.name(),"clusterGroups") == 0) {
+
+			clusterMaxRtDiff = atof(node.attribute("value").value());
 
 		}
 		else if (strcmp(node.name(),"samples") == 0) {
@@ -619,6 +631,15 @@ void PeakDetectorCLI::writeReport(string setName,QString jsPath,QString nodePath
 	//reduce groups
 	groupReduction();
 
+	//groups do not move from here on
+	vector<PeakGroup*> groups;
+	for (unsigned int i = 0; i < mavenParameters->allgroups.size(); i++)
+		groups.push_back(&mavenParameters->allgroups[i]);
+	featureMatrix.build(groups, mavenParameters->samples);
+
+	//cluster related groups
+	clusterGroups();
+
 	//save Eic Json
 	saveJson(setName);
 
@@ -669,6 +690,31 @@ void PeakDetectorCLI::groupReduction() {
 	}
 }
 
+void PeakDetectorCLI::clusterGroups() {
+
+	if (clusterMaxRtDiff <= 0) return;
+
+	#ifndef __APPLE__
+	 double startClustering = getTime();
+	#endif
+
+	GroupClustering clustering(mavenParameters->compoundMassCutoffWindow,
+							   mavenParameters->eicType,
+							   mavenParameters->filterline);
+	clustering.maxRtDiff = clusterMaxRtDiff;
+
+	vector<PeakGroup*> groups;
+	for (unsigned int i = 0; i < mavenParameters->allgroups.size(); i++)
+		groups.push_back(&mavenParameters->allgroups[i]);
+
+	int clusterCount = clustering.cluster(groups, mavenParameters->samples, &featureMatrix);
+	cout << "\nClustered " << groups.size() << " groups into " << clusterCount << " clusters\n";
+
+	#ifndef __APPLE__
+	 cout << "\tExecution time (Clustering)      : " << getTime() - startClustering << " seconds \n";
+	#endif
+}
+
 void PeakDetectorCLI::saveJson(string setName) {
 	if (saveJsonEIC) {
 
@@ -735,6 +781,8 @@ void PeakDetectorCLI::saveMzRoll(string setName) {
         #endif
 
          writePeakTableXML(mavenParameters->outputdir + setName + ".mzroll");
+         if (saveBinaryPeakTable)
+             writePeakTableBinary(mavenParameters->outputdir + setName + ".mzrollb");
 
         #ifndef __APPLE__
          cout << "\tExecution time (Saving mzroll)   : " << getTime() - startSavingMzroll << " seconds \n";
@@ -765,6 +813,8 @@ void PeakDetectorCLI::saveCSV(string setName) {
 
     csvreports->setUserQuantType(quantitationType);
 
+    csvreports->setFeatureMatrix(&featureMatrix);
+
     //Added to pass into csvreports file when merged with Maven776 - Kiran
     //CLI exports the default Group Summary Matrix Format (without set Names)
     csvreports->openGroupReport(fileName);
@@ -896,6 +946,17 @@ void PeakDetectorCLI::writeParametersXML(xml_node& parent) {
 	p.append_attribute("minQuality") = mavenParameters->minQuality;
 }
 
+void PeakDetectorCLI::writePeakTableBinary(string filename) {
+
+	vector<PeakGroup*> groups;
+	for (unsigned int i = 0; i < mavenParameters->allgroups.size(); i++)
+		groups.push_back(&mavenParameters->allgroups[i]);
+
+	PeakTableFile peakTable;
+	if (!peakTable.write(filename, groups, mavenParameters->samples))
+		cerr << "Error: " << peakTable.errorMessage << endl;
+}
+
 void PeakDetectorCLI::writeGroupXML(xml_node& parent, PeakGroup* g) {
 	if (!g)
 		return;
@@ -27,8 +27,10 @@
 #include "databases.h"
 #include "csvreports.h"
 #include "PeakDetector.h"
+#include "groupClustering.h"
 #include "classifierNeuralNet.h"
 #include "jsonReports.h"
+#include "peakTableFile.h"
 #include "pollyintegration.h"
 
 #include <QtCore>
@@ -85,12 +87,17 @@ class PeakDetectorCLI {
 		PeakDetector* peakDetector = new PeakDetector ();
 
 		bool reduceGroupsFlag = true;
+		float clusterMaxRtDiff = 0;
 		bool saveJsonEIC=false;
 		bool uploadToPolly_bool = false;
 		bool saveMzrollFile=true;
+		bool saveBinaryPeakTable=false;
 		string csvFileFieldSeparator=",";
 		PeakGroup::QType quantitationType = PeakGroup::AreaTop;
 
+		/** quantities of the reported groups, built once groups are final */
+		FeatureMatrix featureMatrix;
+
 		string clsfModelFilename = "default.model";
 
 		/**
@@ -155,6 +162,11 @@ class PeakDetectorCLI {
 
 		void groupReduction();
 
+		/**
+		* [cluster groups of related ions, see GroupClustering]
+		*/
+		void clusterGroups();
+
 		void saveJson(string setName);
 
 		void saveMzRoll(string setName);
@@ -181,6 +193,12 @@ class PeakDetectorCLI {
 		*/
 		void writePeakTableXML(string filename);
 
+		/**
+		* [write Peak Table as binary columns with group statistics, see PeakTableFile]
+		* @param filename [name of the file]
+		*/
+		void writePeakTableBinary(string filename);
+
 		/**
 		* [write Group information in XML]
 		* @param parent [parent ion]
@@ -225,6 +243,7 @@ struct Arguments {
 		generalArgs << "int" << "saveEicJson" << "0";
 		generalArgs << "string" << "outputdir" << "0";
 		generalArgs << "int" << "savemzroll" << "0";
+		generalArgs << "float" << "clusterGroups" << "0";
 		generalArgs << "string" << "samples" << "path/to/sample1";
 		generalArgs << "string" << "samples" << "path/to/sample2";
 		generalArgs << "string" << "samples" << "path/to/sample3";
@@ -1,4 +1,7 @@
 #include "EIC.h"
+#include "eicpyramid.h"
+#include "peakColumns.h"
+#include "scratchBuffer.h"
 /**
  * @file EIC.cpp
  * @author Sabu George
@@ -11,6 +14,8 @@ EIC::EIC()
     sample = NULL;
     spline = NULL;
     baseline = NULL;
+    intensityPyramid = NULL;
+    splinePyramid = NULL;
     mzmin = mzmax = rtmin = rtmax = 0;
     maxIntensity = totalIntensity = 0;
     maxAreaTopIntensity = 0;
@@ -35,13 +40,59 @@ EIC::~EIC()
     if (baseline != NULL)
         delete[] baseline;
     baseline = NULL;
+    delete intensityPyramid;
+    delete splinePyramid;
     peaks.clear();
 }
 
+void EIC::visiblePoints(float rtmin, float rtmax, unsigned int maxPoints, bool useSpline, vector<unsigned int> &indices)
+{
+    indices.clear();
+    unsigned int n = min(rt.size(), intensity.size());
+    if (n == 0 || (useSpline && spline == NULL))
+        return;
+
+    EICPyramid *&pyramid = useSpline ? splinePyramid : intensityPyramid;
+    const float *y = useSpline ? spline : &intensity[0];
+    if (pyramid == NULL || !pyramid->isBuiltOn(&rt[0], y, n))
+    {
+        delete pyramid;
+        pyramid = new EICPyramid(&rt[0], y, n);
+    }
+    pyramid->visiblePoints(rtmin, rtmax, maxPoints, indices);
+}
+
 EIC *EIC::eicMerge(const vector<EIC *> &eics)
 {
     // Merge to 776
     EIC *meic = new EIC();
+    eicMerge(eics, meic);
+    return meic;
+}
+
+void EIC::eicMerge(const vector<EIC *> &eics, EIC *meic)
+{
+    //start over, vectors keep their capacity
+    meic->peaks.clear();
+    meic->intensity.clear();
+    meic->rt.clear();
+    meic->scannum.clear();
+    meic->mz.clear();
+    delete[] meic->spline;
+    meic->spline = NULL;
+    delete[] meic->baseline;
+    meic->baseline = NULL;
+    delete meic->intensityPyramid;
+    meic->intensityPyramid = NULL;
+    delete meic->splinePyramid;
+    meic->splinePyramid = NULL;
+    meic->maxIntensity = meic->totalIntensity = 0;
+    meic->maxAreaTopIntensity = meic->maxAreaIntensity = 0;
+    meic->maxAreaTopNotCorrectedIntensity = meic->maxAreaNotCorrectedIntensity = 0;
+    meic->eic_noNoiseObs = 0;
+    meic->rtmin = meic->rtmax = 0;
+    meic->sampleName.clear();
+    meic->sample = NULL;
 
     unsigned int maxlen = 0;
     float minRt = DBL_MAX;
@@ -57,15 +108,18 @@ EIC *EIC::eicMerge(const vector<EIC *> &eics)
     }
 
     if (maxlen == 0)
-        return meic;
+        return;
 
-    //create new EIC
-    meic->sample = NULL;
-    vector<float> intensity(maxlen, 0);
-    vector<float> rt(maxlen, 0);
-    vector<int> scans(maxlen, 0);
-    vector<float> mz(maxlen, 0);
-    vector<int> mzcount(maxlen, 0);
+    vector<float> &intensity = meic->intensity;
+    vector<float> &rt = meic->rt;
+    vector<int> &scans = meic->scannum;
+    vector<float> &mz = meic->mz;
+    intensity.resize(maxlen, 0);
+    rt.resize(maxlen, 0);
+    scans.resize(maxlen, 0);
+    mz.resize(maxlen, 0);
+    ScratchBuffer mzcount(maxlen);
+    std::fill_n(mzcount.data(), maxlen, 0);
 
     //smoothing   //initalize time array
     for (unsigned int i = 0; i < maxlen; i++)
@@ -78,20 +132,16 @@ EIC *EIC::eicMerge(const vector<EIC *> &eics)
     for (unsigned int i = 0; i < eics.size(); i++)
     {
         EIC *e = eics[i];
-        for (unsigned int j = 0; j < e->size(); j++)
+        const float *y = e->spline ? e->spline : e->intensity.data();
+        unsigned int n = e->size();
+        for (unsigned int j = 0; j < n; j++)
         {
             unsigned int bin = ((e->rt[j] - minRt) / (maxRt - minRt) * maxlen);
             if (bin >= maxlen)
                 bin = maxlen - 1;
 
-            if (e->spline and e->spline[j] > 0)
-            {
-                intensity[bin] += e->spline[j];
-            }
-            else
-            {
-                intensity[bin] += e->intensity[j];
-            }
+            //splines are used where they are positive
+            intensity[bin] += y[j] > 0 ? y[j] : e->intensity[j];
 
             if (e->mz[j] > 0)
             {
@@ -112,16 +162,10 @@ EIC *EIC::eicMerge(const vector<EIC *> &eics)
         meic->totalIntensity += intensity[i];
     }
 
-    //copy to new EIC
     meic->rtmin = minRt;
     meic->rtmax = maxRt;
-    meic->intensity = intensity;
-    meic->rt = rt;
-    meic->scannum = scans;
-    meic->mz = mz;
     meic->sampleName = eics[0]->sampleName;
     meic->sample = eics[0]->sample;
-    return meic;
 }
 
 void EIC::computeBaseLine(int smoothing_window, int dropTopX)
@@ -140,29 +184,24 @@ void EIC::computeBaseLine(int smoothing_window, int dropTopX)
     try
     {
         baseline = new float[n];
-        std::fill_n(baseline, n, 0);
     }
     catch (...)
     {
         cerr << "Exception caught while allocating memory " << n << "floats " << endl;
     }
 
-    //sort intensity vector
-    vector<float> tmpv = intensity;
-    std::sort(tmpv.begin(), tmpv.end());
-
     //compute maximum intensity of baseline, any point above this value will
     // be dropped. User specifies quantile of points to keep, for example
     //drop 60% of highest intensities = cut at 40% value;
-
+    //only the value at the cut is needed, so it is selected, not sorted
     float cutvalueF = (100.0 - (float)dropTopX) / 101;
-    //cerr << "cutvalue = " << cutvalueF << "\n";
-    unsigned int pos = tmpv.size() * cutvalueF;
-    //cerr << "pos = " << pos << "\n";
-    //cerr << "tmpv size = " << tmpv.size() << "\n";
-    float qcut = 0;
-    pos < tmpv.size() ? qcut = tmpv[pos] : qcut = tmpv.back();
-    //cerr << "qcut = " << qcut << "\n";
+    unsigned int pos = n * cutvalueF;
+    if (pos >= (unsigned int)n)
+        pos = n - 1;
+    ScratchBuffer tmpv(n);
+    std::copy(intensity.begin(), intensity.end(), tmpv.data());
+    std::nth_element(tmpv.data(), tmpv.data() + pos, tmpv.data() + n);
+    float qcut = tmpv[pos];
 
     //drop all points above maximum baseline value
     for (int i = 0; i < n; i++)
@@ -222,12 +261,12 @@ void EIC::computeSpline(int smoothWindow)
         delete[] spline;
         spline = NULL;
     }
+    delete splinePyramid;
+    splinePyramid = NULL;
 
     try
     {
         this->spline = new float[n];
-        for (int i = 0; i < n; i++)
-            spline[i] = 0;
     }
     catch (...)
     {
@@ -235,8 +274,7 @@ void EIC::computeSpline(int smoothWindow)
     }
 
     //initalize spline, set to intensity vector
-    for (int i = 0; i < n; i++)
-        spline[i] = intensity[i];
+    std::copy(intensity.begin(), intensity.end(), spline);
 
     if (smoothWindow > n / 3)
         smoothWindow = n / 3; //smoothing window is too large
@@ -245,10 +283,8 @@ void EIC::computeSpline(int smoothWindow)
 
     if (smootherType == SAVGOL)
     { //SAVGOL SMOOTHER
-        mzUtils::SavGolSmoother smoother(smoothWindow, smoothWindow, 4);
-        vector<float> smoothed = smoother.Smooth(intensity);
-        for (int i = 0; i < n; i++)
-            spline[i] = smoothed[i];
+        const mzUtils::SavGolSmoother &smoother = mzUtils::SavGolSmoother::cached(smoothWindow, smoothWindow, 4);
+        smoother.Smooth(intensity.data(), spline, n);
     }
     else if (smootherType == GAUSSIAN)
     { //GAUSSIAN SMOOTHER
@@ -256,11 +292,7 @@ void EIC::computeSpline(int smoothWindow)
     }
     else if (smootherType == AVG)
     {
-        float *y = new float[n];
-        for (int i = 0; i < n; i++)
-            y[i] = intensity[i];
-        smoothAverage(y, spline, smoothWindow, n);
-        delete[] y;
+        smoothAverage(intensity.data(), spline, smoothWindow, n);
     }
 }
 
@@ -656,10 +688,7 @@ void EIC::checkGaussianFit(Peak &peak)
     if (moves < 3)
         return;
 
-    //copy intensities into separate vector
-    //dim
-    vector<float> pints(moves * 2 + 1);
-
+    int n = moves * 2 + 1;
     int j = peak.pos + moves;
     if (j >= intensity.size())
         j = intensity.size() - 1;
@@ -669,13 +698,24 @@ void EIC::checkGaussianFit(Peak &peak)
     if (i < 1)
         i = 1;
 
+    //fit in place unless the window was clipped at the ends, then the
+    //missing points are fitted as zeros
+    if (j - i + 1 == n)
+    {
+        mzUtils::gaussFit(&intensity[i], n, &(peak.gaussFitSigma), &(peak.gaussFitR2));
+        return;
+    }
+
+    ScratchBuffer pints(n);
     int k = 0;
     for (; i <= j; i++)
     {
         pints[k] = intensity[i];
         k++;
     }
-    mzUtils::gaussFit(pints, &(peak.gaussFitSigma), &(peak.gaussFitR2));
+    for (; k < n; k++)
+        pints[k] = 0;
+    mzUtils::gaussFit(pints.data(), n, &(peak.gaussFitSigma), &(peak.gaussFitR2));
 }
 
 void EIC::getPeakStatistics()
@@ -770,10 +810,11 @@ vector<PeakGroup> EIC::groupPeaks(vector<EIC *> &eics,
     //     return pgroups;
     // }
 
-    //create EIC compose from all sample eics
-    EIC *m = EIC::eicMerge(eics);
-    if (!m)
-        return pgroups;
+    //create EIC compose from all sample eics, the merged EIC of the
+    //previous call on this thread is reused
+    thread_local EIC merged;
+    EIC *m = &merged;
+    EIC::eicMerge(eics, m);
 
     //find peaks in merged eic
     m->setFilterSignalBaselineDiff(minSignalBaselineDifference);
@@ -785,11 +826,22 @@ vector<PeakGroup> EIC::groupPeaks(vector<EIC *> &eics,
         PeakGroup grp;
         grp.groupId = i;
         grp.setSelectedSamples(samples);
-        pgroups.push_back(grp);
+        pgroups.push_back(std::move(grp));
     }
 
     //cerr << "EIC::groupPeaks() peakgroups=" << pgroups.size() << endl;
 
+    //matching only reads retention times and intensities of the merged
+    //peaks, take them out of the peaks once for all samples
+    thread_local PeakColumns columns;
+    columns.assign(m->peaks);
+    const float *rt = columns.rt.data();
+    const float *rtmin = columns.rtmin.data();
+    const float *rtmax = columns.rtmax.data();
+    const float *intensity = columns.peakIntensity.data();
+    unsigned int ngroups = columns.size();
+    ScratchBuffer scores(ngroups);
+
     for (unsigned int i = 0; i < eics.size(); i++)
     { //for every sample
         for (unsigned int j = 0; j < eics[i]->peaks.size(); j++)
@@ -798,49 +850,52 @@ vector<PeakGroup> EIC::groupPeaks(vector<EIC *> &eics,
             b.groupNum = -1;
             b.groupOverlap = FLT_MIN;
 
-            vector<Peak>::iterator itr = lower_bound(m->peaks.begin(), m->peaks.end(), b, Peak::compRtMin);
-            int lb = (itr - (m->peaks.begin())) - 1;
-            if (lb < 0)
-                lb = 0;
-            //cerr << "\tb=" << b.rtmin << "<=>" << b.rtmax << " lb=" << lb << endl;
+            //merged peaks are sorted by rt, with useOverlap the search stops
+            //at the first group that starts after this peak has ended
+            unsigned int end = ngroups;
+            if (useOverlap)
+            {
+                for (unsigned int k = 0; k < ngroups; k++)
+                {
+                    if (rtmin[k] > b.rtmax && !(rtmax[k] < b.rtmin)
+                        && checkOverlap(rtmin[k], rtmax[k], b.rtmin, b.rtmax) == 0)
+                    {
+                        end = k;
+                        break;
+                    }
+                }
+            }
 
-            //Find best matching group
-            for (unsigned int k = 0; k < m->peaks.size(); k++)
+            //score all candidates, a group that can not match gets 0
+            //which never beats the initial FLT_MIN
+            for (unsigned int k = 0; k < end; k++)
             {
-                Peak &a = m->peaks[k];
+                float overlap = checkOverlap(rtmin[k], rtmax[k], b.rtmin, b.rtmax); //check for overlap
+                float distx = abs(b.rt - rt[k]);
+                float disty = abs(b.peakIntensity - intensity[k]);
 
                 float score;
-
-                float overlap = checkOverlap(a.rtmin, a.rtmax, b.rtmin, b.rtmax); //check for overlap
-                float distx = abs(b.rt - a.rt);
-                float disty = abs(b.peakIntensity - a.peakIntensity);
-
                 if (useOverlap)
                 {
-
-                    if (overlap == 0 and a.rtmax < b.rtmin)
-                        continue;
-                    if (overlap == 0 and a.rtmin > b.rtmax)
-                        break;
-
-                    if (distx > maxRtDiff && overlap < 0.2)
-                        continue;
-
+                    bool skip = (overlap == 0 && rtmax[k] < b.rtmin)
+                                || (distx > maxRtDiff && overlap < 0.2);
                     score = 1.0 / (distXWeight * distx + 0.01) / (distYWeight * disty + 0.01) * (overlapWeight * overlap);
+                    scores[k] = skip ? 0.0f : score;
                 }
                 else
                 {
-
-                    if (distx > maxRtDiff)
-                        continue;
-
                     score = 1.0 / (distXWeight * distx + 0.01) / (distYWeight * disty + 0.01);
+                    scores[k] = distx > maxRtDiff ? 0.0f : score;
                 }
+            }
 
-                if (score > b.groupOverlap)
+            //Find best matching group, the first one with the highest score
+            for (unsigned int k = 0; k < end; k++)
+            {
+                if (scores[k] > b.groupOverlap)
                 {
                     b.groupNum = k;
-                    b.groupOverlap = score;
+                    b.groupOverlap = scores[k];
                 }
             }
 
@@ -885,8 +940,6 @@ vector<PeakGroup> EIC::groupPeaks(vector<EIC *> &eics,
     //EIC::mergeOverlapingGroups(pgroups);
     //cerr << "Found " << pgroups.size() << "groups" << endl;
 
-    if (m)
-        delete (m);
     return (pgroups);
 }
 
@@ -931,22 +984,7 @@ void EIC::interpolate()
 vector<Scan *> EIC::getFragmenationEvents()
 {
     // Merged to 776
-    vector<Scan *> matchedscans;
-    for (unsigned int j = 0; j < sample->scans.size(); j++)
-    {
-        Scan *scan = sample->scans[j];
-        if (scan->mslevel <= 1)
-            continue; // skip ms1 events
-        if (scan->rt < rtmin)
-            continue;
-        if (scan->rt > rtmax)
-            break;
-        if (scan->precursorMz >= mzmin and scan->precursorMz <= mzmax)
-        {
-            matchedscans.push_back(scan);
-        }
-    }
-    return matchedscans;
+    return sample->getFragmentScans(mzmin, mzmax, rtmin, rtmax);
 }
 
 void EIC::getRTMinMaxPerScan()
@@ -971,9 +1009,8 @@ bool EIC::makeEICSlice(mzSample *sample, float mzmin, float mzmax, float rtmin,
     int lb, scanNum;
     vector<float>::iterator mzItr;
     deque<Scan *>::iterator scanItr;
-    deque<Scan *> scans;
+    deque<Scan *> &scans = sample->scans;
 
-    scans = sample->scans;
     //binary search rt domain iterator
     Scan tmpScan(sample, 0, 1, rtmin - 0.1, 0, -1);
     scanItr = lower_bound(scans.begin(), scans.end(), &tmpScan, Scan::compRt);
@@ -1012,84 +1049,143 @@ bool EIC::makeEICSlice(mzSample *sample, float mzmin, float mzmax, float rtmin,
         if (scan->rt > rtmax)
             break;
 
-        eicMz = 0;
-        eicIntensity = 0;
-
         //binary search
         mzItr = lower_bound(scan->mz.begin(), scan->mz.end(), mzmin);
         lb = mzItr - scan->mz.begin();
 
-        switch ((EIC::EicType)eicType)
-        {
+        scanIntensity(scan, lb, mzmin, mzmax, eicType, eicMz, eicIntensity);
+        addScanPoint(scanNum, scan->rt, eicMz, eicIntensity);
+    }
 
-        //takes the maximum intensity for given m/z range in a scan
-            case EIC::MAX:
-        {
-            for (unsigned int scanIdx = lb; scanIdx < scan->nobs(); scanIdx++)
-            {
-                if (scan->mz[scanIdx] < mzmin)
-                    continue;
-                if (scan->mz[scanIdx] > mzmax)
-                    break;
+    return true;
+}
 
-                if (scan->intensity[scanIdx] > eicIntensity)
-                {
-                    eicIntensity = scan->intensity[scanIdx];
-                    eicMz = scan->mz[scanIdx];
-                }
-            }
+bool EIC::makeEICSlices(mzSample *sample, vector<EIC *> &eics, const vector<mzSlice> &windows, int mslevel, int eicType, string filterline)
+{
+    if (windows.empty())
+        return false;
+
+    float rtmin = windows[0].rtmin;
+    float rtmax = windows[0].rtmax;
+    for (unsigned int i = 1; i < windows.size(); i++)
+    {
+        rtmin = min(rtmin, windows[i].rtmin);
+        rtmax = max(rtmax, windows[i].rtmax);
+    }
+
+    deque<Scan *> &scans = sample->scans;
+    Scan tmpScan(sample, 0, 1, rtmin - 0.1, 0, -1);
+    deque<Scan *>::iterator scanItr = lower_bound(scans.begin(), scans.end(), &tmpScan, Scan::compRt);
+    if (scanItr >= scans.end())
+        return false;
+
+    for (unsigned int i = 0; i < windows.size(); i++)
+    {
+        int estimatedScans = scans.size();
+        float rtRange = windows[i].rtmax - windows[i].rtmin;
+        if (sample->maxRt - sample->minRt > 0 && rtRange / (sample->maxRt - sample->minRt) <= 1)
+            estimatedScans = rtRange / (sample->maxRt - sample->minRt) * scans.size() + 10;
+
+        eics[i]->scannum.reserve(estimatedScans);
+        eics[i]->rt.reserve(estimatedScans);
+        eics[i]->intensity.reserve(estimatedScans);
+        eics[i]->mz.reserve(estimatedScans);
+    }
+
+    int scanNum = scanItr - scans.begin() - 1;
+    for (; scanItr != scans.end(); scanItr++)
+    {
+        Scan *scan = *(scanItr);
+        scanNum++;
+
+        if (!(scan->filterLine == filterline || filterline == ""))
+            continue;
+        if (scan->mslevel != mslevel)
+            continue;
+        if (scan->rt < rtmin)
+            continue;
+        if (scan->rt > rtmax)
             break;
+
+        //windows are sorted by mzmin, so the lower bound only moves forward
+        vector<float>::iterator mzItr = scan->mz.begin();
+        for (unsigned int i = 0; i < windows.size(); i++)
+        {
+            const mzSlice &window = windows[i];
+            if (scan->rt < window.rtmin || scan->rt > window.rtmax)
+                continue;
+
+            mzItr = lower_bound(mzItr, scan->mz.end(), window.mzmin);
+            int lb = mzItr - scan->mz.begin();
+
+            float eicMz = 0, eicIntensity = 0;
+            scanIntensity(scan, lb, window.mzmin, window.mzmax, eicType, eicMz, eicIntensity);
+            eics[i]->addScanPoint(scanNum, scan->rt, eicMz, eicIntensity);
         }
+    }
+
+    return true;
+}
+
+void EIC::scanIntensity(Scan *scan, int lb, float mzmin, float mzmax, int eicType, float &eicMz, float &eicIntensity)
+{
+    eicMz = 0;
+    eicIntensity = 0;
+
+    switch ((EIC::EicType)eicType)
+    {
 
-        //takes the sum of all intensities for given m/z range in a scan
-        //associated m/z is the weighted average(with intensities as weights)
-        case EIC::SUM:
+    //takes the sum of all intensities for given m/z range in a scan
+    //associated m/z is the weighted average(with intensities as weights)
+    case EIC::SUM:
+    {
+        float n = 0;
+        for (unsigned int scanIdx = lb; scanIdx < scan->nobs(); scanIdx++)
         {
-            float n = 0;
-            for (unsigned int scanIdx = lb; scanIdx < scan->nobs(); scanIdx++)
-            {
-                if (scan->mz[scanIdx] < mzmin)
-                    continue;
-                if (scan->mz[scanIdx] > mzmax)
-                    break;
+            if (scan->mz[scanIdx] < mzmin)
+                continue;
+            if (scan->mz[scanIdx] > mzmax)
+                break;
 
-                eicIntensity += scan->intensity[scanIdx];
-                eicMz += scan->mz[scanIdx] * scan->intensity[scanIdx];
-                n += scan->intensity[scanIdx];
-            }
-            eicMz /= n;
-            break;
+            eicIntensity += scan->intensity[scanIdx];
+            eicMz += scan->mz[scanIdx] * scan->intensity[scanIdx];
+            n += scan->intensity[scanIdx];
         }
+        eicMz /= n;
+        break;
+    }
 
-        default:
+    //takes the maximum intensity for given m/z range in a scan
+    case EIC::MAX:
+    default:
+    {
+        for (unsigned int scanIdx = lb; scanIdx < scan->nobs(); scanIdx++)
         {
-            for (unsigned int scanIdx = lb; scanIdx < scan->nobs(); scanIdx++)
-            {
-                if (scan->mz[scanIdx] < mzmin)
-                    continue;
-                if (scan->mz[scanIdx] > mzmax)
-                    break;
+            if (scan->mz[scanIdx] < mzmin)
+                continue;
+            if (scan->mz[scanIdx] > mzmax)
+                break;
 
-                if (scan->intensity[scanIdx] > eicIntensity)
-                {
-                    eicIntensity = scan->intensity[scanIdx];
-                    eicMz = scan->mz[scanIdx];
-                }
+            if (scan->intensity[scanIdx] > eicIntensity)
+            {
+                eicIntensity = scan->intensity[scanIdx];
+                eicMz = scan->mz[scanIdx];
             }
-            break;
-        }
         }
-
-        this->scannum.push_back(scanNum);
-        this->rt.push_back(scan->rt);
-        this->intensity.push_back(eicIntensity);
-        this->mz.push_back(eicMz);
-        this->totalIntensity += eicIntensity;
-        if (eicIntensity > this->maxIntensity)
-            this->maxIntensity = eicIntensity;
+        break;
+    }
     }
+}
 
-    return true;
+void EIC::addScanPoint(int scanNum, float scanRt, float eicMz, float eicIntensity)
+{
+    this->scannum.push_back(scanNum);
+    this->rt.push_back(scanRt);
+    this->intensity.push_back(eicIntensity);
+    this->mz.push_back(eicMz);
+    this->totalIntensity += eicIntensity;
+    if (eicIntensity > this->maxIntensity)
+        this->maxIntensity = eicIntensity;
 }
 
 void EIC::normalizeIntensityPerScan(float scale)
@@ -13,7 +13,9 @@ class Peak;
 class PeakGroup;
 class mzSample;
 class mzPoint;
+class mzSlice;
 class Scan;
+class EICPyramid;
 
 class EIC
 {
@@ -197,6 +199,17 @@ class EIC
     */
     bool makeEICSlice(mzSample *sample, float mzmin, float mzmax, float rtmin, float rtmax, int mslevel, int eicType, string filterline);
 
+    /**
+    * @brief get EICs of a sample for many m/z windows in a single pass over its scans
+    * @details windows have to be sorted by mzmin. Every scan in the combined rt range is
+    * visited once and its sorted m/z array is walked forward across all windows. A window
+    * only receives points from scans inside its own rt range, so each EIC is the same as
+    * the one makeEICSlice pulls for that window
+    * @param eics one EIC per window, filled in place
+    * @return bool true if EICs are pulled. false otherwise
+    */
+    static bool makeEICSlices(mzSample *sample, vector<EIC *> &eics, const vector<mzSlice> &windows, int mslevel, int eicType, string filterline);
+
     void getRTMinMaxPerScan();
 
     void normalizeIntensityPerScan(float scale);
@@ -247,6 +260,14 @@ class EIC
          */
     static EIC *eicMerge(const vector<EIC *> &eics);
 
+    /**
+         * [eicMerge into an existing EIC]
+         * @method eicMerge
+         * @param  eics     []
+         * @param  merged   [overwritten, its buffers are reused]
+         */
+    static void eicMerge(const vector<EIC *> &eics, EIC *merged);
+
     /**
          * [remove Low Rank Groups ]
          * @method removeLowRankGroups
@@ -264,7 +285,29 @@ class EIC
          */
     static bool compMaxIntensity(EIC *a, EIC *b) { return a->maxIntensity > b->maxIntensity; }
 
+    /**
+    * @brief indices of the points worth drawing in a retention time range
+    * @details uses a lazily built min/max pyramid of the trace so that the
+    * cost depends on the requested resolution and not on the EIC length.
+    * Every point is returned when the range holds at most maxPoints points.
+    * @param  rtmin     start of the visible range
+    * @param  rtmax     end of the visible range
+    * @param  maxPoints resolution limit, usually twice the plot width in pixels
+    * @param  useSpline decimate the spline instead of the raw intensities
+    * @param  indices   output, increasing indices into rt/intensity/spline
+    */
+    void visiblePoints(float rtmin, float rtmax, unsigned int maxPoints, bool useSpline, vector<unsigned int> &indices);
+
   private:
+    EICPyramid *intensityPyramid; /**< display pyramid over intensity, built on first use */
+    EICPyramid *splinePyramid;    /**< display pyramid over spline, rebuilt after computeSpline */
+
+    /**
+    * @brief intensity and m/z of a scan within [mzmin, mzmax], searching from position lb
+    */
+    static void scanIntensity(Scan *scan, int lb, float mzmin, float mzmax, int eicType, float &eicMz, float &eicIntensity);
+    void addScanPoint(int scanNum, float scanRt, float eicMz, float eicIntensity);
+
     SmootherType smootherType; /**< name of selected smoothing algorithm */
 
     int baselineSmoothingWindow; /**< sets the number of scans used for smoothing in one iteration*/
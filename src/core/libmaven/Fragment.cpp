@@ -79,19 +79,16 @@ int Fragment::findClosestHighestIntensityPos(float _mz, float tolr) {
     float mzmin = _mz - tolr;
     float mzmax = _mz + tolr+0.001;
 
-    vector<float>::iterator itr = lower_bound(mzs.begin(), mzs.end(), mzmin-1);
-    int lb = itr-mzs.begin();
+    //mzs are sorted, find the window once and score only inside it
+    int lb = lower_bound(mzs.begin(), mzs.end(), mzmin) - mzs.begin();
+    int ub = lb;
     float highestIntensity=0; 
-    for(unsigned int k=lb; k < mzs.size(); k++ ) {
-        if (mzs[k] < mzmin) continue; 
-        if (mzs[k] > mzmax) break;
-        if (intensity_array[k] > highestIntensity) highestIntensity=intensity_array[k];
+    for(; ub < (int) mzs.size() && mzs[ub] <= mzmax; ub++ ) {
+        if (intensity_array[ub] > highestIntensity) highestIntensity=intensity_array[ub];
     }
 
     int bestPos=-1; float bestScore=0;
-    for(unsigned int k=lb; k < mzs.size(); k++ ) {
-        if (mzs[k] < mzmin) continue; 
-        if (mzs[k] > mzmax) break;
+    for(int k=lb; k < ub; k++ ) {
         float deltaMz = (mzs[k]-_mz); 
         float alignScore = sqrt(intensity_array[k] / highestIntensity)-(deltaMz*deltaMz);
         //	cerr << _mz << "\t" << k << "\t" << deltaMz << " " << alignScore << endl;
@@ -333,10 +330,24 @@ vector<int> Fragment::compareRanks( Fragment* a, Fragment* b, float productAmuTo
     bool verbose=false;
     if (verbose) { cerr << "\t\t "; a->printMzList(); cerr << " vs "; b->printMzList();  }
     vector<int> ranks (a->mzs.size(),-1);	//missing value == -1
-    for(unsigned int i=0; i<a->mzs.size(); i++ ) {
-        for( unsigned int j=0; j < b->mzs.size(); j++ ) {
-            if (abs(a->mzs[i]-b->mzs[j])<productAmuToll) { ranks[i] = j; break; }   //this needs optimization.. 
+
+    //walk both mz lists in increasing order. The b peaks within tolerance
+    //of an a peak form a window that only moves up, each a peak is given
+    //the first b peak of the window in b's own order
+    vector<int> aOrder = a->mzOrderInc();
+    vector<int> bOrder = b->mzOrderInc();
+    unsigned int lo = 0;
+    for(unsigned int i=0; i<aOrder.size(); i++ ) {
+        float mzA = a->mzs[aOrder[i]];
+        while (lo < bOrder.size() && b->mzs[bOrder[lo]] < mzA
+               && !(abs(mzA-b->mzs[bOrder[lo]])<productAmuToll)) lo++;
+
+        int first = -1;
+        for( unsigned int k=lo; k < bOrder.size(); k++ ) {
+            if (!(abs(mzA-b->mzs[bOrder[k]])<productAmuToll)) break;
+            if (first == -1 || bOrder[k] < first) first = bOrder[k];
         }
+        ranks[aOrder[i]] = first;
     }
     if (verbose) { cerr << " compareranks: "; for(unsigned int i=0; i < ranks.size(); i++ ) cerr << ranks[i] << " "; }
     return ranks;
@@ -355,6 +366,97 @@ vector<int> Fragment::locatePositions( Fragment* a, Fragment* b, float productAm
     return ranks;
 }
 
+namespace {
+    //copy the peaks of a spectrum in increasing mz
+    void peaksByMz(Fragment* f, vector<float>& mzs, vector<float>& intensities) {
+        if (is_sorted(f->mzs.begin(), f->mzs.end())) {
+            mzs.assign(f->mzs.begin(), f->mzs.end());
+            intensities.assign(f->intensity_array.begin(), f->intensity_array.end());
+            return;
+        }
+        vector<int> order = f->mzOrderInc();
+        mzs.resize(order.size());
+        intensities.resize(order.size());
+        for(unsigned int i=0; i<order.size(); i++) {
+            mzs[i] = f->mzs[order[i]];
+            intensities[i] = f->intensity_array[order[i]];
+        }
+    }
+
+    //plain loops over contiguous arrays, vectorized by the compiler
+    double dotProduct(const float* x, const float* y, unsigned int n) {
+        double sum=0;
+        for(unsigned int i=0; i<n; i++) sum += (double) x[i] * y[i];
+        return sum;
+    }
+
+    double squaredNorm(const float* x, unsigned int n) {
+        return dotProduct(x, x, n);
+    }
+}
+
+Fragment::SpectralScore Fragment::scoreSpectrum(Fragment* other, float productAmuToll) {
+    return scoreSpectra(this, vector<Fragment*>(1, other), productAmuToll)[0];
+}
+
+vector<Fragment::SpectralScore> Fragment::scoreSpectra(Fragment* query, const vector<Fragment*>& library, float productAmuToll) {
+    SpectralScore empty = {0, 0, 0};
+    vector<SpectralScore> scores(library.size(), empty);
+    if (!query || query->mzs.empty()) return scores;
+
+    vector<float> queryMzs, queryIntensities;
+    peaksByMz(query, queryMzs, queryIntensities);
+    double queryNorm = squaredNorm(queryIntensities.data(), queryIntensities.size());
+
+    #ifndef __APPLE__
+    #pragma omp parallel for schedule(dynamic, 64)
+    #endif
+    for(int s=0; s < (int) library.size(); s++) {
+        Fragment* other = library[s];
+        if (!other || other->mzs.empty()) continue;
+
+        thread_local vector<float> mzs, intensities;
+        peaksByMz(other, mzs, intensities);
+        scores[s] = scorePeaks(queryMzs.data(), queryIntensities.data(), queryMzs.size(), queryNorm,
+                               mzs.data(), intensities.data(), mzs.size(), productAmuToll);
+    }
+    return scores;
+}
+
+Fragment::SpectralScore Fragment::scoreSortedPeaks(const float* queryMzs, const float* queryIntensities, unsigned int queryCount,
+                                                   const float* mzs, const float* intensities, unsigned int count, float productAmuToll) {
+    return scorePeaks(queryMzs, queryIntensities, queryCount, squaredNorm(queryIntensities, queryCount),
+                      mzs, intensities, count, productAmuToll);
+}
+
+Fragment::SpectralScore Fragment::scorePeaks(const float* queryMzs, const float* queryIntensities, unsigned int queryCount, double queryNorm,
+                                             const float* mzs, const float* intensities, unsigned int count, float productAmuToll) {
+    thread_local vector<float> pairedQuery, pairedOther;
+
+    //pair peaks one to one walking both spectra in increasing mz
+    pairedQuery.clear();
+    pairedOther.clear();
+    unsigned int i=0, j=0;
+    while (i < queryCount && j < count) {
+        float delta = mzs[j] - queryMzs[i];
+        if (abs(delta) < productAmuToll) {
+            pairedQuery.push_back(queryIntensities[i++]);
+            pairedOther.push_back(intensities[j++]);
+        } else if (delta < 0) {
+            j++;
+        } else {
+            i++;
+        }
+    }
+
+    SpectralScore score;
+    score.matchedPeaks = pairedQuery.size();
+    score.dotProduct = dotProduct(pairedQuery.data(), pairedOther.data(), pairedQuery.size());
+    double norms = queryNorm * squaredNorm(intensities, count);
+    score.cosine = norms > 0 ? score.dotProduct / sqrt(norms) : 0;
+    return score;
+}
+
 void Fragment::addFragment(Fragment* b) { brothers.push_back(b); }
 
 void Fragment::buildConsensus(float productAmuToll) { 
@@ -366,6 +468,7 @@ void Fragment::buildConsensus(float productAmuToll) {
 
         vector<int>ranks=locatePositions(brother,Cons,productAmuToll);	//location 
 
+        unsigned int sorted = Cons->mzs.size();
         for(unsigned int j=0; j<ranks.size(); j++ ) {
             int   posA = ranks[j];	
             float mzB = brother->mzs[j];
@@ -379,7 +482,8 @@ void Fragment::buildConsensus(float productAmuToll) {
                 Cons->obscount.push_back(1);
             }
         }
-        Cons->sortByMz();
+        //only the unmatched peaks of this brother are out of order
+        Cons->mergeByMz(sorted);
         //cerr << "cons" << i  << " "; Cons->printFragment(productAmuToll);
     }
 
@@ -403,20 +507,18 @@ void Fragment::annotatePeptideFragementsSpectraST(float productAmuToll,string fr
     this->sortByMz();
 
     Peptide record(assignedPeptide->peptide,assignedPeptide->charge);
-    vector<FragmentIon*>ions;
+    thread_local FragmentIonTable ions;
     record.generateFragmentIons(ions,fragType);
 
+    //names are only built for ions that annotate a peak
     vector<bool>seen(mzs.size(),false);
     for(unsigned int i=0; i < ions.size(); i++) {
-        FragmentIon* ion = ions[i];
-        int pos = this->findClosestHighestIntensityPos(ion->m_mz,productAmuToll);
+        int pos = this->findClosestHighestIntensityPos(ions.ions[i].mz,productAmuToll);
         if(pos != -1 and seen[pos] == false) {
-            annotations[pos] = ion->m_ion;
+            annotations[pos] = ions.ionName(i);
             seen[pos]=true;
         }
     }
-
-    delete_all(ions);
 }
 
 
@@ -455,26 +557,34 @@ vector<int> Fragment::mzOrderInc() {
 
 
 void Fragment::sortByIntensity() { 
-    vector<int>order = intensityOrderDesc();
-    vector<float> a(mzs.size());
-    vector<float> b(intensity_array.size());
-    vector<int> c(obscount.size());
-    map<int,string>d;
-    for(unsigned int i=0; i<order.size(); i++) {
-        b[i] = intensity_array[order[i]];
-        a[i] = mzs[order[i]];
-        c[i] = obscount[order[i]];
-        if (annotations.count(order[i])>0) d[i] = annotations[order[i]];
-
-    };
-    mzs = a;
-    intensity_array = b;
-    obscount = c;
-    annotations=d;
+    applyOrder(intensityOrderDesc());
 }	
 
 void Fragment::sortByMz() { 
-    vector<int>order = mzOrderInc();
+    applyOrder(mzOrderInc());
+}	
+
+void Fragment::mergeByMz(unsigned int sorted) {
+    if (sorted >= mzs.size()) return;
+
+    //same order as sortByMz(): by mz, then by position
+    vector<int> tail(mzs.size() - sorted);
+    for(unsigned int i=0; i<tail.size(); i++) tail[i] = sorted + i;
+    stable_sort(tail.begin(), tail.end(), [this](int x, int y) { return mzs[x] < mzs[y]; });
+
+    vector<int> order(mzs.size());
+    unsigned int i=0, j=0, k=0;
+    while (i < sorted && j < tail.size()) {
+        if (mzs[tail[j]] < mzs[i]) order[k++] = tail[j++];
+        else order[k++] = i++;
+    }
+    while (i < sorted) order[k++] = i++;
+    while (j < tail.size()) order[k++] = tail[j++];
+
+    applyOrder(order);
+}
+
+void Fragment::applyOrder(const vector<int>& order) {
     vector<float> a(mzs.size());
     vector<float> b(intensity_array.size());
     vector<int> c(obscount.size());
@@ -488,11 +598,11 @@ void Fragment::sortByMz() {
 
     };
 
-    mzs = a;
-    intensity_array = b;
-    obscount = c;
-    annotations=d;
-}	
+    mzs.swap(a);
+    intensity_array.swap(b);
+    obscount.swap(c);
+    annotations.swap(d);
+}
 
 void Fragment::buildConsensusAvg() { 
     map<float,double> mz_intensity_map;
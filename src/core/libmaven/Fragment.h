@@ -9,6 +9,18 @@ class Scan;
     class Fragment { 
     public: 
 
+        /**
+         * @brief similarity of two spectra over their matched peaks
+         * @details peaks are paired one to one within the product tolerance,
+         * dotProduct sums the products of paired intensities and cosine
+         * divides it by the norms of both full spectra
+         */
+        struct SpectralScore {
+            int matchedPeaks;
+            double dotProduct;
+            double cosine;
+        };
+
         double precursorMz;				//parent
         int polarity;					//scan polarity 	+1 or -1
         vector<float> mzs;				//mz values
@@ -67,6 +79,28 @@ class Scan;
 
         static vector<int> locatePositions( Fragment* a, Fragment* b, float productAmuToll); 
 
+        /**
+         * @brief score this spectrum against another one
+         */
+        SpectralScore scoreSpectrum(Fragment* other, float productAmuToll);
+
+        /**
+         * @brief score a query spectrum against every spectrum of a library
+         * @details the query is sorted once and every library spectrum is
+         * merged against it in a single pass, library spectra may be in any
+         * order and are left unchanged
+         * @return scores in the order of library
+         */
+        static vector<SpectralScore> scoreSpectra(Fragment* query, const vector<Fragment*>& library, float productAmuToll);
+
+        /**
+         * @brief score two spectra given as peaks in increasing mz
+         * @details for spectra kept sorted elsewhere, e.g. in a SpectralLibrary,
+         * scores like scoreSpectrum() without copying or sorting
+         */
+        static SpectralScore scoreSortedPeaks(const float* queryMzs, const float* queryIntensities, unsigned int queryCount,
+                                              const float* mzs, const float* intensities, unsigned int count, float productAmuToll);
+
         void addFragment(Fragment* b);
 
         void buildConsensus(float productAmuToll);
@@ -94,5 +128,21 @@ class Scan;
         static bool compPrecursorMz(const Fragment* a, const Fragment* b);
         bool operator<(const Fragment* b) const;
         bool operator==(const Fragment* b) const;
+
+    private:
+        /**
+         * @brief sort by mz when only the peaks from position sorted onwards
+         * are out of order, gives the same order as sortByMz()
+         */
+        void mergeByMz(unsigned int sorted);
+
+        /**
+         * @brief rearrange peaks, counts and annotations so that position i
+         * holds what was at order[i]
+         */
+        void applyOrder(const vector<int>& order);
+
+        static SpectralScore scorePeaks(const float* queryMzs, const float* queryIntensities, unsigned int queryCount, double queryNorm,
+                                        const float* mzs, const float* intensities, unsigned int count, float productAmuToll);
     };
 #endif
@@ -199,6 +199,241 @@ void PeakDetector::processMassSlices() {
              << timer.elapsed();
 }
 
+int PeakDetector::processNewScans() {
+    vector<PeakGroup>& groups = mavenParameters->allgroups;
+
+    //groups were changed elsewhere, start over from the first scan
+    if (_liveGroupSlices.size() != groups.size()) {
+        groups.clear();
+        _liveSlices.clear();
+        _liveGroupSlices.clear();
+        _liveUnfinished.clear();
+        _liveScanCounts.clear();
+    }
+
+    //retention times of the scans added since the previous call
+    map<mzSample*, size_t> scanCounts = _liveScanCounts;
+    float rtmin = FLT_MAX;
+    float rtmax = -FLT_MAX;
+    for (unsigned int i = 0; i < mavenParameters->samples.size(); i++) {
+        mzSample* sample = mavenParameters->samples[i];
+        size_t& seen = scanCounts[sample];
+        for (size_t j = seen; j < sample->scans.size(); j++) {
+            Scan* scan = sample->scans[j];
+            if (scan->mslevel != 1) continue;
+            rtmin = std::min(rtmin, scan->rt);
+            rtmax = std::max(rtmax, scan->rt);
+        }
+        seen = sample->scans.size();
+    }
+
+    if (mavenParameters->minRt) rtmin = std::max(rtmin, mavenParameters->minRt);
+    if (mavenParameters->maxRt) rtmax = std::min(rtmax, mavenParameters->maxRt);
+    bool newScans = rtmin <= rtmax;
+    bool unfinished = std::find(_liveUnfinished.begin(), _liveUnfinished.end(), true)
+                      != _liveUnfinished.end();
+    if (!newScans && !unfinished) {
+        _liveScanCounts = scanCounts;
+        return 0;
+    }
+
+    mavenParameters->setAverageScanTime();
+
+    MassSlices massSlices;
+    if (newScans) {
+        massSlices.setSamples(mavenParameters->samples);
+        massSlices.setMavenParameters(mavenParameters);
+        massSlices.setMaxIntensity(mavenParameters->maxIntensity);
+        massSlices.setMinIntensity(mavenParameters->minIntensity);
+        massSlices.setMaxRt(rtmax);
+        massSlices.setMinRt(rtmin);
+        massSlices.setMaxMz(mavenParameters->maxMz);
+        massSlices.setMinMz(mavenParameters->minMz);
+        massSlices.algorithmB(mavenParameters->massCutoffMerge, mavenParameters->rtStepSize);
+    }
+
+    //slicing gives up when stopped, the new scans are sliced next time
+    if (mavenParameters->stop) return 0;
+    _liveScanCounts = scanCounts;
+
+    //known slices by m/z, to find the ones new slices overlap
+    vector<unsigned int> byMz(_liveSlices.size());
+    float maxWidth = 0;
+    for (unsigned int i = 0; i < _liveSlices.size(); i++) {
+        byMz[i] = i;
+        maxWidth = std::max(maxWidth, _liveSlices[i].mzmax - _liveSlices[i].mzmin);
+    }
+    sort(byMz.begin(), byMz.end(), [this](unsigned int a, unsigned int b) {
+        return _liveSlices[a].mzmin < _liveSlices[b].mzmin;
+    });
+
+    //slices reaching into the new scans get longer EICs and are detected
+    //again, as is every slice a new slice overlaps. A new slice grows the
+    //first known slice it overlaps. Slices a previous call did not get to
+    //are detected as well
+    vector<bool> dirty(_liveSlices.size(), false);
+    for (unsigned int i = 0; i < _liveSlices.size(); i++)
+        dirty[i] = _liveSlices[i].rtmax >= rtmin || _liveUnfinished[i];
+    vector<pair<unsigned int, mzSlice*> > grown;
+    vector<mzSlice*> added;
+    for (unsigned int i = 0; i < massSlices.slices.size(); i++) {
+        mzSlice* slice = massSlices.slices[i];
+        auto it = lower_bound(byMz.begin(), byMz.end(), slice->mzmin - maxWidth,
+                              [this](unsigned int k, float mz) {
+                                  return _liveSlices[k].mzmin < mz;
+                              });
+        bool overlaps = false;
+        for (; it != byMz.end() && _liveSlices[*it].mzmin <= slice->mzmax; ++it) {
+            const mzSlice& known = _liveSlices[*it];
+            if (known.mzmax < slice->mzmin || known.rtmax < slice->rtmin
+                || slice->rtmax < known.rtmin)
+                continue;
+            if (!overlaps) grown.push_back(make_pair(*it, slice));
+            dirty[*it] = true;
+            overlaps = true;
+        }
+        if (!overlaps) added.push_back(slice);
+    }
+
+    for (unsigned int i = 0; i < grown.size(); i++) {
+        mzSlice& known = _liveSlices[grown[i].first];
+        mzSlice* slice = grown[i].second;
+        known.mzmin = std::min(known.mzmin, slice->mzmin);
+        known.mzmax = std::max(known.mzmax, slice->mzmax);
+        known.rtmin = std::min(known.rtmin, slice->rtmin);
+        known.rtmax = std::max(known.rtmax, slice->rtmax);
+        known.ionCount = std::max(known.ionCount, slice->ionCount);
+    }
+    for (unsigned int i = 0; i < added.size(); i++) {
+        _liveSlices.push_back(*added[i]);
+        dirty.push_back(true);
+    }
+    delete_all(massSlices.slices);
+
+    vector<mzSlice*> slices;
+    for (unsigned int i = 0; i < _liveSlices.size(); i++)
+        if (dirty[i]) slices.push_back(&_liveSlices[i]);
+
+    //every dirty slice has to be detected, do not give up on a run of
+    //slices without groups
+    bool checkConvergance = mavenParameters->checkConvergance;
+    mavenParameters->checkConvergance = false;
+    size_t firstNew = groups.size();
+    vector<mzSlice*> origins;
+    unsigned int finished = detectGroups(slices, &origins);
+    mavenParameters->checkConvergance = checkConvergance;
+    for (unsigned int i = 0; i < origins.size(); i++)
+        _liveGroupSlices.push_back(origins[i] - _liveSlices.data());
+
+    //the new groups of a finished slice replace its old ones. Slices left
+    //when detection stopped keep their groups and are detected next time
+    vector<bool> done(_liveSlices.size(), false);
+    for (unsigned int i = 0; i < finished; i++)
+        done[slices[i] - _liveSlices.data()] = true;
+    _liveUnfinished.assign(_liveSlices.size(), false);
+    for (unsigned int i = 0; i < _liveSlices.size(); i++)
+        _liveUnfinished[i] = dirty[i] && !done[i];
+
+    size_t kept = 0;
+    for (size_t i = 0; i < groups.size(); i++) {
+        if (i < firstNew && done[_liveGroupSlices[i]]) continue;
+        if (kept != i) {
+            groups[kept] = std::move(groups[i]);
+            _liveGroupSlices[kept] = _liveGroupSlices[i];
+        }
+        kept++;
+    }
+    groups.erase(groups.begin() + kept, groups.end());
+    _liveGroupSlices.resize(kept);
+
+    groupsUpdated(groups);
+    return finished;
+}
+
+vector<vector<EIC*> > PeakDetector::pullEICs(vector<mzSlice*>& slices,
+                                              std::vector<mzSample*>&samples,
+                                              int peakDetect,
+                                              int smoothingWindow,
+                                              int smoothingAlgorithm,
+                                              float amuQ1,
+                                              float amuQ3,
+                                              int baseline_smoothingWindow,
+                                              int baseline_dropTopX,
+                                              double minSignalBaselineDifference,
+                                              int eicType,
+                                              string filterline)
+{
+        vector<mzSample*> vsamples;
+        for (unsigned int i = 0; i < samples.size(); i++) {
+                if (samples[i] == NULL)
+                        continue;
+                if (samples[i]->isSelected == false)
+                        continue;
+                vsamples.push_back(samples[i]);
+        }
+
+        //plain m/z-rt windows share one pass over the scans, srm and qqq
+        //slices have their own extraction
+        vector<unsigned int> windowIndex;
+        vector<mzSlice> windows;
+        for (unsigned int j = 0; j < slices.size(); j++) {
+                Compound* c = slices[j]->compound;
+                if (!slices[j]->srmId.empty())
+                        continue;
+                if (c && c->precursorMz > 0 && c->productMz > 0)
+                        continue;
+                windowIndex.push_back(j);
+                windows.push_back(*slices[j]);
+        }
+
+        vector<vector<EIC*> > sampleEics(vsamples.size());
+
+        #ifndef __APPLE__
+        #pragma omp parallel for
+        #endif
+        for (unsigned int i = 0; i < vsamples.size(); i++) {
+                mzSample* sample = vsamples[i];
+                vector<EIC*>& eics = sampleEics[i];
+                eics.assign(slices.size(), NULL);
+
+                vector<EIC*> windowEics = sample->getEICs(windows, 1, eicType, filterline);
+                for (unsigned int k = 0; k < windowEics.size(); k++)
+                        eics[windowIndex[k]] = windowEics[k];
+
+                for (unsigned int j = 0; j < slices.size(); j++) {
+                        mzSlice* slice = slices[j];
+                        Compound* c = slice->compound;
+                        if (!slice->srmId.empty()) {
+                                eics[j] = sample->getEIC(slice->srmId, eicType);
+                        } else if (c && c->precursorMz > 0 && c->productMz > 0) {
+                                eics[j] = sample->getEIC(c->precursorMz, c->collisionEnergy, c->productMz, eicType,
+                                                         filterline, amuQ1, amuQ3);
+                        }
+
+                        EIC* e = eics[j];
+                        if (e) {
+                                //if eic exists, perform smoothing
+                                EIC::SmootherType smootherType =
+                                        (EIC::SmootherType) smoothingAlgorithm;
+                                e->setSmootherType(smootherType);
+                                e->setBaselineSmoothingWindow(baseline_smoothingWindow);
+                                e->setBaselineDropTopX(baseline_dropTopX);
+                                e->setFilterSignalBaselineDiff(minSignalBaselineDifference);
+                                e->getPeakPositions(smoothingWindow);
+                        }
+                }
+        }
+
+        vector<vector<EIC*> > eics(slices.size());
+        for (unsigned int j = 0; j < slices.size(); j++) {
+                for (unsigned int i = 0; i < vsamples.size(); i++) {
+                        if (sampleEics[i][j])
+                                eics[j].push_back(sampleEics[i][j]);
+                }
+        }
+        return eics;
+}
+
 /**
  * This function finds the slices for the given compound database
  * Characteristics of a slices are minimum m/z, maximum m/z, minimum RT,
@@ -280,17 +515,34 @@ void PeakDetector::processSlices(vector<mzSlice *> &slices, string setName)
         return;
     mavenParameters->allgroups.clear();
 
+    detectGroups(slices, NULL);
+}
+
+unsigned int PeakDetector::detectGroups(vector<mzSlice *> &slices, vector<mzSlice *> *origins)
+{
     sort(slices.begin(), slices.end(), mzSlice::compIntensity);
+    size_t firstGroup = mavenParameters->allgroups.size();
+    unsigned int finished = slices.size();
 
     int converged = 0;
     int foundGroups = 0;
 
     int eicCount = 0;
+
+    //EICs of a few consecutive slices are pulled together, one pass over
+    //each sample's scans per batch
+    const unsigned int sliceBatchSize = 8;
+    unsigned int batchStart = 0;
+    vector<vector<EIC *> > batchEics;
+
     for (unsigned int s = 0; s < slices.size(); s++)
     {
 
         if (mavenParameters->stop)
+        {
+            finished = s;
             break;
+        }
         mzSlice *slice = slices[s];
 
         Compound *compound = slice->compound;
@@ -307,24 +559,33 @@ void PeakDetector::processSlices(vector<mzSlice *> &slices, string setName)
                                                                 : converged++;
             if (converged > 1000)
             {
+                finished = s;
                 break;
             }
             foundGroups = mavenParameters->allgroups.size();
         }
 
+        if (s >= batchStart + batchEics.size())
+        {
+            batchStart = s;
+            unsigned int batchEnd = std::min((unsigned int)slices.size(), s + sliceBatchSize);
+            vector<mzSlice *> batch(slices.begin() + s, slices.begin() + batchEnd);
+            batchEics = pullEICs(batch,
+                                 mavenParameters->samples,
+                                 EicLoader::PeakDetection,
+                                 mavenParameters->eic_smoothingWindow,
+                                 mavenParameters->eic_smoothingAlgorithm,
+                                 mavenParameters->amuQ1,
+                                 mavenParameters->amuQ3,
+                                 mavenParameters->baseline_smoothingWindow,
+                                 mavenParameters->baseline_dropTopX,
+                                 mavenParameters->minSignalBaselineDifference,
+                                 mavenParameters->eicType,
+                                 mavenParameters->filterline);
+        }
+
         vector<EIC *> eics;
-        eics = pullEICs(slice,
-                        mavenParameters->samples,
-                        EicLoader::PeakDetection,
-                        mavenParameters->eic_smoothingWindow,
-                        mavenParameters->eic_smoothingAlgorithm,
-                        mavenParameters->amuQ1,
-                        mavenParameters->amuQ3,
-                        mavenParameters->baseline_smoothingWindow,
-                        mavenParameters->baseline_dropTopX,
-                        mavenParameters->minSignalBaselineDifference,
-                        mavenParameters->eicType,
-                        mavenParameters->filterline);
+        eics.swap(batchEics[s - batchStart]);
 
 
         if (mavenParameters->clsf->hasModel())
@@ -398,9 +659,10 @@ void PeakDetector::processSlices(vector<mzSlice *> &slices, string setName)
             if (j >= mavenParameters->eicMaxGroups)
                 break;
 
-            PeakGroup group = peakgroups[j];
-            addPeakGroup(group);
+            addPeakGroup(std::move(peakgroups[j]));
         }
+        if (origins)
+            origins->resize(mavenParameters->allgroups.size() - firstGroup, slice);
 
         //cleanup
         delete_all(eics);
@@ -408,6 +670,7 @@ void PeakDetector::processSlices(vector<mzSlice *> &slices, string setName)
         if (mavenParameters->allgroups.size() > mavenParameters->limitGroupCount)
         {
             cerr << "Group limit exceeded!" << endl;
+            finished = s + 1;
             break;
         }
 
@@ -424,9 +687,15 @@ void PeakDetector::processSlices(vector<mzSlice *> &slices, string setName)
             sendBoostSignal(progressText, s + 1, std::min((int)slices.size(), mavenParameters->limitGroupCount));
         }
     }
+
+    //EICs pulled ahead for slices we never got to
+    for (unsigned int j = 0; j < batchEics.size(); j++)
+        delete_all(batchEics[j]);
+
+    return finished;
 }
 
-bool PeakDetector::addPeakGroup(PeakGroup& grup1) {
+bool PeakDetector::addPeakGroup(PeakGroup&& grup1) {
         bool noOverlap = true;
 
         for (unsigned int i = 0; i < mavenParameters->allgroups.size(); i++) {
@@ -441,7 +710,9 @@ bool PeakDetector::addPeakGroup(PeakGroup& grup1) {
                 }
         }
 
-        //push the group to the allgroups vector
-        mavenParameters->allgroups.push_back(grup1);
+        //push the group to the allgroups vector, without the slack left
+        //from collecting its peaks
+        grup1.peaks.shrink_to_fit();
+        mavenParameters->allgroups.push_back(std::move(grup1));
         return noOverlap;
 }
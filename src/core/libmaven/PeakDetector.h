@@ -45,6 +45,11 @@ class PeakDetector {
 public:
     boost::signals2::signal< void (const string&,unsigned int , int ) > boostSignal;
 
+    /**
+     * @brief sent by processNewScans() once all groups are up to date
+     */
+    boost::signals2::signal< void (const vector<PeakGroup>&) > groupsUpdated;
+
 	PeakDetector();
 	PeakDetector(MavenParameters* mp);
 
@@ -118,6 +123,23 @@ public:
 	 */
 	void processSlices(vector<mzSlice*>&slices, string setName);
 
+	/**
+	 * @brief update the groups with the scans added to the samples since
+	 * the previous call
+	 * @details for samples that are still being acquired, see
+	 * mzSample::appendScans(). Mass slices are only built over the new scans.
+	 * A slice found earlier that takes up new signal is grown by it, new
+	 * signal elsewhere makes new slices. The groups of these slices and of
+	 * slices whose rt range reaches into the new scans are dropped and
+	 * detected again, all other groups are kept as they were. All
+	 * groups are replaced on the first call, or when they were changed
+	 * since the previous call. If detection stops early, as when
+	 * MavenParameters::stop is set, slices it did not get to keep their
+	 * groups and are detected by the next call.
+	 * @return number of slices detected
+	 */
+	int processNewScans();
+
 	/**
 	 * @brief Filter groups on the basis of user-defined parameters
 	 * @param peakgroups vector of Peakgroup objects
@@ -141,17 +163,46 @@ public:
 			float amuQ1, float amuQ3, int baselineSmoothingWindow,
 			int baselineDropTopX, double minSignalBaselineDifference, int eicType, string filterline);
 
+	/**
+	 * @brief pull EICs of many slices with one pass over each sample's scans
+	 * @details slices with an SRM id or a precursor/product pair are pulled
+	 * one at a time, all other slices through mzSample::getEICs
+	 * @return EICs of every slice, indexed like slices, in sample order
+	 */
+	static vector<vector<EIC*> > pullEICs(vector<mzSlice*>& slices, std::vector<mzSample*>&samples,
+			int peakDetect, int smoothingWindow, int smoothingAlgorithm,
+			float amuQ1, float amuQ3, int baselineSmoothingWindow,
+			int baselineDropTopX, double minSignalBaselineDifference, int eicType, string filterline);
+
 private:
 
 	/**
 	 * [check overlap between RT for each group through all the samples; if a certain degree of overlap is present, do not create a new group]
 	 * @method addPeakGroup
-	 * @param  group        [pointer to PeakGroup]
+	 * @param  group        [PeakGroup, moved into all groups]
 	 * @return [True if group is added to all groups, else False]
 	 */
-	bool addPeakGroup(PeakGroup& grup1);
+	bool addPeakGroup(PeakGroup&& grup1);
+
+	/**
+	 * @brief detect groups of slices and append them to all groups
+	 * @details slices are sorted by intensity first
+	 * @param origins if given, receives the slice of every appended group
+	 * @return number of slices, from the start of the sorted slices, that
+	 * were detected before detection stopped
+	 */
+	unsigned int detectGroups(vector<mzSlice*>& slices, vector<mzSlice*>* origins);
+
 	MavenParameters* mavenParameters;
 	bool zeroStatus;
+
+	//state of processNewScans(): slices seen so far, slice of every group
+	//in allgroups, slices still to be detected again and number of scans
+	//of every sample already sliced
+	vector<mzSlice> _liveSlices;
+	vector<unsigned int> _liveGroupSlices;
+	vector<bool> _liveUnfinished;
+	map<mzSample*, size_t> _liveScanCounts;
 };
 
 /**
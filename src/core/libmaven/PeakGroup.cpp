@@ -1,6 +1,7 @@
 #include "PeakGroup.h"
 #include "Compound.h"
 #include "mzSample.h"
+#include "scanAverager.h"
 
 PeakGroup::PeakGroup()  {
     groupId=0;
@@ -69,7 +70,7 @@ PeakGroup::PeakGroup()  {
     peaks.resize(0);
 }
 
-void PeakGroup::copyObj(const PeakGroup& o)  {
+void PeakGroup::copyFields(const PeakGroup& o)  {
     groupId= o.groupId;
     metaGroupId= o.metaGroupId;
     clusterId = o.clusterId;
@@ -121,21 +122,35 @@ void PeakGroup::copyObj(const PeakGroup& o)  {
     parent = o.parent;
     compound = o.compound;
 
-    srmId=o.srmId;
     isFocused=o.isFocused;
     label=o.label;
 
     goodPeakCount=o.goodPeakCount;
     _type = o._type;
-    tagString = o.tagString;
 
     changeFoldRatio = o.changeFoldRatio;
     changePValue    = o.changePValue;
+}
+
+void PeakGroup::copyObj(const PeakGroup& o)  {
+    copyFields(o);
+    srmId=o.srmId;
+    tagString = o.tagString;
     peaks = o.peaks;
     samples=o.samples;
     copyChildren(o);
 }
 
+void PeakGroup::moveObj(PeakGroup& o)  {
+    copyFields(o);
+    srmId = std::move(o.srmId);
+    tagString = std::move(o.tagString);
+    peaks = std::move(o.peaks);
+    samples = std::move(o.samples);
+    children = std::move(o.children);
+    for(unsigned int i=0; i < children.size(); i++ ) children[i].parent = this;
+}
+
 PeakGroup::~PeakGroup() {
     clear();
 }
@@ -234,32 +249,21 @@ vector<float> PeakGroup::getOrderedIntensityVector(vector<mzSample*>& samples, Q
 
     if (samples.size() == 0) { vector<float>x; return x; } //empty vector;
 
-    map<mzSample*,float> sampleOrder;
+    map<mzSample*,unsigned int> sampleOrder;
     vector<float>maxIntensity(samples.size(),0);
 
     for( unsigned int j=0; j < samples.size(); j++) {
         sampleOrder[samples[j]]=j;
-        maxIntensity[j]=0;
     }
 
     for( unsigned int j=0; j < peaks.size(); j++) {
         Peak& peak = peaks.at(j);
         mzSample* sample = peak.getSample();
 
-        if ( sampleOrder.count(sample) > 0 ) {
-            int s  = sampleOrder[ sample ];
-            float y = 0;
-            switch (type)  {
-                case AreaTop: y = peak.peakAreaTopCorrected; break;
-                case Area: y = peak.peakAreaCorrected; break;
-                case Height: y = peak.peakIntensity; break;
-                case AreaNotCorrected: y = peak.peakArea; break;
-                case AreaTopNotCorrected: y = peak.peakAreaTop; break;
-                case RetentionTime: y = peak.rt; break;
-                case Quality: y = peak.quality; break;
-                case SNRatio: y = peak.signalBaselineRatio; break;
-                default: y = peak.peakIntensity; break;
-            }
+        map<mzSample*,unsigned int>::iterator order = sampleOrder.find(sample);
+        if ( order != sampleOrder.end() ) {
+            unsigned int s = order->second;
+            float y = peakQuantity(peak, type);
 
             //normalize
             if(sample) y *= sample->getNormalizationConstant();
@@ -593,6 +597,15 @@ PeakGroup& PeakGroup::operator=(const PeakGroup& o)  {
     return *this;
 }
 
+PeakGroup::PeakGroup(PeakGroup&& o) noexcept  {
+    moveObj(o);
+}
+
+PeakGroup& PeakGroup::operator=(PeakGroup&& o) noexcept  {
+    if (this != &o) moveObj(o);
+    return *this;
+}
+
 
 bool PeakGroup::operator==(const PeakGroup* o)  {
     if ( this == o ) {
@@ -602,6 +615,20 @@ bool PeakGroup::operator==(const PeakGroup* o)  {
     return false;
 }
 
+float PeakGroup::peakQuantity(Peak& peak, QType type) {
+    switch (type)  {
+        case AreaTop: return peak.peakAreaTopCorrected;
+        case Area: return peak.peakAreaCorrected;
+        case Height: return peak.peakIntensity;
+        case AreaNotCorrected: return peak.peakArea;
+        case AreaTopNotCorrected: return peak.peakAreaTop;
+        case RetentionTime: return peak.rt;
+        case Quality: return peak.quality;
+        case SNRatio: return peak.signalBaselineRatio;
+        default: return peak.peakIntensity;
+    }
+}
+
 Peak* PeakGroup::getPeak(mzSample* s ) {
     if ( s == NULL ) return NULL;
     for(unsigned int i=0; i < peaks.size(); i++ ) {
@@ -666,15 +693,8 @@ vector<Scan*> PeakGroup::getFragmenationEvents() {
         mzSample* sample = peaks[i].getSample();
         if ( sample == NULL ) continue;
 
-        for( unsigned int j=0; j < sample->scans.size(); j++ ) {
-            Scan* scan = sample->scans[j];
-            if (scan->mslevel <= 1) continue; //ms2 + scans only
-            if (scan->rt < peaks[i].rtmin) continue;
-            if (scan->rt > peaks[i].rtmax) break;
-            if( scan->precursorMz >= minMz and scan->precursorMz <= maxMz) {
-                matchedscans.push_back(scan);
-            }
-        }
+        vector<Scan*> events = sample->getFragmentScans(minMz, maxMz, peaks[i].rtmin, peaks[i].rtmax);
+        matchedscans.insert(matchedscans.end(), events.begin(), events.end());
     }
     return matchedscans;
 }
@@ -685,12 +705,11 @@ vector<Scan*> PeakGroup::getFragmenationEvents() {
    */
 //TODO: Sahil, Added while merging spectrawidget
 Scan* PeakGroup::getAverageFragmenationScan( MassCutoff *massCutoff) {
+    ScanAverager averager(massCutoff, ScanAverager::ScanCount);
+    return getAverageFragmenationScan(averager);
+}
 
-    int scanCount=0;
-    map<float,double> mz_intensity_map;
-    map<float,double> mz_bin_map;
-    map<float,int> mz_count;
-
+Scan* PeakGroup::getAverageFragmenationScan(ScanAverager& averager) {
     vector<Scan*> scans = getFragmenationEvents();
     if (scans.size() == 0 ) return NULL;
 
@@ -699,56 +718,31 @@ Scan* PeakGroup::getAverageFragmenationScan( MassCutoff *massCutoff) {
 
     if (scans.size() == 1) return avgScan;
 
-    for(unsigned int s=0; s < scans.size(); s++) {
-        Scan* scan = scans[s];
-        scanCount++;
-
-        //vector<int>positions = scan->intensityOrderDesc();
-        //for(unsigned int p=0; p <positions.size() and p<100; p++ ) {
-        for(unsigned int i=0; i < scan->nobs(); i++ ) {
-            int pos = avgScan->findClosestHighestIntensityPos(scan->mz[i],massCutoff);
-            float bin;
-            if (pos >= 0) {
-                bin = FLOATROUND(avgScan->mz[pos],1000);
-            } else {
-                bin = FLOATROUND(scan->mz[i],1000);
-            }
-            mz_intensity_map[bin] += ((double) scan->intensity[i]);
-            mz_bin_map[bin] += ((double)(scan->intensity[i])*(scan->mz[i]));
-            mz_count[bin]++;
-        }
-
-
-        //resort
-        vector<float> avgmzs;
-        vector<float> avgints;
-        map<float,double>::iterator itr;
-        for(itr = mz_intensity_map.begin(); itr != mz_intensity_map.end(); ++itr ) {
-            avgmzs.push_back((*itr).first);
-            avgints.push_back((*itr).second);
-        }
-        avgScan->mz = avgmzs;
-        avgScan->intensity = avgints;
-    }
-
-    //average
-    vector<float> avgmzs;
-    vector<float> avgints;
-    map<float,double>::iterator itr;
-    for(itr = mz_intensity_map.begin(); itr != mz_intensity_map.end(); ++itr ) {
-        float bin = (*itr).first;
-        double totalIntensity=(*itr).second;
-        double avgMz =  mz_bin_map[bin] / totalIntensity;
-        avgmzs.push_back((float)avgMz);
-        avgints.push_back((float) totalIntensity / scanCount);
-    }
-
-    avgScan->mz = avgmzs;
-    avgScan->intensity = avgints;
+    averager.average(scans, avgScan->mz, avgScan->intensity);
 
     //cout << "getAverageScan() from:" << from << " to:" << to << " scanCount:" << scanCount << "scans. mzs=" << avgScan->nobs() << endl;
     return avgScan;
+}
+
+vector<Scan*> PeakGroup::getAverageFragmenationScans(const vector<PeakGroup*>& groups, MassCutoff* massCutoff) {
+    vector<Scan*> averages(groups.size(), NULL);
+
+    #ifndef __APPLE__
+    #pragma omp parallel
+    #endif
+    {
+        //one averager per thread, its arrays are reused for every group
+        ScanAverager averager(massCutoff, ScanAverager::ScanCount);
+
+        #ifndef __APPLE__
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int i = 0; i < (int) groups.size(); i++) {
+            if (groups[i]) averages[i] = groups[i]->getAverageFragmenationScan(averager);
+        }
     }
+    return averages;
+}
 
 void PeakGroup::calGroupRank(bool deltaRtCheckFlag,
                             float compoundRTWindow,
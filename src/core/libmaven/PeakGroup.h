@@ -19,6 +19,7 @@ class Compound;
 class Peak;
 class Scan;
 class EIC;
+class ScanAverager;
 
 using namespace std;
 
@@ -38,6 +39,15 @@ class PeakGroup{
         PeakGroup(const PeakGroup& o);
         PeakGroup& operator=(const PeakGroup& o);
 
+        /**
+         * @brief take over peaks, samples and children of o instead of
+         * copying them, o is left without them
+         * @details same fields as a copy; lets vectors of groups grow, sort
+         * and erase without deep copies
+         */
+        PeakGroup(PeakGroup&& o) noexcept;
+        PeakGroup& operator=(PeakGroup&& o) noexcept;
+
         bool operator==(const PeakGroup* o);
         /**
          * [copyObj ]
@@ -221,8 +231,27 @@ class PeakGroup{
 
         vector<Scan*> getFragmenationEvents();
 
+        /**
+         * @brief average of the fragmentation events of this group, peaks of
+         * all events within massCutoff of each other are merged
+         * @details intensities are averaged over all events, a single event
+         * is returned as it is
+         * @return new scan owned by the caller, NULL without events
+         */
         Scan* getAverageFragmenationScan(MassCutoff* massCutoff);
 
+        /**
+         * @brief same as above, reusing the working arrays of averager
+         */
+        Scan* getAverageFragmenationScan(ScanAverager& averager);
+
+        /**
+         * @brief average fragmentation scans of many groups in parallel
+         * @return one scan per group, in the order of groups, NULL for groups
+         * without events
+         */
+        static vector<Scan*> getAverageFragmenationScans(const vector<PeakGroup*>& groups, MassCutoff* massCutoff);
+
         
         double getExpectedMz(int charge);
 
@@ -428,8 +457,23 @@ class PeakGroup{
          */
         void copyChildren(const PeakGroup& other);
 
+        /**
+         * @brief fields shared by copyObj and moveObj that are copied either way
+         */
+        void copyFields(const PeakGroup& o);
+
+        /**
+         * @brief move counterpart of copyObj
+         */
+        void moveObj(PeakGroup& o);
+
         vector<float> getOrderedIntensityVector(vector<mzSample*>& samples, QType type);
 
+        /**
+         * @brief quantity of type in a peak, before normalization
+         */
+        static float peakQuantity(Peak& peak, QType type);
+
         /**
          * [reorderSamples ]
          * @method reorderSamples
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*
 
@@ -1916,120 +1917,202 @@ void Peptide::generateFragmentIons(vector<FragmentIon*>& ions, string fragmentat
 
 }
 
+void Peptide::generateFragmentIons(FragmentIonTable& table, string fragmentationType) {
+
+  if (fragmentationType.empty() || fragmentationType == "CID" || fragmentationType == "CID-QTOF" || fragmentationType == "HCD") {
+
+    generateFragmentIonsCID(table);
+
+  } else if (fragmentationType == "ETD" || fragmentationType == "ETD-SA") {
+
+    generateFragmentIonsETD(table);
+  
+  } else {
+
+    generateFragmentIonsCID(table); // CID by default
+
+  }
+
+}
+
+void Peptide::generateFragmentIons(vector<Peptide*>& peptides, vector<FragmentIonTable>& tables, string fragmentationType) {
+
+  tables.resize(peptides.size());
+  for (unsigned int i = 0; i < peptides.size(); i++) {
+    if (peptides[i]) {
+      peptides[i]->generateFragmentIons(tables[i], fragmentationType);
+    } else {
+      tables[i].clear();
+    }
+  }
+
+}
+
 void Peptide::generateFragmentIonsCID(vector<FragmentIon*>& ions) {
 
+  FragmentIonTable table;
+  generateFragmentIonsCID(table);
+  table.toFragmentIons(ions);
+
+}
+
+void Peptide::generateFragmentIonsETD(vector<FragmentIon*>& ions) {
+
+  FragmentIonTable table;
+  generateFragmentIonsETD(table);
+  table.toFragmentIons(ions);
+
+}
+
+// prepareResidues - looks up the mass and neutral losses of every residue once, so that the ions
+// of all charges can be read off prefix sums instead of map lookups
+void Peptide::prepareResidues(FragmentIonTable& table) {
+
+  unsigned int n = NAA();
+  table.m_prefixMass.assign(n + 1, 0.0);
+  table.m_aaLosses.assign(n, (double*)NULL);
+  table.m_modLosses.assign(n, (double*)NULL);
+
+  for (unsigned int i = 0; i < n; i++) {
+
+    double mass = 0.0;
+    map<char, double>::iterator aa = AAMonoisotopicMassTable->find(stripped[i]);
+    if (aa != AAMonoisotopicMassTable->end()) mass = aa->second;
+
+    map<char, double*>::iterator nls = AAMonoisotopicNeutralLossTable->find(stripped[i]);
+    if (nls != AAMonoisotopicNeutralLossTable->end()) table.m_aaLosses[i] = nls->second;
+
+    if (isModsSet && !mods.empty()) {
+      map<int, string>::iterator j = mods.find(i);
+      if (j != mods.end()) {
+        // modified at this position
+        mass += getModMonoisotopicMass(j->second);
+
+        map<string, double*>::iterator modNls = modMonoisotopicNeutralLossTable->find(j->second);
+        if (modNls != modMonoisotopicNeutralLossTable->end()) table.m_modLosses[i] = modNls->second;
+
+        // hack - loss of 64 only applies to methionine oxidation, not to other oxidations, so check:
+        if (j->second == "Oxidation" && stripped[i] != 'M') table.m_modLosses[i] = NULL;
+      }
+    }
+
+    table.m_prefixMass[i + 1] = table.m_prefixMass[i] + mass;
+  }
+
+}
+
+// addResidueLosses - adds the neutral losses of residue i to the losses seen so far for ions of charge ch
+void Peptide::addResidueLosses(FragmentIonTable& table, unsigned int i, unsigned int ch) {
+
+  FragmentIonTable::LossList& losses = table.m_losses;
+
+  double* nls = table.m_aaLosses[i];
+  if (nls) {
+    unsigned int x = 0;
+    double nl = 0.0;
+    while ((nl = nls[x++]) > 0.00001) {
+      int intLoss = (int)(nl + 0.5);
+
+      // allow double H2O/NH3 losses
+      if (intLoss == 17 || intLoss == 18) {
+        if (losses.has(18)) {
+          losses.set(intLoss + 18, nl + losses.get(18));
+        } else if (losses.has(17)) {
+          losses.set(intLoss + 17, nl + losses.get(17));
+        }
+      }
+
+      losses.set(intLoss, nl);
+    }
+  }
+
+  nls = table.m_modLosses[i];
+  if (nls) {
+    unsigned int x = 0;
+    double nl = 0.0;
+    while ((nl = nls[x++]) > 0.00001) {
+      // hack - if neutral loss is too heavy - over 250 Da, this is really not a "neutral loss"
+      // but rather a charge-carrying loss (e.g. the old ICAT losses), so we will not add
+      // this fragment if the fragment charge == precursor charge.
+      if (nl > 250.0 && ch == (unsigned int)charge) continue;
+
+      losses.set((int)(nl + 0.5), nl);
+    }
+  }
+
+}
+
+void Peptide::generateFragmentIonsCID(FragmentIonTable& table) {
+
+  table.clear();
+  prepareResidues(table);
+
+  const vector<double>& prefix = table.m_prefixMass;
+  FragmentIonTable::LossList& losses = table.m_losses;
+  int n = (int)(stripped.length());
+
+  unsigned int y = table.typeIndex("y");
+  unsigned int b = table.typeIndex("b");
+  unsigned int a = table.typeIndex("a");
+  unsigned int p = table.typeIndex("p");
+
+  double water = (*AAMonoisotopicMassTable)['!'];
+  double proton = (*AAMonoisotopicMassTable)['+'];
+  double cTermMass = isModsSet && !cTermMod.empty() ? getModMonoisotopicMass(cTermMod) : 0.0;
+  double nTermMass = isModsSet && !nTermMod.empty() ? getModMonoisotopicMass(nTermMod) : 0.0;
+  double aLoss = (*AAMonoisotopicMassTable)['$'] + (*AAMonoisotopicMassTable)['o'];
+
   double precursorMH = 0.0;
   
   for (unsigned int ch = 1; ch <= (unsigned int)charge; ch++) {
     
-    map<int, double> losses; // store losses as pairs of (int value of mod mass, double value of mod mass)
-    double sum = 0.0;
-    
-    
     // BEGIN y ions and precursor
     
-    // add a water for the y ion
-    sum += (*AAMonoisotopicMassTable)['!'];
-
-    // add C-terminal modifcation mass, if any
-    if (isModsSet && !cTermMod.empty()) {
-      sum += getModMonoisotopicMass(cTermMod);
-    }
-    
-    losses[18] = (*AAMonoisotopicMassTable)['!'];
-    losses[44] = 43.98982; // CO2
-    losses[46] = 46.00548; // HCOOH
+    // a water for the y ion, the C-terminal modification mass, if any, and a proton for each charge
+    double yBase = water + cTermMass + (double)ch * proton;
     
-    // add a proton for each charge
-    sum += (double)ch * (*AAMonoisotopicMassTable)['+'];
+    losses.clear();
+    losses.set(18, water);
+    losses.set(44, 43.98982); // CO2
+    losses.set(46, 46.00548); // HCOOH
     
-    for (int i = (int)(stripped.length()) - 1; i >= 0; i--) { 
+    for (int i = n - 1; i >= 0; i--) { 
      
-      sum += (*AAMonoisotopicMassTable)[stripped[i]];
-        
-      double* nls = (*AAMonoisotopicNeutralLossTable)[stripped[i]];
-      if (nls) {
-        unsigned int x = 0;
-        double nl = 0.0;
-	while((nl = nls[x++]) > 0.00001) {
-          int intLoss = (int)(nl + 0.5);
-
-	  // allow double H2O/NH3 losses
-	  if (intLoss == 17 || intLoss == 18) {
-	    if (losses.find(18) != losses.end()) {
-	      losses[intLoss + 18] = nl + losses[18];
-	    } else if (losses.find(17) != losses.end()) {
-	      losses[intLoss + 17] = nl + losses[17];
-	    }
-	  }
-
-	  losses[intLoss] = nl;
-        }
-  
-      }
-        
-      if (isModsSet && !mods.empty()) {
-        map<int, string>::iterator j = mods.find(i);
-        if (j != mods.end()) {
-          // modified at this position
-          sum += getModMonoisotopicMass(j->second);
-          double* nls = (*modMonoisotopicNeutralLossTable)[j->second];
-
-	  // hack - loss of 64 only applies to methionine oxidation, not to other oxidations, so check:
-	  if (j->second == "Oxidation" && stripped[i] != 'M') nls = NULL;
-
-          if (nls) { 
-            unsigned int x = 0;
-            double nl = 0.0;
-            while ((nl = nls[x++]) > 0.00001) {
-              // hack - if neutral loss is too heavy - over 250 Da, this is really not a "neutral loss"
-              // but rather a charge-carrying loss (e.g. the old ICAT losses), so we will not add
-              // this fragment if the fragment charge == precursor charge. 
-              if (nl > 250.0 && ch == charge) continue;
-
-              losses[(int)(nl + 0.5)] = nl;
-            }
-          }
-        }
-      }
-        
+      double sum = yBase + (prefix[n] - prefix[i]);
+      addResidueLosses(table, i, ch);
       
       if (i > 0) {
         // this is a y ion
         unsigned int position = NAA() - (unsigned int)i;
-    	unsigned prom = 9;
-	if (ch == charge && stripped[i] != 'P' && (double)position > (double)(stripped.length()) * 0.77) prom = 6;
-        ions.push_back(new FragmentIon("y", position, 0, sum / (double)ch, ch, prom));
+        unsigned prom = 9;
+        if (ch == charge && stripped[i] != 'P' && (double)position > (double)(stripped.length()) * 0.77) prom = 6;
+        table.add(y, position, 0, sum / (double)ch, ch, prom);
         
-        for (map<int, double>::iterator n = losses.begin(); n != losses.end(); n++) {
-	  prom = 4;
-	  if (n->first == 17 || n->first == 18 || n->first == 64 || n->first == 91 || n->first == 98) {
-	    if (ch == charge) {
-	      prom = 5;
-	    } else {
-	      prom = 7;
-	    }
-	  }
-          ions.push_back(new FragmentIon("y", position, n->first, (sum - n->second) / (double)ch, ch, prom));
+        for (FragmentIonTable::LossList::iterator l = losses.begin(); l != losses.end(); l++) {
+          prom = 4;
+          if (l->first == 17 || l->first == 18 || l->first == 64 || l->first == 91 || l->first == 98) {
+            if (ch == charge) {
+              prom = 5;
+            } else {
+              prom = 7;
+            }
+          }
+          table.add(y, position, l->first, (sum - l->second) / (double)ch, ch, prom);
         }
           
-          
       } else {
         // this is really just the precursor!
         
         // add N-terminus mod, if any
-        if (isModsSet && !nTermMod.empty()) {
-          sum += getModMonoisotopicMass(nTermMod);
-        }
-        
+        sum += nTermMass;
         precursorMH = sum;
         
         // precursor -- don't consider all charges, since the precursor should carry all the charges 
         if (ch == charge) {
-          ions.push_back(new FragmentIon("p", 0, 0, sum / (double)ch, ch, 9));
+          table.add(p, 0, 0, sum / (double)ch, ch, 9);
         
-          for (map<int, double>::iterator n = losses.begin(); n != losses.end(); n++) {
-            ions.push_back(new FragmentIon("p", 0, n->first, (sum - n->second) / (double)ch, ch, 9));
+          for (FragmentIonTable::LossList::iterator l = losses.begin(); l != losses.end(); l++) {
+            table.add(p, 0, l->first, (sum - l->second) / (double)ch, ch, 9);
           }    
         }
       }
@@ -2037,106 +2120,50 @@ void Peptide::generateFragmentIonsCID(vector<FragmentIon*>& ions) {
     }
     // END y ions and precursor
     
-    // reset
-    sum = 0.0;
-    losses.clear();
-    
     // BEGIN b and a ions
     
-    // add the N-term modification mass, if any
-    if (isModsSet && !nTermMod.empty()) {
-      sum += getModMonoisotopicMass(nTermMod);
-    }
-    losses[17] = 17.026549; // loss of NH3
+    // the N-term modification mass, if any, and a proton for each charge
+    double bBase = nTermMass + (double)ch * proton;
 
-    // add a proton for each charge
-    sum += (double)ch * (*AAMonoisotopicMassTable)['+'];
+    losses.clear();
+    losses.set(17, 17.026549); // loss of NH3
     
     bool hasBasicAA = false;
     
-    for (int i = 0; i < (int)(stripped.length()) - 1; i++) {
+    for (int i = 0; i < n - 1; i++) {
       
       if (stripped[i] == 'R' || stripped[i] == 'K' || stripped[i] == 'H') hasBasicAA = true;
       
-      sum += (*AAMonoisotopicMassTable)[stripped[i]];
-      
-      double* nls = (*AAMonoisotopicNeutralLossTable)[stripped[i]];
-
-      if (nls) {
-        unsigned int x = 0;
-        double nl = 0.0;
-        while ((nl = nls[x++]) > 0.00001) {
-	  int intLoss = (int)(nl + 0.5);
-	  
-	  // allow double H2O/NH3 losses
-	  if (intLoss == 17 || intLoss == 18) {
-	    if (losses.find(18) != losses.end()) {
-	      losses[intLoss + 18] = nl + losses[18];
-	    } else if (losses.find(17) != losses.end()) {
-	      losses[intLoss + 17] = nl + losses[17];
-	    }
-	  }
-          losses[intLoss] = nl;
-        }
-      }
-      
-      if (isModsSet && !mods.empty()) {
-        map<int, string>::iterator j = mods.find(i);
-        if (j != mods.end()) {
-          // modified at this position
-          sum += getModMonoisotopicMass(j->second);
-          double* nls = (*modMonoisotopicNeutralLossTable)[j->second];
-
-	  // hack - loss of 64 only applies to methionine oxidation, not to other oxidations, so check:
-	  if (j->second == "Oxidation" && stripped[i] != 'M') nls = NULL;
-
-          if (nls) { 
-            unsigned int x = 0;
-            double nl = 0.0;
-            while ((nl = nls[x++]) > 0.00001) {
-              // hack - if neutral loss is too heavy - over 250 Da, this is really not a "neutral loss"
-              // but rather a charge-carrying loss (e.g. the old ICAT losses), so we will not add
-              // this fragment if the fragment charge == precursor charge. 
-              if (nl > 250.0 && ch == charge) continue;
-
-              losses[(int)(nl + 0.5)] = nl;
-            }
-          }
-        }
-      }
+      double sum = bBase + prefix[i + 1];
+      addResidueLosses(table, i, ch);
     
       // b ion
       unsigned int position = (unsigned int)i + 1;
       unsigned int prom = 8;
       if (ch == charge && (double)position > (double)(stripped.length()) * 0.77) prom = 5;
       if (hasBasicAA) prom++;
-      ions.push_back(new FragmentIon("b", position, 0, sum / (double)ch, ch, prom));
+      table.add(b, position, 0, sum / (double)ch, ch, prom);
         
-      for (map<int, double>::iterator n = losses.begin(); n != losses.end(); n++) {
-	prom = 4;
-	if (n->first == 17 || n->first == 18 || n->first == 64 || n->first == 91 || n->first == 98) {
-	  if (ch == charge) {
-	    prom = 5;
-	  } else {
-	    prom = 6;
-	  }
-	}
-	
-        ions.push_back(new FragmentIon("b", position, n->first, (sum - n->second) / (double)ch, ch, prom));
+      for (FragmentIonTable::LossList::iterator l = losses.begin(); l != losses.end(); l++) {
+        prom = 4;
+        if (l->first == 17 || l->first == 18 || l->first == 64 || l->first == 91 || l->first == 98) {
+          if (ch == charge) {
+            prom = 5;
+          } else {
+            prom = 6;
+          }
+        }
+        table.add(b, position, l->first, (sum - l->second) / (double)ch, ch, prom);
       }
 
       // special case, b(n-1) ion can have +18 neutral "gain"
       if (position == NAA() - 1) {
-	ions.push_back(new FragmentIon("b", position, -18, (sum + (*AAMonoisotopicMassTable)['!']) / (double)ch, ch, ch == charge ? 5 : 6));
+        table.add(b, position, -18, (sum + water) / (double)ch, ch, ch == charge ? 5 : 6);
       }
 
       // a ion
       // small a ions are more common
-      ions.push_back(new FragmentIon("a", position, 0, (sum - (*AAMonoisotopicMassTable)['$'] - (*AAMonoisotopicMassTable)['o']) / (double)ch, ch, position <= 3 && ch == 1 ? 7 : 4));
-
-
-  
-           
+      table.add(a, position, 0, (sum - aLoss) / (double)ch, ch, position <= 3 && ch == 1 ? 7 : 4);
     }
       
     // END b and a ions
@@ -2161,54 +2188,54 @@ void Peptide::generateFragmentIonsCID(vector<FragmentIon*>& ions) {
     }
   }
   
-  double waterMass = (*AAMonoisotopicMassTable)['!'];
-  double phosphoMass = (*modMonoisotopicMassTable)["Phospho"];
+  double waterMass = water;
+  double phosphoMass = getModMonoisotopicMass("Phospho");
   
   // 2 H2O loss from p-98 for phosphorylation
   if (numP > 0) {
-    ions.push_back(new FragmentIon("p", 0, 134, (precursorMH - phosphoMass - 3 * waterMass) / (double)charge, charge, 7));
+    table.add(p, 0, 134, (precursorMH - phosphoMass - 3 * waterMass) / (double)charge, charge, 7);
   }
   
   // multiple phosphorylations
   if (numP > 1) {
-    ions.push_back(new FragmentIon("p", 0, 160, (precursorMH - 2 * phosphoMass) / (double)charge, charge, 7));
-    ions.push_back(new FragmentIon("p", 0, 178, (precursorMH - 2 * phosphoMass - waterMass) / (double)charge, charge, 7));
-    ions.push_back(new FragmentIon("p", 0, 196, (precursorMH - 2 * phosphoMass - 2 * waterMass) / (double)charge, charge, 9));
-    ions.push_back(new FragmentIon("p", 0, 214, (precursorMH - 2 * phosphoMass - 3 * waterMass) / (double)charge, charge, 7));
+    table.add(p, 0, 160, (precursorMH - 2 * phosphoMass) / (double)charge, charge, 7);
+    table.add(p, 0, 178, (precursorMH - 2 * phosphoMass - waterMass) / (double)charge, charge, 7);
+    table.add(p, 0, 196, (precursorMH - 2 * phosphoMass - 2 * waterMass) / (double)charge, charge, 9);
+    table.add(p, 0, 214, (precursorMH - 2 * phosphoMass - 3 * waterMass) / (double)charge, charge, 7);
   }
   
   // uncleavable ICAT
   if (isOldICATLight) {
     // these are fragment ions of the ICAT-tag
-    ions.push_back(new FragmentIon("IC546A", 0, 0, 284.2, 1, 9));
-    ions.push_back(new FragmentIon("IC546B", 0, 0, 403.2, 1, 9));
-    ions.push_back(new FragmentIon("IC546C", 0, 0, 477.2, 1, 9));
+    table.add(table.typeIndex("IC546A"), 0, 0, 284.2, 1, 9);
+    table.add(table.typeIndex("IC546B"), 0, 0, 403.2, 1, 9);
+    table.add(table.typeIndex("IC546C"), 0, 0, 477.2, 1, 9);
     
     // the +1-charge-carrying loss from the precursors
     if (charge == 2) {
-      ions.push_back(new FragmentIon("p", 0, 284, (precursorMH - 284.2), 1, 9));
-      ions.push_back(new FragmentIon("p", 0, 403, (precursorMH - 403.2), 1, 9));  
+      table.add(p, 0, 284, (precursorMH - 284.2), 1, 9);
+      table.add(p, 0, 403, (precursorMH - 403.2), 1, 9);  
     }
     if (charge == 3) {
-      ions.push_back(new FragmentIon("p", 0, 284, (precursorMH - 284.2) / 2.0, 2, 9));
-      ions.push_back(new FragmentIon("p", 0, 403, (precursorMH - 403.2) / 2.0, 2, 9));
+      table.add(p, 0, 284, (precursorMH - 284.2) / 2.0, 2, 9);
+      table.add(p, 0, 403, (precursorMH - 403.2) / 2.0, 2, 9);
     }
   }
   
   if (isOldICATHeavy) {
     // these are fragment ions of the ICAT-tag
-    ions.push_back(new FragmentIon("IC554A", 0, 0, 288.2, 1, 9));
-    ions.push_back(new FragmentIon("IC554B", 0, 0, 411.2, 1, 9));
-    ions.push_back(new FragmentIon("IC554C", 0, 0, 485.2, 1, 9));
+    table.add(table.typeIndex("IC554A"), 0, 0, 288.2, 1, 9);
+    table.add(table.typeIndex("IC554B"), 0, 0, 411.2, 1, 9);
+    table.add(table.typeIndex("IC554C"), 0, 0, 485.2, 1, 9);
 
     // the +1-charge-carrying loss from the precursor
     if (charge == 2) {
-      ions.push_back(new FragmentIon("p", 0, 288, (precursorMH - 288.2), 1, 9));
-      ions.push_back(new FragmentIon("p", 0, 411, (precursorMH - 411.2), 1, 9));
+      table.add(p, 0, 288, (precursorMH - 288.2), 1, 9);
+      table.add(p, 0, 411, (precursorMH - 411.2), 1, 9);
     }
     if (charge == 3) {
-      ions.push_back(new FragmentIon("p", 0, 288, (precursorMH - 288.2) / 2.0, 2, 9));
-      ions.push_back(new FragmentIon("p", 0, 411, (precursorMH - 411.2) / 2.0, 2, 9));
+      table.add(p, 0, 288, (precursorMH - 288.2) / 2.0, 2, 9);
+      table.add(p, 0, 411, (precursorMH - 411.2) / 2.0, 2, 9);
     }
   }
   
@@ -2222,17 +2249,15 @@ void Peptide::generateFragmentIonsCID(vector<FragmentIon*>& ions) {
       // no such token in the table, or no listed immonium ions for that token
       continue;
     }
-    stringstream imss;
-    imss << 'I';
+    string im("I");
     for (string::size_type topos = 0; topos < to->first.length(); topos++) {
       char toc = to->first[topos];
       if (toc == '[' || toc == ']') {      
-        imss << '_';
+        im += '_';
       } else {
-        imss << toc;
+        im += toc;
       }
     }
-
  
     unsigned int imIndex = 0; 
     double imMass = 0.0; // assume +1
@@ -2240,215 +2265,101 @@ void Peptide::generateFragmentIonsCID(vector<FragmentIon*>& ions) {
     while ((imMass = (foundImmoniums->second)[imIndex++]) > 0.00001) {
     
       char imSuffix = 'A' + imIndex - 1;
-      string im = imss.str() + imSuffix;  
-    
-      ions.push_back(new FragmentIon(im, 0, 0, imMass, 1, 7));
+      table.add(table.typeIndex(im + imSuffix), 0, 0, imMass, 1, 7);
     }
       
   }
   
-  sort(ions.begin(), ions.end(), FragmentIon::sortFragmentIonPtrsByProminence);
+  table.sortByProminence();
   
 }
 
-void Peptide::generateFragmentIonsETD(vector<FragmentIon*>& ions) {
+void Peptide::generateFragmentIonsETD(FragmentIonTable& table) {
 
-  double precursorMH = 0.0;
+  table.clear();
+  prepareResidues(table);
+
+  const vector<double>& prefix = table.m_prefixMass;
+  FragmentIonTable::LossList& losses = table.m_losses;
+  int n = (int)(stripped.length());
+
+  unsigned int y = table.typeIndex("y");
+  unsigned int z = table.typeIndex("z");
+  unsigned int b = table.typeIndex("b");
+  unsigned int c = table.typeIndex("c");
+  unsigned int p = table.typeIndex("p");
+
+  double water = (*AAMonoisotopicMassTable)['!'];
+  double proton = (*AAMonoisotopicMassTable)['+'];
+  double ammonia = (*AAMonoisotopicMassTable)['a'];
+  double cTermMass = isModsSet && !cTermMod.empty() ? getModMonoisotopicMass(cTermMod) : 0.0;
+  double nTermMass = isModsSet && !nTermMod.empty() ? getModMonoisotopicMass(nTermMod) : 0.0;
+
+  // in ETD, there are charge-reduced precursors, depending on how many e- it absorbs, but
+  // they retain the precursor's protons
+  double precursorMH = charge > 0 ? monoisotopicMH() : 0.0;
   
   for (unsigned int ch = 1; ch <= (unsigned int)charge; ch++) { 
 
-    map<int, double> losses; // store losses as pairs of (int value of mod mass, double value of mod mass)
-    double sum = 0.0;
-    
     // BEGIN y/z ions and precursor
     
-    // add a water for the y ion
-    sum += (*AAMonoisotopicMassTable)['!'];
-
-    // add C-terminal modifcation mass, if any
-    if (isModsSet && !cTermMod.empty()) {
-      sum += getModMonoisotopicMass(cTermMod);
-    }
-    
-    // losses[18] = (*AAMonoisotopicMassTable)['!'];
-    // losses[44] = 43.98982; // CO2
-    // losses[46] = 46.00548; // HCOOH
+    // a water for the y ion, the C-terminal modification mass, if any, and a proton for each charge
+    double yBase = water + cTermMass + (double)ch * proton;
     
-    // add a proton for each charge
-    sum += (double)ch * (*AAMonoisotopicMassTable)['+'];
+    losses.clear();
     
-    for (int i = (int)(stripped.length()) - 1; i >= 0; i--) { 
+    for (int i = n - 1; i >= 0; i--) { 
      
-      sum += (*AAMonoisotopicMassTable)[stripped[i]];
-        
-      double* nls = (*AAMonoisotopicNeutralLossTable)[stripped[i]];
-      if (nls) {
-        unsigned int x = 0;
-        double nl = 0.0;
-	while((nl = nls[x++]) > 0.00001) {
-          int intLoss = (int)(nl + 0.5);
-
-	  // allow double H2O/NH3 losses
-	  if (intLoss == 17 || intLoss == 18) {
-	    if (losses.find(18) != losses.end()) {
-	      losses[intLoss + 18] = nl + losses[18];
-	    } else if (losses.find(17) != losses.end()) {
-	      losses[intLoss + 17] = nl + losses[17];
-	    }
-	  }
-
-	  losses[intLoss] = nl;
-        }
-  
-      }
-        
-
-      if (isModsSet && !mods.empty()) {
-        map<int, string>::iterator j = mods.find(i);
-        if (j != mods.end()) {
-          // modified at this position
-          sum += getModMonoisotopicMass(j->second);
-
-          double* nls = (*modMonoisotopicNeutralLossTable)[j->second];
-
-	  // hack - loss of 64 only applies to methionine oxidation, not to other oxidations, so check:
-	  if (j->second == "Oxidation" && stripped[i] != 'M') nls = NULL;
-
-          if (nls) { 
-            unsigned int x = 0;
-            double nl = 0.0;
-            while ((nl = nls[x++]) > 0.00001) {
-              // hack - if neutral loss is too heavy - over 250 Da, this is really not a "neutral loss"
-              // but rather a charge-carrying loss (e.g. the old ICAT losses), so we will not add
-              // this fragment if the fragment charge == precursor charge. 
-              if (nl > 250.0 && ch == charge) continue;
-
-              losses[(int)(nl + 0.5)] = nl;
-            }
-          }
-        }
-      }
+      double sum = yBase + (prefix[n] - prefix[i]);
+      addResidueLosses(table, i, ch);
       
       if (i > 0) {
-	if (ch <= (unsigned int) (charge - 1)) {
+        if (ch <= (unsigned int) (charge - 1)) {
 
-	  // this is a y/z ion
-	  unsigned int position = NAA() - (unsigned int)i;
-	  ions.push_back(new FragmentIon("y", position, 0, sum / (double)ch, ch, 6));
+          // this is a y/z ion
+          unsigned int position = NAA() - (unsigned int)i;
+          table.add(y, position, 0, sum / (double)ch, ch, 6);
 	  
-	  // subtract an ammonia to get the z, add a proton to get zdot
-	  // NOTE: In annotations, "z" actually means zdot!!
-	  double zsum = sum - (*AAMonoisotopicMassTable)['a'] + (*AAMonoisotopicMassTable)['+'];
-	  ions.push_back(new FragmentIon("z", position, 0, zsum / (double)ch, ch, 8));
-	}	  
+          // subtract an ammonia to get the z, add a proton to get zdot
+          // NOTE: In annotations, "z" actually means zdot!!
+          double zsum = sum - ammonia + proton;
+          table.add(z, position, 0, zsum / (double)ch, ch, 8);
+        }	  
           
       } else {
         // this is really just the precursor!
+        table.add(p, 0, 0, precursorMH / (double)ch, ch, 9);
         
-        // add N-terminus mod, if any
-        if (isModsSet && !nTermMod.empty()) {
-          sum += getModMonoisotopicMass(nTermMod);
-        }
-       
-        
-        // in ETD, there are charge-reduced precursors, depending on how many e- it absorbs, but
-	// they retain the precursor's protons
-        precursorMH = monoisotopicMH();
-	ions.push_back(new FragmentIon("p", 0, 0, precursorMH / (double)ch, ch, 9));
-        
-	for (map<int, double>::iterator n = losses.begin(); n != losses.end(); n++) {
-	  ions.push_back(new FragmentIon("p", 0, n->first, (precursorMH - n->second) / (double)ch, ch, 9));
-	}    
-        
+        for (FragmentIonTable::LossList::iterator l = losses.begin(); l != losses.end(); l++) {
+          table.add(p, 0, l->first, (precursorMH - l->second) / (double)ch, ch, 9);
+        }    
       }
         
     }
     // END y ions and precursor
     
-    // reset
-    sum = 0.0;
-    // losses.clear();
+    // BEGIN b and c ions
     
-    // BEGIN b and a ions
+    // the N-term modification mass, if any, and a proton for each charge
+    double bBase = nTermMass + (double)ch * proton;
     
-    // add the N-term modification mass, if any
-    if (isModsSet && !nTermMod.empty()) {
-      sum += getModMonoisotopicMass(nTermMod);
-    }
-
-    // losses[17] = 17.026549; // loss of NH3
-
-    // add a proton for each charge
-    sum += (double)ch * (*AAMonoisotopicMassTable)['+'];
-    
-    for (int i = 0; i < (int)(stripped.length()) - 1; i++) {
-      sum += (*AAMonoisotopicMassTable)[stripped[i]];
-      
-      /*
-      double* nls = (*AAMonoisotopicNeutralLossTable)[stripped[i]];
-
-      if (nls) {
-        unsigned int x = 0;
-        double nl = 0.0;
-        while ((nl = nls[x++]) > 0.00001) {
-	  int intLoss = (int)(nl + 0.5);
-	  
-	  // allow double H2O/NH3 losses
-	  if (intLoss == 17 || intLoss == 18) {
-	    if (losses.find(18) != losses.end()) {
-	      losses[intLoss + 18] = nl + losses[18];
-	    } else if (losses.find(17) != losses.end()) {
-	      losses[intLoss + 17] = nl + losses[17];
-	    }
-	  }
-          losses[intLoss] = nl;
-        }
-      }
-      */
-      if (isModsSet && !mods.empty()) {
-        map<int, string>::iterator j = mods.find(i);
-        if (j != mods.end()) {
-          // modified at this position
-          sum += getModMonoisotopicMass(j->second);
-       
-	  /*
-	  double* nls = (*modMonoisotopicNeutralLossTable)[j->second];
-
-	  // hack - loss of 64 only applies to methionine oxidation, not to other oxidations, so check:
-	  if (j->second == "Oxidation" && stripped[i] != 'M') nls = NULL;
-
-          if (nls) { 
-            unsigned int x = 0;
-            double nl = 0.0;
-            while ((nl = nls[x++]) > 0.00001) {
-              // hack - if neutral loss is too heavy - over 250 Da, this is really not a "neutral loss"
-              // but rather a charge-carrying loss (e.g. the old ICAT losses), so we will not add
-              // this fragment if the fragment charge == precursor charge. 
-              if (nl > 250.0 && ch == charge) continue;
-
-              losses[(int)(nl + 0.5)] = nl;
-            }
-          }
-	  */
-        }
-      }
+    for (int i = 0; i < n - 1; i++) {
+      double sum = bBase + prefix[i + 1];
     
       // b ion
       unsigned int position = (unsigned int)i + 1;
-      ions.push_back(new FragmentIon("b", position, 0, sum / (double)ch, ch, 5));
+      table.add(b, position, 0, sum / (double)ch, ch, 5);
 
       // add an ammonium to get the c ion
-      double csum = sum + (*AAMonoisotopicMassTable)['a'];
-      ions.push_back(new FragmentIon("c", position, 0, csum / (double)ch, ch, 8));
-
-   
+      double csum = sum + ammonia;
+      table.add(c, position, 0, csum / (double)ch, ch, 8);
     }
       
     // END b and c ions
   
   } // for all charges <= pep.charge - 1
   
-  sort(ions.begin(), ions.end(), FragmentIon::sortFragmentIonPtrsByProminence);
+  table.sortByProminence();
 
 }
 
@@ -3333,6 +3244,151 @@ bool FragmentIon::sortFragmentIonPtrsByProminence(FragmentIon* a, FragmentIon* b
 }
 
 
+// =============================================================================
+// FRAGMENT ION TABLE
+
+void FragmentIonTable::clear() {
+  ions.clear();
+}
+
+unsigned int FragmentIonTable::typeIndex(const string& type) {
+  for (unsigned int i = 0; i < types.size(); i++) {
+    if (types[i] == type) return (i);
+  }
+  types.push_back(type);
+  return ((unsigned int)types.size() - 1);
+}
+
+void FragmentIonTable::add(unsigned int type, int pos, int loss, double mz, unsigned int ch, unsigned int prominence) {
+  Ion ion;
+  ion.mz = mz;
+  ion.charge = ch;
+  ion.prominence = prominence;
+  ion.pos = pos;
+  ion.loss = loss;
+  ion.type = type;
+  ions.push_back(ion);
+}
+
+// appendName - appends text to buffer as far as it fits, keeping room for the terminating zero
+static void appendName(char* buffer, unsigned int size, unsigned int& len, const char* text, unsigned int n) {
+  for (unsigned int i = 0; i < n && len + 1 < size; i++) buffer[len++] = text[i];
+  buffer[len] = '\0';
+}
+
+static void appendNumber(char* buffer, unsigned int size, unsigned int& len, char prefix, unsigned int value) {
+  char digits[12];
+  unsigned int n = 0;
+  do {
+    digits[11 - n++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  if (prefix) digits[11 - n++] = prefix;
+  appendName(buffer, size, len, digits + 12 - n, n);
+}
+
+// formatName - writes the annotation of an ion the way the FragmentIon constructor does, returns its length
+unsigned int FragmentIonTable::formatName(const Ion& ion, char* buffer, unsigned int size) {
+  unsigned int len = 0;
+  const string& type = types[ion.type];
+  appendName(buffer, size, len, type.c_str(), type.length());
+  
+  if (ion.pos > 0) {
+    appendNumber(buffer, size, len, 0, ion.pos);
+  }
+  
+  if (ion.loss > 0) {
+    appendNumber(buffer, size, len, '-', ion.loss);
+  } else if (ion.loss < 0) {
+    appendNumber(buffer, size, len, '+', -ion.loss);
+  }
+
+  if (ion.charge != 1) {
+    appendNumber(buffer, size, len, '^', ion.charge);
+  }
+  
+  return (len);
+}
+
+string FragmentIonTable::ionName(unsigned int i) {
+  char buffer[256];
+  unsigned int len = formatName(ions[i], buffer, sizeof(buffer));
+  return (string(buffer, len));
+}
+
+void FragmentIonTable::sortByProminence() {
+
+  // names are written once into fixed size slots instead of being built as strings. Ions are
+  // sorted on a key holding prominence, charge and the first bytes of the name, full names
+  // are only compared when those are equal
+  struct SortKey {
+    unsigned long long order;
+    unsigned long long prefix;
+    unsigned int index;
+  };
+
+  const unsigned int slot = 64;
+  vector<char> names(ions.size() * slot);
+  vector<SortKey> keys(ions.size());
+  for (unsigned int i = 0; i < ions.size(); i++) {
+    char* name = &names[i * slot];
+    unsigned int len = formatName(ions[i], name, slot);
+
+    SortKey& key = keys[i];
+    key.order = ((unsigned long long)(~ions[i].prominence) << 32) | ions[i].charge;
+    key.prefix = 0;
+    for (unsigned int k = 0; k < 8; k++) {
+      key.prefix = (key.prefix << 8) | (k < len ? (unsigned char)name[k] : 0);
+    }
+    key.index = i;
+  }
+
+  sort(keys.begin(), keys.end(), [&names, slot](const SortKey& a, const SortKey& b) {
+    // higher prominence first, in case of a tie, annotate with ion of smaller charge first
+    if (a.order != b.order) return (a.order < b.order);
+    // if still tied, sort by ion string
+    if (a.prefix != b.prefix) return (a.prefix < b.prefix);
+    return (strcmp(&names[a.index * slot], &names[b.index * slot]) < 0);
+  });
+
+  vector<Ion> sorted(ions.size());
+  for (unsigned int i = 0; i < keys.size(); i++) sorted[i] = ions[keys[i].index];
+  ions.swap(sorted);
+
+}
+
+static bool lossBefore(const pair<int, double>& a, int key) {
+  return (a.first < key);
+}
+
+void FragmentIonTable::LossList::set(int key, double loss) {
+  iterator found = lower_bound(m_losses.begin(), m_losses.end(), key, lossBefore);
+  if (found != m_losses.end() && found->first == key) {
+    found->second = loss;
+  } else {
+    m_losses.insert(found, make_pair(key, loss));
+  }
+}
+
+bool FragmentIonTable::LossList::has(int key) {
+  iterator found = lower_bound(m_losses.begin(), m_losses.end(), key, lossBefore);
+  return (found != m_losses.end() && found->first == key);
+}
+
+double FragmentIonTable::LossList::get(int key) {
+  iterator found = lower_bound(m_losses.begin(), m_losses.end(), key, lossBefore);
+  if (found != m_losses.end() && found->first == key) return (found->second);
+  return (0.0);
+}
+
+void FragmentIonTable::toFragmentIons(vector<FragmentIon*>& fragmentIons) {
+  for (unsigned int i = 0; i < ions.size(); i++) {
+    const Ion& ion = ions[i];
+    fragmentIons.push_back(new FragmentIon(types[ion.type], ion.pos, ion.loss, ion.mz, ion.charge, ion.prominence));
+  }
+}
+
+
 
 // TOKENIZER
 
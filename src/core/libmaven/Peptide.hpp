@@ -76,6 +76,76 @@ public:
   static bool sortFragmentIonPtrsByProminence(FragmentIon* a, FragmentIon* b); 
 };
 
+/* Class: FragmentIonTable
+ *
+ * The fragment ions of a peptide as plain values in one array, filled by
+ * Peptide::generateFragmentIons(FragmentIonTable&). Ion types are stored as indices into a short
+ * list of type names, and the annotation string of an ion (what FragmentIon::m_ion holds) is
+ * only built when asked for. A table keeps its memory when it is refilled, so one table can be
+ * reused for many peptides.
+ */
+class FragmentIonTable {
+
+  friend class Peptide;
+
+public:
+
+  struct Ion {
+    double mz;
+    unsigned int charge;
+    unsigned int prominence;
+    int pos;
+    int loss;
+    unsigned int type; // index into types
+  };
+
+  vector<Ion> ions;
+  vector<string> types;
+
+  // removes all ions, type names are kept for the next peptide
+  void clear();
+
+  unsigned int size() { return ((unsigned int)ions.size()); }
+
+  // returns the index of a type name, adding it if it is new
+  unsigned int typeIndex(const string& type);
+
+  void add(unsigned int type, int pos, int loss, double mz, unsigned int ch, unsigned int prominence);
+
+  // annotation of ion i, e.g. y7-18^2
+  string ionName(unsigned int i);
+
+  // same order as sorting FragmentIon pointers with FragmentIon::sortFragmentIonPtrsByProminence
+  void sortByProminence();
+
+  // appends newly allocated FragmentIons, for callers of the pointer based interface
+  void toFragmentIons(vector<FragmentIon*>& fragmentIons);
+
+private:
+
+  // neutral losses keyed by their nominal mass, iterated in increasing key order
+  class LossList {
+  public:
+    typedef vector<pair<int, double> >::iterator iterator;
+    void clear() { m_losses.clear(); }
+    bool has(int key);
+    double get(int key);
+    void set(int key, double loss);
+    iterator begin() { return (m_losses.begin()); }
+    iterator end() { return (m_losses.end()); }
+  private:
+    vector<pair<int, double> > m_losses;
+  };
+
+  // scratch space of the generator
+  vector<double> m_prefixMass; // mass of the first i residues, with mods
+  vector<double*> m_aaLosses;
+  vector<double*> m_modLosses;
+  LossList m_losses;
+
+  unsigned int formatName(const Ion& ion, char* buffer, unsigned int size);
+};
+
 class Peptide {
 	
 public:
@@ -151,6 +221,14 @@ public:
   void generateFragmentIonsCID(vector<FragmentIon*>& ions);
   void generateFragmentIonsETD(vector<FragmentIon*>& ions);
 
+  // same ions in a flat table, in the same order
+  void generateFragmentIons(FragmentIonTable& table, string fragmentationType = "CID");
+  void generateFragmentIonsCID(FragmentIonTable& table);
+  void generateFragmentIonsETD(FragmentIonTable& table);
+
+  // ions of many peptides, one table per peptide; tables are reused if the vector is passed again
+  static void generateFragmentIons(vector<Peptide*>& peptides, vector<FragmentIonTable>& tables, string fragmentationType = "CID");
+
   // method to shuffle the peptide sequence randomly
   // string shufflePeptideSequence();
   Peptide* shufflePeptideSequence(map<int, set<string> >& allSequences);
@@ -216,6 +294,10 @@ private:
   bool stripPeptide(string pep);
   
  static double calcApproximateAverageMass(double monoisotopicMass);
+
+  // helpers of the fragment ion generators
+  void prepareResidues(FragmentIonTable& table);
+  void addResidueLosses(FragmentIonTable& table, unsigned int i, unsigned int ch);
  string nextToken(string s, string::size_type from, string::size_type& tokenEnd, const char* delim = " \t\r\n", const char* skipover = " \t\r\n");
 
 	
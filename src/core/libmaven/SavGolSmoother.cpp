@@ -15,7 +15,10 @@
  ***************************************************************************/
 
 #include "SavGolSmoother.h"
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <tuple>
 namespace mzUtils
 {
 
@@ -117,32 +120,46 @@ namespace mzUtils
     {
         int size = (int) intensities.size() ;
         mvect_temp_y.resize(size);
+        Smooth(intensities.data(), mvect_temp_y.data(), size) ;
+        return mvect_temp_y;
+    }
 
-        for (int i = 0 ; i < size ; i++)
+    void SavGolSmoother::Smooth(const float *in, float *out, int size) const
+    {
+        int num_coeffs = mint_Nleft_golay + mint_Nright_golay + 1 ;
+
+        // dont worry about smoothing the ends just copy them
+        int first = mint_Nleft_golay ;
+        int end = size - mint_Nright_golay - 1 ;
+        if (end < first) end = first ;
+        for (int i = 0 ; i < std::min(first, size) ; i++)
+            out[i] = in[i] ;
+        for (int i = end ; i < size ; i++)
+            out[i] = in[i] ;
+        if (end == first) return ;
+
+        // accumulate one coefficient at a time over all points, each point
+        // still sums its terms in coefficient order
+        for (int i = first ; i < end ; i++)
+            out[i] = 0 ;
+        for (int k = 0 ; k < num_coeffs ; k++)
         {
-            int start_index = i - mint_Nleft_golay ;
-            int stop_index =  i + mint_Nright_golay +1 ;
-            mvect_temp_y[i] = 0;
-
-            if (start_index < 0 || stop_index >= size)
-            {
-                // dont worry about smoothing just push back and forget.
-                mvect_temp_y[i] = intensities[i];
-                continue ;
-            }
-
-            float sum = 0 ;
-            float sum_before = 0 ;
-            for (int j = start_index ; j < stop_index ; j++)
-            {
-                sum_before = sum ;
-                float val = intensities.at(j) * mvect_coefficients[j-start_index]  ;
-                sum = sum_before + val ;
-            }
-
-            if (sum < 0) sum = 0 ;
-            mvect_temp_y[i]=sum;
+            float c = mvect_coefficients[k] ;
+            const float *src = in - mint_Nleft_golay + k ;
+            for (int i = first ; i < end ; i++)
+                out[i] += src[i] * c ;
         }
-       return mvect_temp_y;
+        for (int i = first ; i < end ; i++)
+            if (out[i] < 0) out[i] = 0 ;
+    }
+
+    const SavGolSmoother& SavGolSmoother::cached(int num_left, int num_right, int order)
+    {
+        thread_local std::map<std::tuple<int, int, int>, SavGolSmoother> smoothers ;
+        std::tuple<int, int, int> key(num_left, num_right, order) ;
+        std::map<std::tuple<int, int, int>, SavGolSmoother>::iterator it = smoothers.find(key) ;
+        if (it == smoothers.end())
+            it = smoothers.insert(std::make_pair(key, SavGolSmoother(num_left, num_right, order))).first ;
+        return it->second ;
     }
 }
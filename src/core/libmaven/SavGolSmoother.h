@@ -40,5 +40,11 @@ namespace mzUtils
         ~SavGolSmoother() ;
         void Smooth(std::vector<float> *mzs, std::vector<float> *intensities) ;
         std::vector<float> Smooth(std::vector<float>& intensities);
+
+        //! smooth size values of in into out, which must not overlap in.
+        void Smooth(const float *in, float *out, int size) const ;
+
+        //! smoother with these options, built once per thread and kept.
+        static const SavGolSmoother& cached(int num_left, int num_right, int order) ;
     };
 }
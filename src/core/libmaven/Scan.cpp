@@ -170,11 +170,13 @@ vector<float> Scan::smoothenIntensitites() {
 
 
 
-    mzUtils::SavGolSmoother smoother(smoothWindow,smoothWindow,order);
+    const mzUtils::SavGolSmoother& smoother = mzUtils::SavGolSmoother::cached(smoothWindow,smoothWindow,order);
+    int n = intensity.size();
+    vector<float> once(n), spline(n);
     //smooth once
-    vector<float>spline = smoother.Smooth(intensity);
+    smoother.Smooth(intensity.data(), once.data(), n);
     //smooth twice
-    spline = smoother.Smooth(spline);
+    smoother.Smooth(once.data(), spline.data(), n);
 
     return spline;
 }
@@ -446,6 +448,35 @@ string Scan::toMGF() {
     return buffer.str();
 }
 
+void Scan::findHighestIntensityPositions(float offset, MassCutoff *massCutoff, const vector<int> &positions, vector<int> &matches) {
+    //targets grow with the positions, so both window ends only move forward;
+    //they are moved back as well in case rounding ever shrinks a window end
+    unsigned int N = nobs();
+    unsigned int lb = 0, ub = 0;
+    matches.resize(positions.size());
+    for (unsigned int i = 0; i < positions.size(); i++) {
+        float _mz = mz[positions[i]] + offset;
+        double cutoff = massCutoff->massCutoffValue(_mz);
+        float mzmin = _mz - cutoff;
+        float mzmax = _mz + cutoff;
+
+        while (lb < N && mz[lb] < mzmin) lb++;
+        while (lb > 0 && !(mz[lb - 1] < mzmin)) lb--;
+        if (ub < lb) ub = lb;
+        while (ub < N && !(mz[ub] > mzmax)) ub++;
+        while (ub > lb && mz[ub - 1] > mzmax) ub--;
+
+        int bestPos=-1;  float highestIntensity=0;
+        for (unsigned int k = lb; k < ub; k++) {
+            if (intensity[k] > highestIntensity) {
+                highestIntensity=intensity[k];
+                bestPos=k;
+            }
+        }
+        matches[i] = bestPos;
+    }
+}
+
 vector<int> Scan::assignCharges(MassCutoff *massCutoffTolr) {
     if ( nobs() == 0) {
         vector<int>empty;
@@ -462,78 +493,90 @@ vector<int> Scan::assignCharges(MassCutoff *massCutoffTolr) {
     vector<int>intensityOrder = intensityOrderDesc();
     double NMASS=C13_MASS-12.00;
 
+    MassCutoff massCutoff=*massCutoffTolr;
+    massCutoff.setMassCutoffAndType(2*massCutoffTolr->getMassCutoff(),massCutoffTolr->getMassCutoffType());
+
     //a little silly, required number of peaks in a series in already to call a charge
                           //z=0,   z=1,    z=2,   z=3,    z=4,   z=5,    z=6,     z=7,   z=8,
     int minSeriesSize[9] = { 1,     2,     3,      3,      3,     4,      4,       4,     5  } ;
 
-    //for every position in a scan
-    for(int i=0; i < N; i++ ) {
-        int pos=intensityOrder[i];
-        float centerMz = mz[pos];
-        float centerInts = intensity[pos];
-       // float ppm = (0.125/centerMz)*1e6;
-       MassCutoff massCutoff=*massCutoffTolr;
-       massCutoff.setMassCutoffAndType(2*massCutoffTolr->getMassCutoff(),massCutoffTolr->getMassCutoffType());
-       // cerr << pos << " " <<  centerMz << " " << centerInts << " " << clusterNumber << endl;
-        if (chargeStates[pos] != 0) continue;  //charge already assigned
-
-        //check for charged peak groups
-        int bestZ=0; int maxSeriesIntenisty=0;
-        vector<int>bestSeries;
-
-
-        //determine most likely charge state
-        for(int z=5; z>=1; z--) {
-            float delta = NMASS/z;
-            int zSeriesIntensity=centerInts;
-            vector<int>series;
-
-
-            for(int j=1; j<6; j++) { //forward
-                float mz=centerMz+(j*delta);
+    //the series of a peak does not depend on charges assigned to other peaks,
+    //so the best series of every peak is found up front. Every isotope step
+    //of a charge is matched in one sweep along m/z over the peaks whose
+    //series is still growing.
+    const int forwardSteps = 5, backSteps = 2, steps = forwardSteps + backSteps;
+    vector<int>seriesIntensity(N);
+    vector<int>series(N * steps);
+    vector<int>seriesSize(N);
+    vector<int>bestZ(N, 0);
+    vector<int>maxSeriesIntensity(N, 0);
+    vector<int>bestSeries(N * steps);
+    vector<int>bestSeriesSize(N, 0);
+    vector<int>growing, matches;
+    growing.reserve(N);
+    matches.reserve(N);
+
+    //determine most likely charge state
+    for(int z=5; z>=1; z--) {
+        float delta = NMASS/z;
+        for(int pos=0; pos < N; pos++) {
+            seriesIntensity[pos]=intensity[pos];
+            seriesSize[pos]=0;
+        }
 
-                int matchedPos = findHighestIntensityPos(mz,&massCutoff);
-                if (matchedPos>0 && intensity[matchedPos]<centerInts) {
-                    series.push_back(matchedPos);
-                    zSeriesIntensity += intensity[matchedPos];
-                } else break;
+        for(int direction=1; direction >= -1; direction -= 2) {
+            growing.resize(N);
+            for(int pos=0; pos < N; pos++) growing[pos]=pos;
+
+            int maxSteps = direction > 0 ? forwardSteps : backSteps;
+            for(int j=1; j<=maxSteps && !growing.empty(); j++) {
+                findHighestIntensityPositions(direction*(j*delta), &massCutoff, growing, matches);
+
+                unsigned int kept=0;
+                for(unsigned int i=0; i < growing.size(); i++) {
+                    int pos=growing[i];
+                    int matchedPos=matches[i];
+                    if (matchedPos>0 && intensity[matchedPos]<intensity[pos]) {
+                        series[pos * steps + seriesSize[pos]++]=matchedPos;
+                        seriesIntensity[pos] += intensity[matchedPos];
+                        growing[kept++]=pos;
+                    }
+                }
+                growing.resize(kept);
             }
+        }
 
-            for(int j=1; j<3; j++) {  //back
-                float mz=centerMz-(j*delta);
-                int matchedPos = findHighestIntensityPos(mz,&massCutoff);
-                if (matchedPos>0 && intensity[matchedPos]<centerInts) {
-                    series.push_back(matchedPos);
-                    zSeriesIntensity += intensity[matchedPos];
-                } else break;
-            } 
-            //cerr << endl;
-            if (zSeriesIntensity>maxSeriesIntenisty) { bestZ=z; maxSeriesIntenisty=zSeriesIntensity; bestSeries=series; }
+        for(int pos=0; pos < N; pos++) {
+            if (seriesIntensity[pos]>maxSeriesIntensity[pos]) {
+                bestZ[pos]=z;
+                maxSeriesIntensity[pos]=seriesIntensity[pos];
+                bestSeriesSize[pos]=seriesSize[pos];
+                std::copy(&series[pos * steps], &series[pos * steps] + seriesSize[pos], &bestSeries[pos * steps]);
+            }
         }
+    }
 
-        //if ( i < 50) cerr << centerMz << " " << bestZ << " " << bestSeries.size() << " " << minSeriesSize[bestZ] << endl;
+    //for every position in a scan, from the most intense
+    for(int i=0; i < N; i++ ) {
+        int pos=intensityOrder[i];
+        if (chargeStates[pos] != 0) continue;  //charge already assigned
 
         //series with highest intensity is taken to be be the right one
-        if(bestZ > 0 and bestSeries.size() >= minSeriesSize[bestZ] ) {
+        int z = bestZ[pos];
+        if(z > 0 and bestSeriesSize[pos] >= minSeriesSize[z] ) {
             clusterNumber++;
             int parentPeakPos=pos;
-            for(unsigned int j=0; j<bestSeries.size();j++) {
-                int brother_pos =bestSeries[j];
-                if(bestZ > 1 and mz[brother_pos] < mz[parentPeakPos]
+            for(int j=0; j<bestSeriesSize[pos];j++) {
+                int brother_pos =bestSeries[pos * steps + j];
+                if(z > 1 and mz[brother_pos] < mz[parentPeakPos]
                         and intensity[brother_pos] < intensity[parentPeakPos]
                         and intensity[brother_pos] > intensity[parentPeakPos]*0.25)
                         parentPeakPos=brother_pos;
-                chargeStates[brother_pos]=bestZ;
+                chargeStates[brother_pos]=z;
                 peakClusters[brother_pos]=clusterNumber;
              }
-
-           //if ( i < 50 ) cerr << "c12parent: " << mz[parentPeakPos] << endl;
             peakClusters[parentPeakPos]=clusterNumber;
-            parentPeaks[parentPeakPos]=bestZ;
-
-
-            //cerr << "z-series: " <<  mz[pos] << endl;
-            //cerr << "parentPeak=" << mz[parentPeakPos] << " " << bestZ << endl;
+            parentPeaks[parentPeakPos]=z;
         }
     }
     return parentPeaks;
@@ -212,5 +212,11 @@ class Scan
     */
     void findLocalMaximaInIntensitySpace(int vsize, vector<float> *cMz, vector<float> *cIntensity, vector<float> *spline);
     void updateIntensityWithTheLocalMaximas(vector<float> *cMz, vector<float> *cIntensity);
+
+    /**
+    *@brief findHighestIntensityPos(mz[pos] + offset) for every pos in positions, which must be increasing
+    *@details sweeps both ends of the m/z window along the sorted m/z once instead of searching for every position
+    */
+    void findHighestIntensityPositions(float offset, MassCutoff *massCutoff, const vector<int> &positions, vector<int> &matches);
 };
 #endif
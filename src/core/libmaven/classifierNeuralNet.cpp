@@ -20,6 +20,14 @@ ClassifierNeuralNet::ClassifierNeuralNet() {
 //	features_names.push_back("widePeak");			//f10
 }
 
+ClassifierNeuralNet::ClassifierNeuralNet(const ClassifierNeuralNet& other)
+		: Classifier(other) {
+	hidden_layer = other.hidden_layer;
+	num_outputs = other.num_outputs;
+	trainingSize = other.trainingSize;
+	brain = other.brain ? new nnwork(*other.brain) : NULL;
+}
+
 ClassifierNeuralNet::~ClassifierNeuralNet() {
 	if (brain)
 		delete (brain);
@@ -50,6 +58,12 @@ void ClassifierNeuralNet::loadModel(string filename) {
 
 vector<float> ClassifierNeuralNet::getFeatures(Peak& p) {
 	vector<float> set(num_features, 0);
+	getFeatures(p, set.data());
+	return set;
+}
+
+void ClassifierNeuralNet::getFeatures(const Peak& p, float* set) {
+	std::fill(set, set + num_features, 0.0f);
 	if (p.width > 0) {
 		set[0] = p.peakAreaFractional;
 		set[1] = p.noNoiseFraction;
@@ -67,7 +81,6 @@ vector<float> ClassifierNeuralNet::getFeatures(Peak& p) {
 		//cerr << "tiny=" << set[8] << " " << set[7] << " " << p.symmetry << endl;
 		//set[7] =  ((float) (p.baseLineRightCleanCount >= 5) +  (int) (p.baseLineLeftCleanCount >= 5))/2;
 	}
-	return set;
 }
 
 void ClassifierNeuralNet::classify(PeakGroup* grp) {
@@ -96,9 +109,7 @@ float ClassifierNeuralNet::scorePeak(Peak& p) {
     float result[2] = {0.1,0.1};
     if(brain != NULL) {
         float fts[1000];
-        vector<float> features = getFeatures(p);
-        for(int k=0;k<num_features;k++)
-        fts[k]=features[k];
+        getFeatures(p, fts);
         brain->run(fts, result);
     }
 
@@ -16,6 +16,12 @@ using namespace std;
 class ClassifierNeuralNet: public Classifier {
 public:
 	ClassifierNeuralNet();
+
+	/**
+	 * @brief independent copy of the model, safe to score with on another
+	 * thread while the original is used or trained
+	 */
+	ClassifierNeuralNet(const ClassifierNeuralNet& other);
 	~ClassifierNeuralNet();
 	void classify(PeakGroup* grp);
 	void train(vector<PeakGroup*>& groups);
@@ -24,6 +30,12 @@ public:
 	void loadModel(string filename);
 	bool hasModel();
     vector<float> getFeatures(Peak& p);
+
+	/**
+	 * @brief write the features of a peak to set, which holds num_features
+	 * values, without allocating
+	 */
+	void getFeatures(const Peak& p, float* set);
 	float scorePeak(Peak& p);
 	void scoreEICs(vector<EIC*> &eics);
 private:
@@ -1,143 +1,266 @@
 #include "comparesampleslogic.h"
 
+#include <algorithm>
+#include <random>
+
+#ifndef __APPLE__
+#include <omp.h>
+#endif
+
 CompareSamplesLogic::CompareSamplesLogic() {
+	permutations = 1000;
+	seed = 5489;
 }
 
-void CompareSamplesLogic::shuffle(StatisticsVector<float>& groupA,
-		StatisticsVector<float>& groupB) {
-	int n1 = groupA.size();
-	int n2 = groupB.size();
-	int n3 = n1 + n2;
-	if (n1 == 0 || n2 == 0)
-		return;
-	MTRand mtrand; //TODO: replace by std::mt
-
-	//combine two sets
-	//cerr << "N3=" << n3 << endl;
-	StatisticsVector<float> groupC(n1 + n2);
-	for (int i = 0; i < n1; i++)
-		groupC[i] = groupA[i];
-	for (int i = 0; i < n2; i++)
-		groupC[n1 + i] = groupB[i];
-	//for(int i=0; i < n3; i++ ) cerr << groupC[i] << " "; cerr << endl;
-
-	//float realT = ttest(groupA,ratio>100groupB);
-
-	for (int s = 0; s < 10; s++) {
-		//shuffle combined set
-		for (int i = 0; i < n3; i++) {
-			int r = mtrand.randInt(n3 - 1);
-			assert(r <= n3 - 1);
-			if (i == r)
-				continue;
-			float tmp = groupC[i];
-			groupC[i] = groupC[r];
-			groupC[r] = tmp; //swap
-		}
+void CompareSamplesLogic::tStatistics(const vector<float>& values,
+		unsigned int nGroups, const vector<double>& sums,
+		const vector<double>& squares, const vector<int>& order,
+		unsigned int n1, vector<double>& sumA, vector<double>& squareA,
+		float* scores) {
+	unsigned int n2 = order.size() - n1;
 
-		//split random vector
-		StatisticsVector<float> tmpA(n1);
-		StatisticsVector<float> tmpB(n2);
-		for (int i = 0; i < n1; i++)
-			tmpA[i] = groupC[i];
-		for (int i = 0; i < n2; i++)
-			tmpB[i] = groupC[n1 + i];
-
-		//for(int i=0; i < n1; i++ ) cerr << tmpA[i] << " "; cerr << endl;
-		//for(int i=0; i < n2; i++ ) cerr << tmpB[i] << " "; cerr << endl;
-
-		//ttest
-		float randT = abs(mzUtils::ttest(tmpA, tmpB));
-		//cerr << "RealT=" << realT << "  RandT=" << randT << endl;
-		rand_scores.push_back(randT);
+	//sums over the first set, the second set is the rest of the row totals
+	std::fill(sumA.begin(), sumA.end(), 0.0);
+	std::fill(squareA.begin(), squareA.end(), 0.0);
+	for (unsigned int i = 0; i < n1; i++) {
+		const float* x = values.data() + (size_t) order[i] * nGroups;
+		double* sa = sumA.data();
+		double* qa = squareA.data();
+		for (unsigned int g = 0; g < nGroups; g++) {
+			sa[g] += x[g];
+			qa[g] += (double) x[g] * x[g];
+		}
 	}
-	/*
-	 std::sort(rand_scores.begin(), rand_scores.end());
-	 int rank = countBelow(rand_scores,  ttest(groupA,groupB));
-	 cerr << "Q=" << rank << " p-value=" << 1.0-(float) rank / rand_scores.size() << endl;
-	 */
 
+	for (unsigned int g = 0; g < nGroups; g++) {
+		double sb = sums[g] - sumA[g];
+		double qb = squares[g] - squareA[g];
+		double meanA = sumA[g] / n1;
+		double meanB = sb / n2;
+
+		//sample variances, 0 for a single sample or constant values as in
+		//StatisticsVector::variance(), which mzUtils::ttest() replaces by 1
+		double varA = n1 > 1 ? (squareA[g] - sumA[g] * meanA) / (n1 - 1) : 0;
+		double varB = n2 > 1 ? (qb - sb * meanB) / (n2 - 1) : 0;
+		if (varA <= 1e-12 * squareA[g] / n1)
+			varA = 1;
+		if (varB <= 1e-12 * qb / n2)
+			varB = 1;
+
+		scores[g] = std::abs((meanA - meanB) / std::sqrt(varA / n1 + varB / n2));
+	}
 }
 
-void CompareSamplesLogic::FDRCorrection(QList<PeakGroup*> allgroups,
-		int correction) {
+void CompareSamplesLogic::computeStats(QList<PeakGroup*> allgroups,
+		vector<mzSample*> sset1, vector<mzSample*> sset2, float _missingValue,
+		FeatureMatrix* featureMatrix) {
+	for (int i = 0; i < allgroups.size(); i++) {
+		allgroups[i]->changeFoldRatio = 0;
+		allgroups[i]->changePValue = 1;
+	}
 
-	int Ngroups = allgroups.size();
-	int j = 0;
-	sort(allgroups.begin(), allgroups.end(), PeakGroup::compPvalue);
-	for (int i = 0; i < Ngroups; i++) {
-		PeakGroup* group = allgroups[i];
+	unsigned int n1 = sset1.size();
+	unsigned int n2 = sset2.size();
+	unsigned int nSamples = n1 + n2;
+	if (n1 == 0 || n2 == 0 || allgroups.size() == 0)
+		return;
+
+	vector<mzSample*> sampleSet(sset1);
+	sampleSet.insert(sampleSet.end(), sset2.begin(), sset2.end());
+
+	//quantities of all groups, one row per sample
+	unsigned int nGroups = allgroups.size();
+	vector<float> quantities((size_t) nSamples * nGroups);
+	if (featureMatrix)
+		featureMatrix->fill(PeakGroup::AreaTop);
+#ifndef __APPLE__
+#pragma omp parallel for schedule(static)
+#endif
+	for (unsigned int g = 0; g < nGroups; g++) {
+		PeakGroup* group = allgroups[g];
+		vector<float> yvalues = featureMatrix
+				? featureMatrix->orderedValues(group, sampleSet, PeakGroup::AreaTop)
+				: group->getOrderedIntensityVector(sampleSet, PeakGroup::AreaTop);
+		for (unsigned int s = 0; s < nSamples; s++)
+			quantities[(size_t) s * nGroups + g] = std::max(yvalues[s], _missingValue);
+	}
+
+	//fold change, groups with equal means are not tested
+	vector<PeakGroup*> tested;
+	vector<unsigned int> testedColumns;
+	for (unsigned int g = 0; g < nGroups; g++) {
+		double sumA = 0, sumB = 0;
+		for (unsigned int s = 0; s < n1; s++)
+			sumA += quantities[(size_t) s * nGroups + g];
+		for (unsigned int s = n1; s < nSamples; s++)
+			sumB += quantities[(size_t) s * nGroups + g];
+
+		float meanA = std::abs(sumA / n1);
+		float meanB = std::abs(sumB / n2);
+		if (meanA <= 0)
+			meanA = 1;
+		if (meanB <= 0)
+			meanB = 1;
+
+		PeakGroup* group = allgroups[g];
+		group->changeFoldRatio = log2(meanA / meanB);
 		if (group->changeFoldRatio == 0)
 			continue;
-		//cerr << group->changePValue << " " ;
-		if (correction == 1) {	 	//Bonferroni
-			group->changePValue *= Ngroups;
-		}
-		if (correction == 2) { 	//HOLMS
-			group->changePValue *= Ngroups - j;
+		tested.push_back(group);
+		testedColumns.push_back(g);
+	}
+
+	unsigned int nTested = tested.size();
+	if (nTested == 0)
+		return;
+
+	//centered quantities of the tested groups, the t-statistic does not
+	//depend on the offset and the sums of squares keep their precision
+	vector<float> values((size_t) nSamples * nTested);
+	vector<double> sums(nTested, 0.0);
+	vector<double> squares(nTested, 0.0);
+	for (unsigned int t = 0; t < nTested; t++) {
+		unsigned int g = testedColumns[t];
+		double mean = 0;
+		for (unsigned int s = 0; s < nSamples; s++)
+			mean += quantities[(size_t) s * nGroups + g];
+		mean /= nSamples;
+		for (unsigned int s = 0; s < nSamples; s++) {
+			float x = quantities[(size_t) s * nGroups + g] - mean;
+			values[(size_t) s * nTested + t] = x;
+			sums[t] += x;
+			squares[t] += (double) x * x;
 		}
-		if (correction == 3) { 	//Benjamini
-			group->changePValue *= Ngroups / (j + 1);
+	}
+	quantities.clear();
+
+	vector<int> order(nSamples);
+	for (unsigned int s = 0; s < nSamples; s++)
+		order[s] = s;
+	vector<double> sumA(nTested);
+	vector<double> squareA(nTested);
+	vector<float> realScores(nTested);
+	tStatistics(values, nTested, sums, squares, order, n1, sumA, squareA,
+			realScores.data());
+
+	vector<float> sortedScores(realScores);
+	std::sort(sortedScores.begin(), sortedScores.end());
+
+	//buckets of equal width up to the 99th percentile of the real scores and
+	//one for the tail, a score is searched for only among the real scores
+	//of its bucket. The bucket of a score never decreases with the score, so
+	//smaller buckets only hold smaller scores.
+	unsigned int nBuckets = nTested;
+	float bucketMax = sortedScores[(nTested - 1) * 99 / 100];
+	float bucketScale = bucketMax > 0 ? nBuckets / bucketMax : 0;
+	auto bucket = [=](float score) -> unsigned int {
+		if (!(score < bucketMax))
+			return nBuckets;
+		return std::min((unsigned int) (score * bucketScale), nBuckets - 1);
+	};
+	vector<unsigned int> bucketFirst(nBuckets + 2, 0);
+	for (unsigned int t = 0; t < nTested; t++)
+		bucketFirst[bucket(sortedScores[t]) + 1]++;
+	for (unsigned int b = 1; b <= nBuckets + 1; b++)
+		bucketFirst[b] += bucketFirst[b - 1];
+
+	//nullCounts[k] is the number of permuted scores at least as large as
+	//sortedScores[k - 1] and smaller than sortedScores[k]
+	vector<unsigned long> nullCounts(nTested + 1, 0);
+	int nPermutations = std::max(permutations, 0);
+
+#ifndef __APPLE__
+#pragma omp parallel
+#endif
+	{
+		vector<int> labels(order);
+		vector<double> threadSumA(nTested);
+		vector<double> threadSquareA(nTested);
+		vector<float> scores(nTested);
+		vector<unsigned long> counts(nTested + 1, 0);
+		std::mt19937 generator;
+
+#ifndef __APPLE__
+#pragma omp for schedule(static)
+#endif
+		for (int p = 0; p < nPermutations; p++) {
+			std::seed_seq seeds = { seed, (unsigned int) p };
+			generator.seed(seeds);
+
+			//partial Fisher-Yates, only the first set has to be drawn
+			for (unsigned int s = 0; s < nSamples; s++)
+				labels[s] = s;
+			for (unsigned int i = 0; i < n1; i++) {
+				std::uniform_int_distribution<unsigned int> draw(i, nSamples - 1);
+				std::swap(labels[i], labels[draw(generator)]);
+			}
+
+			tStatistics(values, nTested, sums, squares, labels, n1,
+					threadSumA, threadSquareA, scores.data());
+			for (unsigned int t = 0; t < nTested; t++) {
+				unsigned int b = bucket(scores[t]);
+				unsigned int k = std::upper_bound(
+						sortedScores.begin() + bucketFirst[b],
+						sortedScores.begin() + bucketFirst[b + 1], scores[t])
+						- sortedScores.begin();
+				counts[k]++;
+			}
 		}
-		//cerr << group->changePValue << endl;
-		j++;
+
+#ifndef __APPLE__
+#pragma omp critical
+#endif
+		for (unsigned int k = 0; k <= nTested; k++)
+			nullCounts[k] += counts[k];
 	}
 
+	if (nPermutations == 0)
+		return;
+
+	//p-value is the fraction of permuted scores at least as large
+	vector<unsigned long> atLeast(nTested + 1, 0);
+	for (int k = nTested - 1; k >= 0; k--)
+		atLeast[k] = atLeast[k + 1] + nullCounts[k + 1];
+
+	double nullSize = (double) nPermutations * nTested;
+	for (unsigned int t = 0; t < nTested; t++) {
+		unsigned int k = std::lower_bound(sortedScores.begin(),
+				sortedScores.end(), realScores[t]) - sortedScores.begin();
+		tested[t]->changePValue = atLeast[k] / nullSize;
+	}
 }
 
-void CompareSamplesLogic::computeMinPValue(QList<PeakGroup*> allgroups) {
+void CompareSamplesLogic::FDRCorrection(QList<PeakGroup*> allgroups,
+		int correction) {
+	if (correction < 1 || correction > 3)
+		return;
 
-	std::sort(rand_scores.begin(), rand_scores.end()); //sort random scores,
+	vector<PeakGroup*> tested;
 	for (int i = 0; i < allgroups.size(); i++) {
-		PeakGroup* group = allgroups[i];
-		if (group->changeFoldRatio == 0)
-			continue;
-		int rank = countBelow(rand_scores, group->changePValue); //calculate p-value
-		//cerr << group->changePValue << " " <<  ((float) rank)/rand_scores.size() << endl;
-		group->changePValue = 1 - ((float) rank) / rand_scores.size();
-
+		if (allgroups[i]->changeFoldRatio != 0)
+			tested.push_back(allgroups[i]);
 	}
-}
+	std::sort(tested.begin(), tested.end(), PeakGroup::compPvalue);
 
-void CompareSamplesLogic::computeStats(PeakGroup* group,
-		vector<mzSample*> sampleSet, vector<mzSample*> sset1,
-		vector<mzSample*> sset2, float _missingValue) {
-	group->changeFoldRatio = 0;		//TODO why?
-	group->changePValue = 1;		//TODO why?
-
-    //group->groupStatistics();
-	vector<float> yvalues = group->getOrderedIntensityVector(sampleSet,
-			PeakGroup::AreaTop);
-
-	StatisticsVector<float> groupA(sset1.size());
-	StatisticsVector<float> groupB(sset2.size());
-
-	// Was missing - Kiran
-	// TODO: misingSet1 and 2 is not used anywhere - Kiran
-    int missingSet1=0;
-	int missingSet2=0;
-	for(unsigned int i=0; i < sset1.size(); i++ ) { groupA[i]=yvalues[i]; if (groupA[i] == 0) missingSet1++; }
-	for(unsigned int i=0; i < sset2.size(); i++ ) { groupB[i]=yvalues[ sset1.size()+i ]; if (groupB[i] ==0 ) missingSet2++; }
-	
-	for (unsigned int i = 0; i < groupA.size(); i++)
-		if (groupA[i] < _missingValue)
-			groupA[i] = _missingValue;
-	for (unsigned int i = 0; i < groupB.size(); i++)
-		if (groupB[i] < _missingValue)
-			groupB[i] = _missingValue;
-
-    //skip empty
-	float meanA = abs(groupA.mean());
-	float meanB = abs(groupB.mean());
-
-    //Equation Updated -Kiran
-    if (meanA <= 0)
-		meanA = 1;
-	if (meanB <= 0)
-		meanB = 1;
-
-    //Equation Updated -Kiran
-    group->changeFoldRatio = log2(meanA/meanB);
-	group->changePValue = abs(mzUtils::ttest(groupA, groupB));
-	shuffle(groupA, groupB);
+	int m = tested.size();
+	if (correction == 1) {	 	//Bonferroni
+		for (int i = 0; i < m; i++)
+			tested[i]->changePValue = std::min(1.0f, tested[i]->changePValue * m);
+	}
+	if (correction == 2) { 	//Holm, step-down, adjusted values never decrease
+		float previous = 0;
+		for (int i = 0; i < m; i++) {
+			float p = std::min(1.0f, tested[i]->changePValue * (m - i));
+			previous = std::max(previous, p);
+			tested[i]->changePValue = previous;
+		}
+	}
+	if (correction == 3) { 	//Benjamini-Hochberg, step-up from the largest
+		float next = 1;
+		for (int i = m - 1; i >= 0; i--) {
+			float p = tested[i]->changePValue * m / (i + 1);
+			next = std::min(next, p);
+			tested[i]->changePValue = next;
+		}
+	}
 }
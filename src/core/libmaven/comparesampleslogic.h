@@ -11,21 +11,59 @@
 #include <QList>
 #include <cmath>
 #include "mzSample.h"
+#include "featureMatrix.h"
 
+/**
+ * @class CompareSamplesLogic
+ * @ingroup libmaven
+ * @brief fold change and permutation p-value of every group between two sets
+ * of samples
+ * @details The t-statistic of a group is compared to a null distribution
+ * pooled over all tested groups, obtained by relabelling the samples of both
+ * sets. Every permutation relabels all groups at once, so its statistics are
+ * sums over the columns of a samples x groups matrix. Permutations run on
+ * several threads, each permutation draws its labels from a generator seeded
+ * with seed and its own number, so results do not depend on the number of
+ * threads.
+ */
 class CompareSamplesLogic {
 public:
 	CompareSamplesLogic();
 
-	void shuffle(StatisticsVector<float>& groupA,
-			StatisticsVector<float>& groupB);
-	void FDRCorrection(QList<PeakGroup*> allgroups, int correction);
-	void computeMinPValue(QList<PeakGroup*> allgroups);
-	void computeStats(PeakGroup* group, vector<mzSample*> sampleSet,
-			vector<mzSample*> sset1, vector<mzSample*> sset2,
-			float _missingValue);
+	/**
+	 * @brief number of relabellings of the samples
+	 */
+	int permutations;
+
+	/**
+	 * @brief seed of the permutations, equal seeds give equal p-values
+	 */
+	unsigned int seed;
 
-	StatisticsVector<float> rand_scores;
-	StatisticsVector<float> real_scores;
+	/**
+	 * @brief set changeFoldRatio and changePValue of all groups
+	 * @details quantities below _missingValue are replaced by it. Groups with
+	 * equal means in both sets are not tested and get a p-value of 1.
+	 */
+	void computeStats(QList<PeakGroup*> allgroups, vector<mzSample*> sset1,
+			vector<mzSample*> sset2, float _missingValue,
+			FeatureMatrix* featureMatrix = NULL);
+
+	/**
+	 * @brief adjust p-values of the tested groups for multiple testing
+	 * @param correction 0 none, 1 Bonferroni, 2 Holm, 3 Benjamini-Hochberg
+	 */
+	void FDRCorrection(QList<PeakGroup*> allgroups, int correction);
 
+private:
+	/**
+	 * @brief absolute Welch t-statistic of every group
+	 * @details values holds one row of nGroups centered quantities per
+	 * sample, the first n1 entries of order are the samples of the first set
+	 */
+	static void tStatistics(const vector<float>& values, unsigned int nGroups,
+			const vector<double>& sums, const vector<double>& squares,
+			const vector<int>& order, unsigned int n1, vector<double>& sumA,
+			vector<double>& squareA, float* scores);
 };
 #endif // COMPARESAMPLESLOGIC_H
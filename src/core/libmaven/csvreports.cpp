@@ -12,6 +12,7 @@ CSVReports::CSVReports(vector<mzSample*>&insamples) {
     */
     samples = insamples;
     groupId = 0;
+    featureMatrix = NULL;
     /**@brief-  set user quant type-  generally represent intensity but not always check QType enum in PeaKGroup.h  */
     setUserQuantType(PeakGroup::AreaTop);
     setTabDelimited();      /**@brief-  set output file separator as tab*/
@@ -268,7 +269,8 @@ void CSVReports::writeGroupInfo(PeakGroup* group) {
 
     }
 
-    vector<float> yvalues = group->getOrderedIntensityVector(samples, qtype);
+    vector<float> yvalues = featureMatrix ? featureMatrix->orderedValues(group, samples, qtype)
+                                          : group->getOrderedIntensityVector(samples, qtype);
     //if ( group->metaGroupId == 0 ) { group->metaGroupId=groupId; }
 
     string tagString = group->srmId + group->tagString;
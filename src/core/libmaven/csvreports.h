@@ -8,6 +8,7 @@
 #include "mzSample.h"
 #include "mzUtils.h"
 #include "mavenparameters.h"
+#include "featureMatrix.h"
 
 using namespace std;
 using namespace mzUtils;
@@ -57,6 +58,13 @@ public:
         */
         samples = insamples;
     }
+    void setFeatureMatrix(FeatureMatrix* matrix) {
+        /**
+        *@brief-    read quantities of the exported groups from a feature matrix
+        *instead of collecting them from the peaks of every group
+        */
+        featureMatrix = matrix;
+    }
     void setUserQuantType(PeakGroup::QType t) {
         /**
         *@details-  set user quant type.
@@ -136,6 +144,7 @@ private:
 
     vector<mzSample*> samples;      /**@param-  pointers to all mz samples uploaded*/
     PeakGroup::QType qtype;             /**@param-  user quant type, represents intensity of peaks*/
+    FeatureMatrix* featureMatrix;       /**@param-  quantities of the exported groups, NULL if not given*/
     MavenParameters * mavenparameters;
     int selectionFlag;      /**@param-  TODO*/
 };
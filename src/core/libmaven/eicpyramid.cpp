@@ -0,0 +1,97 @@
+#include "eicpyramid.h"
+
+#include <algorithm>
+
+EICPyramid::EICPyramid(const float* x, const float* y, unsigned int n) {
+	_x = x;
+	_y = y;
+	_n = n;
+	if (n < 2) return;
+
+	//level 1 is built from the raw trace, every further level from the one below
+	unsigned int buckets = (n + 1) / 2;
+	vector<unsigned int> level(2 * buckets);
+	for (unsigned int b = 0; b < buckets; b++) {
+		unsigned int i = 2 * b;
+		unsigned int j = min(i + 1, n - 1);
+		level[2 * b] = y[j] < y[i] ? j : i;
+		level[2 * b + 1] = y[j] > y[i] ? j : i;
+	}
+	_levels.push_back(level);
+
+	while (buckets > 1) {
+		const vector<unsigned int>& below = _levels.back();
+		unsigned int belowBuckets = buckets;
+		buckets = (belowBuckets + 1) / 2;
+		vector<unsigned int> next(2 * buckets);
+		for (unsigned int b = 0; b < buckets; b++) {
+			unsigned int l = 2 * b;
+			unsigned int r = min(l + 1, belowBuckets - 1);
+			unsigned int lmin = below[2 * l], lmax = below[2 * l + 1];
+			unsigned int rmin = below[2 * r], rmax = below[2 * r + 1];
+			next[2 * b] = y[rmin] < y[lmin] ? rmin : lmin;
+			next[2 * b + 1] = y[rmax] > y[lmax] ? rmax : lmax;
+		}
+		_levels.push_back(next);
+	}
+}
+
+void EICPyramid::addPair(unsigned int a, unsigned int b,
+						 vector<unsigned int>& indices) const {
+	if (a > b) swap(a, b);
+	if (!indices.empty() && indices.back() == a) {
+		if (a != b) indices.push_back(b);
+		return;
+	}
+	indices.push_back(a);
+	if (a != b) indices.push_back(b);
+}
+
+void EICPyramid::addExtrema(unsigned int from, unsigned int to,
+							vector<unsigned int>& indices) const {
+	if (from >= to) return;
+	unsigned int imin = from, imax = from;
+	for (unsigned int i = from + 1; i < to; i++) {
+		if (_y[i] < _y[imin]) imin = i;
+		if (_y[i] > _y[imax]) imax = i;
+	}
+	addPair(imin, imax, indices);
+}
+
+void EICPyramid::visiblePoints(float xmin, float xmax, unsigned int maxPoints,
+							   vector<unsigned int>& indices) const {
+	indices.clear();
+	if (_n == 0 || xmin > xmax) return;
+
+	unsigned int lo = lower_bound(_x, _x + _n, xmin) - _x;
+	unsigned int hi = upper_bound(_x, _x + _n, xmax) - _x;
+	if (lo >= hi) return;
+	unsigned int count = hi - lo;
+
+	if (count <= maxPoints || maxPoints < 4 || _levels.empty()) {
+		indices.reserve(count);
+		for (unsigned int i = lo; i < hi; i++) indices.push_back(i);
+		return;
+	}
+
+	//coarsest detail that still fits: two points per bucket plus both partial ends
+	unsigned int k = 1;
+	while (k < _levels.size() && 2 * ((count >> k) + 2) > maxPoints) k++;
+
+	const vector<unsigned int>& level = _levels[k - 1];
+	unsigned int bucketSize = 1u << k;
+	unsigned int firstBucket = (lo + bucketSize - 1) / bucketSize;
+	unsigned int lastBucket = hi / bucketSize;
+
+	indices.reserve(2 * (lastBucket - firstBucket + 2));
+	if (firstBucket >= lastBucket) {
+		addExtrema(lo, hi, indices);
+		return;
+	}
+
+	addExtrema(lo, firstBucket * bucketSize, indices);
+	for (unsigned int b = firstBucket; b < lastBucket; b++) {
+		addPair(level[2 * b], level[2 * b + 1], indices);
+	}
+	addExtrema(lastBucket * bucketSize, hi, indices);
+}
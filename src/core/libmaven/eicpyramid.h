@@ -0,0 +1,70 @@
+#ifndef EICPYRAMID_H
+#define EICPYRAMID_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class EICPyramid
+ * @ingroup libmaven
+ * @brief Multi-resolution min/max summary of a chromatogram trace.
+ * @details Level k of the pyramid splits the trace into buckets of 2^k
+ * consecutive points and keeps, for every bucket, the indices of its
+ * smallest and largest value (in index order). Drawing those two points per
+ * bucket preserves every peak apex and every valley of the trace, so a plot
+ * that is only a few hundred pixels wide never has to walk all points of a
+ * long chromatogram. The pyramid is built once per trace (O(n) time, ~2n
+ * indices of memory) and then queried for any visible retention time range.
+ */
+class EICPyramid {
+public:
+	/**
+	 * @brief build the pyramid for a trace
+	 * @param x sorted abscissa (retention times) of the trace
+	 * @param y ordinate values, same length as x
+	 * @param n number of points in the trace
+	 */
+	EICPyramid(const float* x, const float* y, unsigned int n);
+
+	/**
+	 * @brief indices of points that should be drawn for a visible range
+	 * @details Returns every point in [xmin, xmax] if they are at most
+	 * maxPoints, otherwise the min/max points of the coarsest-but-sufficient
+	 * pyramid level. Indices are returned in increasing order; points outside
+	 * the range are never returned.
+	 * @param xmin lower bound of the visible range
+	 * @param xmax upper bound of the visible range
+	 * @param maxPoints upper limit on returned points (typically 2 x pixel width)
+	 * @param indices output vector, cleared before being filled
+	 */
+	void visiblePoints(float xmin, float xmax, unsigned int maxPoints,
+					   vector<unsigned int>& indices) const;
+
+	/**
+	 * @brief number of points in the original trace
+	 */
+	unsigned int size() const { return _n; }
+
+	/**
+	 * @brief true if the pyramid was built over exactly these arrays
+	 */
+	bool isBuiltOn(const float* x, const float* y, unsigned int n) const {
+		return _x == x && _y == y && _n == n;
+	}
+
+private:
+	const float* _x;
+	const float* _y;
+	unsigned int _n;
+
+	/** levels[k-1] holds (minIdx, maxIdx) pairs for buckets of 2^k points */
+	vector<vector<unsigned int> > _levels;
+
+	void addExtrema(unsigned int from, unsigned int to,
+					vector<unsigned int>& indices) const;
+	void addPair(unsigned int a, unsigned int b,
+				 vector<unsigned int>& indices) const;
+};
+
+#endif // EICPYRAMID_H
@@ -0,0 +1,142 @@
+#include "eicservice.h"
+#include "eiclogic.h"
+#include "peakFiltering.h"
+#include "classifierNeuralNet.h"
+#include "mavenparameters.h"
+
+namespace {
+
+class EicTask : public QRunnable {
+public:
+	EicTask(EicService* service, const EicRequest& request)
+		: _service(service), _request(request) {}
+
+	void run() {
+		if (!_service->isCurrent(_request.id)) return;
+		EicResult* result = _service->compute(_request);
+		if (result) Q_EMIT _service->computed(result);
+	}
+
+private:
+	EicService* _service;
+	EicRequest _request;
+};
+
+}
+
+EicSettings::EicSettings() {
+	eic_smoothingWindow = 10;
+	eic_smoothingAlgorithm = 0;
+	amuQ1 = 0.5;
+	amuQ3 = 0.5;
+	baseline_smoothingWindow = 5;
+	baseline_dropTopX = 80;
+	minSignalBaselineDifference = 0;
+	eicType = 0;
+	filterline = "";
+	minPeakQuality = 0;
+	grouping_maxRtWindow = 0.5;
+	minQuality = 0.5;
+	distXWeight = 1.0;
+	distYWeight = 1.0;
+	overlapWeight = 1.0;
+	useOverlap = true;
+}
+
+EicSettings::EicSettings(MavenParameters* mp) {
+	eic_smoothingWindow = mp->eic_smoothingWindow;
+	eic_smoothingAlgorithm = mp->eic_smoothingAlgorithm;
+	amuQ1 = mp->amuQ1;
+	amuQ3 = mp->amuQ3;
+	baseline_smoothingWindow = mp->baseline_smoothingWindow;
+	baseline_dropTopX = mp->baseline_dropTopX;
+	minSignalBaselineDifference = mp->minSignalBaselineDifference;
+	eicType = mp->eicType;
+	filterline = mp->filterline;
+	minPeakQuality = mp->minPeakQuality;
+	grouping_maxRtWindow = mp->grouping_maxRtWindow;
+	minQuality = mp->minQuality;
+	distXWeight = mp->distXWeight;
+	distYWeight = mp->distYWeight;
+	overlapWeight = mp->overlapWeight;
+	useOverlap = mp->useOverlap;
+}
+
+EicService::EicService(QObject* parent) : QObject(parent), _latest(0) {
+	qRegisterMetaType<EicResult*>("EicResult*");
+	//requests own their classifier and settings, but pullEICs is already
+	//parallel over samples, so one worker is enough to keep the GUI free
+	_pool.setMaxThreadCount(1);
+	connect(this, SIGNAL(computed(EicResult*)), SLOT(deliver(EicResult*)),
+			Qt::QueuedConnection);
+}
+
+EicService::~EicService() {
+	cancelAll();
+	_pool.waitForDone();
+}
+
+int EicService::request(EicRequest request) {
+	request.id = _latest.fetchAndAddOrdered(1) + 1;
+	_pool.start(new EicTask(this, request));
+	return request.id;
+}
+
+void EicService::cancelAll() {
+	_latest.fetchAndAddOrdered(1);
+}
+
+void EicService::deliver(EicResult* result) {
+	if (!isCurrent(result->id)) {
+		delete_all(result->eics);
+		delete result;
+		return;
+	}
+	Q_EMIT eicsReady(result);
+}
+
+EicResult* EicService::compute(const EicRequest& request) {
+	const EicSettings& settings = request.settings;
+
+	EICLogic logic;
+	logic._slice = request.slice;
+	logic.getEIC(request.bounds, request.samples, settings.eic_smoothingWindow,
+			settings.eic_smoothingAlgorithm, settings.amuQ1, settings.amuQ3,
+			settings.baseline_smoothingWindow, settings.baseline_dropTopX,
+			settings.minSignalBaselineDifference, settings.eicType,
+			settings.filterline);
+
+	if (!isCurrent(request.id)) {
+		delete_all(logic.eics);
+		return NULL;
+	}
+
+	//score peak quality
+	if (request.classifier) {
+		request.classifier->scoreEICs(logic.eics);
+	}
+
+	bool isIsotope = false;
+	PeakFiltering peakFiltering(settings.minPeakQuality, 0, isIsotope);
+	peakFiltering.filter(logic.eics);
+
+	if (!isCurrent(request.id)) {
+		delete_all(logic.eics);
+		return NULL;
+	}
+
+	if (request.groupPeaks) {
+		logic.groupPeaks(settings.eic_smoothingWindow,
+				settings.grouping_maxRtWindow, settings.minQuality,
+				settings.distXWeight, settings.distYWeight,
+				settings.overlapWeight, settings.useOverlap,
+				settings.minSignalBaselineDifference);
+	}
+	logic.associateNameWithPeakGroups();
+
+	EicResult* result = new EicResult();
+	result->id = request.id;
+	result->eics.swap(logic.eics);
+	result->peakgroups.swap(logic.peakgroups);
+	return result;
+}
@@ -0,0 +1,130 @@
+#ifndef EICSERVICE_H
+#define EICSERVICE_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include "mzSample.h"
+
+class MavenParameters;
+class ClassifierNeuralNet;
+
+/**
+ * @brief settings a worker reads while computing EICs
+ * @details copied from MavenParameters when a request is made, so edits
+ * made in the meantime only reach later requests
+ */
+struct EicSettings {
+	EicSettings();
+	EicSettings(MavenParameters* mp);
+
+	int eic_smoothingWindow;
+	int eic_smoothingAlgorithm;
+	float amuQ1;
+	float amuQ3;
+	int baseline_smoothingWindow;
+	int baseline_dropTopX;
+	double minSignalBaselineDifference;
+	int eicType;
+	string filterline;
+	double minPeakQuality;
+	float grouping_maxRtWindow;
+	float minQuality;
+	double distXWeight;
+	double distYWeight;
+	double overlapWeight;
+	bool useOverlap;
+};
+
+/**
+ * @brief everything a worker needs to compute the EICs of one slice
+ */
+struct EicRequest {
+	int id;								//assigned by EicService::request
+	mzSlice slice;						//mz window and compound of the EICs
+	mzSlice bounds;						//rt range of the visible samples
+	vector<mzSample*> samples;
+	EicSettings settings;				//smoothing, baseline and filtering settings
+	QSharedPointer<ClassifierNeuralNet> classifier;	//optional peak quality scoring,
+										//a copy only this request uses
+	bool groupPeaks;
+};
+
+/**
+ * @brief EICs and peak groups computed for one request
+ * @details ownership of the EICs passes to whoever receives the result
+ */
+struct EicResult {
+	int id;
+	vector<EIC*> eics;
+	vector<PeakGroup> peakgroups;
+};
+
+Q_DECLARE_METATYPE(EicResult*)
+
+/**
+ * @class EicService
+ * @ingroup libmaven
+ * @brief Computes EICs, peak scores and peak groups off the GUI thread.
+ * @details Only the most recent request is ever delivered: a new request
+ * (or cancelAll) makes every earlier one stale, queued stale requests are
+ * skipped and a running one stops at the next stage boundary. Finished
+ * results are queued to the thread the service lives in and checked again
+ * there, so a result that went stale while it waited in the event queue is
+ * deleted instead of reaching eicsReady().
+ */
+class EicService : public QObject {
+Q_OBJECT
+
+public:
+	EicService(QObject* parent = 0);
+	~EicService();
+
+	/**
+	 * @brief queue a computation, superseding all earlier requests
+	 * @return id that will be carried by the matching result
+	 */
+	int request(EicRequest request);
+
+	/**
+	 * @brief make every queued, running and undelivered request stale
+	 */
+	void cancelAll();
+
+	/**
+	 * @brief true if id belongs to the most recent, not cancelled request
+	 */
+	bool isCurrent(int id) { return id == _latest.loadAcquire(); }
+
+	/**
+	 * @brief block until no request is queued or running
+	 * @details finished results are still delivered by the event loop
+	 */
+	void waitForDone() { _pool.waitForDone(); }
+
+	/**
+	 * @brief run a request in the calling thread
+	 * @return result, or NULL if the request went stale on the way
+	 */
+	EicResult* compute(const EicRequest& request);
+
+Q_SIGNALS:
+	/**
+	 * @brief result of the most recent request, emitted in the service's thread
+	 */
+	void eicsReady(EicResult* result);
+
+	//internal, a finished result on its way to deliver()
+	void computed(EicResult* result);
+
+private Q_SLOTS:
+	void deliver(EicResult* result);
+
+private:
+	QThreadPool _pool;
+	QAtomicInt _latest;
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include "featureMatrix.h"
+
+#include <algorithm>
+
+#ifndef __APPLE__
+#include <omp.h>
+#endif
+
+FeatureMatrix::FeatureMatrix()
+{
+	_values.resize(typeCount);
+}
+
+void FeatureMatrix::build(const vector<PeakGroup *> &groups, const vector<mzSample *> &samples)
+{
+	clear();
+
+	_samples = samples;
+	_normalization.resize(samples.size());
+	for (unsigned int j = 0; j < samples.size(); j++)
+	{
+		_columns[samples[j]] = j;
+		_normalization[j] = samples[j] ? samples[j]->getNormalizationConstant() : 1;
+	}
+
+	_groups.reserve(groups.size());
+	_peakColumns.reserve(groups.size());
+	_firstPeaks.reserve(groups.size() * samples.size());
+	for (unsigned int i = 0; i < groups.size(); i++)
+		append(groups[i]);
+}
+
+void FeatureMatrix::clear()
+{
+	_groups.clear();
+	_samples.clear();
+	_rows.clear();
+	_columns.clear();
+	_normalization.clear();
+	_peakColumns.clear();
+	_firstPeaks.clear();
+	for (unsigned int t = 0; t < typeCount; t++)
+		_values[t].clear();
+}
+
+int FeatureMatrix::row(const PeakGroup *group) const
+{
+	unordered_map<const PeakGroup *, unsigned int>::const_iterator it = _rows.find(group);
+	return it == _rows.end() ? -1 : (int)it->second;
+}
+
+int FeatureMatrix::column(const mzSample *sample) const
+{
+	unordered_map<const mzSample *, unsigned int>::const_iterator it = _columns.find(sample);
+	return it == _columns.end() ? -1 : (int)it->second;
+}
+
+vector<int> FeatureMatrix::columns(const vector<mzSample *> &samples) const
+{
+	vector<int> result(samples.size());
+	for (unsigned int j = 0; j < samples.size(); j++)
+		result[j] = column(samples[j]);
+	return result;
+}
+
+void FeatureMatrix::mapPeaks(unsigned int row)
+{
+	vector<Peak> &peaks = _groups[row]->getPeaks();
+	vector<int> &peakColumns = _peakColumns[row];
+	int *firstPeaks = _firstPeaks.data() + row * _samples.size();
+
+	peakColumns.resize(peaks.size());
+	std::fill(firstPeaks, firstPeaks + _samples.size(), -1);
+	for (unsigned int k = 0; k < peaks.size(); k++)
+	{
+		int c = column(peaks[k].getSample());
+		peakColumns[k] = c;
+		if (c >= 0 && firstPeaks[c] < 0)
+			firstPeaks[c] = k;
+	}
+}
+
+bool FeatureMatrix::isMapped(unsigned int row) const
+{
+	return _peakColumns[row].size() == _groups[row]->getPeaks().size();
+}
+
+void FeatureMatrix::fillRow(unsigned int row, PeakGroup::QType type, float *out) const
+{
+	vector<Peak> &peaks = _groups[row]->getPeaks();
+	const vector<int> &peakColumns = _peakColumns[row];
+	//peaks added or removed since the row was mapped are looked up
+	bool mapped = isMapped(row);
+
+	std::fill(out, out + _samples.size(), 0.0f);
+	for (unsigned int k = 0; k < peaks.size(); k++)
+	{
+		int c = mapped ? peakColumns[k] : column(peaks[k].getSample());
+		if (c < 0)
+			continue;
+		float y = PeakGroup::peakQuantity(peaks[k], type) * _normalization[c];
+		if (out[c] < y)
+			out[c] = y;
+	}
+}
+
+void FeatureMatrix::fill(PeakGroup::QType type)
+{
+	vector<float> &values = _values[type];
+	unsigned int ncols = _samples.size();
+	if (values.size() == _groups.size() * ncols)
+		return;
+
+	values.resize(_groups.size() * ncols);
+#ifndef __APPLE__
+#pragma omp parallel for schedule(static)
+#endif
+	for (unsigned int i = 0; i < _groups.size(); i++)
+		fillRow(i, type, values.data() + i * ncols);
+}
+
+const float *FeatureMatrix::values(unsigned int row, PeakGroup::QType type)
+{
+	if (!isMapped(row))
+		update(row);
+	fill(type);
+	return _values[type].data() + row * _samples.size();
+}
+
+vector<float> FeatureMatrix::orderedValues(PeakGroup *group, vector<mzSample *> &samples,
+										   PeakGroup::QType type)
+{
+	int r = row(group);
+	if (r < 0)
+		return group->getOrderedIntensityVector(samples, type);
+
+	vector<float> result(samples.size());
+	const float *rowValues = values(r, type);
+	for (unsigned int j = 0; j < samples.size(); j++)
+	{
+		int c = column(samples[j]);
+		if (c < 0)
+			return group->getOrderedIntensityVector(samples, type);
+		result[j] = rowValues[c];
+	}
+	return result;
+}
+
+Peak *FeatureMatrix::peak(unsigned int row, unsigned int column) const
+{
+	vector<Peak> &peaks = _groups[row]->getPeaks();
+	if (!isMapped(row))
+	{
+		for (unsigned int k = 0; k < peaks.size(); k++)
+			if (this->column(peaks[k].getSample()) == (int)column)
+				return &peaks[k];
+		return NULL;
+	}
+	int k = _firstPeaks[row * _samples.size() + column];
+	return k < 0 ? NULL : &peaks[k];
+}
+
+void FeatureMatrix::append(PeakGroup *group)
+{
+	unsigned int r = _groups.size();
+	unsigned int ncols = _samples.size();
+	_groups.push_back(group);
+	_rows[group] = r;
+	_peakColumns.push_back(vector<int>());
+	_firstPeaks.resize((r + 1) * ncols);
+	mapPeaks(r);
+
+	for (unsigned int t = 0; t < typeCount; t++)
+	{
+		vector<float> &values = _values[t];
+		if (values.size() != r * ncols || values.empty())
+			continue;
+		values.resize((r + 1) * ncols);
+		fillRow(r, (PeakGroup::QType)t, values.data() + r * ncols);
+	}
+}
+
+void FeatureMatrix::update(unsigned int row)
+{
+	unsigned int ncols = _samples.size();
+	mapPeaks(row);
+	for (unsigned int t = 0; t < typeCount; t++)
+	{
+		if (_values[t].empty())
+			continue;
+		fillRow(row, (PeakGroup::QType)t, _values[t].data() + row * ncols);
+	}
+}
+
+void FeatureMatrix::remove(unsigned int row)
+{
+	unsigned int ncols = _samples.size();
+	_rows.erase(_groups[row]);
+	_groups.erase(_groups.begin() + row);
+	_peakColumns.erase(_peakColumns.begin() + row);
+	_firstPeaks.erase(_firstPeaks.begin() + row * ncols,
+					  _firstPeaks.begin() + (row + 1) * ncols);
+	for (unsigned int t = 0; t < typeCount; t++)
+	{
+		vector<float> &values = _values[t];
+		if (values.empty())
+			continue;
+		values.erase(values.begin() + row * ncols, values.begin() + (row + 1) * ncols);
+	}
+
+	for (unsigned int i = row; i < _groups.size(); i++)
+		_rows[_groups[i]] = i;
+}
+
+void FeatureMatrix::invalidate()
+{
+	for (unsigned int i = 0; i < _groups.size(); i++)
+		mapPeaks(i);
+	for (unsigned int t = 0; t < typeCount; t++)
+		_values[t].clear();
+}
+
+bool FeatureMatrix::refreshNormalization()
+{
+	bool changed = false;
+	for (unsigned int j = 0; j < _samples.size(); j++)
+	{
+		float x = _samples[j] ? _samples[j]->getNormalizationConstant() : 1;
+		if (x != _normalization[j])
+		{
+			_normalization[j] = x;
+			changed = true;
+		}
+	}
+
+	if (changed)
+	{
+		for (unsigned int t = 0; t < typeCount; t++)
+			_values[t].clear();
+	}
+	return changed;
+}
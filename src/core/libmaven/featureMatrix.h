@@ -0,0 +1,146 @@
+#ifndef FEATUREMATRIX_H
+#define FEATUREMATRIX_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "PeakGroup.h"
+
+using namespace std;
+
+/**
+ * @class FeatureMatrix
+ * @ingroup libmaven
+ * @brief quantities of peak groups in samples, one row per group and one
+ * column per sample
+ * @details Rows and columns are numbered in the order of the groups and
+ * samples given to build(). For every peak of a group the column of its
+ * sample is looked up once, so reading a quantity costs no search by sample.
+ * A matrix per quantitation type is filled the first time that type is asked
+ * for, with the normalization constant of each sample applied, and kept
+ * until the groups change. A cell holds the largest quantity of the group in
+ * that sample, as PeakGroup::getOrderedIntensityVector() returns it.
+ *
+ * Owners keep the matrix in step with their groups through append(),
+ * update() and remove(), call invalidate() after editing peaks of many
+ * groups in place, and rebuild it when groups are reordered. A row whose
+ * group gained or lost peaks since it was mapped is mapped again when it is
+ * read. The matrix stores group pointers and does not follow groups that
+ * move in memory. Filling a type is not thread safe, call fill() before
+ * reading from several threads.
+ */
+class FeatureMatrix
+{
+  public:
+	FeatureMatrix();
+
+	/**
+	 * @brief replace rows and columns, no quantities are filled yet
+	 */
+	void build(const vector<PeakGroup *> &groups, const vector<mzSample *> &samples);
+	void clear();
+
+	unsigned int rowCount() const { return _groups.size(); }
+	unsigned int columnCount() const { return _samples.size(); }
+	const vector<PeakGroup *> &groups() const { return _groups; }
+	const vector<mzSample *> &samples() const { return _samples; }
+
+	/**
+	 * @return row of a group, -1 if it is not in the matrix
+	 */
+	int row(const PeakGroup *group) const;
+
+	/**
+	 * @return column of a sample, -1 if it is not in the matrix
+	 */
+	int column(const mzSample *sample) const;
+
+	/**
+	 * @brief columns of samples, -1 for samples not in the matrix
+	 */
+	vector<int> columns(const vector<mzSample *> &samples) const;
+
+	/**
+	 * @brief compute all quantities of a type now instead of on first read
+	 */
+	void fill(PeakGroup::QType type);
+
+	/**
+	 * @brief quantities of a row, indexed by column
+	 * @details valid until the matrix changes
+	 */
+	const float *values(unsigned int row, PeakGroup::QType type);
+
+	float value(unsigned int row, unsigned int column, PeakGroup::QType type)
+	{
+		return values(row, type)[column];
+	}
+
+	/**
+	 * @brief quantities of a group in the given samples
+	 * @details same as group->getOrderedIntensityVector(samples, type), which
+	 * it falls back to for groups or samples that are not in the matrix
+	 */
+	vector<float> orderedValues(PeakGroup *group, vector<mzSample *> &samples,
+								PeakGroup::QType type);
+
+	/**
+	 * @brief first peak of a group in a sample, NULL if there is none
+	 * @details same as PeakGroup::getPeak() without searching the peaks
+	 */
+	Peak *peak(unsigned int row, unsigned int column) const;
+
+	/**
+	 * @brief add a row for a group, filled types are filled for it at once
+	 */
+	void append(PeakGroup *group);
+
+	/**
+	 * @brief recompute a row after the peaks of its group were edited
+	 */
+	void update(unsigned int row);
+
+	/**
+	 * @brief drop a row, later rows move up by one
+	 */
+	void remove(unsigned int row);
+
+	/**
+	 * @brief recompute all rows on the next read, e.g. after retention times
+	 * or qualities of the peaks changed
+	 */
+	void invalidate();
+
+	/**
+	 * @brief drop the filled quantities if a normalization constant changed
+	 * since they were computed
+	 * @return true if they were dropped
+	 */
+	bool refreshNormalization();
+
+  private:
+	static const unsigned int typeCount = PeakGroup::AreaTopNotCorrected + 1;
+
+	vector<PeakGroup *> _groups;
+	vector<mzSample *> _samples;
+	unordered_map<const PeakGroup *, unsigned int> _rows;
+	unordered_map<const mzSample *, unsigned int> _columns;
+
+	//normalization constant of every column when quantities were computed
+	vector<float> _normalization;
+
+	//column of every peak of a row, -1 if its sample is not a column
+	vector<vector<int> > _peakColumns;
+
+	//index of the first peak of a row in every column, -1 for none
+	vector<int> _firstPeaks;
+
+	//quantities by type, rows of columnCount() values, empty until filled
+	vector<vector<float> > _values;
+
+	void mapPeaks(unsigned int row);
+	bool isMapped(unsigned int row) const;
+	void fillRow(unsigned int row, PeakGroup::QType type, float *out) const;
+};
+
+#endif //FEATUREMATRIX_H
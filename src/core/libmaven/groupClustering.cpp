@@ -0,0 +1,167 @@
+#include "groupClustering.h"
+
+GroupClustering::GroupClustering(MassCutoff *massCutoff, int eicType, string filterline)
+{
+    _massCutoff = massCutoff;
+    _eicType = eicType;
+    _filterline = filterline;
+    _cancelled = false;
+    maxRtDiff = 0.5;
+    minSampleCorrelation = 0.6;
+    minRtCorrelation = 0.8;
+}
+
+mzSample* GroupClustering::largestSample(PeakGroup &group)
+{
+    mzSample *largest = NULL;
+    float maxIntensity = 0;
+    for (unsigned int i = 0; i < group.peaks.size(); i++)
+    {
+        if (group.peaks[i].peakIntensity > maxIntensity)
+        {
+            maxIntensity = group.peaks[i].peakIntensity;
+            largest = group.peaks[i].getSample();
+        }
+    }
+    return largest;
+}
+
+vector<unsigned int> GroupClustering::linkedGroups(vector<PeakGroup*> &groups,
+                                                   unsigned int anchor,
+                                                   const vector<vector<float> > &intensities,
+                                                   mzSample *sample)
+{
+    vector<unsigned int> linked;
+    if (sample == NULL)
+        return linked;
+
+    PeakGroup &grup1 = *groups[anchor];
+    float mzWindow = _massCutoff->massCutoffValue(grup1.meanMz);
+
+    //the anchor's own trace goes first, candidates follow in index order
+    vector<unsigned int> candidates;
+    vector<mzSlice> windows;
+    windows.push_back(mzSlice(grup1.meanMz - mzWindow, grup1.meanMz + mzWindow,
+                              grup1.minRt, grup1.maxRt));
+
+    for (unsigned int j = anchor + 1; j < groups.size(); j++)
+    {
+        PeakGroup &grup2 = *groups[j];
+
+        //cluster parents never come after the anchor, so no later group can
+        //be within maxRtDiff*2 of the parent once it is that far from the anchor
+        if (grup2.meanRt - grup1.meanRt > maxRtDiff * 2)
+            break;
+
+        //retention time overlap
+        float rtoverlap = mzUtils::checkOverlap(grup1.minRt, grup1.maxRt, grup2.minRt, grup2.maxRt);
+        if (rtoverlap < 0.1)
+            continue;
+
+        //peak intensity correlation
+        float cor = mzUtils::correlation(intensities[anchor], intensities[j]);
+        if (cor < minSampleCorrelation)
+            continue;
+
+        float window = _massCutoff->massCutoffValue(grup2.meanMz);
+        candidates.push_back(j);
+        windows.push_back(mzSlice(grup2.meanMz - window, grup2.meanMz + window,
+                                  grup1.minRt, grup1.maxRt));
+    }
+
+    if (candidates.empty())
+        return linked;
+
+    //peak shape correlation
+    int mslevel = 1;
+    vector<TraceCache::Trace> traces = sample->getTraces(windows, mslevel, _eicType, _filterline);
+    for (unsigned int k = 0; k < candidates.size(); k++)
+    {
+        float cor2 = mzUtils::correlation(*traces[0], *traces[k + 1]);
+        if (cor2 >= minRtCorrelation)
+            linked.push_back(candidates[k]);
+    }
+
+    return linked;
+}
+
+int GroupClustering::cluster(vector<PeakGroup*> &groups, vector<mzSample*> &samples,
+                             FeatureMatrix *featureMatrix)
+{
+    _cancelled = false;
+    stable_sort(groups.begin(), groups.end(), compRt);
+
+    int n = groups.size();
+    vector<vector<float> > intensities(n);
+    vector<mzSample*> largest(n);
+    if (featureMatrix)
+        featureMatrix->fill(PeakGroup::AreaTop);
+
+#ifndef __APPLE__
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+        if (featureMatrix)
+            intensities[i] = featureMatrix->orderedValues(groups[i], samples, PeakGroup::AreaTop);
+        else
+            intensities[i] = groups[i]->getOrderedIntensityVector(samples, PeakGroup::AreaTop);
+        largest[i] = largestSample(*groups[i]);
+    }
+
+    //evaluate anchors in blocks so progress and cancellation stay responsive
+    vector<vector<unsigned int> > links(n);
+    const int blockSize = 256;
+    for (int start = 0; start < n; start += blockSize)
+    {
+        if (_cancelled)
+            return 0;
+
+        int end = min(n, start + blockSize);
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = start; i < end; i++)
+        {
+            links[i] = linkedGroups(groups, i, intensities, largest[i]);
+        }
+        sendBoostSignal("Clustering", end, n);
+    }
+
+    if (_cancelled)
+        return 0;
+
+    //clear cluster information, a cancelled run leaves it untouched
+    for (int i = 0; i < n; i++)
+        groups[i]->clusterId = 0;
+
+    //assign clusters in rt order, exactly as a serial sweep would
+    int clusterId = 0;
+    vector<unsigned int> parentOf;
+    for (int i = 0; i < n; i++)
+    {
+        PeakGroup &grup1 = *groups[i];
+        if (grup1.clusterId == 0)
+        {
+            grup1.clusterId = ++clusterId;
+            parentOf.push_back(i);
+        }
+
+        PeakGroup &parent = *groups[parentOf[grup1.clusterId - 1]];
+        for (unsigned int k = 0; k < links[i].size(); k++)
+        {
+            PeakGroup &grup2 = *groups[links[i][k]];
+            if (grup2.clusterId > 0)
+                continue;
+
+            //retention time distance
+            float rtdist = abs(parent.meanRt - grup2.meanRt);
+            if (rtdist > maxRtDiff * 2)
+                continue;
+
+            grup2.clusterId = grup1.clusterId;
+        }
+    }
+
+    return clusterId;
+}
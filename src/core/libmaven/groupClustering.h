@@ -0,0 +1,106 @@
+#ifndef GROUPCLUSTERING_H
+#define GROUPCLUSTERING_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/signals2.hpp>
+
+#include "PeakGroup.h"
+#include "mzSample.h"
+#include "masscutofftype.h"
+#include "featureMatrix.h"
+
+using namespace std;
+
+/**
+ * @class GroupClustering
+ * @ingroup libmaven
+ * @brief Clusters peak groups that are likely to come from the same metabolite
+ * @details Two groups end up in the same cluster when their retention times
+ * are close to the cluster parent, their rt ranges overlap, their intensities
+ * correlate across samples and their EIC shapes correlate in the sample where
+ * the anchor group is most intense.
+ *
+ * Groups are swept in retention time order, so only groups inside the rt
+ * window of an anchor are ever compared. Per-group intensity vectors are
+ * computed once, the EICs of all candidates of an anchor are pulled in a
+ * single pass over its largest sample and kept in the trace cache of that
+ * sample, so clustering again with other thresholds skips extraction.
+ * Anchors are evaluated in parallel.
+ * Cluster ids are then assigned sequentially, giving the same clusters as a
+ * serial run.
+ */
+class GroupClustering
+{
+  public:
+	boost::signals2::signal< void (const string&, unsigned int, int) > boostSignal;
+
+	/**
+	 * @brief Constructor of class GroupClustering
+	 * @param massCutoff mass window used to pull EICs of each group
+	 * @param eicType EIC::MAX or EIC::SUM
+	 * @param filterline scan filter used to pull EICs
+	 */
+	GroupClustering(MassCutoff *massCutoff, int eicType, string filterline);
+
+	double maxRtDiff;			/**< max rt distance from the cluster parent (half width) */
+	double minSampleCorrelation;	/**< min correlation of intensities across samples */
+	double minRtCorrelation;	/**< min correlation of EIC shapes */
+
+	/**
+	 * @brief assign a clusterId to every group
+	 * @details groups are sorted (stable) by mean retention time. Progress is
+	 * reported through boostSignal from the calling thread only. The groups
+	 * must stay valid until cluster() returns, including while boostSignal
+	 * handlers run.
+	 * @param groups peak groups to cluster, clusterId is overwritten unless
+	 * clustering is cancelled
+	 * @param samples samples defining the order of the intensity vectors
+	 * @param featureMatrix if given, intensities of the groups are read from it
+	 * @return number of clusters, 0 if clustering was cancelled
+	 */
+	int cluster(vector<PeakGroup*> &groups, vector<mzSample*> &samples,
+				FeatureMatrix *featureMatrix = NULL);
+
+	/**
+	 * @brief stop a running cluster() call, safe to call from any thread
+	 */
+	void cancel() { _cancelled = true; }
+
+	/**
+	 * @brief true if the last cluster() call was cancelled
+	 */
+	bool wasCancelled() { return _cancelled; }
+
+  private:
+	MassCutoff *_massCutoff;
+	int _eicType;
+	string _filterline;
+	atomic<bool> _cancelled;
+
+	void sendBoostSignal(const string &progressText, unsigned int completed, int total)
+	{
+		boostSignal(progressText, completed, total);
+	}
+
+	/**
+	 * @brief sample in which a group has its most intense peak
+	 */
+	static mzSample* largestSample(PeakGroup &group);
+
+	static bool compRt(const PeakGroup *a, const PeakGroup *b) { return a->meanRt < b->meanRt; }
+
+	/**
+	 * @brief later groups that pass all pairwise filters against an anchor
+	 * @details independent of cluster assignment, so anchors can be
+	 * evaluated in parallel. Returned indices are increasing.
+	 */
+	vector<unsigned int> linkedGroups(vector<PeakGroup*> &groups,
+									  unsigned int anchor,
+									  const vector<vector<float> > &intensities,
+									  mzSample *sample);
+};
+
+#endif //GROUPCLUSTERING_H
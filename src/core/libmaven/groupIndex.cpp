@@ -0,0 +1,130 @@
+#include "groupIndex.h"
+
+#include <cmath>
+
+GroupIndex::GroupIndex(double mzTolerance, double rtTolerance)
+{
+    _mzTolerance = mzTolerance;
+    _rtTolerance = rtTolerance;
+    _size = 0;
+    _inserted = 0;
+}
+
+long long GroupIndex::mzCell(float mz) const
+{
+    return (long long) floor(mz / _mzTolerance);
+}
+
+long long GroupIndex::rtCell(float rt) const
+{
+    return (long long) floor(rt / _rtTolerance);
+}
+
+unsigned long long GroupIndex::cellKey(long long mzCell, long long rtCell)
+{
+    return ((unsigned long long) mzCell << 32) ^ (unsigned long long) (rtCell & 0xffffffffLL);
+}
+
+bool GroupIndex::matches(const Entry &entry, float mz, float rt) const
+{
+    return (double) std::abs(mz - entry.mz) < _mzTolerance
+           && (double) std::abs(rt - entry.rt) < _rtTolerance;
+}
+
+void GroupIndex::insert(PeakGroup *group)
+{
+    Entry entry;
+    entry.group = group;
+    entry.mz = group->meanMz;
+    entry.rt = group->meanRt;
+    entry.order = _inserted++;
+    _cells[cellKey(mzCell(entry.mz), rtCell(entry.rt))].push_back(entry);
+    _size++;
+}
+
+bool GroupIndex::removeFrom(unordered_map<unsigned long long, vector<Entry> >::iterator cell,
+                            PeakGroup *group)
+{
+    vector<Entry> &entries = cell->second;
+    for (unsigned int i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].group != group)
+            continue;
+        entries.erase(entries.begin() + i);
+        if (entries.empty())
+            _cells.erase(cell);
+        _size--;
+        return true;
+    }
+    return false;
+}
+
+bool GroupIndex::remove(PeakGroup *group)
+{
+    unordered_map<unsigned long long, vector<Entry> >::iterator home =
+        _cells.find(cellKey(mzCell(group->meanMz), rtCell(group->meanRt)));
+    if (home != _cells.end() && removeFrom(home, group))
+        return true;
+
+    //m/z or rt of the group changed since it was inserted
+    for (unordered_map<unsigned long long, vector<Entry> >::iterator cell = _cells.begin();
+         cell != _cells.end(); ++cell)
+    {
+        if (removeFrom(cell, group))
+            return true;
+    }
+    return false;
+}
+
+void GroupIndex::clear()
+{
+    _cells.clear();
+    _size = 0;
+    _inserted = 0;
+}
+
+bool GroupIndex::contains(PeakGroup *group) const
+{
+    long long mc = mzCell(group->meanMz);
+    long long rc = rtCell(group->meanRt);
+    for (long long i = mc - 1; i <= mc + 1; i++)
+    {
+        for (long long j = rc - 1; j <= rc + 1; j++)
+        {
+            unordered_map<unsigned long long, vector<Entry> >::const_iterator cell =
+                _cells.find(cellKey(i, j));
+            if (cell == _cells.end())
+                continue;
+            for (unsigned int k = 0; k < cell->second.size(); k++)
+            {
+                if (cell->second[k].group == group)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+PeakGroup* GroupIndex::find(float mz, float rt) const
+{
+    const Entry *best = NULL;
+    long long mc = mzCell(mz);
+    long long rc = rtCell(rt);
+    for (long long i = mc - 1; i <= mc + 1; i++)
+    {
+        for (long long j = rc - 1; j <= rc + 1; j++)
+        {
+            unordered_map<unsigned long long, vector<Entry> >::const_iterator cell =
+                _cells.find(cellKey(i, j));
+            if (cell == _cells.end())
+                continue;
+            for (unsigned int k = 0; k < cell->second.size(); k++)
+            {
+                const Entry &entry = cell->second[k];
+                if (matches(entry, mz, rt) && (best == NULL || entry.order < best->order))
+                    best = &entry;
+            }
+        }
+    }
+    return best ? best->group : NULL;
+}
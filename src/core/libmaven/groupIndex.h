@@ -0,0 +1,80 @@
+#ifndef GROUPINDEX_H
+#define GROUPINDEX_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "PeakGroup.h"
+
+using namespace std;
+
+/**
+ * @class GroupIndex
+ * @ingroup libmaven
+ * @brief Hash grid over the m/z and retention time of peak groups
+ * @details Groups are bucketed into cells as wide as the match tolerance, so
+ * every group within tolerance of a query lies in one of the 3x3 cells around
+ * it. Inserting, removing and looking up a group are O(1) on average, which
+ * keeps duplicate checks linear when a table grows to 100k groups.
+ *
+ * The index stores the m/z and rt a group had when it was inserted and never
+ * dereferences the stored pointers, so it stays safe if a group is freed
+ * without being removed. Owners must rebuild it when groups are moved or
+ * their m/z or rt change.
+ */
+class GroupIndex
+{
+  public:
+	/**
+	 * @param mzTolerance groups closer than this in m/z may match
+	 * @param rtTolerance groups closer than this in rt may match
+	 */
+	GroupIndex(double mzTolerance = 1e-5, double rtTolerance = 1e-5);
+
+	void insert(PeakGroup *group);
+
+	/**
+	 * @brief remove a group inserted earlier
+	 * @return false if the group was not in the index
+	 */
+	bool remove(PeakGroup *group);
+
+	void clear();
+
+	unsigned int size() const { return _size; }
+
+	/**
+	 * @brief true if this exact group (pointer) is in the index
+	 */
+	bool contains(PeakGroup *group) const;
+
+	/**
+	 * @brief earliest inserted group within tolerance of mz and rt
+	 * @return pointer to that group, or NULL
+	 */
+	PeakGroup* find(float mz, float rt) const;
+
+  private:
+	struct Entry
+	{
+		PeakGroup *group;
+		float mz;
+		float rt;
+		unsigned long order;
+	};
+
+	double _mzTolerance;
+	double _rtTolerance;
+	unsigned int _size;
+	unsigned long _inserted;
+	unordered_map<unsigned long long, vector<Entry> > _cells;
+
+	long long mzCell(float mz) const;
+	long long rtCell(float rt) const;
+	static unsigned long long cellKey(long long mzCell, long long rtCell);
+	bool matches(const Entry &entry, float mz, float rt) const;
+	bool removeFrom(unordered_map<unsigned long long, vector<Entry> >::iterator cell,
+					PeakGroup *group);
+};
+
+#endif //GROUPINDEX_H
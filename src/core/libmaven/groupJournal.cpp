@@ -0,0 +1,245 @@
+#include "groupJournal.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const char MAGIC[8] = {'M', 'A', 'V', 'E', 'N', 'J', 'N', 'L'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const unsigned long HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(uint32_t);
+
+template <typename T>
+void put(string &buffer, T value)
+{
+    buffer.append((const char *)&value, sizeof(value));
+}
+
+template <typename T>
+bool get(const string &buffer, size_t &offset, T &value)
+{
+    if (offset + sizeof(value) > buffer.size())
+        return false;
+    memcpy(&value, buffer.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+bool decodePath(const string &payload, size_t &offset, vector<int> &path)
+{
+    uint32_t depth;
+    if (!get(payload, offset, depth) || depth == 0 || depth > payload.size())
+        return false;
+    path.resize(depth);
+    for (uint32_t i = 0; i < depth; i++) {
+        int32_t index;
+        if (!get(payload, offset, index))
+            return false;
+        path[i] = index;
+    }
+    return true;
+}
+
+} // namespace
+
+GroupJournal::GroupJournal()
+{
+    _fileSize = 0;
+    _marked = false;
+    _markOffset = 0;
+}
+
+void GroupJournal::mark()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _marked = true;
+    _markOffset = _pending.size();
+}
+
+bool GroupJournal::start(string filename)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_marked)
+        return false;
+    string kept = _pending.substr(_markOffset);
+    _pending.clear();
+    _fileName.clear();
+    _fileSize = 0;
+    _marked = false;
+    _markOffset = 0;
+
+    ofstream out(filename.c_str(), ios::binary | ios::trunc);
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write((const char *)&VERSION, sizeof(VERSION));
+    out.write((const char *)&BYTE_ORDER_MARK, sizeof(BYTE_ORDER_MARK));
+    out.close();
+    if (!out)
+        return false;
+
+    _fileName = filename;
+    _fileSize = HEADER_SIZE;
+    _pending = kept;
+    return true;
+}
+
+void GroupJournal::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.clear();
+    _fileName.clear();
+    _fileSize = 0;
+    _marked = false;
+    _markOffset = 0;
+}
+
+bool GroupJournal::isStarted() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_fileName.empty();
+}
+
+string GroupJournal::fileName() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _fileName;
+}
+
+unsigned long GroupJournal::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _fileSize + _pending.size();
+}
+
+string GroupJournal::encodePath(const vector<int> &path)
+{
+    string payload;
+    put<uint32_t>(payload, path.size());
+    for (unsigned int i = 0; i < path.size(); i++)
+        put<int32_t>(payload, path[i]);
+    return payload;
+}
+
+void GroupJournal::append(Operation operation, const string &payload)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_fileName.empty() && !_marked)
+        return;
+    put<uint32_t>(_pending, payload.size() + 1);
+    put<uint8_t>(_pending, operation);
+    _pending.append(payload);
+}
+
+void GroupJournal::logLabel(const vector<int> &path, char label)
+{
+    if (path.empty())
+        return;
+    string payload = encodePath(path);
+    put<int8_t>(payload, label);
+    append(Label, payload);
+}
+
+void GroupJournal::logDelete(const vector<int> &path)
+{
+    if (path.empty())
+        return;
+    append(Delete, encodePath(path));
+}
+
+void GroupJournal::logAdd(PeakGroup *group, const vector<mzSample *> &samples)
+{
+    if (!group)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_fileName.empty() && !_marked)
+            return;
+    }
+
+    PeakTableFile peakTable;
+    peakTable.compress = false;
+    ostringstream out(ios::binary);
+    vector<PeakGroup *> groups(1, group);
+    if (peakTable.write(out, groups, samples))
+        append(Add, out.str());
+}
+
+bool GroupJournal::flush()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_fileName.empty())
+        return false;
+
+    //records logged after a mark belong to the journal start() begins
+    size_t length = _marked ? _markOffset : _pending.size();
+    if (length == 0)
+        return true;
+
+    ofstream out(_fileName.c_str(), ios::binary | ios::app);
+    out.write(_pending.data(), length);
+    out.close();
+    if (!out)
+        return false;
+
+    _fileSize += length;
+    _pending.erase(0, length);
+    _markOffset = 0;
+    return true;
+}
+
+bool GroupJournal::read(string filename, const vector<mzSample *> &samples,
+                        vector<Record> &records,
+                        PeakTableFile::CompoundResolver compoundResolver)
+{
+    ifstream in(filename.c_str(), ios::binary);
+    char magic[sizeof(MAGIC)];
+    uint32_t version, byteOrder;
+    in.read(magic, sizeof(magic));
+    in.read((char *)&version, sizeof(version));
+    in.read((char *)&byteOrder, sizeof(byteOrder));
+    if (!in || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION
+        || byteOrder != BYTE_ORDER_MARK)
+        return false;
+
+    PeakTableFile peakTable;
+    peakTable.compoundResolver = compoundResolver;
+
+    while (true) {
+        uint32_t length;
+        in.read((char *)&length, sizeof(length));
+        if (!in || length == 0)
+            break;
+        string payload(length, '\0');
+        in.read(&payload[0], length);
+        if (!in)
+            break;
+
+        Record record;
+        record.operation = (Operation)(uint8_t)payload[0];
+        record.label = 0;
+        size_t offset = 1;
+        bool valid = false;
+
+        if (record.operation == Label) {
+            int8_t label;
+            valid = decodePath(payload, offset, record.path) && get(payload, offset, label);
+            record.label = label;
+        } else if (record.operation == Delete) {
+            valid = decodePath(payload, offset, record.path);
+        } else if (record.operation == Add) {
+            istringstream group(payload.substr(1), ios::binary);
+            vector<PeakGroup> added;
+            valid = peakTable.read(group, samples, added) && added.size() == 1;
+            if (valid)
+                record.group = added[0];
+        }
+
+        //a damaged record ends the journal, later edits may depend on it
+        if (!valid)
+            break;
+        records.push_back(record);
+    }
+    return true;
+}
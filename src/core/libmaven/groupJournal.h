@@ -0,0 +1,174 @@
+#ifndef GROUPJOURNAL_H
+#define GROUPJOURNAL_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PeakGroup.h"
+#include "peakTableFile.h"
+
+using namespace std;
+
+class mzSample;
+
+/**
+ * @class GroupJournal
+ * @ingroup libmaven
+ * @brief Append-only log of edits made to a peak table since it was saved
+ * @details A journal belongs to one saved table. Edits are recorded in
+ * memory as they happen and appended to the journal file by flush(), so an
+ * autosave costs as much as the edits since the previous one. Replaying the
+ * records in order over the groups of the saved table restores the edited
+ * table. After the table is saved in full again the journal is restarted,
+ * which compacts it: mark() is called just before the table is written and
+ * start() once it has been, so edits made while the table was being written
+ * stay in the restarted journal.
+ *
+ * Groups are addressed by their path: the index of the top level group in
+ * the table followed by child indices. Paths are taken just before an edit,
+ * so they are valid during replay as long as every edit that moves groups
+ * is journaled; owners must save in full after any other reordering.
+ *
+ * Logging and flushing may happen on different threads.
+ */
+class GroupJournal
+{
+  public:
+	enum Operation
+	{
+		Label = 1,
+		Delete = 2,
+		Add = 3
+	};
+
+	/**
+	 * @brief one edit read back from a journal
+	 */
+	struct Record
+	{
+		Operation operation;
+		vector<int> path;	//Label and Delete
+		char label;			//Label
+		PeakGroup group;	//Add, a top level group
+	};
+
+	GroupJournal();
+
+	/**
+	 * @brief a full save of the table begins, records logged from now on are
+	 * kept by the next start()
+	 */
+	void mark();
+
+	/**
+	 * @brief start a journal holding the records logged since mark()
+	 * @details records logged before mark() are dropped, they are in the
+	 * saved table
+	 * @return false if there is no mark, as after stop(), or the file could
+	 * not be created
+	 */
+	bool start(string filename);
+
+	/**
+	 * @brief stop journaling and drop the mark, the file is left as it is
+	 */
+	void stop();
+
+	bool isStarted() const;
+	string fileName() const;
+
+	/**
+	 * @brief bytes in the file and pending, used to decide when to compact
+	 */
+	unsigned long size() const;
+
+	void logLabel(const vector<int> &path, char label);
+	void logDelete(const vector<int> &path);
+
+	/**
+	 * @brief log a group added at the end of the table
+	 */
+	void logAdd(PeakGroup *group, const vector<mzSample *> &samples);
+
+	/**
+	 * @brief append pending records logged before any mark to the file
+	 * @return false if the journal is not started or the write failed
+	 */
+	bool flush();
+
+	/**
+	 * @brief read all complete records of a journal
+	 * @details a record cut short by a crash ends the journal
+	 * @param samples loaded samples for groups added by the journal
+	 * @param compoundResolver compound lookup for added groups, may be empty
+	 * @return false if the file is missing or not a journal
+	 */
+	static bool read(string filename, const vector<mzSample *> &samples,
+					 vector<Record> &records,
+					 PeakTableFile::CompoundResolver compoundResolver = PeakTableFile::CompoundResolver());
+
+	/**
+	 * @return path of a group in a list of top level groups, empty if the
+	 * group is not in it
+	 * @details top level groups are looked up at groupId - 1 first, where
+	 * tables number them, before the list is searched
+	 */
+	template <typename List>
+	static vector<int> pathOf(List &groups, PeakGroup *group)
+	{
+		vector<int> path;
+		while (group && group->parent) {
+			PeakGroup *parent = group->parent;
+			if (parent->children.empty() || group < &parent->children[0]
+				|| group > &parent->children.back())
+				return vector<int>();
+			path.insert(path.begin(), group - &parent->children[0]);
+			group = parent;
+		}
+		if (!group)
+			return vector<int>();
+		int hint = group->groupId - 1;
+		if (hint >= 0 && hint < (int)groups.size() && &groups[hint] == group) {
+			path.insert(path.begin(), hint);
+			return path;
+		}
+		for (int i = 0; i < (int)groups.size(); i++) {
+			if (&groups[i] == group) {
+				path.insert(path.begin(), i);
+				return path;
+			}
+		}
+		return vector<int>();
+	}
+
+	/**
+	 * @return group at a path, NULL if the path does not exist
+	 */
+	template <typename List>
+	static PeakGroup *groupAt(List &groups, const vector<int> &path)
+	{
+		if (path.empty() || path[0] < 0 || path[0] >= (int)groups.size())
+			return NULL;
+		PeakGroup *group = &groups[path[0]];
+		for (unsigned int i = 1; i < path.size(); i++) {
+			if (path[i] < 0 || path[i] >= (int)group->children.size())
+				return NULL;
+			group = &group->children[path[i]];
+		}
+		return group;
+	}
+
+  private:
+	string _fileName;
+	string _pending;
+	unsigned long _fileSize;
+	bool _marked;
+	size_t _markOffset;		//bytes of _pending logged before mark()
+	mutable std::mutex _mutex;
+
+	void append(Operation operation, const string &payload);
+	static string encodePath(const vector<int> &path);
+};
+
+#endif
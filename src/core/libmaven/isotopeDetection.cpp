@@ -32,13 +32,14 @@ void IsotopeDetection::pullIsotopes(PeakGroup* parentgroup)
     string formula = parentgroup->compound->formula; //parent formula
     int charge = _mavenParameters->getCharge(parentgroup->compound);//generate isotope list for parent mass
 
-    vector<Isotope> masslist = MassCalculator::computeIsotopes(
+    vector<Isotope> masslist = MassCalculator::computeIsotopePattern(
         formula,
         charge,
         _C13Flag,
         _N15Flag,
         _S34Flag,
-        _D2Flag
+        _D2Flag,
+        _mavenParameters->minIsotopicAbundance
     );
 
     map<string, PeakGroup> isotopes = getIsotopes(parentgroup, masslist);
@@ -52,15 +53,24 @@ map<string, PeakGroup> IsotopeDetection::getIsotopes(PeakGroup* parentgroup, vec
     //iterate over samples to find properties for parent's isotopes.
     map<string, PeakGroup> isotopes;
 
+    float maxRtDiff = _mavenParameters->maxIsotopeScanDiff * _mavenParameters->avgScanTime;
+    //smoothing can move an apex by up to half a window, do not prune those
+    float signalRtPadding = maxRtDiff
+                            + _mavenParameters->eic_smoothingWindow * _mavenParameters->avgScanTime;
+
     for (unsigned int s = 0; s < _mavenParameters->samples.size(); s++) {
         mzSample* sample = _mavenParameters->samples[s];
+
+        //isotopologues worth an EIC in this sample, pulled together in one pass
+        vector<unsigned int> candidates;
+        vector<float> candidateRts;
+        vector<mzSlice> windows;
+
         for (unsigned int k = 0; k < masslist.size(); k++) {
             //			if (stopped())
             //				break; TODO: stop
             Isotope& x = masslist[k];
-            string isotopeName = x.name;
             double isotopeMass = x.mass;
-            double expectedAbundance = x.abundance;
 
             float mzmin = isotopeMass -_mavenParameters->compoundMassCutoffWindow->massCutoffValue(isotopeMass);
             float mzmax = isotopeMass +_mavenParameters->compoundMassCutoffWindow->massCutoffValue(isotopeMass);
@@ -87,19 +97,35 @@ map<string, PeakGroup> IsotopeDetection::getIsotopes(PeakGroup* parentgroup, vec
                 isotopePeakIntensity = isotope.first;
                 rt = isotope.second;
             }
-            //if(isotopePeakIntensity==0) continue;
+            //no peak of this isotopologue can be found near the parent
+            if (!hasSignal(sample, mzmin, mzmax, rt - signalRtPadding, rt + signalRtPadding))
+                continue;
 
             if (filterIsotope(x, isotopePeakIntensity, parentPeakIntensity, sample, parentgroup))
                 continue;
-            
+
+            candidates.push_back(k);
+            candidateRts.push_back(rt);
+            windows.push_back(mzSlice(mzmin, mzmax, sample->minRt, sample->maxRt));
+        }
+
+        //actually mslevel should probably be deepest MS level?
+        //TODO: decide how isotope children should even work in MS mode
+        vector<EIC*> eics = sample->getEICs(windows, 1, _mavenParameters->eicType,
+                                            _mavenParameters->filterline);
+
+        for (unsigned int c = 0; c < candidates.size(); c++) {
+            Isotope& x = masslist[candidates[c]];
+            string isotopeName = x.name;
+            double isotopeMass = x.mass;
+            double expectedAbundance = x.abundance;
+            float rt = candidateRts[c];
+
             vector<Peak> allPeaks;
 
-            EIC * eic = sample->getEIC(mzmin, mzmax, sample->minRt,sample->maxRt, 1, _mavenParameters->eicType,
-                                        _mavenParameters->filterline);
-            //actually last parameter should probably be deepest MS level?
-            //TODO: decide how isotope children should even work in MS mode
+            EIC * eic = eics[c];
 
-            // smooth fond eic TODO: null check for found
+            // smooth fond eic
             eic->setSmootherType(
                     (EIC::SmootherType)
                     _mavenParameters->eic_smoothingAlgorithm);
@@ -116,8 +142,8 @@ map<string, PeakGroup> IsotopeDetection::getIsotopes(PeakGroup* parentgroup, vec
             peakFiltering.filter(allPeaks);
 
             delete(eic);
+            eics[c] = NULL;
             // find nearest peak as long as it is within RT window
-            float maxRtDiff=_mavenParameters->maxIsotopeScanDiff * _mavenParameters->avgScanTime;
             //why are we even doing this calculation, why not have the parameter be in units of RT?
             Peak* nearestPeak = NULL;
             float d = FLT_MAX;
@@ -228,6 +254,28 @@ std::pair<float, float> IsotopeDetection::getIntensity(Scan* scan, float mzmin,
     return std::make_pair(highestIntensity, rt);
 }
 
+bool IsotopeDetection::hasSignal(mzSample* sample, float mzmin, float mzmax, float rtmin, float rtmax)
+{
+    deque<Scan*>& scans = sample->scans;
+    deque<Scan*>::iterator scanItr = lower_bound(scans.begin(), scans.end(), rtmin,
+                                                 [](Scan* scan, float rt) { return scan->rt < rt; });
+
+    for (; scanItr != scans.end(); scanItr++) {
+        Scan* scan = *scanItr;
+        if (scan->rt > rtmax)
+            break;
+        if (scan->mslevel != 1)
+            continue;
+        if (!(scan->filterLine == _mavenParameters->filterline || _mavenParameters->filterline == ""))
+            continue;
+
+        vector<float>::iterator mzItr = lower_bound(scan->mz.begin(), scan->mz.end(), mzmin);
+        if (mzItr != scan->mz.end() && *mzItr <= mzmax)
+            return true;
+    }
+    return false;
+}
+
 void IsotopeDetection::addIsotopes(PeakGroup* parentgroup, map<string, PeakGroup> isotopes)
 {
 
@@ -42,6 +42,12 @@ class IsotopeDetection
 	 **/
 	bool filterIsotope(Isotope x, float isotopePeakIntensity, float parentPeakIntensity, mzSample* sample, PeakGroup* parentGroup = NULL);
 
+	/**
+	 * @brief checks if any MS1 scan in the given rt range has a data point in the m/z range
+	 * @details used to skip isotopologues that cannot be observed before pulling their EICs
+	 **/
+	bool hasSignal(mzSample* sample, float mzmin, float mzmax, float rtmin, float rtmax);
+
   private:
 	bool _C13Flag;
 	bool _N15Flag;
@@ -43,7 +43,11 @@ SOURCES = 	base64.cpp \
                 mzMassCalculator.cpp \
                 mzPatterns.cpp \
                 mzSample.cpp \
+                ms2Index.cpp \
+                traceCache.cpp \
                 mzUtils.cpp \
+                scratchBuffer.cpp \
+                scanAverager.cpp \
                 statistics.cpp \
                 elementMass.cpp \
                 mzFit.cpp \
@@ -51,10 +55,12 @@ SOURCES = 	base64.cpp \
                 mzMassSlicer.cpp \
 	        PeakGroup.cpp \
             Fragment.cpp \
+                spectralLibrary.cpp \
 	        EIC.cpp \
 	        Scan.cpp \
                 SRMList.cpp \
 	        Peak.cpp  \
+                peakColumns.cpp \
 	        Compound.cpp \
 	        savgol.cpp \
        	        SavGolSmoother.cpp \
@@ -67,6 +73,8 @@ SOURCES = 	base64.cpp \
                 comparesampleslogic.cpp \
                 isotopelogic.cpp \
                 eiclogic.cpp \
+                eicservice.cpp \
+                eicpyramid.cpp \
                 databases.cpp \
                 Peptide.cpp \
                 PolyAligner.cpp \
@@ -74,22 +82,33 @@ SOURCES = 	base64.cpp \
                 masscutofftype.cpp \
                 peakFiltering.cpp \
                 groupFiltering.cpp \
+                groupClustering.cpp \
+                groupIndex.cpp \
+                featureMatrix.cpp \
+                groupJournal.cpp \
+                peakTableFile.cpp \
                 isotopeDetection.cpp
 
 HEADERS += 	constants.h \
 		base64.h \
                 mzFit.h \
                 Peak.h \
+                peakColumns.h \
                 mzAligner.h \
                 mzMassSlicer.h \
 	            PeakGroup.h \
                 mzSample.h \
+                ms2Index.h \
+                traceCache.h \
                 PeptideRecord.h \
                 Fragment.h \
+                spectralLibrary.h \
                 elementMass.h \
                 mzMassCalculator.h \
                 mzPatterns.h \
                 mzUtils.h \
+                scratchBuffer.h \
+                scanAverager.h \
                 statistics.h \
                 SavGolSmoother.h \
                 PeakDetector.h \
@@ -101,6 +120,8 @@ HEADERS += 	constants.h \
                 comparesampleslogic.h \
                 isotopelogic.h \
                 eiclogic.h \
+                eicservice.h \
+                eicpyramid.h \
                 EIC.h \
 	            Scan.h \
                 SRMList.h \
@@ -112,5 +133,10 @@ HEADERS += 	constants.h \
                 masscutofftype.h \
                 peakFiltering.h \
                 groupFiltering.h \
+                groupClustering.h \
+                groupIndex.h \
+                featureMatrix.h \
+                groupJournal.h \
+                peakTableFile.h \
                 isotopeDetection.h \
                 settings.h
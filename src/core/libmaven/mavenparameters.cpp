@@ -91,6 +91,7 @@ MavenParameters::MavenParameters(string settingsPath):lastUsedSettingsPath(setti
         maxIsotopeScanDiff = 10;
         maxNaturalAbundanceErr = 100;
         minIsotopicCorrelation = 0;
+        minIsotopicAbundance = 0;
         isotopeC13Correction = 0;
 
 	C13Labeled_BPE = false;
@@ -383,6 +384,9 @@ void MavenParameters::setOptionsDialogSettings(const char* key, const char* valu
     if(strcmp(key, "minIsotopicCorrelation") == 0)
         minIsotopicCorrelation = atof(value);
 
+    if(strcmp(key, "minIsotopicAbundance") == 0)
+        minIsotopicAbundance = atof(value);
+
     if(strcmp(key, "maxIsotopeScanDiff") == 0)
         maxIsotopeScanDiff = atof(value);
 
@@ -195,6 +195,12 @@ class MavenParameters
         double maxIsotopeScanDiff;
         double maxNaturalAbundanceErr;
         double minIsotopicCorrelation;
+        /**
+        * labelled isotopologues with a lower expected natural abundance are not
+        * pulled. Defaults to 0, which pulls every labelled species: tracers such
+        * as fully labelled glucose sit far below any natural-abundance floor.
+        */
+        double minIsotopicAbundance;
         bool isotopeC13Correction;
         bool C13Labeled_BPE;
         bool N15Labeled_BPE;
@@ -0,0 +1,80 @@
+#include "ms2Index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Scan.h"
+
+MS2Index::MS2Index()
+{
+    _scanCount = 0;
+    _firstScan = NULL;
+    _lastScan = NULL;
+}
+
+void MS2Index::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _scanCount = 0;
+    _firstScan = NULL;
+    _lastScan = NULL;
+}
+
+bool MS2Index::isStale(const deque<Scan *> &scans) const
+{
+    if (_scanCount != scans.size())
+        return true;
+    return !scans.empty() && (scans.front() != _firstScan || scans.back() != _lastScan);
+}
+
+void MS2Index::build(const deque<Scan *> &scans)
+{
+    _entries.clear();
+    for (unsigned int i = 0; i < scans.size(); i++) {
+        Scan *scan = scans[i];
+        if (scan == NULL || scan->mslevel <= 1)
+            continue;
+        //a NaN would break the ordering binary searches rely on
+        if (!std::isfinite(scan->precursorMz))
+            continue;
+        Entry entry;
+        entry.precursorMz = scan->precursorMz;
+        entry.order = i;
+        entry.scan = scan;
+        _entries.push_back(entry);
+    }
+    std::stable_sort(_entries.begin(), _entries.end());
+    _scanCount = scans.size();
+    _firstScan = scans.empty() ? NULL : scans.front();
+    _lastScan = scans.empty() ? NULL : scans.back();
+}
+
+vector<Scan *> MS2Index::find(const deque<Scan *> &scans, float mzmin, float mzmax,
+                              float rtmin, float rtmax)
+{
+    vector<Entry> hits;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (isStale(scans))
+            build(scans);
+
+        Entry bound;
+        bound.precursorMz = mzmin;
+        vector<Entry>::const_iterator it = std::lower_bound(_entries.begin(), _entries.end(), bound);
+        for (; it != _entries.end() && it->precursorMz <= mzmax; ++it) {
+            float rt = it->scan->rt;
+            if (rt < rtmin || rt > rtmax)
+                continue;
+            hits.push_back(*it);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(),
+              [](const Entry &a, const Entry &b) { return a.order < b.order; });
+
+    vector<Scan *> matches(hits.size());
+    for (unsigned int i = 0; i < hits.size(); i++)
+        matches[i] = hits[i].scan;
+    return matches;
+}
@@ -0,0 +1,62 @@
+#ifndef MS2INDEX_H
+#define MS2INDEX_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+class Scan;
+
+/**
+ * @class MS2Index
+ * @ingroup libmaven
+ * @brief Fragmentation scans of one sample sorted by precursor m/z
+ * @details Turns the search for MS2 events of an m/z window, which used to
+ * walk every scan of a sample, into a binary search plus a walk over the
+ * matches. The index is built on first use and rebuilt when the number of
+ * scans or the first or last scan changes, as when scans are appended or a
+ * sample is reloaded. Scans without a valid precursor m/z are not indexed.
+ * Retention times are read from the scans at query time, so alignment does
+ * not invalidate it. Queries may run on several threads.
+ */
+class MS2Index
+{
+  public:
+	MS2Index();
+
+	/**
+	 * @brief scans of msLevel > 1 with precursor m/z in [mzmin, mzmax] and
+	 * rt in [rtmin, rtmax]
+	 * @param scans all scans of the sample, in acquisition order
+	 * @return matches in acquisition order
+	 */
+	vector<Scan *> find(const deque<Scan *> &scans, float mzmin, float mzmax,
+						float rtmin, float rtmax);
+
+	/**
+	 * @brief drop the index, e.g. before scans are deleted
+	 */
+	void clear();
+
+  private:
+	struct Entry
+	{
+		float precursorMz;
+		unsigned int order;		//position in scans
+		Scan *scan;
+		bool operator<(const Entry &b) const { return precursorMz < b.precursorMz; }
+	};
+
+	vector<Entry> _entries;
+	size_t _scanCount;
+	Scan *_firstScan;		//scans the index was built from
+	Scan *_lastScan;
+	std::mutex _mutex;
+
+	void build(const deque<Scan *> &scans);
+	bool isStale(const deque<Scan *> &scans) const;
+};
+
+#endif
@@ -88,115 +88,212 @@ double MassCalculator::computeMass(string formula, int charge) {
     return adjustMass(mass, charge);
 }
 
-vector<Isotope> MassCalculator::computeIsotopes(
+namespace {
+
+    const int LOG_FACTORIAL_CACHE_SIZE = 1024;
+
+    /**
+     * log(n!) is looked up for atom counts that occur in practice and
+     * falls back to lgamma for anything larger.
+     */
+    double logFactorial(int n) {
+        static const vector<double> cache = [] {
+            vector<double> table(LOG_FACTORIAL_CACHE_SIZE, 0.0);
+            for (int i = 2; i < LOG_FACTORIAL_CACHE_SIZE; i++)
+                table[i] = table[i - 1] + log((double) i);
+            return table;
+        }();
+
+        if (n < LOG_FACTORIAL_CACHE_SIZE) return cache[n];
+        return lgamma(n + 1.0);
+    }
+
+    /* log of n choose k, -inf when there is no way to choose k of n */
+    double logChoose(int n, int k) {
+        if (k < 0 || k > n) return -numeric_limits<double>::infinity();
+        return logFactorial(n) - logFactorial(k) - logFactorial(n - k);
+    }
+
+    /**
+     * One labelled element of the formula. The number of heavy atoms k
+     * follows a binomial distribution over the atoms of that element.
+     */
+    struct LabelAxis {
+        LabelAxis(int atoms, double light, double heavy, double delta,
+                  int Isotope::*count)
+            : atoms(atoms),
+              logLight(log(light)),
+              logHeavy(log(heavy)),
+              massDelta(delta),
+              count(count) {
+            mode = (int) floor((atoms + 1) * heavy);
+            mode = max(1, min(atoms, mode));
+        }
+
+        double logAbundance(int k) const {
+            return logChoose(atoms, k) + k * logHeavy + (atoms - k) * logLight;
+        }
+
+        /* most probable abundance among the labelled (k >= 1) states */
+        double peakLogAbundance() const { return logAbundance(mode); }
+
+        int atoms;
+        int mode;
+        double logLight;
+        double logHeavy;
+        double massDelta;
+        int Isotope::*count;
+    };
+
+    void addSingleLabels(vector<Isotope>& isotopes,
+                         const string& label,
+                         double parentMass,
+                         double logParent,
+                         double logMin,
+                         const LabelAxis& axis) {
+        double logRest = logParent - axis.logAbundance(0);
+        for (int i = 1; i <= axis.atoms; i++) {
+            double logAbundance = logRest + axis.logAbundance(i);
+            if (logAbundance < logMin) {
+                if (i > axis.mode) break;
+                continue;
+            }
+            Isotope x(label + integer2string(i), parentMass + (i * axis.massDelta));
+            x.*(axis.count) = i;
+            x.abundance = exp(logAbundance);
+            isotopes.push_back(x);
+        }
+    }
+
+    void addDualLabels(vector<Isotope>& isotopes,
+                       const string& label,
+                       double parentMass,
+                       double logParent,
+                       double logMin,
+                       const LabelAxis& first,
+                       const LabelAxis& second) {
+        double logRest = logParent - first.logAbundance(0) - second.logAbundance(0);
+        double secondPeak = second.peakLogAbundance();
+        for (int i = 1; i <= first.atoms; i++) {
+            double logFirst = logRest + first.logAbundance(i);
+            if (logFirst + secondPeak < logMin) {
+                if (i > first.mode) break;
+                continue;
+            }
+            for (int j = 1; j <= second.atoms; j++) {
+                double logAbundance = logFirst + second.logAbundance(j);
+                if (logAbundance < logMin) {
+                    if (j > second.mode) break;
+                    continue;
+                }
+                string name = label + integer2string(i) + "-" + integer2string(j);
+                double mass = parentMass + (j * second.massDelta) + (i * first.massDelta);
+                Isotope x(name, mass);
+                x.*(first.count) = i;
+                x.*(second.count) = j;
+                x.abundance = exp(logAbundance);
+                isotopes.push_back(x);
+            }
+        }
+    }
+
+    bool compIsotopeMass(const Isotope& a, const Isotope& b) {
+        return a.mass < b.mass;
+    }
+}
+
+vector<Isotope> MassCalculator::enumerateIsotopes(
     string formula,
     int charge,
     bool C13Flag,
     bool N15Flag,
     bool S34Flag,
-    bool D2Flag
+    bool D2Flag,
+    double minAbundance
 )
 {
     map<string, int> atoms = getComposition(formula);
-    int CatomCount = atoms[C_STRING_ID];
-    int NatomCount = atoms[N_STRING_ID];
-    int SatomCount = atoms[S_STRING_ID];
-    int HatomCount = atoms[H_STRING_ID];
+    LabelAxis carbon(atoms[C_STRING_ID], C12_ABUNDANCE, C13_ABUNDANCE,
+                     C_MASS_DELTA, &Isotope::C13);
+    LabelAxis nitrogen(atoms[N_STRING_ID], N14_ABUNDANCE, N15_ABUNDANCE,
+                       N_MASS_DELTA, &Isotope::N15);
+    LabelAxis sulfur(atoms[S_STRING_ID], S32_ABUNDANCE, S34_ABUNDANCE,
+                     S_MASS_DELTA, &Isotope::S34);
+    LabelAxis hydrogen(atoms[H_STRING_ID], H_ABUNDANCE, H2_ABUNDANCE,
+                       D_MASS_DELTA, &Isotope::H2);
+
+    double logParent = carbon.logAbundance(0) + nitrogen.logAbundance(0)
+                       + sulfur.logAbundance(0) + hydrogen.logAbundance(0);
+    double logMin = minAbundance > 0 ? log(minAbundance)
+                                     : -numeric_limits<double>::infinity();
 
     vector<Isotope> isotopes;
     double parentMass = computeNeutralMass(formula);
 
     Isotope parent(C12_PARENT_LABEL, parentMass);
+    parent.abundance = exp(logParent);
     isotopes.push_back(parent);
 
-    if(C13Flag && N15Flag) {
-        for (int i = 1; i <= CatomCount; i++) {
-            for (int j = 1; j <= NatomCount; j++) {
-                string name = C13N15_LABEL + integer2string(i) + "-" + integer2string(j);
-                double mass = parentMass + (j * N_MASS_DELTA) + (i * C_MASS_DELTA);
-                Isotope x(name, mass, i, j, 0, 0);
-                isotopes.push_back(x);
-            }
-        }
-    }
+    if(C13Flag && N15Flag)
+        addDualLabels(isotopes, C13N15_LABEL, parentMass, logParent, logMin, carbon, nitrogen);
 
-    if(C13Flag && S34Flag) {
-        for (int i = 1; i <= CatomCount; i++) {
-            for (int j = 1; j <= SatomCount; j++) {
-                string name = C13S34_LABEL + integer2string(i) + "-" + integer2string(j);
-                double mass = parentMass + (j * S_MASS_DELTA) + (i * C_MASS_DELTA);
-                Isotope x(name, mass, i, 0, j, 0);
-                isotopes.push_back(x);
-            }
-        }
-    }
+    if(C13Flag && S34Flag)
+        addDualLabels(isotopes, C13S34_LABEL, parentMass, logParent, logMin, carbon, sulfur);
 
-    if(C13Flag && D2Flag) {
-        for (int i = 1; i <= CatomCount; i++) {
-            for (int j = 1; j <= HatomCount; j++) {
-                string name = C13H2_LABEL + integer2string(i) + "-" + integer2string(j);
-                double mass = parentMass + (j * D_MASS_DELTA) + (i * C_MASS_DELTA);
-                Isotope x(name, mass, i, 0, 0, j);
-                isotopes.push_back(x);
-            }
-        }
-    }
+    if(C13Flag && D2Flag)
+        addDualLabels(isotopes, C13H2_LABEL, parentMass, logParent, logMin, carbon, hydrogen);
 
-    if(C13Flag) {
-        for (int i = 1; i <= CatomCount; i++) {
-            Isotope x(C13_LABEL + integer2string(i),
-                    parentMass + (i * C_MASS_DELTA), i, 0, 0, 0);
-            isotopes.push_back(x);
-        }
-    }
+    if(C13Flag)
+        addSingleLabels(isotopes, C13_LABEL, parentMass, logParent, logMin, carbon);
 
-    if(N15Flag) {
-        for (int i = 1; i <= NatomCount; i++) {
-            Isotope x(N15_LABEL + integer2string(i),
-                    parentMass + (i * N_MASS_DELTA), 0, i, 0, 0);
-            isotopes.push_back(x);
-        }
-    }
+    if(N15Flag)
+        addSingleLabels(isotopes, N15_LABEL, parentMass, logParent, logMin, nitrogen);
 
-    if(S34Flag) {
-        for (int i = 1; i <= SatomCount; i++) {
-            Isotope x(S34_LABEL + integer2string(i),
-                    parentMass + (i * S_MASS_DELTA), 0, 0, i, 0);
-            isotopes.push_back(x);
-        }
-    }
+    if(S34Flag)
+        addSingleLabels(isotopes, S34_LABEL, parentMass, logParent, logMin, sulfur);
 
-    if(D2Flag) {
-        for (int i = 1; i <= HatomCount; i++) {
-            Isotope x(H2_LABEL + integer2string(i), parentMass + (i * D_MASS_DELTA),
-                    0, 0, 0, i);
-            isotopes.push_back(x);
-        }
-    }
+    if(D2Flag)
+        addSingleLabels(isotopes, H2_LABEL, parentMass, logParent, logMin, hydrogen);
 
-    for (unsigned int i = 0; i < isotopes.size(); i++) {
-        Isotope& x = isotopes[i];
-        int c = x.C13;
-        int n = x.N15;
-        int s = x.S34;
-        int d = x.H2;
-
-        isotopes[i].mass = adjustMass(isotopes[i].mass,charge);
-
-        isotopes[i].abundance =
-            mzUtils::nchoosek(CatomCount, c) *
-            pow(C12_ABUNDANCE, CatomCount - c) * pow(C13_ABUNDANCE, c) *
-            mzUtils::nchoosek(NatomCount, n) *
-            pow(N14_ABUNDANCE, NatomCount - n) * pow(N15_ABUNDANCE, n) *
-            mzUtils::nchoosek(SatomCount, s) *
-            pow(S32_ABUNDANCE, SatomCount - s) * pow(S34_ABUNDANCE, s) *
-            mzUtils::nchoosek(HatomCount, d) *
-            pow(H_ABUNDANCE, HatomCount - d) * pow(H2_ABUNDANCE, d);
-    }
+    for (unsigned int i = 0; i < isotopes.size(); i++)
+        isotopes[i].mass = adjustMass(isotopes[i].mass, charge);
 
     return isotopes;
 }
 
+vector<Isotope> MassCalculator::computeIsotopes(
+    string formula,
+    int charge,
+    bool C13Flag,
+    bool N15Flag,
+    bool S34Flag,
+    bool D2Flag
+)
+{
+    return enumerateIsotopes(formula, charge, C13Flag, N15Flag, S34Flag, D2Flag, 0);
+}
+
+vector<Isotope> MassCalculator::computeIsotopePattern(
+    string formula,
+    int charge,
+    bool C13Flag,
+    bool N15Flag,
+    bool S34Flag,
+    bool D2Flag,
+    double minAbundance
+)
+{
+    vector<Isotope> isotopes = enumerateIsotopes(formula,
+                                                 charge,
+                                                 C13Flag,
+                                                 N15Flag,
+                                                 S34Flag,
+                                                 D2Flag,
+                                                 minAbundance);
+    stable_sort(isotopes.begin(), isotopes.end(), compIsotopeMass);
+    return isotopes;
+}
+
 void MassCalculator::enumerateMasses(double inputMass, double charge,
     MassCutoff *massCutoff, vector<Match*>& matches) {
     if (charge > 0)
@@ -105,6 +105,24 @@ class MassCalculator {
             bool D2Flag 
         );
 
+        /**
+         * @brief enumerate isotopologues whose expected abundance is at least minAbundance
+         * @details abundances are computed from cached log-binomials. Along every label
+         * axis the enumeration stops once it is past the binomial mode and below the
+         * threshold, so improbable label combinations are never generated.
+         * A threshold of 0 keeps every isotopologue.
+         * @return isotopologues sorted by mass, parent first
+         */
+        static vector<Isotope> computeIsotopePattern(
+            string formula,
+            int charge,
+            bool C13Flag,
+            bool N15Flag,
+            bool S34Flag,
+            bool D2Flag,
+            double minAbundance
+        );
+
         /**
          * [adjustMass ]
          * @method adjustMass
@@ -135,6 +153,13 @@ class MassCalculator {
          */
         static ElementMass elementMass;
         static double getElementMass(string elmnt);
+        static vector<Isotope> enumerateIsotopes(string formula,
+                                                 int charge,
+                                                 bool C13Flag,
+                                                 bool N15Flag,
+                                                 bool S34Flag,
+                                                 bool D2Flag,
+                                                 double minAbundance);
         static void generateElementMassMap(string filename);
 
 };
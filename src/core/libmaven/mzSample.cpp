@@ -1,5 +1,6 @@
 #include "mzSample.h"
 #include "Compound.h"
+#include "scanAverager.h"
 #include <MavenException.h>
 
 //global options
@@ -21,6 +22,8 @@ mzSample::mzSample()
 	totalIntensity = 0;
 	_normalizationConstant = 1; //TODO: Sahil Not being used anywhere
 	injectionTime = 0;
+	_appendOffset = 0;
+	_acquisitionComplete = false;
 	_sampleOrder = 0;
 	sampleNumber = -1;
 	_C13Labeled = false;
@@ -39,6 +42,8 @@ mzSample::~mzSample()
 		if (scans[i] != NULL)
 			delete (scans[i]);
 	scans.clear();
+	ms2Index.clear();
+	traceCache.clear();
 }
 
 void mzSample::addScan(Scan *s)
@@ -177,6 +182,160 @@ void mzSample::loadSample(const char *filename)
 	checkSampleBlank(filename);
 }
 
+int mzSample::appendScans(const char *filename)
+{
+	bool mzML = mystrcasestr(filename, "mzml") != NULL;
+	if (!mzML && mystrcasestr(filename, "mzxml") == NULL)
+		return -1;
+
+	ifstream file(filename, ios::binary);
+	if (!file.is_open())
+		return -1;
+
+	file.seekg(0, ios::end);
+	streamoff fileSize = file.tellg();
+	//shorter than what was read, the file was replaced
+	if (fileSize < (streamoff)_appendOffset)
+		return -1;
+	if (fileSize == (streamoff)_appendOffset)
+		return 0;
+
+	string data(fileSize - _appendOffset, '\0');
+	file.seekg(_appendOffset);
+	if (!file.read(&data[0], data.size()))
+		return -1;
+
+	auto isTag = [&data](size_t pos, const string &name) {
+		size_t end = pos + name.size();
+		return end < data.size() && data.compare(pos, name.size(), name) == 0 &&
+			   (isspace(data[end]) || data[end] == '>' || data[end] == '/');
+	};
+
+	//find the complete top level scans, a scan of an mzXML file
+	//encloses the MS/MS scans taken from it
+	const string scanTag = mzML ? "spectrum" : "scan";
+	const string closeTag = "/" + scanTag;
+	const string runEnd = mzML ? "/spectrumList" : "/msRun";
+	size_t first = string::npos;
+	size_t last = 0;
+	int depth = 0;
+
+	for (size_t pos = data.find('<'); pos != string::npos; pos = data.find('<', pos + 1))
+	{
+		if (isTag(pos + 1, scanTag))
+		{
+			size_t end = data.find('>', pos);
+			if (end == string::npos)
+				break;
+			if (first == string::npos)
+				first = pos;
+			if (data[end - 1] != '/')
+				depth++;
+			else if (depth == 0)
+				last = end + 1;
+			pos = end;
+		}
+		else if (depth > 0 && isTag(pos + 1, closeTag))
+		{
+			size_t end = data.find('>', pos);
+			if (end == string::npos)
+				break;
+			if (--depth == 0)
+				last = end + 1;
+			pos = end;
+		}
+		else if (depth == 0 && isTag(pos + 1, runEnd))
+		{
+			_acquisitionComplete = true;
+			break;
+		}
+	}
+
+	if (first == string::npos || last == 0)
+		return 0;
+
+	//everything ahead of the first scan is read once
+	if (_appendOffset == 0)
+	{
+		string header = data.substr(0, first);
+		xml_document headerDoc;
+		if (mzML)
+		{
+			size_t run = header.find("<run ");
+			size_t runClose = header.find('>', run);
+			if (run != string::npos && runClose != string::npos)
+			{
+				string runTag = header.substr(run, runClose - run);
+				if (runTag[runTag.size() - 1] != '/')
+					runTag += '/';
+				runTag += '>';
+				headerDoc.load_buffer(runTag.data(), runTag.size(), parse_minimal | parse_fragment);
+				xml_node experimentRun = headerDoc.child("run");
+				parseMzMLInjectionTimeStamp(experimentRun);
+			}
+		}
+		else
+		{
+			size_t instrument = header.find("<msInstrument");
+			size_t instrumentEnd = header.find("</msInstrument>", instrument);
+			if (instrument != string::npos && instrumentEnd != string::npos)
+			{
+				headerDoc.load_buffer(header.data() + instrument,
+									  instrumentEnd + 15 - instrument,
+									  parse_minimal | parse_fragment);
+				setInstrumentSettigs(headerDoc, headerDoc);
+			}
+		}
+		sampleNaming(filename);
+		checkSampleBlank(filename);
+	}
+
+	xml_document doc;
+	xml_parse_result parseResult = doc.load_buffer(data.data() + first, last - first,
+												   parse_minimal | parse_fragment);
+	if (!parseResult)
+		return -1;
+	_appendOffset += last;
+
+	unsigned int firstNew = scans.size();
+	if (mzML)
+		parseMzMLSpectrumList(doc);
+	else
+		parseMzXMLData(doc, doc);
+
+	if (firstNew == 0)
+	{
+		enumerateSRMScans();
+		calculateMzRtRange();
+		return scans.size();
+	}
+
+	//extend srm map and ranges by the new scans only
+	for (unsigned int j = firstNew; j < scans.size(); j++)
+	{
+		Scan *scan = scans[j];
+		if (scan->filterLine.length() > 0)
+			srmScans[scan->filterLine].push_back(j);
+
+		for (unsigned int i = 0; i < scan->mz.size(); i++)
+		{
+			totalIntensity += scan->intensity[i];
+			float mz = scan->mz[i];
+			if (mz < minMz && mz > 0)
+				minMz = mz;
+			if (mz > maxMz && mz < 1e9)
+				maxMz = mz;
+			if (scan->intensity[i] < minIntensity)
+				minIntensity = scan->intensity[i];
+			if (scan->intensity[i] > maxIntensity)
+				maxIntensity = scan->intensity[i];
+		}
+	}
+	maxRt = std::min(1e4f, scans[scans.size() - 1]->rt);
+
+	return scans.size() - firstNew;
+}
+
 void mzSample::parseMzCSV(const char *filename)
 {
 
@@ -429,8 +588,8 @@ void mzSample::parseMzMLChromatogromList(xml_node &chromatogramList)
 void mzSample::parseMzMLSpectrumList(xml_node &spectrumList)
 {
 
-	//Iterate through spectrums
-	int scannum = 0;
+	//Iterate through spectrums, numbering continues after scans appended before
+	int scannum = scans.size();
 
 	for (xml_node spectrum = spectrumList.child("spectrum");
 		 spectrum; spectrum = spectrum.next_sibling("spectrum"))
@@ -689,8 +848,8 @@ void mzSample::setInstrumentSettigs(xml_document &doc, xml_node spectrumstore)
 
 void mzSample::parseMzXMLData(xml_document &doc, xml_node spectrumstore)
 {
-	//Iterate through spectrums
-	int scannum = 0;
+	//Iterate through spectrums, numbering continues after scans appended before
+	int scannum = scans.size();
 
 	for (xml_node scan = spectrumstore.child("scan"); scan; scan = scan.next_sibling("scan"))
 	{
@@ -1461,6 +1620,71 @@ EIC *mzSample::getEIC(float mzmin, float mzmax, float rtmin, float rtmax, int ms
 	return (e);
 }
 
+vector<EIC *> mzSample::getEICs(const vector<mzSlice> &slices, int mslevel, int eicType, string filterline)
+{
+	vector<EIC *> eics(slices.size(), NULL);
+	vector<mzSlice> windows;
+	windows.reserve(slices.size());
+
+	for (unsigned int i = 0; i < slices.size(); i++)
+	{
+		//same adjustments as the single window getEIC
+		mzSlice window = slices[i];
+		if (window.rtmin < this->minRt)
+			window.rtmin = this->minRt;
+		if (window.rtmax > this->maxRt && this->maxRt > window.rtmin)
+			window.rtmax = this->maxRt;
+		if (window.mzmin < this->minMz)
+			window.mzmin = this->minMz;
+		if (window.mzmax > this->maxMz && this->maxMz > window.mzmin)
+			window.mzmax = this->maxMz;
+		windows.push_back(window);
+
+		EIC *e = new EIC();
+		e->sampleName = sampleName;
+		e->sample = this;
+		e->mzmin = window.mzmin;
+		e->mzmax = window.mzmax;
+		e->totalIntensity = 0;
+		e->maxIntensity = 0;
+		eics[i] = e;
+	}
+
+	if (scans.size() == 0 || slices.size() == 0)
+		return eics;
+
+	//the single pass walks windows in order of their mzmin
+	vector<unsigned int> order(windows.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+		order[i] = i;
+	sort(order.begin(), order.end(), [&windows](unsigned int a, unsigned int b) {
+		return windows[a].mzmin < windows[b].mzmin;
+	});
+
+	vector<mzSlice> sortedWindows;
+	vector<EIC *> sortedEics;
+	sortedWindows.reserve(order.size());
+	sortedEics.reserve(order.size());
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		sortedWindows.push_back(windows[order[i]]);
+		sortedEics.push_back(eics[order[i]]);
+	}
+
+	bool success = EIC::makeEICSlices(this, sortedEics, sortedWindows, mslevel, eicType, filterline);
+	if (!success)
+		return eics;
+
+	float scale = getNormalizationConstant();
+	for (unsigned int i = 0; i < eics.size(); i++)
+	{
+		eics[i]->getRTMinMaxPerScan();
+		eics[i]->normalizeIntensityPerScan(scale);
+	}
+
+	return eics;
+}
+
 EIC *mzSample::getTIC(float rtmin, float rtmax, int mslevel)
 {
 	//TODO naman unused function
@@ -1567,16 +1791,27 @@ EIC *mzSample::getBIC(float rtmin, float rtmax, int mslevel)
 //compute correlation between two mzs within some retention time window
 float mzSample::correlation(float mz1, float mz2, MassCutoff *massCutoff, float rt1, float rt2, int eicType, string filterline)
 {
+	vector<float> mzs(2);
+	mzs[0] = mz1;
+	mzs[1] = mz2;
+	return correlations(mzs, massCutoff, rt1, rt2, eicType, filterline)[0][1];
+}
 
-	float ppm1 = massCutoff->massCutoffValue(mz1);
-	float ppm2 = massCutoff->massCutoffValue(mz2);
+vector<vector<float> > mzSample::correlations(const vector<float> &mzs, MassCutoff *massCutoff, float rt1, float rt2, int eicType, string filterline)
+{
 	int mslevel = 1;
-	EIC *e1 = mzSample::getEIC(mz1 - ppm1, mz1 + ppm1, rt1, rt2, mslevel, eicType, filterline);
-	EIC *e2 = mzSample::getEIC(mz2 - ppm2, mz2 + ppm1, rt1, rt2, mslevel, eicType, filterline);
-	float correlation = mzUtils::correlation(e1->intensity, e2->intensity);
-	delete (e1);
-	delete (e2);
-	return correlation;
+	vector<mzSlice> windows(mzs.size());
+	for (unsigned int i = 0; i < mzs.size(); i++)
+	{
+		float window = massCutoff->massCutoffValue(mzs[i]);
+		windows[i] = mzSlice(mzs[i] - window, mzs[i] + window, rt1, rt2);
+	}
+
+	vector<TraceCache::Trace> traces = getTraces(windows, mslevel, eicType, filterline);
+	vector<const vector<float> *> intensities(traces.size());
+	for (unsigned int i = 0; i < traces.size(); i++)
+		intensities[i] = traces[i].get();
+	return mzUtils::correlationMatrix(intensities);
 }
 
 //TODO: is_verbose not being used
@@ -1794,43 +2029,25 @@ int mzSample::parseCDF(const char *filename, int is_verbose)
 
 Scan *mzSample::getAverageScan(float rtmin, float rtmax, int mslevel, int polarity, float sd)
 {
-	//TODO naman unused function
-
 	float rt = rtmin + (rtmax - rtmin) / 2;
-	int scanCount = 0;
 	int scannum = 0;
 
-	map<float, double> mz_intensity_map;
-	map<float, double> mz_bin_map;
-	map<float, int> mz_count;
-
+	vector<Scan *> selected;
 	for (unsigned int s = 0; s < scans.size(); s++)
 	{
 		if (scans[s]->getPolarity() != polarity || scans[s]->mslevel != mslevel || scans[s]->rt < rtmin || scans[s]->rt > rtmax)
 			continue;
-
-		Scan *scan = scans[s];
-		scanCount++;
-		for (unsigned int i = 0; i < scan->mz.size(); i++)
-		{
-			float bin = FLOATROUND(scan->mz[i], sd);
-			mz_intensity_map[bin] += ((double)scan->intensity[i]);
-			mz_bin_map[bin] += ((double)(scan->intensity[i]) * (scan->mz[i]));
-			mz_count[bin]++;
-		}
+		selected.push_back(scans[s]);
 	}
+	int scanCount = selected.size();
 
-	Scan *avgScan = new Scan(this, scannum, mslevel, rt / scanCount, 0, polarity);
+	//peaks closer than 1/sd merge, like the 1/sd wide bins used before
+	MassCutoff massCutoff;
+	massCutoff.setMassCutoffAndType(500.0 / sd, "mDa");
+	ScanAverager averager(&massCutoff, ScanAverager::PeakCount);
 
-	map<float, double>::iterator itr;
-	for (itr = mz_intensity_map.begin(); itr != mz_intensity_map.end(); ++itr)
-	{
-		float bin = (*itr).first;
-		double totalIntensity = (*itr).second;
-		double avgMz = mz_bin_map[bin] / totalIntensity;
-		avgScan->mz.push_back((float)avgMz);
-		avgScan->intensity.push_back((float)totalIntensity / mz_count[bin]);
-	}
+	Scan *avgScan = new Scan(this, scannum, mslevel, rt / scanCount, 0, polarity);
+	averager.average(selected, avgScan->mz, avgScan->intensity);
 	//cout << "getAverageScan() from:" << from << " to:" << to << " scanCount:" << scanCount << "scans. mzs=" << avgScan->nobs() << endl;
 	return avgScan;
 }
@@ -24,6 +24,8 @@
 #include "Matrix.h"
 #include "EIC.h"
 #include "Scan.h"
+#include "ms2Index.h"
+#include "traceCache.h"
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
@@ -376,6 +378,23 @@ class mzSample
     */
     void loadSample(const char *filename);
 
+    /**
+    * @brief Read the scans written to an mzXML or mzML file since the last call
+    * @details Used instead of loadSample() while the file is still being
+    * acquired. Only complete top level scan elements are read, a scan that is
+    * partly written is read by a later call. The first call also reads
+    * instrument settings and injection time and names the sample. mzML
+    * chromatograms are not read.
+    * @param filename Sample file name
+    * @return Number of scans appended, -1 if the file can't be read
+    */
+    int appendScans(const char *filename);
+
+    /**
+    * @brief True once appendScans() has read the end of the run
+    */
+    bool isAcquisitionComplete() const { return _acquisitionComplete; }
+
     /**
     * @brief Parse mzData file format
     * @param char* mzData file name
@@ -479,15 +498,29 @@ class mzSample
     * @brief Find correlation between two EICs
     * @param mz1 m/z for first EIC
     * @param mz2 m/z for second EIC
-    * @param ppm ppm window
+    * @param massCutoff mass window around each m/z
     * @param rt1 Retention time for first EIC
     * @param rt2 Retention time for second EIC
     * @param eicType Type of EIC (max or sum)
     * @param filterline selected filterline
     * @return correlation
+    * @details traces are kept in traceCache, so correlating one m/z against
+    * many others extracts it only once
     */
     float correlation(float mz1, float mz2, MassCutoff *massCutoff, float rt1, float rt2, int eicType, string filterline);
 
+    /**
+    * @brief Find correlations between the EICs of every pair of m/z values
+    * @param mzs m/z values, e.g. a parent with its adducts and isotopes
+    * @param massCutoff mass window around each m/z
+    * @param rt1 start of the retention time window
+    * @param rt2 end of the retention time window
+    * @param eicType Type of EIC (max or sum)
+    * @param filterline selected filterline
+    * @return symmetric matrix, element [i][j] equals correlation(mzs[i], mzs[j], ...)
+    */
+    vector<vector<float> > correlations(const vector<float> &mzs, MassCutoff *massCutoff, float rt1, float rt2, int eicType, string filterline);
+
     /**
     * @brief Get normalization constant
     * @return Normalization constant
@@ -538,6 +571,18 @@ class mzSample
     * @see EIC
     */
     EIC *getEIC(float mzmin, float mzmax, float rtmin, float rtmax, int mslevel, int eicType, string filterline);
+    /**
+    * @brief Get EICs for many m/z and rt windows in a single pass over the scans
+    * @details Each scan's sorted m/z array is walked once across all windows.
+    * Every returned EIC is the same as getEIC would return for its slice
+    * @param slices m/z and rt windows, in any order
+    * @param mslevel MS Level. MS Level is 1 for MS data and 2 for MS/MS data
+    * @param eicType Type of EIC (max or sum)
+    * @param filterline selected filterline
+    * @return one EIC per slice, in the order of slices. Caller owns them
+    * @see EIC::makeEICSlices
+    */
+    vector<EIC *> getEICs(const vector<mzSlice> &slices, int mslevel, int eicType, string filterline);
 
     /**
     * @brief Get EIC based on srmId
@@ -602,6 +647,27 @@ class mzSample
                           */
     void addScan(Scan *s);
 
+    /**
+     * @brief fragmentation events of a precursor m/z and rt window
+     * @details served from an index sorted by precursor m/z, see MS2Index
+     * @return scans with msLevel > 1 in acquisition order
+     */
+    vector<Scan *> getFragmentScans(float mzmin, float mzmax, float rtmin, float rtmax)
+    {
+        return ms2Index.find(scans, mzmin, mzmax, rtmin, rtmax);
+    }
+
+    /**
+     * @brief intensity traces of many windows, extracted in one pass
+     * @details served from traceCache, only traces not cached yet are pulled
+     * from the scans; traces are normalized like getEIC()
+     * @return traces in the order of windows
+     */
+    vector<TraceCache::Trace> getTraces(const vector<mzSlice> &windows, int mslevel, int eicType, string filterline)
+    {
+        return traceCache.traces(this, windows, mslevel, eicType, filterline);
+    }
+
     /**
                           * [get Polarity]
                           * @method getPolarity
@@ -801,6 +867,8 @@ class mzSample
     vector<float> getIntensityDistribution(int mslevel);
 
     deque<Scan *> scans;
+    MS2Index ms2Index;
+    TraceCache traceCache;
     string sampleName;
     string fileName;
     bool isSelected;
@@ -844,6 +912,10 @@ class mzSample
     vector<double> polynomialAlignmentTransformation; //parameters for polynomial transform
 
   private:
+    //bytes of the file read by appendScans()
+    unsigned long _appendOffset;
+    bool _acquisitionComplete;
+
     void sampleNaming(const char *filename);
     void checkSampleBlank(const char *filename);
 
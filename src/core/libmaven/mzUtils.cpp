@@ -1,4 +1,7 @@
 #include "mzUtils.h"
+#include "scratchBuffer.h"
+
+#include <limits>
 
 
 /**
@@ -91,10 +94,26 @@ namespace mzUtils {
 
     void smoothAverage(float *y, float* s, int smoothWindowLen, int ly) {
         if (smoothWindowLen == 0 ) return;
-        float* x = new float[smoothWindowLen];
+        ScratchBuffer x(smoothWindowLen);
         for(int i=0; i< smoothWindowLen; i++ ) x[i] = 1.0/smoothWindowLen;
-        conv(smoothWindowLen,-smoothWindowLen/2,x,ly, 0,y,ly,0,s);
-        delete[] x;
+        convolve(y, ly, x.data(), smoothWindowLen, smoothWindowLen/2, s);
+    }
+
+    void convolve(const float* y, int ny, const float* kernel, int nk, int center, float* z) {
+        for (int i = 0; i < ny; i++) z[i] = 0;
+
+        //one pass over the output per tap, the inner loop is a plain
+        //multiply-add over contiguous arrays. Every z[i] still adds its terms
+        //in kernel order, so results match conv()
+        for (int k = 0; k < nk; k++) {
+            int shift = center - k;
+            int ifirst = max(0, -shift);
+            int iend = min(ny, ny - shift);
+            float w = kernel[k];
+            const float* src = y + shift;
+            for (int i = ifirst; i < iend; i++)
+                z[i] += w * src[i];
+        }
     }
 
     void conv (int lx, int ifx, float *x, int ly, int ify, float *y, int lz, int ifz, float *z) /*****************************************************************************
@@ -150,6 +169,40 @@ namespace mzUtils {
         }
     }
 
+    const vector<float>& gaussianKernel(int nsr)
+    {
+        //kernels are built once per thread and width, the width is capped
+        thread_local map<int, vector<float> > kernels;
+        if (nsr > 100) nsr = 100;
+
+        vector<float>& s = kernels[nsr];
+        if (!s.empty()) return s;
+
+        float fcut = 1.0/nsr;
+
+        /* set span of 3, at width of 1.5*exp(-PI*1.5**2)=1/1174 */
+        int n=(int) (3.0/fcut+0.5);
+        n=2*n/2+1;		/* make it odd for symmetry */
+
+        /* mean is the index of the zero in the smoothing wavelet */
+        int mean=n/2;
+
+        /* s(n) is the smoothing gaussian */
+        s.resize(n);
+        for (int is=1; is<=n; is++) {
+            float r=is-mean-1;
+            r= -r*r*fcut*fcut*3.141;
+            s[is-1]=exp(r);
+        }
+
+        /* normalize to unit area, will preserve DC frequency at full
+           amplitude. Frequency at fcut will be half amplitude */
+        float sum=0.0;
+        for (int is=0; is<n; is++) sum +=s[is];
+        for (int is=0; is<n; is++) s[is] /=sum;
+        return s;
+    }
+
     void gaussian1d_smoothing (int ns, int nsr, float *data)
     {
         //Subroutine to apply a one-dimensional gaussian smoothing
@@ -164,75 +217,32 @@ data		1-D array[ns] of data to smooth
 Output:
 data		1-D array[ns] of smoothed data
          ******************************************************************************/
-        int is;				/* loop counter */
-        float sum=0.0;
-        float fcut;
-        float r;
-        float fcutr=1.0/nsr;
-        int n=0;
-        int mean=0;
-        float fcutl=0;
-        float s[1000];		/* smoothing filter array */
-        float *temp;			/* temporary array */
-
-        /* save input fcut */
-        fcut=fcutr;
 
         /* don't smooth if nsr equal to zero */
         if (nsr==0 || ns<=1) return;
 
-        /* if halfwidth more than 100 samples, truncate */
-        if (nsr>100) fcut=1.0/100;
-
-        /* allocate space */
-        temp=new float[ns];
-
-
-        /* initialize smoothing function if not the same as the last one used */
-        if (fcut != fcutl) {
-            fcutl=fcut;
-
-            /* set span of 3, at width of 1.5*exp(-PI*1.5**2)=1/1174 */
-            n=(int) (3.0/fcut+0.5);
-            n=2*n/2+1;		/* make it odd for symmetry */
-
-            /* mean is the index of the zero in the smoothing wavelet */
-            mean=n/2;
-
-            /* s(n) is the smoothing gaussian */
-            for (is=1; is<=n; is++) {
-                r=is-mean-1;
-                r= -r*r*fcut*fcut*3.141;
-                s[is-1]=exp(r);
-            }
-
-            /* normalize to unit area, will preserve DC frequency at full
-               amplitude. Frequency at fcut will be half amplitude */
-            for (is=0; is<n; is++) sum +=s[is];
-            for (is=0; is<n; is++) s[is] /=sum;
-            //cerr << "new gaussian " << nsr << endl;
-        }
+        float fcutr=1.0/nsr;
 
         /* convolve by gaussian into buffer */
         if (1.01/fcutr>(float)ns) {
 
             /* replace drastic smoothing by averaging */
-            sum=0.0;
-            for (is=0; is<ns; is++) sum +=data[is];
+            float sum=0.0;
+            for (int is=0; is<ns; is++) sum +=data[is];
             sum /=ns;
-            for (is=0; is<ns; is++) data[is]=sum;
+            for (int is=0; is<ns; is++) data[is]=sum;
 
         } else {
 
             /* convolve with gaussian */
-            conv (n, -mean, s, ns, -mean, data, ns, -mean, temp);
+            const vector<float>& s = gaussianKernel(nsr);
+            int n = s.size();
+            ScratchBuffer temp(ns);
+            convolve(data, ns, s.data(), n, n/2, temp.data());
 
             /* copy filtered data back to output array */
-            for (is=0; is<ns; is++) data[is]=temp[is];
+            for (int is=0; is<ns; is++) data[is]=temp[is];
         }
-
-        /* free allocated space */
-        delete[] temp;
     }
 
     float median(vector <float> y) {
@@ -539,58 +549,172 @@ Series:  Prentice-Hall Series in Automatic Computation
         return (sumxy -( sumx*sumy)/n) / sqrt((x2-(sumx*sumx)/n)*(y2-(sumy*sumy)/n));
     }
 
+    vector<vector<float> > correlationMatrix(const vector<const vector<float>*>& traces) {
+        int k = traces.size();
+        vector<vector<float> > matrix(k, vector<float>(k, 0));
+
+        //center and scale every trace once, each pair is then a dot product
+        vector<vector<float> > z(k);
+        vector<bool> flat(k, false);
+        for (int i = 0; i < k; i++) {
+            const vector<float>& x = *traces[i];
+            int n = x.size();
+            double sum = 0;
+            for (int t = 0; t < n; t++) sum += x[t];
+            float mean = n > 0 ? sum / n : 0;
+
+            z[i].resize(n);
+            double ss = 0;
+            for (int t = 0; t < n; t++) {
+                z[i][t] = x[t] - mean;
+                ss += z[i][t] * z[i][t];
+            }
+            flat[i] = (ss == 0);
+            if (flat[i]) continue;
+            float scale = 1.0 / sqrt(ss);
+            for (int t = 0; t < n; t++) z[i][t] *= scale;
+        }
+
+        for (int i = 0; i < k; i++) {
+            if (!flat[i]) matrix[i][i] = 1;
+            for (int j = i + 1; j < k; j++) {
+                float r = 0;
+                if (z[i].size() != z[j].size()) {
+                    //traces of different rt windows, compare the common part
+                    unsigned int n = min(traces[i]->size(), traces[j]->size());
+                    vector<float> a(traces[i]->begin(), traces[i]->begin() + n);
+                    vector<float> b(traces[j]->begin(), traces[j]->begin() + n);
+                    r = correlation(a, b);
+                } else if (!flat[i] && !flat[j]) {
+                    const float* a = z[i].data();
+                    const float* b = z[j].data();
+                    int n = z[i].size();
+                    double dot = 0;
+                    for (int t = 0; t < n; t++) dot += a[t] * b[t];
+                    r = dot;
+                }
+                matrix[i][j] = matrix[j][i] = r;
+            }
+        }
+        return matrix;
+    }
+
 
     /*peak fitting function*/
     void gaussFit(const vector<float>&ycoord, float* sigma, float* R2) {
+        gaussFit(ycoord.data(), ycoord.size(), sigma, R2);
+    }
 
-        float s = 20;
-        float min_s = 0;
-        float minR = 1e99;
+    namespace {
+        //sum of squared residuals of a unit gaussian of width s centered at
+        //x=0, where yobs[i] is observed at x=xinit+i
+        float gaussResidual(const float* yobs, int ysize, int xinit, float s) {
+            float a = -0.5f/(s*s);
+            float Rsqr=0;
+            for(int i=0; i < ysize; i++ )  {
+                float x = xinit+i;
+                Rsqr += POW2(expf(a*x*x) - yobs[i]);
+            }
+            return Rsqr;
+        }
+
+        //width minimizing the residual, or 0 if the data has no gaussian shape.
+        //starts from a log-parabola fit and refines u=1/s^2 by Newton steps
+        float gaussFitWidth(const float* yobs, int ysize, int xinit) {
+
+            //ln(y) = -u/2 x^2, weighted by y^2 to damp noise in the tails
+            float num = 0, den = 0;
+            for(int i=0; i < ysize; i++ ) {
+                float y = yobs[i];
+                float x2 = POW2(float(xinit+i));
+                float w = y > 0 ? y*y*x2 : 0;
+                num += w*logf(y > 0 ? y : 1);
+                den += w*x2;
+            }
+            if (den == 0 || num >= 0) return 0;
+            float u = -2*num/den;
+
+            for (int step = 0; step < 4; step++) {
+                float d1 = 0, d2 = 0;
+                for(int i=0; i < ysize; i++ ) {
+                    float h = -0.5f*POW2(float(xinit+i));
+                    float g = expf(h*u);
+                    float r = g - yobs[i];
+                    d1 += r*h*g;
+                    d2 += h*h*g*(g + r);
+                }
+                if (d2 <= 0) break;
+                float next = u - d1/d2;
+                if (next <= 0) next = u/2;
+                bool done = fabs(next - u) < 1e-3f*u;
+                u = next;
+                if (done) break;
+            }
+            return 1/sqrt(u);
+        }
+    }
+
+    void gaussFit(const float* ycoord, int ysize, float* sigma, float* R2) {
 
         //find best fit
-        if (ycoord.size()<3) return;
-        vector<float>yobs=ycoord;
-        int ysize=yobs.size();
+        if (ysize<3) return;
         int midpoint  = int(ysize/2);
         //find maximum point ( assuming it somewhere around midpoint of the yobs);
-        float ymax = max(max(yobs[midpoint], yobs[midpoint-1]),yobs[midpoint+1]);
-        float ymin = min( yobs[0], yobs[ysize-1]);
+        float ymax = max(max(ycoord[midpoint], ycoord[midpoint-1]),ycoord[midpoint+1]);
+        float ymin = min( ycoord[0], ycoord[ysize-1]);
 
-        //initialize x vector, values centered around 0, forxample  -2, -1, 0, 1, 2
+        //x values are centered around 0, forxample  -2, -1, 0, 1, 2
         int xinit = int(ysize/2)*-1;
-        vector<float>x(ysize,0);
+        ScratchBuffer yobs(ysize);
         int greaterZeroCount=0;
 
         for(int i=0; i<ysize; i++ ) {
-            x[i] = xinit+i;
-            if ( yobs[i] > ymin ) greaterZeroCount++;
-            yobs[i] = (yobs[i]-ymin)/(ymax-ymin);
+            if ( ycoord[i] > ymin ) greaterZeroCount++;
+            yobs[i] = (ycoord[i]-ymin)/(ymax-ymin);
             if(yobs[i]<0) yobs[i]=0;
         }
 
-        /*
-           cerr << "fitting yobs:" << endl; for(int i=0; i < ysize; i++ )
-           cerr << setprecision(2) << yobs[i] << ", "; cerr << endl;
-           */
+        if (greaterZeroCount <= 3 ) return;
 
-        bool converged = false;
-        int ittr = 0;
+        //a flat apex leaves no finite residual, no width can be accepted
+        if (ymax == ymin) {
+            *sigma = 0;
+            *R2 = numeric_limits<float>::infinity();
+            return;
+        }
 
-        if (greaterZeroCount <= 3 ) return;
-        while (!converged ) {
-            if ( ittr++ > 20 ) break;
-            float Rsqr=0;
-            for(int i=0; i < ysize; i++ )  { Rsqr += POW2(exp(-0.5*POW2(x[i]/s)) - yobs[i]); }
-            //       cerr << "\t\ts=" << s << " Rsqr=" << Rsqr << endl;
-            if ( Rsqr < minR || ittr == 0 ) { minR = Rsqr; min_s = s; }
-            else if ( Rsqr > minR ) break;
-            else if ( Rsqr - minR == 0 ) break;
-            s /= 1.25;
+        //sigma is reported on the grid 20, 20/1.25, 20/1.25^2, ... The first
+        //grid point where the residual stops decreasing is the answer, which
+        //is one of the two neighbours of the best continuous width.
+        const int gridSize = 21;
+        float grid[gridSize];
+        float s = 20;
+        for (int k = 0; k < gridSize; k++) { grid[k] = s; s /= 1.25; }
+
+        float best = gaussFitWidth(yobs.data(), ysize, xinit);
+        int k = 0;
+        if (best > 0) {
+            while (k < gridSize - 1 && grid[k + 1] >= best) k++;
+        }
+
+        //the residual is unimodal in sigma for peak shaped data; walking to
+        //the first local minimum from there keeps results exact otherwise
+        float Rk = gaussResidual(yobs.data(), ysize, xinit, grid[k]);
+        while (k > 0) {
+            float Rup = gaussResidual(yobs.data(), ysize, xinit, grid[k - 1]);
+            if (Rup > Rk) break;
+            k--;
+            Rk = Rup;
+        }
+        while (k < gridSize - 1) {
+            float Rdown = gaussResidual(yobs.data(), ysize, xinit, grid[k + 1]);
+            if (!(Rdown < Rk)) break;
+            k++;
+            Rk = Rdown;
         }
 
-        *sigma = min_s;
-        *R2 = minR/(ysize*ysize);	//corrected R2
-        //cerr << "fit() s=" << *sigma << " R2=" << *R2 << endl;
+        *sigma = grid[k];
+        *R2 = Rk/(ysize*ysize);	//corrected R2
     }
 
 
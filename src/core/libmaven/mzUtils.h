@@ -125,6 +125,14 @@ namespace mzUtils {
      */
     void gaussian1d_smoothing(int ns, int nsr, float* data);
 
+    /**
+     * [gaussianKernel normalized kernel used by gaussian1d_smoothing]
+     * @method gaussianKernel
+     * @param  nsr                  [width in samples, capped at 100]
+     * @return                      [odd length kernel, cached per thread]
+     */
+    const vector<float>& gaussianKernel(int nsr);
+
     /**
      * [smoothAverage ]
      * @method smoothAverage
@@ -151,6 +159,19 @@ namespace mzUtils {
     void conv(int lx, int ifx, float* x, int ly, int ify, float* y, int lz, int ifz,
             float* z);  // convolutio
 
+    /**
+     * [convolve same-size convolution with zero padding, vectorizable
+     *  version of conv(nk, -center, kernel, ny, 0, y, ny, 0, z)]
+     * @method convolve
+     * @param  y      [input, ny values]
+     * @param  ny     []
+     * @param  kernel [nk taps]
+     * @param  nk     []
+     * @param  center [index of the kernel tap at offset 0]
+     * @param  z      [output, ny values, must not overlap y]
+     */
+    void convolve(const float* y, int ny, const float* kernel, int nk, int center, float* z);
+
     /*statistical functions*/
     /**
      * [ttest ]
@@ -216,6 +237,15 @@ namespace mzUtils {
      */
     float correlation(const vector<float>& a, const vector<float>& b);
 
+    /**
+     * [correlationMatrix pearson correlation of every pair of traces]
+     * @method correlationMatrix
+     * @param  traces      [intensity traces, usually of one rt window]
+     * @return             [symmetric matrix, same values as correlation();
+     *                     the diagonal is 1 except for constant traces]
+     */
+    vector<vector<float> > correlationMatrix(const vector<const vector<float>*>& traces);
+
     /**
      * [gaussFit ]
      * @method gaussFit
@@ -225,6 +255,16 @@ namespace mzUtils {
      */
     void gaussFit(const vector<float>& yobs, float* sigmal, float* R2);
 
+    /**
+     * [gaussFit same as above, on ysize values starting at yobs]
+     * @method gaussFit
+     * @param  yobs     []
+     * @param  ysize    []
+     * @param  sigmal   [width on the grid 20/1.25^k, k=0..20]
+     * @param  R2       [squared residual divided by ysize^2]
+     */
+    void gaussFit(const float* yobs, int ysize, float* sigmal, float* R2);
+
     /**
      * [factorial ]
      * @method factorial
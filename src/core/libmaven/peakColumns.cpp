@@ -0,0 +1,20 @@
+#include "peakColumns.h"
+
+#include "Peak.h"
+
+void PeakColumns::assign(const vector<Peak> &peaks)
+{
+    size_t n = peaks.size();
+    rt.resize(n);
+    rtmin.resize(n);
+    rtmax.resize(n);
+    peakIntensity.resize(n);
+
+    for (size_t i = 0; i < n; i++) {
+        const Peak &peak = peaks[i];
+        rt[i] = peak.rt;
+        rtmin[i] = peak.rtmin;
+        rtmax[i] = peak.rtmax;
+        peakIntensity[i] = peak.peakIntensity;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef PEAKCOLUMNS_H
+#define PEAKCOLUMNS_H
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+class Peak;
+
+/**
+ * @class PeakColumns
+ * @ingroup libmaven
+ * @brief The few peak fields read when grouping peaks, one array per field
+ * @details A Peak carries well over fifty fields, so a pass that only looks
+ * at retention times and intensities drags all of them through the cache. The
+ * columns hold copies of these hot fields in the order of the peaks they were
+ * taken from, which lets such passes run over plain float arrays. Peaks stay
+ * the owners of the values, columns have to be assigned again after peaks are
+ * changed.
+ */
+class PeakColumns
+{
+  public:
+	vector<float> rt;
+	vector<float> rtmin;
+	vector<float> rtmax;
+	vector<float> peakIntensity;
+
+	/**
+	 * @brief copy the hot fields of peaks, capacity is kept between calls
+	 */
+	void assign(const vector<Peak> &peaks);
+
+	size_t size() const { return rt.size(); }
+};
+
+#endif
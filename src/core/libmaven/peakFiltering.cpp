@@ -3,7 +3,15 @@
 PeakFiltering::PeakFiltering(MavenParameters *mavenParameters, bool isIsotope)
 {
     _isIsotope = isIsotope; 
-    _mavenParameters = mavenParameters;
+    _minPeakQuality = mavenParameters->minPeakQuality;
+    _minIsotopicPeakQuality = mavenParameters->minIsotopicPeakQuality;
+}
+
+PeakFiltering::PeakFiltering(double minPeakQuality, double minIsotopicPeakQuality, bool isIsotope)
+{
+    _isIsotope = isIsotope;
+    _minPeakQuality = minPeakQuality;
+    _minIsotopicPeakQuality = minIsotopicPeakQuality;
 }
 
 void PeakFiltering::filter(vector<EIC*> &eics)
@@ -21,24 +29,19 @@ void PeakFiltering::filter(EIC *eic)
     filter(eic->peaks);
 }
 
-// TODO: Erasing takes linear time. We can make copy
-// of filtered peaks and return these to caller method
-// or should do something else.
 void PeakFiltering::filter(vector<Peak> &peaks)
 {
-
-    unsigned int i = 0;
-    while (i < peaks.size())
+    //kept peaks are moved up in a single pass, keeping their order
+    size_t kept = 0;
+    for (size_t i = 0; i < peaks.size(); i++)
     {
         if (filter(peaks[i]))
-        {
-            peaks.erase(peaks.begin() + i);
-        }
-        else
-        {
-            ++i;
-        }
+            continue;
+        if (kept != i)
+            peaks[kept] = peaks[i];
+        kept++;
     }
+    peaks.erase(peaks.begin() + kept, peaks.end());
 }
 
 bool PeakFiltering::filter(Peak &peak)
@@ -46,14 +49,14 @@ bool PeakFiltering::filter(Peak &peak)
 
     if (_isIsotope)
     {
-        if (_mavenParameters->minIsotopicPeakQuality > peak.quality)
+        if (_minIsotopicPeakQuality > peak.quality)
         {
             return true;
         }
     }
     else
     {
-        if (_mavenParameters->minPeakQuality > peak.quality)
+        if (_minPeakQuality > peak.quality)
         {
             return true;
         }
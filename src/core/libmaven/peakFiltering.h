@@ -18,6 +18,12 @@ class PeakFiltering
 	 * @see Peak
 	 */
 	PeakFiltering(MavenParameters *mavenParameters, bool isIsotope);
+	/**
+	 * @brief Constructor with the quality cutoffs given directly
+	 * @param minPeakQuality minimum quality of parent peaks
+	 * @param minIsotopicPeakQuality minimum quality of isotopic peaks
+	 */
+	PeakFiltering(double minPeakQuality, double minIsotopicPeakQuality, bool isIsotope);
 
 	/**
 	 * @brief Filter peaks in vector of EICs
@@ -49,7 +55,8 @@ class PeakFiltering
 
   private:
 	bool _isIsotope;
-	MavenParameters *_mavenParameters;
+	double _minPeakQuality;
+	double _minIsotopicPeakQuality;
 };
 
 #endif //PEAKFILTERING_H
\ No newline at end of file
@@ -0,0 +1,538 @@
+#include "peakTableFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "Compound.h"
+#include "mzSample.h"
+
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'M', 'A', 'V', 'E', 'N', 'P', 'T', 'B'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+enum Codec { RAW = 0, DEFLATE = 1 };
+
+// columns, in file order; append new fields at the end and bump VERSION
+int PeakGroup::* const groupIntFields[] = {
+    &PeakGroup::groupId, &PeakGroup::metaGroupId, &PeakGroup::clusterId,
+    &PeakGroup::totalSampleCount, &PeakGroup::isotopeC13count,
+    &PeakGroup::sampleCount, &PeakGroup::goodPeakCount
+};
+
+unsigned int PeakGroup::* const groupUIntFields[] = {
+    &PeakGroup::blankSampleCount, &PeakGroup::maxNoNoiseObs, &PeakGroup::maxPeakOverlap
+};
+
+float PeakGroup::* const groupFloatFields[] = {
+    &PeakGroup::maxIntensity, &PeakGroup::maxAreaTopIntensity, &PeakGroup::maxAreaIntensity,
+    &PeakGroup::maxHeightIntensity, &PeakGroup::maxAreaNotCorrectedIntensity,
+    &PeakGroup::maxAreaTopNotCorrectedIntensity, &PeakGroup::currentIntensity,
+    &PeakGroup::meanRt, &PeakGroup::meanMz, &PeakGroup::expectedMz,
+    &PeakGroup::expectedAbundance, &PeakGroup::minRt, &PeakGroup::maxRt,
+    &PeakGroup::minMz, &PeakGroup::maxMz, &PeakGroup::blankMax, &PeakGroup::blankMean,
+    &PeakGroup::sampleMean, &PeakGroup::sampleMax, &PeakGroup::maxQuality,
+    &PeakGroup::maxPeakFracionalArea, &PeakGroup::maxSignalBaseRatio,
+    &PeakGroup::maxSignalBaselineRatio, &PeakGroup::expectedRtDiff, &PeakGroup::groupRank,
+    &PeakGroup::changeFoldRatio, &PeakGroup::changePValue
+};
+
+double PeakGroup::* const groupDoubleFields[] = {
+    &PeakGroup::minIntensity, &PeakGroup::minQuality
+};
+
+unsigned int Peak::* const peakUIntFields[] = {
+    &Peak::pos, &Peak::minpos, &Peak::maxpos, &Peak::splineminpos, &Peak::splinemaxpos,
+    &Peak::scan, &Peak::minscan, &Peak::maxscan, &Peak::width, &Peak::noNoiseObs
+};
+
+float Peak::* const peakFloatFields[] = {
+    &Peak::rt, &Peak::rtmin, &Peak::rtmax, &Peak::mzmin, &Peak::mzmax,
+    &Peak::peakArea, &Peak::peakSplineArea, &Peak::peakAreaCorrected, &Peak::peakAreaTop,
+    &Peak::peakAreaTopCorrected, &Peak::peakAreaFractional, &Peak::peakRank,
+    &Peak::peakIntensity, &Peak::peakBaseLineLevel, &Peak::peakMz, &Peak::medianMz,
+    &Peak::baseMz, &Peak::quality, &Peak::gaussFitSigma, &Peak::gaussFitR2,
+    &Peak::noNoiseFraction, &Peak::symmetry, &Peak::signalBaselineRatio,
+    &Peak::signalBaselineDifference, &Peak::groupOverlap, &Peak::groupOverlapFrac
+};
+
+class ColumnWriter
+{
+  public:
+    ColumnWriter(ostream &out, bool compress) : _out(out), _compress(compress) {}
+
+    template <typename T>
+    void write(const vector<T> &values)
+    {
+        writeBlock(values.empty() ? NULL : (const char *)&values[0], values.size() * sizeof(T));
+    }
+
+    /**
+     * @brief store one field of every object, converted to S
+     */
+    template <typename S, typename T, typename O>
+    void writeField(const vector<O *> &objects, T O::*field)
+    {
+        vector<S> values(objects.size());
+        for (unsigned int i = 0; i < objects.size(); i++)
+            values[i] = (S)(objects[i]->*field);
+        write(values);
+    }
+
+    void writeStrings(const vector<string> &strings)
+    {
+        string buffer;
+        for (unsigned int i = 0; i < strings.size(); i++) {
+            uint32_t length = strings[i].size();
+            buffer.append((const char *)&length, sizeof(length));
+            buffer.append(strings[i]);
+        }
+        writeBlock(buffer.data(), buffer.size());
+    }
+
+    void writeBlock(const char *data, uint64_t size)
+    {
+        uint8_t codec = RAW;
+        const char *stored = data;
+        uint64_t storedSize = size;
+
+#ifdef ZLIB
+        vector<Bytef> deflated;
+        if (_compress && size > 0) {
+            uLongf deflatedSize = compressBound(size);
+            deflated.resize(deflatedSize);
+            if (compress2(&deflated[0], &deflatedSize, (const Bytef *)data, size, Z_BEST_SPEED) == Z_OK
+                && deflatedSize < size) {
+                codec = DEFLATE;
+                stored = (const char *)&deflated[0];
+                storedSize = deflatedSize;
+            }
+        }
+#endif
+
+        _out.write((const char *)&codec, sizeof(codec));
+        _out.write((const char *)&size, sizeof(size));
+        _out.write((const char *)&storedSize, sizeof(storedSize));
+        if (storedSize > 0)
+            _out.write(stored, storedSize);
+    }
+
+  private:
+    ostream &_out;
+    bool _compress;
+};
+
+/**
+ * Reads blocks in the order they were written. The first failure sticks,
+ * later reads do nothing, so callers only check ok() where it matters.
+ */
+class ColumnReader
+{
+  public:
+    ColumnReader(istream &in) : _in(in), _ok(true) {}
+
+    bool ok() const { return _ok; }
+    const string &error() const { return _error; }
+
+    template <typename T>
+    bool read(vector<T> &values, uint64_t count)
+    {
+        string block;
+        if (!readBlock(block))
+            return false;
+        if (block.size() != count * sizeof(T))
+            return fail("column size does not match the number of rows");
+        values.resize(count);
+        if (count > 0)
+            memcpy(&values[0], block.data(), block.size());
+        return true;
+    }
+
+    template <typename S, typename T, typename O>
+    void readField(const vector<O *> &objects, T O::*field)
+    {
+        vector<S> values;
+        if (!read(values, objects.size()))
+            return;
+        for (unsigned int i = 0; i < objects.size(); i++)
+            objects[i]->*field = (T)values[i];
+    }
+
+    bool readStrings(vector<string> &strings, uint64_t count)
+    {
+        string block;
+        if (!readBlock(block))
+            return false;
+        strings.resize(count);
+        size_t offset = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            uint32_t length;
+            if (offset + sizeof(length) > block.size())
+                return fail("truncated string column");
+            memcpy(&length, block.data() + offset, sizeof(length));
+            offset += sizeof(length);
+            if (offset + length > block.size())
+                return fail("truncated string column");
+            strings[i].assign(block, offset, length);
+            offset += length;
+        }
+        return true;
+    }
+
+    bool readBlock(string &block)
+    {
+        if (!_ok)
+            return false;
+
+        uint8_t codec;
+        uint64_t size, storedSize;
+        _in.read((char *)&codec, sizeof(codec));
+        _in.read((char *)&size, sizeof(size));
+        _in.read((char *)&storedSize, sizeof(storedSize));
+        if (!_in)
+            return fail("unexpected end of file");
+
+        string stored(storedSize, '\0');
+        if (storedSize > 0)
+            _in.read(&stored[0], storedSize);
+        if (!_in)
+            return fail("unexpected end of file");
+
+        if (codec == RAW) {
+            if (storedSize != size)
+                return fail("corrupt column");
+            block.swap(stored);
+            return true;
+        }
+
+#ifdef ZLIB
+        if (codec == DEFLATE) {
+            block.resize(size);
+            uLongf inflatedSize = size;
+            if (size == 0
+                || uncompress((Bytef *)&block[0], &inflatedSize, (const Bytef *)stored.data(), storedSize) != Z_OK
+                || inflatedSize != size)
+                return fail("corrupt compressed column");
+            return true;
+        }
+#endif
+        return fail("unsupported column compression");
+    }
+
+  private:
+    istream &_in;
+    bool _ok;
+    string _error;
+
+    bool fail(const string &message)
+    {
+        if (_ok) {
+            _ok = false;
+            _error = message;
+        }
+        return false;
+    }
+};
+
+/**
+ * Creates the tree of a group in place from pre-order child and peak counts
+ * and returns the index of the next group.
+ */
+unsigned int buildGroup(PeakGroup &group, unsigned int index,
+                        const vector<uint32_t> &childCount, const vector<uint32_t> &peakCount,
+                        vector<PeakGroup *> &flat, vector<Peak *> &peaks)
+{
+    flat[index] = &group;
+    group.peaks.resize(peakCount[index]);
+    for (unsigned int i = 0; i < group.peaks.size(); i++)
+        peaks.push_back(&group.peaks[i]);
+
+    group.children.resize(childCount[index]);
+    unsigned int next = index + 1;
+    for (unsigned int i = 0; i < group.children.size(); i++) {
+        if (next >= flat.size())
+            return flat.size() + 1;
+        group.children[i].parent = &group;
+        next = buildGroup(group.children[i], next, childCount, peakCount, flat, peaks);
+    }
+    return next;
+}
+
+} // namespace
+
+PeakTableFile::PeakTableFile()
+{
+    compress = true;
+}
+
+void PeakTableFile::flatten(PeakGroup *group, vector<PeakGroup *> &flat)
+{
+    flat.push_back(group);
+    for (unsigned int i = 0; i < group->children.size(); i++)
+        flatten(&group->children[i], flat);
+}
+
+bool PeakTableFile::isPeakTableFile(string filename)
+{
+    ifstream in(filename.c_str(), ios::binary);
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(magic));
+    return in && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool PeakTableFile::write(string filename, const vector<PeakGroup *> &groups,
+                          const vector<mzSample *> &samples)
+{
+    ofstream out(filename.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        errorMessage = "could not open " + filename + " for writing";
+        return false;
+    }
+
+    write(out, groups, samples);
+    out.close();
+    if (!out) {
+        errorMessage = "could not write " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool PeakTableFile::write(ostream &out, const vector<PeakGroup *> &groups,
+                          const vector<mzSample *> &samples)
+{
+    vector<PeakGroup *> flat;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        flatten(groups[i], flat);
+
+    vector<Peak *> peaks;
+    map<mzSample *, int> sampleIndex;
+    vector<string> sampleNames(samples.size());
+    for (unsigned int i = 0; i < samples.size(); i++) {
+        sampleIndex[samples[i]] = i;
+        sampleNames[i] = samples[i]->sampleName;
+    }
+
+    vector<uint32_t> childCount(flat.size());
+    vector<uint32_t> peakCount(flat.size());
+    vector<uint32_t> usedCount(flat.size());
+    vector<int32_t> usedSamples;
+    vector<int32_t> peakSample;
+    vector<string> strings;
+    strings.reserve(flat.size() * 5);
+
+    for (unsigned int i = 0; i < flat.size(); i++) {
+        PeakGroup *g = flat[i];
+        childCount[i] = g->children.size();
+        peakCount[i] = g->peaks.size();
+
+        for (unsigned int j = 0; j < g->peaks.size(); j++) {
+            peaks.push_back(&g->peaks[j]);
+            map<mzSample *, int>::iterator s = sampleIndex.find(g->peaks[j].getSample());
+            peakSample.push_back(s != sampleIndex.end() ? s->second : -1);
+        }
+
+        usedCount[i] = 0;
+        for (unsigned int j = 0; j < g->samples.size(); j++) {
+            map<mzSample *, int>::iterator s = sampleIndex.find(g->samples[j]);
+            if (s == sampleIndex.end())
+                continue;
+            usedSamples.push_back(s->second);
+            usedCount[i]++;
+        }
+
+        strings.push_back(g->tagString);
+        strings.push_back(g->srmId);
+        strings.push_back(g->compound ? g->compound->id : "");
+        strings.push_back(g->compound ? g->compound->name : "");
+        strings.push_back(g->compound ? g->compound->db : "");
+    }
+
+    uint32_t header[] = {VERSION, BYTE_ORDER_MARK, (uint32_t)groups.size(), (uint32_t)flat.size(),
+                         (uint32_t)peaks.size(), (uint32_t)samples.size(), (uint32_t)usedSamples.size()};
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write((const char *)header, sizeof(header));
+
+    ColumnWriter writer(out, compress);
+    writer.writeStrings(sampleNames);
+    writer.write(childCount);
+    writer.write(peakCount);
+    writer.write(usedCount);
+    writer.write(usedSamples);
+    writer.writeStrings(strings);
+
+    for (unsigned int i = 0; i < sizeof(groupIntFields) / sizeof(groupIntFields[0]); i++)
+        writer.writeField<int32_t>(flat, groupIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupUIntFields) / sizeof(groupUIntFields[0]); i++)
+        writer.writeField<uint32_t>(flat, groupUIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupFloatFields) / sizeof(groupFloatFields[0]); i++)
+        writer.writeField<float>(flat, groupFloatFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupDoubleFields) / sizeof(groupDoubleFields[0]); i++)
+        writer.writeField<double>(flat, groupDoubleFields[i]);
+    writer.writeField<int32_t>(flat, &PeakGroup::_type);
+    writer.writeField<int32_t>(flat, &PeakGroup::quantitationType);
+    writer.writeField<int8_t>(flat, &PeakGroup::label);
+
+    writer.write(peakSample);
+    for (unsigned int i = 0; i < sizeof(peakUIntFields) / sizeof(peakUIntFields[0]); i++)
+        writer.writeField<uint32_t>(peaks, peakUIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(peakFloatFields) / sizeof(peakFloatFields[0]); i++)
+        writer.writeField<float>(peaks, peakFloatFields[i]);
+    writer.writeField<int32_t>(peaks, &Peak::groupNum);
+    writer.writeField<uint8_t>(peaks, &Peak::localMaxFlag);
+    writer.writeField<uint8_t>(peaks, &Peak::fromBlankSample);
+    writer.writeField<int8_t>(peaks, &Peak::label);
+
+    if (!out) {
+        errorMessage = "write failed";
+        return false;
+    }
+    return true;
+}
+
+bool PeakTableFile::read(string filename, const vector<mzSample *> &samples,
+                         vector<PeakGroup> &groups)
+{
+    ifstream in(filename.c_str(), ios::binary);
+    if (!in) {
+        errorMessage = "could not open " + filename;
+        return false;
+    }
+    if (!read(in, samples, groups)) {
+        errorMessage = filename + ": " + errorMessage;
+        return false;
+    }
+    return true;
+}
+
+bool PeakTableFile::read(istream &in, const vector<mzSample *> &samples,
+                         vector<PeakGroup> &groups)
+{
+    char magic[sizeof(MAGIC)];
+    uint32_t header[7];
+    in.read(magic, sizeof(magic));
+    in.read((char *)header, sizeof(header));
+    if (!in || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        errorMessage = "not a binary peak table";
+        return false;
+    }
+    if (header[0] != VERSION || header[1] != BYTE_ORDER_MARK) {
+        errorMessage = "written by an incompatible version or machine";
+        return false;
+    }
+    uint32_t topCount = header[2];
+    uint32_t groupCount = header[3];
+    uint32_t totalPeaks = header[4];
+    uint32_t storedSamples = header[5];
+    uint32_t totalUsed = header[6];
+
+    ColumnReader reader(in);
+    vector<string> sampleNames;
+    vector<uint32_t> childCount, peakCount, usedCount;
+    vector<int32_t> usedSamples;
+    vector<string> strings;
+    reader.readStrings(sampleNames, storedSamples);
+    reader.read(childCount, groupCount);
+    reader.read(peakCount, groupCount);
+    reader.read(usedCount, groupCount);
+    reader.read(usedSamples, totalUsed);
+    reader.readStrings(strings, (uint64_t)groupCount * 5);
+    if (!reader.ok()) {
+        errorMessage = reader.error();
+        return false;
+    }
+
+    //stored sample index -> loaded sample
+    map<string, mzSample *> byName;
+    for (unsigned int i = 0; i < samples.size(); i++)
+        byName.insert(make_pair(samples[i]->sampleName, samples[i]));
+    vector<mzSample *> sampleMap(sampleNames.size(), (mzSample *)NULL);
+    for (unsigned int i = 0; i < sampleNames.size(); i++) {
+        map<string, mzSample *>::iterator s = byName.find(sampleNames[i]);
+        if (s != byName.end())
+            sampleMap[i] = s->second;
+    }
+
+    vector<PeakGroup> loaded(topCount);
+    vector<PeakGroup *> flat(groupCount, (PeakGroup *)NULL);
+    vector<Peak *> peaks;
+    peaks.reserve(totalPeaks);
+    unsigned int next = 0;
+    unsigned int built = 0;
+    for (; built < loaded.size() && next < groupCount; built++)
+        next = buildGroup(loaded[built], next, childCount, peakCount, flat, peaks);
+    if (built != loaded.size() || next != groupCount || peaks.size() != totalPeaks) {
+        errorMessage = "corrupt group tree";
+        return false;
+    }
+
+    for (unsigned int i = 0, used = 0; i < groupCount; i++) {
+        PeakGroup *g = flat[i];
+        for (unsigned int j = 0; j < usedCount[i] && used < usedSamples.size(); j++, used++) {
+            int s = usedSamples[used];
+            if (s >= 0 && s < (int)sampleMap.size() && sampleMap[s])
+                g->samples.push_back(sampleMap[s]);
+        }
+
+        g->tagString = strings[i * 5];
+        g->srmId = strings[i * 5 + 1];
+        const string &compoundId = strings[i * 5 + 2];
+        const string &compoundName = strings[i * 5 + 3];
+        const string &compoundDB = strings[i * 5 + 4];
+        if (compoundResolver && (!compoundId.empty() || !compoundName.empty()))
+            g->compound = compoundResolver(compoundId, compoundName, compoundDB);
+        if (!g->compound) {
+            if (!compoundId.empty()) g->tagString = compoundId;
+            else if (!compoundName.empty()) g->tagString = compoundName;
+        }
+    }
+
+    for (unsigned int i = 0; i < sizeof(groupIntFields) / sizeof(groupIntFields[0]); i++)
+        reader.readField<int32_t>(flat, groupIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupUIntFields) / sizeof(groupUIntFields[0]); i++)
+        reader.readField<uint32_t>(flat, groupUIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupFloatFields) / sizeof(groupFloatFields[0]); i++)
+        reader.readField<float>(flat, groupFloatFields[i]);
+    for (unsigned int i = 0; i < sizeof(groupDoubleFields) / sizeof(groupDoubleFields[0]); i++)
+        reader.readField<double>(flat, groupDoubleFields[i]);
+    reader.readField<int32_t>(flat, &PeakGroup::_type);
+    reader.readField<int32_t>(flat, &PeakGroup::quantitationType);
+    reader.readField<int8_t>(flat, &PeakGroup::label);
+
+    vector<int32_t> peakSample;
+    if (reader.read(peakSample, totalPeaks)) {
+        for (unsigned int i = 0; i < peaks.size(); i++) {
+            int s = peakSample[i];
+            if (s >= 0 && s < (int)sampleMap.size())
+                peaks[i]->setSample(sampleMap[s]);
+        }
+    }
+    for (unsigned int i = 0; i < sizeof(peakUIntFields) / sizeof(peakUIntFields[0]); i++)
+        reader.readField<uint32_t>(peaks, peakUIntFields[i]);
+    for (unsigned int i = 0; i < sizeof(peakFloatFields) / sizeof(peakFloatFields[0]); i++)
+        reader.readField<float>(peaks, peakFloatFields[i]);
+    reader.readField<int32_t>(peaks, &Peak::groupNum);
+    reader.readField<uint8_t>(peaks, &Peak::localMaxFlag);
+    reader.readField<uint8_t>(peaks, &Peak::fromBlankSample);
+    reader.readField<int8_t>(peaks, &Peak::label);
+
+    if (!reader.ok()) {
+        errorMessage = reader.error();
+        return false;
+    }
+
+    //swapping keeps the addresses children point back to
+    if (groups.empty()) {
+        groups.swap(loaded);
+    } else {
+        groups.insert(groups.end(), loaded.begin(), loaded.end());
+    }
+    return true;
+}
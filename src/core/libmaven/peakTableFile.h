@@ -0,0 +1,88 @@
+#ifndef PEAKTABLEFILE_H
+#define PEAKTABLEFILE_H
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PeakGroup.h"
+
+using namespace std;
+
+class mzSample;
+class Compound;
+
+/**
+ * @class PeakTableFile
+ * @ingroup libmaven
+ * @brief Binary, column oriented peak table (.mzrollb)
+ * @details Groups are flattened in pre-order (every group is followed by its
+ * children) and each field is stored as one column, i.e. a contiguous array
+ * with one value per group or per peak. Columns are deflated one by one when
+ * built with zlib. Group statistics are stored as computed when saving, so
+ * a table is usable right after reading without calling groupStatistics().
+ *
+ * Samples are stored by name and matched against the loaded samples when
+ * reading, exactly like the .mzroll XML does. Values are written in host
+ * byte order; files from a machine with a different byte order are rejected.
+ * The .mzroll XML remains the interchange format.
+ */
+class PeakTableFile
+{
+  public:
+	/**
+	 * @brief looks up the compound of a group while reading
+	 * @details called with compound id, name and database, returns NULL if
+	 * the compound is not loaded
+	 */
+	typedef std::function<Compound *(const string &, const string &, const string &)> CompoundResolver;
+
+	PeakTableFile();
+
+	/**
+	 * @brief deflate columns when writing, ignored without zlib
+	 */
+	bool compress;
+
+	/**
+	 * @brief compound lookup used by read(), groups keep compound id or
+	 * name as tagString when it is unset or fails
+	 */
+	CompoundResolver compoundResolver;
+
+	/**
+	 * @brief write groups and their children
+	 * @param samples samples peaks may refer to
+	 * @return false if the file could not be written
+	 */
+	bool write(string filename, const vector<PeakGroup *> &groups, const vector<mzSample *> &samples);
+	bool write(ostream &out, const vector<PeakGroup *> &groups, const vector<mzSample *> &samples);
+
+	/**
+	 * @brief read a table written by write()
+	 * @param samples loaded samples, matched to the stored ones by name
+	 * @param groups top level groups are appended, children are nested
+	 * @return false if the file could not be read, groups is left unchanged
+	 */
+	bool read(string filename, const vector<mzSample *> &samples, vector<PeakGroup> &groups);
+	bool read(istream &in, const vector<mzSample *> &samples, vector<PeakGroup> &groups);
+
+	/**
+	 * @brief reason of the last failed read or write
+	 */
+	string errorMessage;
+
+	/**
+	 * @return true if the file starts with the header of a binary peak table
+	 */
+	static bool isPeakTableFile(string filename);
+
+  private:
+	/**
+	 * @brief append a group and all its descendants in pre-order
+	 */
+	static void flatten(PeakGroup *group, vector<PeakGroup *> &flat);
+};
+
+#endif
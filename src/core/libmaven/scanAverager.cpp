@@ -0,0 +1,124 @@
+#include "scanAverager.h"
+
+#include <algorithm>
+
+#include "Scan.h"
+#include "masscutofftype.h"
+
+ScanAverager::ScanAverager(MassCutoff *massCutoff, Divisor divisor)
+{
+    _massCutoff = massCutoff;
+    _divisor = divisor;
+}
+
+void ScanAverager::average(const vector<Scan *> &scans, vector<float> &mzs,
+                           vector<float> &intensities)
+{
+    mzs.clear();
+    intensities.clear();
+
+    //collect one m/z sorted run per scan
+    _runMzs.clear();
+    _runIntensities.clear();
+    _runSizes.clear();
+    unsigned int scanCount = 0;
+    unsigned int sortedCount = 0;
+    for (unsigned int s = 0; s < scans.size(); s++) {
+        Scan *scan = scans[s];
+        if (!scan)
+            continue;
+        scanCount++;
+        if (scan->mz.empty())
+            continue;
+
+        if (is_sorted(scan->mz.begin(), scan->mz.end())) {
+            _runMzs.push_back(scan->mz.data());
+            _runIntensities.push_back(scan->intensity.data());
+            _runSizes.push_back(scan->mz.size());
+            continue;
+        }
+
+        //sort a copy through a permutation, ties keep their order
+        if (_order.size() < scan->mz.size())
+            _order.resize(scan->mz.size());
+        for (unsigned int i = 0; i < scan->mz.size(); i++)
+            _order[i] = i;
+        const vector<float> &scanMzs = scan->mz;
+        stable_sort(_order.begin(), _order.begin() + scanMzs.size(),
+                    [&scanMzs](unsigned int a, unsigned int b) { return scanMzs[a] < scanMzs[b]; });
+
+        if (_sortedMzs.size() <= sortedCount) {
+            _sortedMzs.resize(sortedCount + 1);
+            _sortedIntensities.resize(sortedCount + 1);
+        }
+        vector<float> &runMzs = _sortedMzs[sortedCount];
+        vector<float> &runIntensities = _sortedIntensities[sortedCount];
+        sortedCount++;
+        runMzs.resize(scanMzs.size());
+        runIntensities.resize(scanMzs.size());
+        for (unsigned int i = 0; i < scanMzs.size(); i++) {
+            runMzs[i] = scanMzs[_order[i]];
+            runIntensities[i] = scan->intensity[_order[i]];
+        }
+        _runMzs.push_back(runMzs.data());
+        _runIntensities.push_back(runIntensities.data());
+        _runSizes.push_back(runMzs.size());
+    }
+    if (_runSizes.empty())
+        return;
+
+    _runPositions.assign(_runSizes.size(), 0);
+    _heap.clear();
+    for (unsigned int r = 0; r < _runSizes.size(); r++) {
+        Head head = {_runMzs[r][0], r};
+        _heap.push_back(head);
+    }
+    make_heap(_heap.begin(), _heap.end());
+
+    double binIntensity = 0;
+    double binWeightedMz = 0;
+    float binMz = 0;
+    unsigned int binPeaks = 0;
+    float divisor = scanCount;
+
+    auto closeBin = [&]() {
+        if (binPeaks == 0)
+            return;
+        if (_divisor == PeakCount)
+            divisor = binPeaks;
+        mzs.push_back(binMz);
+        intensities.push_back((float)binIntensity / divisor);
+    };
+
+    while (!_heap.empty()) {
+        pop_heap(_heap.begin(), _heap.end());
+        Head &head = _heap.back();
+        unsigned int r = head.run;
+        unsigned int pos = _runPositions[r]++;
+        float mz = head.mz;
+        float intensity = _runIntensities[r][pos];
+
+        if (pos + 1 < _runSizes[r]) {
+            head.mz = _runMzs[r][pos + 1];
+            push_heap(_heap.begin(), _heap.end());
+        } else {
+            _heap.pop_back();
+        }
+
+        if (binPeaks > 0 && mz - binMz > _massCutoff->massCutoffValue(binMz)) {
+            closeBin();
+            binIntensity = 0;
+            binWeightedMz = 0;
+            binPeaks = 0;
+        }
+
+        if (binPeaks == 0)
+            binMz = mz;
+        binIntensity += intensity;
+        binWeightedMz += (double)intensity * mz;
+        binPeaks++;
+        if (binIntensity > 0)
+            binMz = binWeightedMz / binIntensity;
+    }
+    closeBin();
+}
@@ -0,0 +1,70 @@
+#ifndef SCANAVERAGER_H
+#define SCANAVERAGER_H
+
+#include <vector>
+
+using namespace std;
+
+class Scan;
+class MassCutoff;
+
+/**
+ * @class ScanAverager
+ * @ingroup libmaven
+ * @brief Averages the peaks of several scans into one spectrum
+ * @details Scans are read as m/z sorted runs and merged into a single m/z
+ * ordered stream, which costs log(scans) per peak. The stream is then cut
+ * into bins in one pass: a peak joins the current bin if it lies within the
+ * mass cutoff of the bin's intensity weighted m/z, otherwise it starts a new
+ * bin. Every bin becomes one peak at its intensity weighted m/z.
+ *
+ * An averager keeps its working arrays between calls, one averager per
+ * thread can average many groups without allocating.
+ */
+class ScanAverager
+{
+  public:
+	/**
+	 * @brief what the summed intensity of a bin is divided by
+	 */
+	enum Divisor
+	{
+		ScanCount,	//intensity averaged over all scans, missing peaks count as 0
+		PeakCount	//intensity averaged over the peaks that fell in the bin
+	};
+
+	/**
+	 * @param massCutoff bin width on either side, in ppm or mDa
+	 */
+	ScanAverager(MassCutoff *massCutoff, Divisor divisor);
+
+	/**
+	 * @brief average scans into mzs and intensities, sorted by m/z
+	 * @details NULL scans are skipped
+	 */
+	void average(const vector<Scan *> &scans, vector<float> &mzs,
+				 vector<float> &intensities);
+
+  private:
+	struct Head
+	{
+		float mz;
+		unsigned int run;
+		bool operator<(const Head &b) const { return mz > b.mz; }	//min heap
+	};
+
+	MassCutoff *_massCutoff;
+	Divisor _divisor;
+
+	//sorted copies of scans whose m/z values are out of order
+	vector<vector<float> > _sortedMzs;
+	vector<vector<float> > _sortedIntensities;
+	vector<unsigned int> _order;
+	vector<const float *> _runMzs;
+	vector<const float *> _runIntensities;
+	vector<unsigned int> _runSizes;
+	vector<unsigned int> _runPositions;
+	vector<Head> _heap;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include "scratchBuffer.h"
+
+#include <memory>
+
+namespace mzUtils
+{
+    namespace
+    {
+        //arrays not lent out at the moment, kept until the thread exits
+        struct Pool
+        {
+            std::vector<std::unique_ptr<std::vector<float> > > free;
+        };
+
+        thread_local Pool pool;
+    }
+
+    ScratchBuffer::ScratchBuffer(size_t n)
+    {
+        if (pool.free.empty()) {
+            _buffer = new std::vector<float>();
+        } else {
+            _buffer = pool.free.back().release();
+            pool.free.pop_back();
+        }
+        if (_buffer->size() < n)
+            _buffer->resize(n);
+        _data = _buffer->data();
+        _size = n;
+    }
+
+    ScratchBuffer::~ScratchBuffer()
+    {
+        pool.free.push_back(std::unique_ptr<std::vector<float> >(_buffer));
+    }
+}
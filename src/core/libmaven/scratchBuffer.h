@@ -0,0 +1,39 @@
+#ifndef SCRATCHBUFFER_H
+#define SCRATCHBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace mzUtils
+{
+	/**
+	 * @class ScratchBuffer
+	 * @ingroup libmaven
+	 * @brief Temporary float array taken from a per-thread pool
+	 * @details Smoothing and baseline code needs short lived arrays for every
+	 * EIC it touches. A ScratchBuffer borrows an array from a pool owned by
+	 * the calling thread and gives it back when it goes out of scope, so after
+	 * warming up these arrays are neither allocated nor freed. Buffers may be
+	 * nested. Contents are not initialized.
+	 */
+	class ScratchBuffer
+	{
+	  public:
+		explicit ScratchBuffer(size_t n);
+		~ScratchBuffer();
+
+		float *data() { return _data; }
+		size_t size() const { return _size; }
+		float &operator[](size_t i) { return _data[i]; }
+
+	  private:
+		std::vector<float> *_buffer;
+		float *_data;
+		size_t _size;
+
+		ScratchBuffer(const ScratchBuffer &);
+		ScratchBuffer &operator=(const ScratchBuffer &);
+	};
+}
+
+#endif
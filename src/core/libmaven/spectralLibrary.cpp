@@ -0,0 +1,702 @@
+#include "spectralLibrary.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifndef __APPLE__
+#include <omp.h>
+#endif
+
+#include "Compound.h"
+
+namespace {
+
+const char MAGIC[8] = {'M', 'A', 'V', 'E', 'N', 'S', 'P', 'L'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// bytes read from the library per chunk; one chunk per thread is in memory
+const size_t CHUNK_SIZE = 8 << 20;
+
+// text of a record: id, name, formula and categories, each '\0' terminated
+const int TEXT_FIELDS = 4;
+
+bool startsWith(const string &line, const char *prefix)
+{
+    size_t n = strlen(prefix);
+    if (line.size() < n)
+        return false;
+    for (size_t i = 0; i < n; i++) {
+        if (tolower((unsigned char)line[i]) != tolower((unsigned char)prefix[i]))
+            return false;
+    }
+    return true;
+}
+
+// QString::simplified() of the line from position offset on
+string simplified(const string &line, size_t offset)
+{
+    string value;
+    bool space = false;
+    for (size_t i = offset; i < line.size(); i++) {
+        if (isspace((unsigned char)line[i])) {
+            space = !value.empty();
+        } else {
+            if (space)
+                value += ' ';
+            value += line[i];
+            space = false;
+        }
+    }
+    return value;
+}
+
+// whole string as a number like QString::toDouble(), 0 if it is none
+double toDouble(const string &value)
+{
+    const char *begin = value.c_str();
+    char *end = NULL;
+    double x = value.empty() ? 0 : strtod(begin, &end);
+    return !value.empty() && end == begin + value.size() ? x : 0;
+}
+
+int toInt(const string &value)
+{
+    const char *begin = value.c_str();
+    char *end = NULL;
+    long x = value.empty() ? 0 : strtol(begin, &end, 10);
+    return !value.empty() && end == begin + value.size() ? (int)x : 0;
+}
+
+// m/z and intensity from the first two words of a peak line
+bool parsePeak(const string &line, float &mz, float &intensity)
+{
+    const char *p = line.c_str();
+    double values[2];
+    for (int k = 0; k < 2; k++) {
+        while (*p && isspace((unsigned char)*p))
+            p++;
+        const char *begin = p;
+        while (*p && !isspace((unsigned char)*p))
+            p++;
+        if (p == begin)
+            return false;
+        char *end = NULL;
+        values[k] = strtod(begin, &end);
+        if (end != p)
+            return false;
+    }
+    if (values[0] < 0 || values[1] < 0)
+        return false;
+    mz = values[0];
+    intensity = values[1];
+    return true;
+}
+
+/**
+ * Length of the part of data made of complete records: up to the last line
+ * starting a NIST record or just past the last "//" line ending a MassBank
+ * record. 0 if data holds no such boundary.
+ */
+size_t recordBoundary(const string &data, SpectralLibrary::Format format)
+{
+    size_t end = data.rfind('\n');
+    while (end != string::npos) {
+        size_t start = end == 0 ? string::npos : data.rfind('\n', end - 1);
+        start = start == string::npos ? 0 : start + 1;
+        if (format == SpectralLibrary::NIST) {
+            if (start > 0 && data.size() - start >= 5 && startsWith(data.substr(start, 5), "Name:"))
+                return start;
+        } else if (data.compare(start, 2, "//") == 0) {
+            return end + 1;
+        }
+        if (start == 0)
+            return 0;
+        end = start - 1;
+    }
+    return 0;
+}
+
+}
+
+struct SpectralLibrary::Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t format;
+    uint32_t recordCount;
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t peaksOffset;
+    uint64_t textOffset;
+    uint64_t fileSize;
+};
+
+/**
+ * Records parsed from one chunk of a library. Peak and text offsets of the
+ * entries are relative to the chunk.
+ */
+struct SpectralLibrary::Chunk
+{
+    vector<Entry> entries;
+    vector<float> peaks;
+    string text;
+};
+
+SpectralLibrary::SpectralLibrary()
+{
+    _file = NULL;
+    _entries = NULL;
+    _peaks = NULL;
+    _text = NULL;
+    _recordCount = 0;
+    _format = NIST;
+}
+
+SpectralLibrary::~SpectralLibrary()
+{
+    close();
+}
+
+string SpectralLibrary::indexFileName(string libraryFile)
+{
+    return libraryFile + ".mzlib";
+}
+
+bool SpectralLibrary::load(string libraryFile, Format format)
+{
+    string indexFile = indexFileName(libraryFile);
+    QString name = QFileInfo(QString::fromStdString(indexFile)).fileName();
+    string fallback = QDir::temp().filePath(name).toStdString();
+
+    //a current index that does not open is damaged and gets rebuilt
+    if (isIndexCurrent(libraryFile, format, indexFile) && open(indexFile))
+        return true;
+    if (isIndexCurrent(libraryFile, format, fallback) && open(fallback))
+        return true;
+    if (build(libraryFile, format, indexFile) && open(indexFile))
+        return true;
+
+    //keep the reason the index could not be written next to the library
+    string reason = errorMessage;
+    if (!build(libraryFile, format, fallback) || !open(fallback))
+        return false;
+    errorMessage = reason;
+    return true;
+}
+
+bool SpectralLibrary::isIndexCurrent(string libraryFile, Format format, string indexFile)
+{
+    QFileInfo source(QString::fromStdString(libraryFile));
+    if (!source.exists())
+        return false;
+
+    ifstream in(indexFile.c_str(), ios::binary);
+    Header header;
+    if (!in.read((char *)&header, sizeof(header)))
+        return false;
+    return memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+           && header.version == VERSION
+           && header.byteOrderMark == BYTE_ORDER_MARK
+           && header.format == (uint32_t)format
+           && header.sourceSize == (uint64_t)source.size()
+           && header.sourceModified == source.lastModified().toMSecsSinceEpoch();
+}
+
+void SpectralLibrary::parseChunk(const string &data, Format format, Chunk &chunk)
+{
+    string id, name, formula;
+    vector<string> categories;
+    double precursor = 0, mw = 0, retentionTime = 0;
+    bool peaks = false;
+    vector<pair<float, float> > mzIntensities;
+
+    //one record per block of lines, as the text loaders of the GUI read them
+    auto flush = [&]() {
+        if (name.empty())
+            return;
+
+        Entry entry;
+        entry.precursor = precursor;
+        entry.mw = mw;
+        entry.precursorMz = precursor > 0 ? precursor : mw;
+        entry.expectedRt = format == NIST ? retentionTime : -1;
+        entry.charge = 0;
+        entry.peakCount = mzIntensities.size();
+        entry.peakOffset = chunk.peaks.size();
+        entry.textOffset = chunk.text.size();
+        entry.order = chunk.entries.size();
+
+        stable_sort(mzIntensities.begin(), mzIntensities.end(),
+                    [](const pair<float, float> &a, const pair<float, float> &b) {
+                        return a.first < b.first;
+                    });
+        for (unsigned int i = 0; i < mzIntensities.size(); i++)
+            chunk.peaks.push_back(mzIntensities[i].first);
+        for (unsigned int i = 0; i < mzIntensities.size(); i++)
+            chunk.peaks.push_back(mzIntensities[i].second);
+
+        chunk.text += format == NIST ? name : id;	//NIST records are known by name
+        chunk.text += '\0';
+        chunk.text += name;
+        chunk.text += '\0';
+        chunk.text += formula;
+        chunk.text += '\0';
+        for (unsigned int i = 0; i < categories.size(); i++) {
+            if (i)
+                chunk.text += '\t';
+            chunk.text += categories[i];
+        }
+        chunk.text += '\0';
+        entry.textSize = chunk.text.size() - entry.textOffset;
+        chunk.entries.push_back(entry);
+
+        id.clear();
+        name.clear();
+        formula.clear();
+        categories.clear();
+        precursor = mw = retentionTime = 0;
+        peaks = false;
+        mzIntensities.clear();
+    };
+
+    string line;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if (end == string::npos)
+            end = data.size();
+        line.assign(data, pos, end - pos);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        pos = end + 1;
+
+        float mz, intensity;
+        if (format == NIST) {
+            if (startsWith(line, "Name:")) {
+                flush();
+                name = simplified(line, 5);
+            } else if (startsWith(line, "MW:")) {
+                mw = toDouble(simplified(line, 4));
+            } else if (startsWith(line, "PRECURSORMZ:")) {
+                precursor = toDouble(simplified(line, 13));
+            } else if (startsWith(line, "Comment:")) {
+                string comment = simplified(line, 8);
+
+                //Formula=C..H.. and AvgRt=.. anywhere in the comment
+                for (size_t f = comment.find("Formula="); f != string::npos; f = comment.find("Formula=", f + 1)) {
+                    size_t p = f + 8, c = p;
+                    if (c < comment.size() && comment[c] == 'C') {
+                        size_t d = ++c;
+                        while (c < comment.size() && isdigit((unsigned char)comment[c])) c++;
+                        if (c > d && c < comment.size() && comment[c] == 'H') {
+                            d = ++c;
+                            while (c < comment.size() && isdigit((unsigned char)comment[c])) c++;
+                            if (c > d) {
+                                while (c < comment.size() && comment[c] != ' ') c++;
+                                formula = comment.substr(p, c - p);
+                                break;
+                            }
+                        }
+                    }
+                }
+                size_t r = comment.find("AvgRt=");
+                if (r != string::npos && r + 6 < comment.size() && comment[r + 6] != ' ')
+                    retentionTime = toDouble(comment.substr(r + 6, comment.find(' ', r + 6) - r - 6));
+            } else if (startsWith(line, "Num Peaks:") || startsWith(line, "NumPeaks:")) {
+                peaks = true;
+            } else if (peaks && parsePeak(line, mz, intensity)) {
+                mzIntensities.push_back(make_pair(mz, intensity));
+            }
+        } else {
+            if (startsWith(line, "//")) {
+                flush();
+            }
+
+            if (startsWith(line, "ACCESSION:")) {
+                id = simplified(line, 10);
+            } else if (startsWith(line, "CH$NAME:")) {
+                string alias = simplified(line, 9);
+                if (name.empty())
+                    name = alias;
+            } else if (startsWith(line, "CH$COMPOUND_CLASS:")) {
+                categories.push_back(simplified(line, 19));
+            } else if (startsWith(line, "CH$EXACT_MASS:")) {
+                precursor = toDouble(simplified(line, 14));
+            } else if (startsWith(line, "CH$FORMULA:")) {
+                formula = simplified(line, 12);
+            } else if (startsWith(line, "PK$NUM_PEAK:")) {
+                peaks = toInt(simplified(line, 12)) != 0;
+            } else if (startsWith(line, "RECORD_TITLE:") || startsWith(line, "PK$PEAK:")) {
+                continue;
+            } else if (peaks && parsePeak(line, mz, intensity)) {
+                mzIntensities.push_back(make_pair(mz, intensity));
+            }
+        }
+    }
+    flush();
+}
+
+bool SpectralLibrary::build(string libraryFile, Format format, string indexFile)
+{
+    errorMessage.clear();
+    QFileInfo source(QString::fromStdString(libraryFile));
+    ifstream in(libraryFile.c_str(), ios::binary);
+    if (!in) {
+        errorMessage = "can't open " + libraryFile;
+        return false;
+    }
+
+    string peaksFile = indexFile + ".peaks.tmp";
+    string textFile = indexFile + ".text.tmp";
+    string partFile = indexFile + ".tmp";
+    auto fail = [&](string message) {
+        errorMessage = message;
+        remove(peaksFile.c_str());
+        remove(textFile.c_str());
+        remove(partFile.c_str());
+        return false;
+    };
+
+    ofstream peaksOut(peaksFile.c_str(), ios::binary | ios::trunc);
+    ofstream textOut(textFile.c_str(), ios::binary | ios::trunc);
+    if (!peaksOut || !textOut)
+        return fail("can't write " + indexFile);
+
+    int batch = 1;
+#ifndef __APPLE__
+    batch = omp_get_max_threads();
+#endif
+
+    //parse a batch of chunks in parallel, spill their peaks and text
+    vector<Entry> entries;
+    uint64_t peakTotal = 0, textTotal = 0;
+    string pending;
+    vector<char> block(CHUNK_SIZE);
+    bool atEnd = false;
+    while (!atEnd) {
+        vector<string> chunks;
+        while ((int)chunks.size() < batch && !atEnd) {
+            in.read(&block[0], block.size());
+            pending.append(&block[0], in.gcount());
+            if (in.bad())
+                return fail("can't read " + libraryFile);
+            if ((size_t)in.gcount() < block.size()) {
+                atEnd = true;
+                chunks.push_back(string());
+                chunks.back().swap(pending);
+                break;
+            }
+            size_t boundary = recordBoundary(pending, format);
+            if (boundary == 0)
+                continue;	//a record longer than a block, read on
+            chunks.push_back(pending.substr(0, boundary));
+            pending.erase(0, boundary);
+        }
+
+        vector<Chunk> parsed(chunks.size());
+#ifndef __APPLE__
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int c = 0; c < (int)chunks.size(); c++) {
+            parseChunk(chunks[c], format, parsed[c]);
+            string().swap(chunks[c]);
+        }
+
+        for (unsigned int c = 0; c < parsed.size(); c++) {
+            Chunk &chunk = parsed[c];
+            for (unsigned int i = 0; i < chunk.entries.size(); i++) {
+                Entry entry = chunk.entries[i];
+                entry.peakOffset += peakTotal;
+                entry.textOffset += textTotal;
+                entry.order = entries.size();
+                entries.push_back(entry);
+            }
+            if (!chunk.peaks.empty())
+                peaksOut.write((const char *)&chunk.peaks[0], chunk.peaks.size() * sizeof(float));
+            textOut.write(chunk.text.data(), chunk.text.size());
+            peakTotal += chunk.peaks.size();
+            textTotal += chunk.text.size();
+        }
+    }
+    peaksOut.close();
+    textOut.close();
+    if (!peaksOut || !textOut)
+        return fail("can't write " + indexFile);
+
+    stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.precursorMz < b.precursorMz;
+    });
+
+    //write records in precursor order, each followed by its peaks and text
+    QFile spilledPeaks(QString::fromStdString(peaksFile));
+    QFile spilledText(QString::fromStdString(textFile));
+    const float *peaks = NULL;
+    const char *text = NULL;
+    if (peakTotal > 0) {
+        if (!spilledPeaks.open(QIODevice::ReadOnly)
+            || !(peaks = (const float *)spilledPeaks.map(0, peakTotal * sizeof(float))))
+            return fail("can't read back " + peaksFile);
+    }
+    if (textTotal > 0) {
+        if (!spilledText.open(QIODevice::ReadOnly)
+            || !(text = (const char *)spilledText.map(0, textTotal)))
+            return fail("can't read back " + textFile);
+    }
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.format = format;
+    header.recordCount = entries.size();
+    header.sourceSize = source.size();
+    header.sourceModified = source.lastModified().toMSecsSinceEpoch();
+    header.peaksOffset = sizeof(Header) + entries.size() * sizeof(Entry);
+    header.textOffset = header.peaksOffset + peakTotal * sizeof(float);
+    header.fileSize = header.textOffset + textTotal;
+
+    vector<Entry> sorted(entries);
+    uint64_t peakOffset = 0, textOffset = 0;
+    for (unsigned int i = 0; i < sorted.size(); i++) {
+        sorted[i].peakOffset = peakOffset;
+        sorted[i].textOffset = textOffset;
+        peakOffset += 2 * sorted[i].peakCount;
+        textOffset += sorted[i].textSize;
+    }
+
+    ofstream out(partFile.c_str(), ios::binary | ios::trunc);
+    out.write((const char *)&header, sizeof(header));
+    if (!sorted.empty())
+        out.write((const char *)&sorted[0], sorted.size() * sizeof(Entry));
+    for (unsigned int i = 0; i < entries.size(); i++)
+        out.write((const char *)(peaks + entries[i].peakOffset), 2 * entries[i].peakCount * sizeof(float));
+    for (unsigned int i = 0; i < entries.size(); i++)
+        out.write(text + entries[i].textOffset, entries[i].textSize);
+    out.close();
+    spilledPeaks.close();
+    spilledText.close();
+    if (!out)
+        return fail("can't write " + indexFile);
+
+    remove(peaksFile.c_str());
+    remove(textFile.c_str());
+
+    //on Windows an index still mapped by another instance can't be removed
+    QString target = QString::fromStdString(indexFile);
+    if (QFile::exists(target) && !QFile::remove(target))
+        return fail("can't replace " + indexFile + ", it may still be open");
+    if (!QFile::rename(QString::fromStdString(partFile), target))
+        return fail("can't rename " + partFile + " to " + indexFile);
+    return true;
+}
+
+bool SpectralLibrary::open(string indexFile)
+{
+    close();
+    errorMessage.clear();
+
+    QFile *file = new QFile(QString::fromStdString(indexFile));
+    const uchar *data = NULL;
+    qint64 size = 0;
+    if (file->open(QIODevice::ReadOnly)) {
+        size = file->size();
+        if (size >= (qint64)sizeof(Header))
+            data = file->map(0, size);
+    }
+    if (!data) {
+        delete file;
+        errorMessage = "can't read " + indexFile;
+        return false;
+    }
+
+    const Header *header = (const Header *)data;
+    uint64_t entriesEnd = sizeof(Header) + (uint64_t)header->recordCount * sizeof(Entry);
+    bool valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+                 && header->version == VERSION
+                 && header->byteOrderMark == BYTE_ORDER_MARK
+                 && header->format <= MassBank
+                 && header->fileSize == (uint64_t)size
+                 && header->peaksOffset == entriesEnd
+                 && header->textOffset >= header->peaksOffset
+                 && header->textOffset <= header->fileSize
+                 && (header->textOffset - header->peaksOffset) % sizeof(float) == 0;
+
+    //every record has to lie within the mapping, checked once here so that
+    //queries can trust the offsets
+    const Entry *entries = (const Entry *)(data + sizeof(Header));
+    const char *text = (const char *)(data + (valid ? header->textOffset : 0));
+    uint64_t peakTotal = valid ? (header->textOffset - header->peaksOffset) / sizeof(float) : 0;
+    uint64_t textTotal = valid ? header->fileSize - header->textOffset : 0;
+    for (uint32_t i = 0; valid && i < header->recordCount; i++) {
+        const Entry &entry = entries[i];
+        valid = entry.peakOffset <= peakTotal
+                && 2 * (uint64_t)entry.peakCount <= peakTotal - entry.peakOffset
+                && entry.textOffset <= textTotal
+                && entry.textSize <= textTotal - entry.textOffset
+                && entry.textSize > 0
+                && text[entry.textOffset + entry.textSize - 1] == '\0'
+                && count(text + entry.textOffset, text + entry.textOffset + entry.textSize, '\0')
+                       >= TEXT_FIELDS;
+    }
+    if (!valid) {
+        delete file;
+        errorMessage = indexFile + " is not a spectral library index";
+        return false;
+    }
+
+    _file = file;
+    _entries = entries;
+    _peaks = (const float *)(data + header->peaksOffset);
+    _text = text;
+    _recordCount = header->recordCount;
+    _format = (Format)header->format;
+    return true;
+}
+
+void SpectralLibrary::close()
+{
+    delete _file;	//unmaps
+    _file = NULL;
+    _entries = NULL;
+    _peaks = NULL;
+    _text = NULL;
+    _recordCount = 0;
+}
+
+const float *SpectralLibrary::mzs(unsigned int record) const
+{
+    return _peaks + _entries[record].peakOffset;
+}
+
+const float *SpectralLibrary::intensities(unsigned int record) const
+{
+    return _peaks + _entries[record].peakOffset + _entries[record].peakCount;
+}
+
+const char *SpectralLibrary::textField(unsigned int record, int field) const
+{
+    const char *p = _text + _entries[record].textOffset;
+    for (int i = 0; i < field; i++)
+        p += strlen(p) + 1;
+    return p;
+}
+
+string SpectralLibrary::id(unsigned int record) const
+{
+    return textField(record, 0);
+}
+
+string SpectralLibrary::name(unsigned int record) const
+{
+    return textField(record, 1);
+}
+
+string SpectralLibrary::formula(unsigned int record) const
+{
+    return textField(record, 2);
+}
+
+vector<string> SpectralLibrary::categories(unsigned int record) const
+{
+    vector<string> categories;
+    const char *p = textField(record, 3);
+    while (*p) {
+        const char *end = p;
+        while (*end && *end != '\t')
+            end++;
+        categories.push_back(string(p, end));
+        p = *end ? end + 1 : end;
+    }
+    return categories;
+}
+
+pair<unsigned int, unsigned int> SpectralLibrary::find(float mzmin, float mzmax) const
+{
+    if (!isOpen() || mzmax < mzmin)
+        return make_pair(0u, 0u);
+    const Entry *begin = _entries, *end = _entries + _recordCount;
+    const Entry *first = lower_bound(begin, end, mzmin, [](const Entry &e, float mz) {
+        return e.precursorMz < mz;
+    });
+    const Entry *last = upper_bound(first, end, mzmax, [](float mz, const Entry &e) {
+        return mz < e.precursorMz;
+    });
+    return make_pair((unsigned int)(first - begin), (unsigned int)(last - begin));
+}
+
+vector<SpectralLibrary::Match> SpectralLibrary::search(Fragment *query, float mzmin, float mzmax,
+                                                       float productAmuToll, int minMatchedPeaks) const
+{
+    vector<Match> matches;
+    if (!query || query->mzs.empty())
+        return matches;
+
+    vector<int> order = query->mzOrderInc();
+    vector<float> queryMzs(order.size()), queryIntensities(order.size());
+    for (unsigned int i = 0; i < order.size(); i++) {
+        queryMzs[i] = query->mzs[order[i]];
+        queryIntensities[i] = query->intensity_array[order[i]];
+    }
+
+    pair<unsigned int, unsigned int> records = find(mzmin, mzmax);
+    for (unsigned int r = records.first; r < records.second; r++) {
+        Match match;
+        match.record = r;
+        match.score = Fragment::scoreSortedPeaks(queryMzs.data(), queryIntensities.data(), queryMzs.size(),
+                                                 mzs(r), intensities(r), peakCount(r), productAmuToll);
+        if (match.score.matchedPeaks >= minMatchedPeaks && match.score.matchedPeaks > 0)
+            matches.push_back(match);
+    }
+    stable_sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.score.cosine > b.score.cosine;
+    });
+    return matches;
+}
+
+Fragment *SpectralLibrary::fragment(unsigned int record) const
+{
+    const Entry &entry = _entries[record];
+    Fragment *f = new Fragment();
+    f->precursorMz = entry.precursorMz;
+    f->precursorCharge = entry.charge;
+    f->rt = entry.expectedRt;
+    f->sampleName = name(record);
+    f->mzs.assign(mzs(record), mzs(record) + entry.peakCount);
+    f->intensity_array.assign(intensities(record), intensities(record) + entry.peakCount);
+    f->obscount = vector<int>(entry.peakCount, 1);
+    return f;
+}
+
+Compound *SpectralLibrary::compound(unsigned int record, string db) const
+{
+    const Entry &entry = _entries[record];
+    Compound *cpd = new Compound(id(record), name(record), formula(record), entry.charge);
+    if (_format == NIST) {
+        if (entry.precursor && entry.mw) {
+            cpd->mass = entry.precursor;
+            cpd->precursorMz = entry.precursor;
+        } else if (entry.mw) {
+            cpd->mass = entry.mw;
+            cpd->precursorMz = entry.precursor;
+        }
+        cpd->expectedRt = entry.expectedRt;
+    } else {
+        cpd->precursorMz = entry.precursor;
+        cpd->category = categories(record);
+    }
+    cpd->db = db;
+    cpd->fragment_mzs.assign(mzs(record), mzs(record) + entry.peakCount);
+    cpd->fragment_intensity.assign(intensities(record), intensities(record) + entry.peakCount);
+    return cpd;
+}
@@ -0,0 +1,179 @@
+#ifndef SPECTRALLIBRARY_H
+#define SPECTRALLIBRARY_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Fragment.h"
+
+using namespace std;
+
+class Compound;
+class QFile;
+
+/**
+ * @class SpectralLibrary
+ * @ingroup libmaven
+ * @brief MS/MS library (NIST .msp/.sptxt or MassBank) read through an
+ * on-disk index
+ * @details The text library is imported once into a binary index next to
+ * it. The import streams the library in chunks that end on record
+ * boundaries, parses the chunks of a batch on several threads and appends
+ * their peaks and text to temporary files, so memory is bounded by the
+ * batch and not by the library. Records are then sorted by precursor m/z
+ * and written out with the peaks of every record sorted by m/z.
+ *
+ * Opening an index maps it into memory, so later opens cost nothing and
+ * only the pages of the records that are read get loaded. An index
+ * remembers size and modification time of its library and is rebuilt by
+ * load() when the library changes. Values are in host byte order, indices
+ * from a machine with a different byte order are rebuilt.
+ *
+ * Queries only read the mapping and may run on several threads.
+ */
+class SpectralLibrary
+{
+  public:
+	enum Format
+	{
+		NIST = 0,
+		MassBank = 1
+	};
+
+	/**
+	 * @brief a library spectrum scored against a query
+	 */
+	struct Match
+	{
+		unsigned int record;
+		Fragment::SpectralScore score;
+	};
+
+	SpectralLibrary();
+	~SpectralLibrary();
+
+	/**
+	 * @brief open the index of a library, building it first if it is
+	 * missing, out of date or damaged
+	 * @details the index is kept next to the library, or in the temporary
+	 * directory when it can't be written there. errorMessage then tells
+	 * why.
+	 */
+	bool load(string libraryFile, Format format);
+
+	/**
+	 * @brief import a library into an index file
+	 * @return false if the library could not be read or the index not
+	 * written, an existing index is left as it was
+	 */
+	bool build(string libraryFile, Format format, string indexFile);
+
+	/**
+	 * @brief map an index written by build()
+	 * @details fails if any record lies outside the file or its text
+	 * misses a terminator
+	 */
+	bool open(string indexFile);
+	void close();
+	bool isOpen() const { return _entries != NULL; }
+
+	/**
+	 * @return true if indexFile is an index of the library in its current
+	 * state
+	 */
+	static bool isIndexCurrent(string libraryFile, Format format, string indexFile);
+
+	/**
+	 * @brief default index file of a library
+	 */
+	static string indexFileName(string libraryFile);
+
+	/**
+	 * @brief reason of the last failed build or open
+	 */
+	string errorMessage;
+
+	/**
+	 * @brief number of records, numbered in increasing precursor m/z
+	 */
+	unsigned int size() const { return _recordCount; }
+	Format format() const { return _format; }
+
+	/**
+	 * @brief precursor m/z of a record, its molecular weight if the
+	 * library gives none
+	 */
+	float precursorMz(unsigned int record) const { return _entries[record].precursorMz; }
+	float expectedRt(unsigned int record) const { return _entries[record].expectedRt; }
+
+	/**
+	 * @brief peaks of a record in increasing m/z, valid while the library
+	 * is open
+	 */
+	unsigned int peakCount(unsigned int record) const { return _entries[record].peakCount; }
+	const float *mzs(unsigned int record) const;
+	const float *intensities(unsigned int record) const;
+
+	string id(unsigned int record) const;
+	string name(unsigned int record) const;
+	string formula(unsigned int record) const;
+	vector<string> categories(unsigned int record) const;
+
+	/**
+	 * @brief records with precursor m/z in [mzmin, mzmax]
+	 * @return first record and one past the last
+	 */
+	pair<unsigned int, unsigned int> find(float mzmin, float mzmax) const;
+
+	/**
+	 * @brief score a spectrum against the records with precursor m/z in
+	 * [mzmin, mzmax]
+	 * @return records sharing at least minMatchedPeaks peaks with the query,
+	 * best cosine first
+	 */
+	vector<Match> search(Fragment *query, float mzmin, float mzmax, float productAmuToll,
+						 int minMatchedPeaks = 1) const;
+
+	/**
+	 * @brief copy of a record as a fragment, owned by the caller
+	 */
+	Fragment *fragment(unsigned int record) const;
+
+	/**
+	 * @brief copy of a record as a compound of database db, set up like
+	 * the text loaders of the GUI used to, owned by the caller
+	 */
+	Compound *compound(unsigned int record, string db) const;
+
+  private:
+	struct Entry
+	{
+		float precursorMz;		//search key
+		float precursor;		//as given by the library
+		float mw;
+		float expectedRt;
+		int32_t charge;
+		uint32_t peakCount;
+		uint64_t peakOffset;	//floats into the peaks, mzs then intensities
+		uint64_t textOffset;	//id, name, formula and categories, '\0' terminated
+		uint32_t textSize;
+		uint32_t order;			//position in the library
+	};
+
+	struct Header;
+	struct Chunk;
+
+	QFile *_file;
+	const Entry *_entries;
+	const float *_peaks;
+	const char *_text;
+	unsigned int _recordCount;
+	Format _format;
+
+	const char *textField(unsigned int record, int field) const;
+	static void parseChunk(const string &data, Format format, Chunk &chunk);
+};
+
+#endif
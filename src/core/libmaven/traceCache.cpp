@@ -0,0 +1,111 @@
+#include "traceCache.h"
+
+#include "mzSample.h"
+
+TraceCache::TraceCache()
+{
+    maxPoints = 1 << 24;
+    _points = 0;
+}
+
+void TraceCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _traces.clear();
+    _points = 0;
+    _fingerprint.clear();
+}
+
+unsigned long TraceCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _points;
+}
+
+vector<float> TraceCache::fingerprint(mzSample *sample)
+{
+    const int samplePoints = 16;
+    vector<float> values;
+    values.reserve(samplePoints + 2);
+    values.push_back(sample->scans.size());
+    values.push_back(sample->getNormalizationConstant());
+    if (sample->scans.empty())
+        return values;
+
+    size_t last = sample->scans.size() - 1;
+    for (int i = 0; i < samplePoints; i++) {
+        Scan *scan = sample->scans[last * i / (samplePoints - 1)];
+        values.push_back(scan ? scan->rt : 0);
+    }
+    return values;
+}
+
+vector<TraceCache::Trace> TraceCache::traces(mzSample *sample,
+                                             const vector<mzSlice> &windows,
+                                             int mslevel, int eicType,
+                                             string filterline)
+{
+    vector<Trace> found(windows.size());
+    if (!sample || windows.empty())
+        return found;
+
+    vector<float> current = fingerprint(sample);
+    vector<Key> keys(windows.size());
+    vector<unsigned int> missing;
+    map<Key, unsigned int> pulled;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (current != _fingerprint) {
+            _traces.clear();
+            _points = 0;
+            _fingerprint = current;
+        }
+
+        for (unsigned int i = 0; i < windows.size(); i++) {
+            keys[i] = Key(windows[i].mzmin, windows[i].mzmax, windows[i].rtmin,
+                          windows[i].rtmax, mslevel, eicType, filterline);
+            map<Key, Trace>::iterator it = _traces.find(keys[i]);
+            if (it != _traces.end())
+                found[i] = it->second;
+            else if (pulled.insert(make_pair(keys[i], missing.size())).second)
+                missing.push_back(i);
+        }
+    }
+
+    if (missing.empty())
+        return found;
+
+    //extraction runs unlocked, other threads may pull their own traces
+    vector<mzSlice> missingWindows(missing.size());
+    for (unsigned int m = 0; m < missing.size(); m++)
+        missingWindows[m] = windows[missing[m]];
+    vector<EIC *> eics = sample->getEICs(missingWindows, mslevel, eicType, filterline);
+
+    vector<Trace> extracted(missing.size());
+    unsigned long points = 0;
+    for (unsigned int m = 0; m < missing.size(); m++) {
+        std::shared_ptr<vector<float> > trace(new vector<float>());
+        trace->swap(eics[m]->intensity);
+        points += trace->size();
+        extracted[m] = trace;
+    }
+    delete_all(eics);
+
+    for (unsigned int i = 0; i < windows.size(); i++) {
+        if (!found[i])
+            found[i] = extracted[pulled[keys[i]]];
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (current != _fingerprint || points > maxPoints)
+        return found;
+    if (_points + points > maxPoints) {
+        _traces.clear();
+        _points = 0;
+    }
+    for (unsigned int m = 0; m < missing.size(); m++) {
+        if (_traces.insert(make_pair(keys[missing[m]], extracted[m])).second)
+            _points += extracted[m]->size();
+    }
+    return found;
+}
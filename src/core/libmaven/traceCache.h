@@ -0,0 +1,77 @@
+#ifndef TRACECACHE_H
+#define TRACECACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+class mzSample;
+class mzSlice;
+
+/**
+ * @class TraceCache
+ * @ingroup libmaven
+ * @brief Intensity traces of one sample, cached by mz and rt window
+ * @details Correlating peak shapes used to pull two fresh EICs from the
+ * raw scans for every pair of m/z values. Here all traces missing from the
+ * cache are pulled in a single pass over the scans of their rt window and
+ * kept, so an m/z that is correlated against many others (a parent against
+ * its adducts and isotopes, a cluster anchor against its members) is only
+ * extracted once.
+ *
+ * Traces are normalized like mzSample::getEIC() does. The cache empties
+ * itself when scans are added, retention times are changed or the
+ * normalization constant is changed, and when it grows past maxPoints.
+ * Lookups may run on several threads.
+ */
+class TraceCache
+{
+  public:
+	typedef std::shared_ptr<const vector<float> > Trace;
+
+	TraceCache();
+
+	/**
+	 * @brief max number of intensities kept over all traces
+	 */
+	unsigned long maxPoints;
+
+	/**
+	 * @brief intensity traces of a sample, one per window
+	 * @details traces of windows with the same rt range have the same length
+	 * @return traces in the order of windows
+	 */
+	vector<Trace> traces(mzSample *sample, const vector<mzSlice> &windows,
+						 int mslevel, int eicType, string filterline);
+
+	/**
+	 * @brief drop all traces, e.g. before scans are deleted
+	 */
+	void clear();
+
+	/**
+	 * @brief number of cached intensities
+	 */
+	unsigned long size() const;
+
+  private:
+	typedef std::tuple<float, float, float, float, int, int, string> Key;
+
+	map<Key, Trace> _traces;
+	unsigned long _points;
+	vector<float> _fingerprint;
+	mutable std::mutex _mutex;
+
+	/**
+	 * @brief scan count, normalization constant and retention times of a
+	 * few scans spread over the sample
+	 */
+	static vector<float> fingerprint(mzSample *sample);
+};
+
+#endif
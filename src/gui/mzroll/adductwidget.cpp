@@ -157,50 +157,68 @@ void AdductWidget::addLinks(float centerMz,int recursionLevel) {
     }
 
 	//parent check
+	vector<int> parentAdducts;
+	vector<float> parentMasses;
     for(int i=0; i < DB.adductsDB.size(); i++ ) {
     	if ( SIGN(DB.adductsDB[i]->charge) != SIGN(ionizationMode) ) continue;
         float parentMass=DB.adductsDB[i]->computeParentMass(centerMz);
 		parentMass += ionizationMode*HMASS;   //adjusted mass
 		cerr << DB.adductsDB[i]->name << " " << DB.adductsDB[i]->charge << " " << parentMass << endl;
         if( abs(parentMass-centerMz)>0.1 && scan->hasMz(parentMass,massCutoff)) {
-			QString noteText = tr("Possible Parent %1").arg(QString(DB.adductsDB[i]->name.c_str()));
-			massCutoff->setMassCutoff(5);
-			float correlation  = sample->correlation(centerMz, parentMass, massCutoff, scan->rt-1, scan->rt+1,
-													_mw->mavenParameters->eicType, _mw->mavenParameters->filterline);
-            float parentIntensity = getIntensity(parentMass,massCutoff);
-
-			if ( correlation > 0.3 && !linkExists(centerMz,parentMass,massCutoff) && parentIntensity > intensity1) {
-					mzLink* l = new mzLink(parentMass,centerMz,noteText.toStdString());
-					l->correlation = correlation;
-					links.push_back(l);
-					addLink(l);
-                    newMzs << parentMass;
-			}
+			parentAdducts.push_back(i);
+			parentMasses.push_back(parentMass);
         }
     }
 
+	if (parentMasses.size() > 0) massCutoff->setMassCutoff(5);
+	vector<float> parentCorrelations = correlations(centerMz, parentMasses, massCutoff);
+	for(unsigned int k=0; k < parentMasses.size(); k++ ) {
+		Adduct* adduct = DB.adductsDB[parentAdducts[k]];
+		float parentMass = parentMasses[k];
+		QString noteText = tr("Possible Parent %1").arg(QString(adduct->name.c_str()));
+		float correlation = parentCorrelations[k];
+		float parentIntensity = getIntensity(parentMass,massCutoff);
+
+		if ( correlation > 0.3 && !linkExists(centerMz,parentMass,massCutoff) && parentIntensity > intensity1) {
+				mzLink* l = new mzLink(parentMass,centerMz,noteText.toStdString());
+				l->correlation = correlation;
+				links.push_back(l);
+				addLink(l);
+				newMzs << parentMass;
+		}
+	}
+
 	//adduct check
+	vector<int> adducts;
+	vector<float> adductMasses;
     for(int i=0; i < DB.adductsDB.size(); i++ ) {
     	if ( SIGN(DB.adductsDB[i]->charge) != SIGN(ionizationMode) ) continue;
 		float parentMass = centerMz-ionizationMode*HMASS;   //adjusted mass
         float adductMass=DB.adductsDB[i]->computeAdductMass(parentMass);
 
         if( abs(adductMass-centerMz)>0.1 && scan->hasMz(adductMass,massCutoff)) {
-            QString noteText = tr("Adduct %1").arg(QString(DB.adductsDB[i]->name.c_str()));
-			float correlation  = sample->correlation(centerMz, adductMass, massCutoff, scan->rt-1, scan->rt+1,
-												_mw->mavenParameters->eicType, _mw->mavenParameters->filterline);
-            float childIntensity = getIntensity(adductMass,massCutoff);
-
-			if (correlation > 0.5 && ! linkExists(adductMass, centerMz,massCutoff) && childIntensity < intensity1) {
-				mzLink* l = new mzLink(centerMz,adductMass,noteText.toStdString());
-				l->correlation = correlation;
-				links.push_back(l);
-				addLink(l);
-                newMzs << adductMass;
-			}
+			adducts.push_back(i);
+			adductMasses.push_back(adductMass);
         }
     }
 
+	vector<float> adductCorrelations = correlations(centerMz, adductMasses, massCutoff);
+	for(unsigned int k=0; k < adductMasses.size(); k++ ) {
+		Adduct* adduct = DB.adductsDB[adducts[k]];
+		float adductMass = adductMasses[k];
+		QString noteText = tr("Adduct %1").arg(QString(adduct->name.c_str()));
+		float correlation = adductCorrelations[k];
+		float childIntensity = getIntensity(adductMass,massCutoff);
+
+		if (correlation > 0.5 && ! linkExists(adductMass, centerMz,massCutoff) && childIntensity < intensity1) {
+			mzLink* l = new mzLink(centerMz,adductMass,noteText.toStdString());
+			l->correlation = correlation;
+			links.push_back(l);
+			addLink(l);
+			newMzs << adductMass;
+		}
+	}
+
 	/*
     //recursive walk
     processedMzs << centerMz;
@@ -273,6 +291,31 @@ float AdductWidget::getIntensity(float mz, MassCutoff *massCutoff) {
    return x;
 }
 
+vector<float> AdductWidget::correlations(float centerMz, const vector<float>& mzs, MassCutoff *massCutoff) {
+	vector<float> values(mzs.size(), 0);
+	if (!_scan || mzs.empty()) return values;
+	mzSample* sample = _scan->getSample();
+	if (!sample) return values;
+
+	//all traces come out of a single pass over the scans around _scan
+	vector<mzSlice> slices;
+	float rtmin = _scan->rt - 1;
+	float rtmax = _scan->rt + 1;
+	float centerWindow = massCutoff->massCutoffValue(centerMz);
+	slices.push_back(mzSlice(centerMz - centerWindow, centerMz + centerWindow, rtmin, rtmax));
+	for(unsigned int i=0; i < mzs.size(); i++ ) {
+		float window = massCutoff->massCutoffValue(mzs[i]);
+		slices.push_back(mzSlice(mzs[i] - window, mzs[i] + window, rtmin, rtmax));
+	}
+
+	vector<TraceCache::Trace> traces = sample->getTraces(slices, 1, _mw->mavenParameters->eicType,
+														 _mw->mavenParameters->filterline);
+	for(unsigned int i=0; i < mzs.size(); i++ )
+		values[i] = mzUtils::correlation(*traces[0], *traces[i + 1]);
+
+	return values;
+}
+
 mzLink* AdductWidget::checkConnection(float mz1, float mz2, string note) {
 
 	//cerr << "check: " << mz1 << " " << mz2 << " " << note << endl;
@@ -54,6 +54,10 @@ private:
 
 	  bool linkExists(float mz1, float mz2, MassCutoff *massCutoff);
       float getIntensity(float mz,MassCutoff *massCutoff);
+      /**
+       * @brief correlation of the EIC at centerMz with the EIC at each of mzs around the current scan
+       */
+      vector<float> correlations(float centerMz, const vector<float>& mzs, MassCutoff *massCutoff);
       
 };
 
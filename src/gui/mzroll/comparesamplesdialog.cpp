@@ -152,37 +152,27 @@ void CompareSamplesDialog::compareSets(vector<mzSample*> sset1,
 	if (!table)
 		return;
 
-	vector<mzSample*> sampleSet;
-	for (int i = 0; i < sset1.size(); i++)
-		sampleSet.push_back(sset1[i]);
-	for (int i = 0; i < sset2.size(); i++)
-		sampleSet.push_back(sset2[i]);
-
 	QList<PeakGroup*> allgroups = table->getGroups();
-	compareLogic.rand_scores.clear();
-
-	for (int i = 0; i < allgroups.size(); i++) {
-
-		//replace missing values
-		float _missingValue = missingValue->value();
+	FeatureMatrix& featureMatrix = table->getFeatureMatrix();
 
-		PeakGroup* group = allgroups[i];
-		compareLogic.computeStats(group, sampleSet, sset1, sset2,
-				_missingValue);
+	//replace missing values
+	float _missingValue = missingValue->value();
 
-		//qDebug() << "CompareSamplesDialog: " << i << " " << meanA << " " << meanB;
-		Q_EMIT(setProgressBar("CompareSamples", i + 1, allgroups.size()));
-	}
+	//fold changes and permutation p-values of all groups
+	Q_EMIT(setProgressBar("CompareSamples", 0, allgroups.size()));
+	compareLogic.computeStats(allgroups, sset1, sset2, _missingValue,
+			&featureMatrix);
+	Q_EMIT(setProgressBar("CompareSamples", allgroups.size(), allgroups.size()));
 
 	float alpha = minPValue->value(); //alpha value //TODO: Alpha value is not being used
 
-	//calculate Pvalues
-	compareLogic.computeMinPValue(allgroups);
-
 	//correct P-values (FDR)
 	int correction = correctionBox->currentIndex();
 	compareLogic.FDRCorrection(allgroups, correction);
 
+	//the journal does not record fold changes and p-values
+	table->invalidateJournal();
+
 	//if (table) { table->updateTable();}
 	if (parentWidget())
 		((ScatterPlot*) parentWidget())->replot();
@@ -199,6 +189,5 @@ void CompareSamplesDialog::compareSets(vector<mzSample*> sset1,
 	 */
 
 	//cleanup
-	compareLogic.rand_scores.clear();
 	allgroups.clear();
 }
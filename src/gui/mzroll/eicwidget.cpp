@@ -5,6 +5,11 @@ EicWidget::EicWidget(QWidget *p) {
 	eicParameters = new EICLogic();
 	parent = p;
 
+	eicService = new EicService(this);
+	_pendingRequest = 0;
+	_pendingSource = NULL;
+	connect(eicService, SIGNAL(eicsReady(EicResult*)), SLOT(eicsComputed(EicResult*)));
+
 	//default values
 	_zoomFactor = 0.5;
 	_minX = _minY = 0;
@@ -473,6 +478,10 @@ void EicWidget::addEICLines(bool showSpline, bool showEIC) {
 				EIC::compMaxIntensity);
 	}
 
+	//two points (min and max) per pixel are enough to draw a trace faithfully
+	unsigned int maxPoints = 2 * std::max(1, (int) scene()->width());
+	vector<unsigned int> visible;
+
 	//display eics
 	for (unsigned int i = 0; i < eicParameters->eics.size(); i++) {
 		EIC* eic = eicParameters->eics[i];
@@ -494,16 +503,21 @@ void EicWidget::addEICLines(bool showSpline, bool showEIC) {
 			}
 		}
 
-		//ignore EICs that do not fall within current time range
-		for (int j = 0; j < eic->size(); j++) {
-			if (eic->rt[j] < eicParameters->_slice.rtmin)
-				continue;
-			if (eic->rt[j] > eicParameters->_slice.rtmax)
-				continue;
-			if (showSpline) {
+		//ignore EICs that do not fall within current time range, and draw
+		//at most a min/max pair per pixel column of the visible range
+		if (showSpline) {
+			eic->visiblePoints(eicParameters->_slice.rtmin,
+					eicParameters->_slice.rtmax, maxPoints, true, visible);
+			for (unsigned int k = 0; k < visible.size(); k++) {
+				int j = visible[k];
 				lineSpline->addPoint(QPointF(toX(eic->rt[j]), toY(eic->spline[j])));
 			}
-			if (showEIC){
+		}
+		if (showEIC) {
+			eic->visiblePoints(eicParameters->_slice.rtmin,
+					eicParameters->_slice.rtmax, maxPoints, false, visible);
+			for (unsigned int k = 0; k < visible.size(); k++) {
+				int j = visible[k];
 				lineEIC->addPoint(
 					QPointF(toX(eic->rt[j]), toY(eic->intensity[j])));
 			}
@@ -667,6 +681,10 @@ void EicWidget::addTicLine() {
 	float tmpMaxY = _maxY;
 	float tmpMinY = _minY;
 
+	//tics are kept across replots, so their pyramids are reused on every zoom
+	unsigned int maxPoints = 2 * std::max(1, (int) scene()->width());
+	vector<unsigned int> visible;
+
 	for (unsigned int i = 0; i < eicParameters->tics.size(); i++) {
 		EIC* tic = eicParameters->tics[i];
 		if (tic->size() == 0)
@@ -679,11 +697,10 @@ void EicWidget::addTicLine() {
 		_maxY = tic->maxIntensity;
 		_minY = 0;
 
-		for (int j = 0; j < tic->size(); j++) {
-			if (tic->rt[j] < eicParameters->_slice.rtmin)
-				continue;
-			if (tic->rt[j] > eicParameters->_slice.rtmax)
-				continue;
+		tic->visiblePoints(eicParameters->_slice.rtmin,
+				eicParameters->_slice.rtmax, maxPoints, false, visible);
+		for (unsigned int k = 0; k < visible.size(); k++) {
+			int j = visible[k];
 			line->addPoint(QPointF(toX(tic->rt[j]), toY(tic->intensity[j])));
 		}
 
@@ -975,6 +992,9 @@ void EicWidget::setTitle() {
 
 void EicWidget::recompute() {
 	//qDebug <<" EicWidget::recompute()";
+	//synchronous results supersede any request still in flight
+	eicService->cancelAll();
+	_pendingRequest = 0;
 	cleanup(); //more clean up
 	computeEICs();	//retrive eics
 	eicParameters->selectedGroup = NULL;
@@ -1554,6 +1574,126 @@ void EicWidget::setPeakGroup(PeakGroup* group) {
 	addPeakPositions(group);
 }
 
+void EicWidget::setPeakGroupAsync(PeakGroup* group) {
+
+	if (group == NULL) return;
+
+	vector<mzSample*> samples = getMainWindow()->getVisibleSamples();
+	if (samples.size() == 0) return;
+
+	//same slice that setPeakGroup ends up with, minus the intermediate
+	//recomputes done by setCompound and setSrmId
+	MavenParameters* mp = getMainWindow()->mavenParameters;
+	mzSlice bounds = visibleSamplesBounds();
+	mzSlice& slice = eicParameters->_slice;
+
+	if (!group->srmId.empty()) {
+		slice.compound = NULL;
+		slice.srmId = group->srmId;
+		if (!_autoZoom) {
+			slice.rtmin = bounds.rtmin;
+			slice.rtmax = bounds.rtmax;
+		}
+	} else if (group->compound) {
+		slice.compound = group->compound;
+		slice.srmId = group->compound->srmId;
+		if (!_autoZoom && group->compound->expectedRt <= 0) {
+			slice.rtmin = bounds.rtmin;
+			slice.rtmax = bounds.rtmax;
+		}
+	} else {
+		slice.compound = NULL;
+		slice.srmId = group->srmId;
+	}
+
+	if (_autoZoom && group->parent != NULL) {
+		slice.rtmin = group->parent->minRt - 2 * _zoomFactor;
+		slice.rtmax = group->parent->maxRt + 2 * _zoomFactor;
+	} else if (_autoZoom) {
+		slice.rtmin = group->minRt - 2 * _zoomFactor;
+		slice.rtmax = group->maxRt + 2 * _zoomFactor;
+	}
+	if (slice.rtmin < bounds.rtmin) slice.rtmin = bounds.rtmin;
+	if (slice.rtmax > bounds.rtmax) slice.rtmax = bounds.rtmax;
+
+	int charge = mp->getCharge(group->compound);
+	if (group->getExpectedMz(charge) != -1) {
+		slice.mz = group->getExpectedMz(charge);
+	} else {
+		slice.mz = group->meanMz;
+	}
+	MassCutoff* massCutoff = getMainWindow()->getUserMassCutoff();
+	slice.mzmin = slice.mz - massCutoff->massCutoffValue(slice.mz);
+	slice.mzmax = slice.mz + massCutoff->massCutoffValue(slice.mz);
+
+	//the worker gets its own copies of everything the GUI may change
+	EicRequest request;
+	request.slice = slice;
+	request.bounds = bounds;
+	request.samples = samples;
+	request.settings = EicSettings(mp);
+	ClassifierNeuralNet* clsf = getMainWindow()->getClassifier();
+	if (clsf != NULL && clsf->hasModel())
+		request.classifier = QSharedPointer<ClassifierNeuralNet>(new ClassifierNeuralNet(*clsf));
+	request.groupPeaks = _groupPeaks;
+
+	//group is held by value, callers may free or move it before the result
+	_pendingGroup = *group;
+	_pendingSource = group;
+	_pendingRequest = eicService->request(request);
+}
+
+PeakGroup* EicWidget::pendingGroup() {
+	//marking and bookmarking act on the table's group while it still exists
+	QList< QPointer<TableDockWidget> > tables = getMainWindow()->getPeakTableList();
+	tables.append(getMainWindow()->getBookmarkedPeaks());
+	Q_FOREACH(QPointer<TableDockWidget> table, tables) {
+		if (table && table->holdsGroup(_pendingSource)
+				&& _pendingSource->meanMz == _pendingGroup.meanMz
+				&& _pendingSource->meanRt == _pendingGroup.meanRt)
+			return _pendingSource;
+	}
+
+	_shownGroup = _pendingGroup;
+	return &_shownGroup;
+}
+
+void EicWidget::eicsComputed(EicResult* result) {
+
+	if (result->id != _pendingRequest) {
+		delete_all(result->eics);
+		delete result;
+		return;
+	}
+
+	PeakGroup* group = pendingGroup();
+	_pendingRequest = 0;
+	_pendingSource = NULL;
+
+	cleanup();
+	eicParameters->eics = result->eics;
+	eicParameters->peakgroups = result->peakgroups;
+	eicParameters->selectedGroup = NULL;
+	delete result;
+
+	if (group->compound)
+		for (int i = 0; i < eicParameters->peakgroups.size(); i++)
+			eicParameters->peakgroups[i].compound = group->compound;
+	if (eicParameters->_slice.srmId.length())
+		for (int i = 0; i < eicParameters->peakgroups.size(); i++)
+			eicParameters->peakgroups[i].srmId = eicParameters->_slice.srmId;
+
+	//what setCompound leaves behind on the synchronous path
+	if (group->compound && group->compound->expectedRt > 0) {
+		selectGroupNearRt(group->compound->expectedRt);
+	} else if (group->compound) {
+		getMainWindow()->mavenParameters->setPeakGroup(NULL);
+	}
+
+	replot(group);
+	addPeakPositions(group);
+}
+
 void EicWidget::setMassCutoff(MassCutoff *massCutoff) {
 	//qDebug <<"EicWidget::setMassCutoff(double massCutoff) ";
 	mzSlice x = eicParameters->_slice;
@@ -2057,36 +2197,60 @@ void EicWidget::addMS2Events(float mzmin, float mzmax) {
     vector <mzSample*> samples = mw->getVisibleSamples();
 
     if (samples.size() <= 0 ) return;
-    MassCutoff *massCutoff = mw->getUserMassCutoff();
+
+    //events closer than this in pixels are drawn as one point
+    const float mergeDistance = 3;
+
+    struct EventBin {
+        Scan* scan;         //most intense precursor in the bin
+        mzSample* sample;
+        bool mixedSamples;
+        int count;
+    };
+    QMap<int, EventBin> bins;
 
     mw->fragPanel->clearTree();
     int count=0;
     for ( unsigned int i=0; i < samples.size(); i++ ) {
         mzSample* sample = samples[i];
-
-        for (unsigned int j=0; j < sample->scans.size(); j++ ) {
-            Scan* scan = sample->scans[j];
-
-            if (scan->mslevel > 1 && scan->precursorMz >= mzmin && scan->precursorMz <= mzmax) {
-
-                mw->fragPanel->addScanItem(scan);
-                if (scan->rt < eicParameters->_slice.rtmin || scan->rt > eicParameters->_slice.rtmax) continue;
-
-        		QColor color = QColor::fromRgbF( sample->color[0], sample->color[1], sample->color[2], 1 );
-                EicPoint* p  = new EicPoint(toX(scan->rt), toY(10), NULL, getMainWindow());
-                p->setPointShape(EicPoint::TRIANGLE_UP);
-                p->forceFillColor(true);;
-                p->setScan(scan);
-                p->setSize(30);
-                p->setColor(color);
-                p->setZValue(1000);
-                p->setPeakGroup(NULL);
-                scene()->addItem(p);
-                count++;
+        vector<Scan*> events = sample->getFragmentScans(mzmin, mzmax,
+                                                        eicParameters->_slice.rtmin,
+                                                        eicParameters->_slice.rtmax);
+
+        for (unsigned int j=0; j < events.size(); j++ ) {
+            Scan* scan = events[j];
+            mw->fragPanel->addScanItem(scan);
+
+            int bin = (int) floor(toX(scan->rt) / mergeDistance);
+            QMap<int, EventBin>::iterator it = bins.find(bin);
+            if (it == bins.end()) {
+                EventBin b = { scan, sample, false, 1 };
+                bins.insert(bin, b);
+            } else {
+                it->count++;
+                if (it->sample != sample) it->mixedSamples = true;
+                if (scan->precursorIntensity > it->scan->precursorIntensity) it->scan = scan;
             }
+            count++;
         }
     }
 
-    qDebug() << "addMS2Events()  found=" << count;
+    Q_FOREACH(const EventBin& b, bins) {
+        QColor color = QColor::fromRgbF( b.sample->color[0], b.sample->color[1], b.sample->color[2], 1 );
+        if (b.mixedSamples) color = QColor(Qt::darkGray);
+
+        EicPoint* p  = new EicPoint(toX(b.scan->rt), toY(10), NULL, getMainWindow());
+        p->setPointShape(EicPoint::TRIANGLE_UP);
+        p->forceFillColor(true);;
+        p->setScan(b.scan);
+        p->setSize(30);
+        p->setColor(color);
+        p->setZValue(1000);
+        p->setPeakGroup(NULL);
+        if (b.count > 1) p->setToolTip(tr("%1 MS2 events").arg(b.count));
+        scene()->addItem(p);
+    }
+
+    qDebug() << "addMS2Events()  found=" << count << " points=" << bins.size();
 
 }
@@ -7,6 +7,7 @@
 #include "boxplot.h"
 #include "barplot.h"
 #include "eiclogic.h"
+#include "eicservice.h"
 #include "plot_axes.h"
 #include "mainwindow.h"
 #include "isotopeplot.h"
@@ -45,6 +46,13 @@ public Q_SLOTS:
 	void setRtWindow(float rtmin, float rtmax);
 	void setSrmId(string srmId);
 	void setPeakGroup(PeakGroup* group);
+	/**
+	 * @brief shows a peak group without blocking the GUI thread
+	 * @details EICs are computed by the EIC service; a later call (or any
+	 * synchronous recompute) supersedes a request that has not finished yet
+	 * @param group peak group to show once its EICs are ready
+	 **/
+	void setPeakGroupAsync(PeakGroup* group);
 	/**
 	 * @brief updates EIC widget for the selected compound
 	 * @details sets appropriate mzSlice in the EIC widget and focusLine for expected Rt
@@ -158,6 +166,10 @@ public Q_SLOTS:
 	void copyToClipboard();
 	void selectionChangedAction();
 	void freezeView(bool freeze);
+
+private Q_SLOTS:
+	void eicsComputed(EicResult* result);
+
 protected:
 	void moved(QMouseEvent *event);
 	void selected(const QRect&);
@@ -189,6 +201,11 @@ Q_SIGNALS:
 
 private:
 	EICLogic* eicParameters;
+	EicService* eicService;
+	int _pendingRequest;				//request of the group to show, 0 if none
+	PeakGroup _pendingGroup;			//copy of that group taken with the request
+	PeakGroup* _pendingSource;			//group it was copied from, may be freed
+	PeakGroup _shownGroup;				//shown copy when the source is gone
 	float _focusLineRt;					// 0
 
 	float _minX;						//plot bounds
@@ -246,6 +263,7 @@ private:
 	void clearPlot();	//removes non permenent graphics objects
 	void findPlotBounds(); //find _minX, _maxX...etc
 	mzSlice visibleSamplesBounds();
+	PeakGroup* pendingGroup();			//group of the finished request, see eicsComputed
 
 	float toX(float x);
 	float toY(float y);
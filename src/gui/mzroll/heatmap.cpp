@@ -69,10 +69,11 @@ void HeatMap::drawMap() {
         _heatMin=0;
 
         sort(allgroups.begin(), allgroups.end(), PeakGroup::compPvalue);
+        FeatureMatrix& featureMatrix = _table->getFeatureMatrix();
 
         for (int i=0; i < Nrows; i++ ) {
             PeakGroup* group = allgroups[i];
-            StatisticsVector<float> yvalues = group->getOrderedIntensityVector(vsamples,PeakGroup::AreaTop);
+            StatisticsVector<float> yvalues = featureMatrix.orderedValues(group,vsamples,PeakGroup::AreaTop);
 
             float center = median(yvalues);
             if ( center == 0 ) center = yvalues.mean();
@@ -648,6 +648,7 @@ using namespace mzUtils;
 				settings->setArrayIndex(i);
 				QFile file (settings->value("crashTable").toString());
 				file.remove();
+				QFile::remove(settings->value("crashTable").toString() + ".journal");
 			}
 			settings->endArray();
 			settings->beginWriteArray("crashTables");
@@ -855,7 +856,7 @@ void AutoSave::saveMzRollWorker() {
 	this->start();
 }
 void AutoSave::run() {
-	_mainwindow->saveMzRoll();
+	_mainwindow->saveMzRoll(true);
 }
 void MainWindow::showAlignmetErrorDialog(QString errorMessage){
 	QErrorMessage alignmentErrorDialog(this);
@@ -899,21 +900,21 @@ void MainWindow::openAWSDialog()
 
 }
 
-void MainWindow::saveMzRoll() {
+void MainWindow::saveMzRoll(bool incremental) {
 
     QSettings* settings = this->getSettings();
 	if (this->peaksMarked > 5) {
-			this->saveMzRollAllTables();
+			this->saveMzRollAllTables(incremental);
 	} else if (this->allPeaksMarked) {
-			this->saveMzRollAllTables();	
+			this->saveMzRollAllTables(incremental);
 	} else if (settings->value("closeEvent").toInt() == 1) {
 		this->saveMzRollAllTables();
 	} else if(this->doAutosave) {
-		this->saveMzRollAllTables();
+		this->saveMzRollAllTables(incremental);
 	}
 }
 
-void MainWindow::saveMzRollAllTables() {
+void MainWindow::saveMzRollAllTables(bool incremental) {
 
     QSettings* settings = this->getSettings();
 
@@ -931,16 +932,16 @@ void MainWindow::saveMzRollAllTables() {
 	Q_FOREACH(peaksTable, peaksTableList) {
 
 		if ( !newFileName.isEmpty() && this->projectDockWidget->lastSavedProject == newFileName ) {
-			savePeaksTable(peaksTable, fileName, QString::number(j));
+			savePeaksTable(peaksTable, fileName, QString::number(j), incremental);
 		} else {
-			savePeaksTable(peaksTable, fileName, QString::number(j));
+			savePeaksTable(peaksTable, fileName, QString::number(j), incremental);
 		}
 		j++;
 	}
 
 }
 
-void MainWindow::savePeaksTable(TableDockWidget* peaksTable, QString fileName, QString tableName) {
+void MainWindow::savePeaksTable(TableDockWidget* peaksTable, QString fileName, QString tableName, bool incremental) {
 	if(fileName.endsWith(".mzroll",Qt::CaseInsensitive)) {
 		QRegExp rxr("_table-[0-9]+");
 		fileName = fileName.replace(rxr, "");
@@ -951,11 +952,19 @@ void MainWindow::savePeaksTable(TableDockWidget* peaksTable, QString fileName, Q
 		if (peaksTable) {
 			newFileName = fi.absolutePath() + QDir::separator() + fi.completeBaseName() + "_table-" + tableName + ".mzroll";
 			saveMzRollList(newFileName);
-			this->projectDockWidget->saveProject(newFileName, peaksTable);
+			if (!incremental || !peaksTable->saveJournal(newFileName)) {
+				peaksTable->markJournal();
+				this->projectDockWidget->saveProject(newFileName, peaksTable);
+				peaksTable->startJournal(newFileName);
+			}
 		} else if (!this->bookmarkedPeaks->getGroups().isEmpty()) {
 			newFileName = fi.absolutePath() + QDir::separator() + fi.completeBaseName() + "_bookmarkedPeaks" + ".mzroll";
 			saveMzRollList(newFileName);
-			this->projectDockWidget->saveProject(newFileName);
+			if (!incremental || !this->bookmarkedPeaks->saveJournal(newFileName)) {
+				this->bookmarkedPeaks->markJournal();
+				this->projectDockWidget->saveProject(newFileName);
+				this->bookmarkedPeaks->startJournal(newFileName);
+			}
 		} else {
 			newFileName = fi.absolutePath() + QDir::separator() + fi.completeBaseName() + ".mzroll";
 			saveMzRollList(newFileName);
@@ -1518,7 +1527,7 @@ void MainWindow::open() {
 			QFileDialog::getOpenFileNames(this,
 					"Select projects, peaks, samples to open:", dir,
 					tr(
-							"All Known Formats(*.mzroll *.mzPeaks *.mzXML *.mzxml *.mzdata *.mzData *.mzData.xml *.cdf *.nc *.mzML);;")
+							"All Known Formats(*.mzroll *.mzrollb *.mzPeaks *.mzXML *.mzxml *.mzdata *.mzData *.mzData.xml *.cdf *.nc *.mzML);;")
 							+ tr("mzXML Format(*.mzXML *.mzxml);;")
 							+ tr("mzData Format(*.mzdata *.mzData *.mzData.xml);;")
 							+ tr("mzML Format(*.mzml *.mzML);;")
@@ -1526,6 +1535,7 @@ void MainWindow::open() {
 							+ tr("Thermo (*.raw);;") //TODO: Sahil-Kiran, Added while merging mainwindow
 							+ tr("Maven Project File (*.mzroll);;")
 							+ tr("Maven Peaks File (*.mzPeaks);;")
+							+ tr("Maven Binary Peak Table (*.mzrollb);;")
 							+ tr("Peptide XML(*.pep.xml *.pepXML);;")
 							+ tr("Peptide idpDB(*.idpDB);;")
 							+ tr("All Files(*.*)"));
@@ -2738,7 +2748,7 @@ void MainWindow::setPeakGroup(PeakGroup* group) {
 	searchText->setText(QString::number(group->meanMz, 'f', 8));
 
 	if (eicWidget && eicWidget->isVisible()) {
-		eicWidget->setPeakGroup(group);
+		eicWidget->setPeakGroupAsync(group);
 	}
 
 	if (isotopeWidget && isotopeWidget->isVisible() && group->compound != NULL) {
@@ -3579,6 +3589,10 @@ void MainWindow::markGroup(PeakGroup* group, char label) {
 		return;
 
 	group->setLabel(label);
+	Q_FOREACH(QPointer<TableDockWidget> table, getPeakTableList()) {
+		if (table) table->logLabel(group);
+	}
+	if (bookmarkedPeaks) bookmarkedPeaks->logLabel(group);
 	bookmarkPeakGroup(group);
 	//if (getClassifier()) { getClassifier()->refineModel(group); }
 	//getPlotWidget()->scene()->update();
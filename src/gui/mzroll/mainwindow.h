@@ -237,7 +237,7 @@ public:
 	void autoSaveSignal();
 	void normalizeIsotopicMatrix(MatrixXf &MM);
 
-	void savePeaksTable(TableDockWidget* peaksTable, QString fileName, QString tableName);
+	void savePeaksTable(TableDockWidget* peaksTable, QString fileName, QString tableName, bool incremental = false);
 
     mzSample* getSampleByName(QString sampleName); //TODO: Sahil, Added this while merging mzfile
 	void setIsotopicPlotStyling();
@@ -270,7 +270,11 @@ public:
 	// bool isSampleFileType(QString filename);
 	// bool isProjectFileType(QString filename);
 	bool askAutosave();
-	void saveMzRoll();
+	/**
+	 * @param incremental append to the journals of tables saved before instead
+	 * of saving them in full, see TableDockWidget::saveJournal
+	 */
+	void saveMzRoll(bool incremental = false);
 	bool doAutosave;
 	int askAutosaveMain;
 	void loadPollySettings(QString fileName);
@@ -443,7 +447,7 @@ private:
 	QString fileName;
 	QString newFileName;
 	void saveMzRollList(QString MzrollFileName);
-	void saveMzRollAllTables();
+	void saveMzRollAllTables(bool incremental = false);
     void checkCorruptedSampleInjectionOrder();
     void warningForInjectionOrders(QMap<int, QList<mzSample*>>, QList<mzSample*>);
 
@@ -94,235 +94,59 @@ mzSample* mzFileIO::loadSample(QString filename){
     return NULL;
 }
 
-int mzFileIO::loadMassBankLibrary(QString fileName) {
-    qDebug() << "Loading Nist Libary: " << fileName;
-    QFile data(fileName);
-
-    if (!data.open(QFile::ReadOnly) ) {
-        qDebug() << "Can't open " << fileName; 
-        return 0;
-    }
-
-    string dbfilename = fileName.toStdString();
-    string dbname = mzUtils::cleanFilename(dbfilename);
-
-   QTextStream stream(&data);
-
-   /* sample
-ACCESSION: PR100458
-RECORD_TITLE: Cyanidin-3-O-(2''-O-beta-glucopyranosyl-beta-glucopyranoside); LC-ESI-QTOF; MS2; CE:Ramp 5-60 V; [M]+
-CH$NAME: Cyanidin-3-O-(2''-O-beta-glucopyranosyl-beta-glucopyranoside)
-CH$NAME: Cy 3-Soph
-CH$NAME: cyanidin-3-sophoroside
-CH$COMPOUND_CLASS: Anthocyanidin
-CH$FORMULA: C27H31O16
-CH$EXACT_MASS: 611.16121
-CH$SMILES: c(c(c([o+1]4)c(cc(c(O)5)c(cc(O)c5)4)OC(O2)C(OC(O3)C(C(C(C3CO)O)O)O)C(C(C2CO)O)O)1)c(O)c(O)cc1
-CH$IUPAC: InChI=1S/C27H30O16/c28-7-17-19(34)21(36)23(38)26(41-17)43-25-22(37)20(35)18(8-29)42-27(25)40-16-6-11-13(32)4-10(30)5-15(11)39-24(16)9-1-2-12(31)14(33)3-9/h1-6,17-23,25-29,34-38H,7-8H2,(H3-,30,31,32,33)/p+1/t17-,18-,19-,20-,21+,22+,23-,25-,26+,27-/m1/s1
-CH$LINK: CAS 38820-68-7
-CH$LINK: CHEMSPIDER 9344547
-CH$LINK: KEGG C16306
-CH$LINK: KNAPSACK C00006658
-CH$LINK: PUBCHEM CID:11169452
-PK$NUM_PEAK: 4
-PK$PEAK: m/z int. rel.int.
-  213.0567 47.98 11
-  287.0564 4418 999
-  288.0616 60.38 14
-  611.1612 927.9 210
-//
-   */
-
-   QRegExp whiteSpace("\\s+");
-   QRegExp formulaMatch("(C\\d+H\\d+\\S*)");
-
-   int charge=0;
-   QString line;
-   QString id,name, comment,formula,title;
-   QStringList compound_class;
-   QStringList alias;
-   double mw=0;
-   double precursor=0;
-   int peaks=0;
-   vector<float>mzs;
-   vector<float>intest;
-
-   int compoundCount=0;
-
-    do {
-        line = stream.readLine();
-
-        if(line.startsWith("//",Qt::CaseInsensitive) && !name.isEmpty()) {
-            if (!name.isEmpty()) { //insert new compound
-               Compound* cpd = new Compound( id.toStdString(), name.toStdString(), formula.toStdString(), charge);
-               cpd->precursorMz=precursor;
-               cpd->db=dbname;
-               cpd->fragment_mzs = mzs;
-               cpd->fragment_intensity = intest;
-			   Q_FOREACH (QString cat, compound_class) { cpd->category.push_back(cat.toStdString()); }
-               DB.addCompound(cpd);
-               compoundCount++;
-            }
-
-            //reset for the next record
-           name = comment = formula = title=QString();
-		   compound_class = alias = QStringList();
-           mw=precursor=0;
-           peaks=0;
-           mzs.clear();
-           intest.clear();
-        }
+mzFileIO::~mzFileIO() {
+    for (map<string, SpectralLibrary*>::iterator it = _spectralLibraries.begin(); it != _spectralLibraries.end(); it++)
+        delete it->second;
+}
 
-         if(line.startsWith("ACCESSION:",Qt::CaseInsensitive)) {
-             id = line.mid(10,line.length()).simplified();
-			 //qDebug() << "ID=" << id;
-         } else if (line.startsWith("CH$NAME:",Qt::CaseInsensitive)) {
-             QString aliasname = line.mid(9,line.length()).simplified();
-			 alias << aliasname;
-			 if (name.isEmpty() ) name = aliasname;
-			 //qDebug() << "NAME=" << name;
-         } else if (line.startsWith("CH$COMPOUND_CLASS:",Qt::CaseInsensitive)) {
-             QString comp_class = line.mid(19,line.length()).simplified();
-			 compound_class << comp_class;
-         } else if (line.startsWith("CH$EXACT_MASS:",Qt::CaseInsensitive)) {
-             precursor = line.mid(14,line.length()).simplified().toDouble();
-			 //qDebug() << "PRECURSOR=" << precursor;
-         } else if (line.startsWith("CH$FORMULA:",Qt::CaseInsensitive)) {
-            formula = line.mid(12,line.length()).simplified();
-			 //qDebug() << "FORMULA=" << formula;
-         } else if (line.startsWith("PK$NUM_PEAK:",Qt::CaseInsensitive)) {
-             peaks = line.mid(12,line.length()).simplified().toInt();
-			 //qDebug() << "NUM_PEAK=" << peaks;
-         } else if (line.startsWith("RECORD_TITLE:",Qt::CaseInsensitive)) {
-             title = line.mid(13,line.length()).simplified();
-         } else if (line.startsWith("PK$PEAK:",Qt::CaseInsensitive)) {
-			 continue;
-         } else if ( peaks != 0 ) {
-			 line = line.simplified();
-             QStringList mzintpair = line.split(whiteSpace);
-             if( mzintpair.size() >=2 ) {
-                 bool ok=false; bool ook=false;
-                 float mz = mzintpair.at(0).toDouble(&ok);
-                 float ints = mzintpair.at(1).toDouble(&ook);
-                 if (ok && ook && mz >= 0 && ints >= 0) {
-                     mzs.push_back(mz); intest.push_back(ints);
-			 		 //qDebug() << "PEAK=" << mz << ints;
-                 }
-             }
-         }
-    } while (!line.isNull());
-    return compoundCount;
+int mzFileIO::loadMassBankLibrary(QString fileName) {
+    return loadSpectralLibrary(fileName, SpectralLibrary::MassBank);
 }
-//TODO: Shouldnot be here
+
 int mzFileIO::loadNISTLibrary(QString fileName) {
-    qDebug() << "Loading Nist Libary: " << fileName;
-    QFile data(fileName);
+    return loadSpectralLibrary(fileName, SpectralLibrary::NIST);
+}
 
-    if (!data.open(QFile::ReadOnly) ) {
-        qDebug() << "Can't open " << fileName; 
-        return 0;
-    }
+int mzFileIO::loadSpectralLibrary(QString fileName, SpectralLibrary::Format format) {
+    qDebug() << "Loading spectral libary: " << fileName;
 
+    //parsed once into an index next to the library, later loads map it
     string dbfilename = fileName.toStdString();
     string dbname = mzUtils::cleanFilename(dbfilename);
 
-   QTextStream stream(&data);
-
-   /* sample
-   Name: DGDG 8:0; [M-H]-; DGDG(2:0/6:0)
-   MW: 555.22888
-   PRECURSORMZ: 555.22888
-   Comment: Parent=555.22888 Mz_exact=555.22888 ; DGDG 8:0; [M-H]-; DGDG(2:0/6:0); C23H40O15
-   Num Peaks: 2
-   115.07586 999 "sn2 FA"
-   59.01330 999 "sn1 FA"
-   */
-
-   QRegExp whiteSpace("\\s+");
-   QRegExp formulaMatch("Formula\\=(C\\d+H\\d+\\S*)");
-   QRegExp retentionTimeMatch("AvgRt\\=(\\S+)");
-
-   int charge=0;
-   QString line;
-   QString name, comment,formula;
-   double retentionTime;
-   double mw=0;
-   double precursor=0;
-   int peaks=0;
-   vector<float>mzs;
-   vector<float>intest;
-
-   int compoundCount=0;
-
-    do {
-        line = stream.readLine();
-
-        if(line.startsWith("Name:",Qt::CaseInsensitive) && !name.isEmpty()) {
-            if (!name.isEmpty()) { //insert new compound
-
-                Compound* cpd = new Compound(
-                           name.toStdString(),
-                           name.toStdString(),
-                           formula.toStdString(),
-                           charge);
-			   if (precursor and mw) { cpd->mass=precursor; cpd->precursorMz=precursor; }
-			   else if (mw) { cpd->mass=mw; cpd->precursorMz=precursor; }
-               //cpd->mass=mw;
-               //cpd->precursorMz=mw;
-               cpd->db=dbname;
-               cpd->fragment_mzs = mzs;
-               cpd->fragment_intensity = intest;
-			   cpd->expectedRt=retentionTime;
-               DB.addCompound(cpd);
-               compoundCount++;
-            }
-
-            //reset for the next record
-           name = comment = formula = QString();
-           mw=precursor=0;
-		   retentionTime=0;
-           peaks=0;
-           mzs.clear();
-           intest.clear();
-        }
+    //a reload may rebuild the index, which can't be replaced while mapped
+    if (_spectralLibraries.count(dbname)) {
+        delete _spectralLibraries[dbname];
+        _spectralLibraries.erase(dbname);
+    }
 
-         if(line.startsWith("Name:",Qt::CaseInsensitive)) {
-             name = line.mid(5,line.length()).simplified();
-         } else if (line.startsWith("MW:",Qt::CaseInsensitive)) {
-             mw = line.mid(4,line.length()).simplified().toDouble();
-         } else if (line.startsWith("PRECURSORMZ:",Qt::CaseInsensitive)) {
-             precursor = line.mid(13,line.length()).simplified().toDouble();
-         } else if (line.startsWith("Comment:",Qt::CaseInsensitive)) {
-             comment = line.mid(8,line.length()).simplified();
-             if (comment.contains(formulaMatch)){
-                 formula=formulaMatch.capturedTexts().at(1);
-                 qDebug() << "Formula=" << formula;
-             }
-			if (comment.contains(retentionTimeMatch)){
-                 retentionTime=retentionTimeMatch.capturedTexts().at(1).simplified().toDouble();
-                 //qDebug() << "retentionTime=" << retentionTimeString;
-             }
-         } else if (line.startsWith("Num Peaks:",Qt::CaseInsensitive) || line.startsWith("NumPeaks:",Qt::CaseInsensitive)) {
-            //  peaks = line.mid(11,line.length()).simplified().toInt();
-             peaks = 1;
-         } else if ( peaks ) {
-             QStringList mzintpair = line.split(whiteSpace);
-             if( mzintpair.size() >=2 ) {
-                 bool ok=false; bool ook=false;
-                 float mz = mzintpair.at(0).toDouble(&ok);
-                 float ints = mzintpair.at(1).toDouble(&ook);
-                 if (ok && ook && mz >= 0 && ints >= 0) {
-                     mzs.push_back(mz);
-                     intest.push_back(ints);
-                 }
-             }
-         }
-
-    } while (!line.isNull());
+    SpectralLibrary* library = new SpectralLibrary();
+    if (!library->load(dbfilename, format)) {
+        qDebug() << "Can't load " << fileName << library->errorMessage.c_str();
+        delete library;
+        return 0;
+    }
+    if (!library->errorMessage.empty())
+        qDebug() << "Index of " << fileName << " kept in the temporary folder: "
+                 << library->errorMessage.c_str();
+
+    int compoundCount=0;
+    for (unsigned int i = 0; i < library->size(); i++) {
+        DB.addCompound(library->compound(i, dbname));
+        compoundCount++;
+    }
 
+    _spectralLibraries[dbname] = library;
     return compoundCount;
 }
 
+vector<SpectralLibrary*> mzFileIO::spectralLibraries() {
+    vector<SpectralLibrary*> libraries;
+    for (map<string, SpectralLibrary*>::iterator it = _spectralLibraries.begin(); it != _spectralLibraries.end(); it++)
+        libraries.push_back(it->second);
+    return libraries;
+}
+
 //TODO: Should not be here
 int mzFileIO::loadPepXML(QString fileName) {
 
@@ -680,7 +504,7 @@ bool mzFileIO::isSpectralHitType(QString filename) {
 
 bool mzFileIO::isPeakListType(QString filename) {
     QStringList extList;
-    extList << "mzPeaks";
+    extList << "mzPeaks" << "mzrollb";
     Q_FOREACH (QString suffix, extList) {
         if (filename.endsWith(suffix,Qt::CaseInsensitive)) return true;
     }
@@ -3,6 +3,7 @@
 #include "globals.h"
 #include "mainwindow.h"
 #include "mzAligner.h"
+#include "spectralLibrary.h"
 
 
 class ProjectDockWidget;
@@ -18,6 +19,7 @@ Q_OBJECT
 
     public:
         mzFileIO(QWidget*);
+        ~mzFileIO();
         void qtSlot(const string& progressText, unsigned int completed_samples, int total_samples);
         /**
          * [set File List]
@@ -58,6 +60,20 @@ Q_OBJECT
          */
         int loadNISTLibrary(QString filename);        
         int loadMassBankLibrary(QString filename); //TODO: Sahil, Added while merging mzfileio
+
+        /**
+         * [load MS/MS library through its on-disk index]
+         * @param  filename [name of the file]
+         * @param  format   [NIST .msp/.sptxt or MassBank]
+         * @return          [number of compounds added to DB]
+         */
+        int loadSpectralLibrary(QString filename, SpectralLibrary::Format format);
+
+        /**
+         * [loaded MS/MS libraries, one per database]
+         * @return          [libraries, owned by mzFileIO]
+         */
+        vector<SpectralLibrary*> spectralLibraries();
         /**
          * [load Pep XML]
          * @param  filename [name of the file]
@@ -113,6 +129,7 @@ Q_OBJECT
          ProjectDockWidget* projectdocwidget;
          bool _stopped;
          QProcess* process; //TODO: Sahil, Added while merging mzfileio
+         map<string, SpectralLibrary*> _spectralLibraries;
 
 
 };
@@ -116,6 +116,7 @@ HEADERS +=  stable.h \
                     comparesamplesdialog.h \
                     traindialog.h \
                     tabledockwidget.h  \
+                    peaktablemodel.h \
                     treedockwidget.h  \
                     heatmap.h  \
                     treemap.h  \
@@ -179,6 +180,7 @@ database.cpp \
  eicwidget.cpp \
  plot_axes.cpp \
  tabledockwidget.cpp \
+ peaktablemodel.cpp \
  peakdetectiondialog.cpp \
  pollyelmaveninterface.cpp \
  comparesamplesdialog.cpp \
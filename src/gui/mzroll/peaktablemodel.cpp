@@ -0,0 +1,533 @@
+#include "peaktablemodel.h"
+#include "tabledockwidget.h"
+#include "mavenparameters.h"
+
+PeakTableModel::Node::Node(PeakGroup* g, Node* p) {
+	group = g;
+	clusterId = g ? g->clusterId : 0;
+	clusterRt = 0;
+	parent = p;
+	row = 0;
+	childrenBuilt = (g == NULL);
+	valuesGeneration = 0;
+}
+
+PeakTableModel::Node::~Node() {
+	for (unsigned int i = 0; i < children.size(); i++) delete children[i];
+}
+
+bool PeakTableModel::SortKeyLess::operator()(const SortKey& a, const SortKey& b) const {
+	if (byText) {
+		int c = collator->compare(a.text, b.text);
+		return ascending ? c < 0 : c > 0;
+	}
+	return ascending ? a.value < b.value : b.value < a.value;
+}
+
+PeakTableModel::PeakTableModel(TableDockWidget* table) : QAbstractItemModel(table) {
+	_table = table;
+	_root = new Node(NULL, NULL);
+	_generation = 1;
+	_filtered = false;
+	_sortColumn = -1;
+	_sortOrder = Qt::AscendingOrder;
+}
+
+PeakTableModel::~PeakTableModel() {
+	delete _root;
+}
+
+void PeakTableModel::setColumns(const QStringList& headers, const vector<mzSample*>& samples) {
+	beginResetModel();
+	_headers = headers;
+	_samples = samples;
+	_generation++;
+	endResetModel();
+}
+
+bool PeakTableModel::accepts(PeakGroup* group, bool topLevel) const {
+	if (group == NULL) return false;
+	if (group->peakCount() == 0) return false;
+	if (group->meanMz <= 0) return false;
+
+	if (_table->filtersDialog->isVisible()) {
+		float minG = _table->sliders["GoodPeakCount"]->minBoundValue();
+		float maxG = _table->sliders["GoodPeakCount"]->maxBoundValue();
+		if (group->goodPeakCount < minG || group->goodPeakCount > maxG) return false;
+	}
+
+	if (topLevel && _table->focusedGroupsOnly && !group->isFocused) return false;
+	return true;
+}
+
+PeakTableModel::Node* PeakTableModel::addCluster(int clusterId, float rt) {
+	Node* cluster = new Node(NULL, _root);
+	cluster->clusterId = clusterId;
+	cluster->clusterRt = rt;
+	cluster->row = _root->children.size();
+	_root->children.push_back(cluster);
+	_clusters.insert(clusterId, cluster);
+	return cluster;
+}
+
+PeakTableModel::Node* PeakTableModel::addNode(Node* parent, PeakGroup* group) const {
+	Node* node = new Node(group, parent);
+	node->row = parent->children.size();
+	parent->children.push_back(node);
+	_nodes.insert(group, node);
+	return node;
+}
+
+void PeakTableModel::rebuild() {
+	beginResetModel();
+	delete _root;
+	_root = new Node(NULL, NULL);
+	_nodes.clear();
+	_clusters.clear();
+	_generation++;
+	_filtered = _table->filtersDialog->isVisible() || _table->focusedGroupsOnly;
+
+	QList<PeakGroup>& groups = _table->allgroups;
+	for (int i = 0; i < groups.size(); i++) {
+		PeakGroup* group = &groups[i];
+		if (!accepts(group, true)) continue;
+
+		Node* parent = _root;
+		if (group->clusterId) {
+			parent = _clusters.value(group->clusterId, NULL);
+			if (parent == NULL) parent = addCluster(group->clusterId, group->meanRt);
+		}
+		addNode(parent, group);
+	}
+	endResetModel();
+}
+
+void PeakTableModel::clear() {
+	beginResetModel();
+	delete _root;
+	_root = new Node(NULL, NULL);
+	_nodes.clear();
+	_clusters.clear();
+	_filtered = false;
+	endResetModel();
+}
+
+void PeakTableModel::refresh() {
+	_generation++;
+	int rows = _root->children.size();
+	if (rows == 0 || _headers.size() == 0) return;
+	Q_EMIT dataChanged(index(0, 0), index(rows - 1, _headers.size() - 1));
+}
+
+void PeakTableModel::groupChanged(PeakGroup* group) {
+	Node* node = _nodes.value(group, NULL);
+	if (node == NULL || _headers.size() == 0) return;
+	node->valuesGeneration = 0;
+	Q_EMIT dataChanged(indexOfNode(node, 0), indexOfNode(node, _headers.size() - 1));
+}
+
+void PeakTableModel::appendGroup(PeakGroup* group) {
+	if (!accepts(group, true)) return;
+
+	Node* parent = _root;
+	if (group->clusterId) {
+		parent = _clusters.value(group->clusterId, NULL);
+		if (parent == NULL) {
+			int row = _root->children.size();
+			beginInsertRows(QModelIndex(), row, row);
+			parent = addCluster(group->clusterId, group->meanRt);
+			endInsertRows();
+		}
+	}
+
+	int row = parent->children.size();
+	beginInsertRows(indexOfNode(parent), row, row);
+	addNode(parent, group);
+	endInsertRows();
+}
+
+void PeakTableModel::forget(Node* node) {
+	if (node->group) _nodes.remove(node->group);
+	else if (node->clusterId) _clusters.remove(node->clusterId);
+	for (unsigned int i = 0; i < node->children.size(); i++) forget(node->children[i]);
+}
+
+void PeakTableModel::renumber(Node* node) const {
+	for (unsigned int i = 0; i < node->children.size(); i++) node->children[i]->row = i;
+}
+
+void PeakTableModel::removeGroup(PeakGroup* group) {
+	Node* node = _nodes.value(group, NULL);
+	if (node == NULL) return;
+
+	Node* parent = node->parent;
+	beginRemoveRows(indexOfNode(parent), node->row, node->row);
+	parent->children.erase(parent->children.begin() + node->row);
+	forget(node);
+	delete node;
+	renumber(parent);
+	endRemoveRows();
+
+	//drop clusters that lost their last member
+	if (parent != _root && parent->group == NULL && parent->children.empty()) {
+		beginRemoveRows(QModelIndex(), parent->row, parent->row);
+		_root->children.erase(_root->children.begin() + parent->row);
+		forget(parent);
+		delete parent;
+		renumber(_root);
+		endRemoveRows();
+	}
+}
+
+bool PeakTableModel::deleteChild(PeakGroup* child) {
+	PeakGroup* parentGroup = child->parent;
+	if (parentGroup == NULL) return false;
+
+	Node* parentNode = _nodes.value(parentGroup, NULL);
+	QModelIndex parentIndex = indexOfNode(parentNode);
+
+	//erasing from the children vector moves every later sibling
+	if (parentNode && parentNode->childrenBuilt && !parentNode->children.empty()) {
+		beginRemoveRows(parentIndex, 0, parentNode->children.size() - 1);
+		for (unsigned int i = 0; i < parentNode->children.size(); i++) {
+			forget(parentNode->children[i]);
+			delete parentNode->children[i];
+		}
+		parentNode->children.clear();
+		endRemoveRows();
+	}
+
+	bool deleted = parentGroup->deleteChild(child);
+
+	if (parentNode && parentNode->childrenBuilt) {
+		int rows = 0;
+		for (unsigned int i = 0; i < parentGroup->children.size(); i++) {
+			if (accepts(&parentGroup->children[i], false)) rows++;
+		}
+		if (rows > 0) {
+			beginInsertRows(parentIndex, 0, rows - 1);
+			parentNode->childrenBuilt = false;
+			childrenOf(parentNode);
+			endInsertRows();
+		}
+	}
+	return deleted;
+}
+
+PeakTableModel::Node* PeakTableModel::nodeFor(const QModelIndex& index) const {
+	if (!index.isValid()) return _root;
+	return static_cast<Node*>(index.internalPointer());
+}
+
+QModelIndex PeakTableModel::indexOfNode(Node* node, int column) const {
+	if (node == NULL || node == _root) return QModelIndex();
+	return createIndex(node->row, column, node);
+}
+
+const vector<PeakTableModel::Node*>& PeakTableModel::childrenOf(Node* node) const {
+	if (!node->childrenBuilt) {
+		node->childrenBuilt = true;
+		PeakGroup* group = node->group;
+		for (unsigned int i = 0; i < group->children.size(); i++) {
+			if (accepts(&group->children[i], false)) addNode(node, &group->children[i]);
+		}
+		if (_sortColumn >= 0 && _sortColumn < _headers.size()) {
+			QCollator collator;
+			collator.setNumericMode(true);
+			sortNode(node, _sortColumn, _sortOrder, false, collator);
+		}
+	}
+	return node->children;
+}
+
+PeakGroup* PeakTableModel::groupAt(const QModelIndex& index) const {
+	if (!index.isValid()) return NULL;
+	return nodeFor(index)->group;
+}
+
+QModelIndex PeakTableModel::indexOf(PeakGroup* group) const {
+	return indexOfNode(_nodes.value(group, NULL));
+}
+
+bool PeakTableModel::isCluster(const QModelIndex& index) const {
+	if (!index.isValid()) return false;
+	return nodeFor(index)->group == NULL;
+}
+
+QModelIndex PeakTableModel::index(int row, int column, const QModelIndex& parent) const {
+	if (row < 0 || column < 0 || column >= _headers.size()) return QModelIndex();
+	if (parent.isValid() && parent.column() != 0) return QModelIndex();
+
+	const vector<Node*>& children = childrenOf(nodeFor(parent));
+	if (row >= (int) children.size()) return QModelIndex();
+	return createIndex(row, column, children[row]);
+}
+
+QModelIndex PeakTableModel::parent(const QModelIndex& index) const {
+	if (!index.isValid()) return QModelIndex();
+	return indexOfNode(nodeFor(index)->parent);
+}
+
+int PeakTableModel::rowCount(const QModelIndex& parent) const {
+	if (parent.column() > 0) return 0;
+	return childrenOf(nodeFor(parent)).size();
+}
+
+int PeakTableModel::columnCount(const QModelIndex& parent) const {
+	return _headers.size();
+}
+
+bool PeakTableModel::hasChildren(const QModelIndex& parent) const {
+	if (parent.column() > 0) return false;
+	Node* node = nodeFor(parent);
+	if (!node->childrenBuilt) return node->group->childCount() > 0;
+	return !node->children.empty();
+}
+
+void PeakTableModel::computeValues(Node* node) const {
+	if (node->valuesGeneration == _generation) return;
+	node->valuesGeneration = _generation;
+
+	//rt column and one column per sample, colored as a heatmap
+	PeakGroup* group = node->group;
+	node->values.clear();
+	node->values.push_back(group->meanRt);
+	vector<float> yvalues = group->getOrderedIntensityVector(_samples, _table->_mainwindow->getUserQuantType());
+	node->values.insert(node->values.end(), yvalues.begin(), yvalues.end());
+
+	float max = node->values[0];
+	for (unsigned int i = 1; i < node->values.size(); i++) max = std::max(max, node->values[i]);
+
+	node->colors.assign(node->values.size(), QColor(Qt::white));
+	for (unsigned int i = 0; i < node->values.size(); i++) {
+		float prob = node->values[i];
+		if (max != 0) prob = std::abs((max - prob) / max);
+		if (prob < 0) prob = 0;
+		if (prob > 1) prob = 1;
+		node->colors[i].setHsvF(0.0, prob, 1, 1);
+	}
+}
+
+QString PeakTableModel::text(const Node* node, int column) const {
+	PeakGroup* group = node->group;
+	if (group == NULL) {
+		if (column == 0) return QString("Cluster ") + QString::number(node->clusterId);
+		if (column == 5) return QString::number(node->clusterRt, 'f', 2);
+		return QString();
+	}
+
+	switch (column) {
+		case 0: return QString::number(group->groupId);
+		case 1: return QString(group->getName().c_str());
+		case 2: return QString::number(group->meanMz, 'f', 4);
+		case 3: {
+			int charge = _table->_mainwindow->mavenParameters->getCharge(group->compound);
+			double mz = group->getExpectedMz(charge);
+			if (mz != -1) return QString::number(mz, 'f', 4);
+			return QString("NA");
+		}
+		case 4: return QString::number(group->meanRt, 'f', 2);
+	}
+
+	if (_table->viewType == TableDockWidget::groupView) {
+		switch (column) {
+			case 5: return QString::number(group->expectedRtDiff, 'f', 2);
+			case 6: return QString::number(group->sampleCount);
+			case 7: return QString::number(group->goodPeakCount);
+			case 8: return QString::number(group->maxNoNoiseObs);
+			case 9: return QString::number(_table->extractMaxIntensity(group), 'g', 2);
+			case 10: return QString::number(group->maxSignalBaselineRatio, 'f', 0);
+			case 11: return QString::number(group->maxQuality, 'f', 2);
+			case 12: return QString::number(group->groupRank, 'e', 6);
+			case 13: return QString::number(group->changeFoldRatio, 'f', 3);
+			case 14: return QString::number(group->changePValue, 'f', 6);
+		}
+		return QString();
+	}
+
+	Node* mutableNode = const_cast<Node*>(node);
+	computeValues(mutableNode);
+	unsigned int i = column - 4;
+	if (i < node->values.size()) return QString::number(node->values[i]);
+	return QString();
+}
+
+double PeakTableModel::sortValue(const Node* node, int column) const {
+	PeakGroup* group = node->group;
+	if (group == NULL) {
+		if (column == 0) return node->clusterId;
+		if (column == 5) return node->clusterRt;
+		return 0;
+	}
+
+	switch (column) {
+		case 0: return group->groupId;
+		case 2: return group->meanMz;
+		case 3: return group->getExpectedMz(_table->_mainwindow->mavenParameters->getCharge(group->compound));
+		case 4: return group->meanRt;
+	}
+
+	if (_table->viewType == TableDockWidget::groupView) {
+		switch (column) {
+			case 5: return group->expectedRtDiff;
+			case 6: return group->sampleCount;
+			case 7: return group->goodPeakCount;
+			case 8: return group->maxNoNoiseObs;
+			case 9: return _table->extractMaxIntensity(group);
+			case 10: return group->maxSignalBaselineRatio;
+			case 11: return group->maxQuality;
+			case 12: return group->groupRank;
+			case 13: return group->changeFoldRatio;
+			case 14: return group->changePValue;
+		}
+		return 0;
+	}
+
+	Node* mutableNode = const_cast<Node*>(node);
+	computeValues(mutableNode);
+	unsigned int i = column - 4;
+	return i < node->values.size() ? node->values[i] : 0;
+}
+
+QVariant PeakTableModel::background(Node* node, int column) const {
+	PeakGroup* group = node->group;
+	if (group == NULL) return QVariant();
+
+	if (column == 0) {
+		//groups whose label disagrees with their peak qualities
+		int good = 0; int bad = 0;
+		int total = group->peakCount();
+		for (int i = 0; i < total; i++) {
+			group->peaks[i].quality > _table->_mainwindow->mavenParameters->minQuality ? good++ : bad++;
+		}
+
+		if (good > 0 && group->label == 'b') {
+			float incorrectFraction = ((float) good) / total;
+			return QBrush(QColor::fromRgbF(0.8, 0, 0, incorrectFraction));
+		} else if (bad > 0 && group->label == 'g') {
+			float incorrectFraction = ((float) bad) / total;
+			return QBrush(QColor::fromRgbF(0.8, 0, 0, incorrectFraction));
+		}
+		return QVariant();
+	}
+
+	if (_table->viewType == TableDockWidget::peakView && column >= 4) {
+		computeValues(node);
+		unsigned int i = column - 4;
+		if (i < node->colors.size()) return QBrush(node->colors[i]);
+	}
+	return QVariant();
+}
+
+QVariant PeakTableModel::data(const QModelIndex& index, int role) const {
+	if (!index.isValid()) return QVariant();
+	Node* node = nodeFor(index);
+	int column = index.column();
+
+	switch (role) {
+		case Qt::DisplayRole:
+			return text(node, column);
+		case Qt::UserRole:
+			if (node->group) return QVariant::fromValue(node->group);
+			return QVariant();
+		case Qt::DecorationRole:
+			if (column == 0 && node->group) {
+				if (node->group->label == 'g') return QIcon(":/images/good.png");
+				if (node->group->label == 'b') return QIcon(":/images/bad.png");
+			}
+			return QVariant();
+		case Qt::BackgroundRole:
+			return background(node, column);
+	}
+	return QVariant();
+}
+
+QVariant PeakTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+	if (section < 0 || section >= _headers.size()) return QVariant();
+	return _headers[section];
+}
+
+bool PeakTableModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role) {
+	if (orientation != Qt::Horizontal) return false;
+	if (role != Qt::EditRole && role != Qt::DisplayRole) return false;
+	if (section < 0 || section >= _headers.size()) return false;
+
+	_headers[section] = value.toString();
+	Q_EMIT headerDataChanged(orientation, section, section);
+	return true;
+}
+
+Qt::ItemFlags PeakTableModel::flags(const QModelIndex& index) const {
+	if (!index.isValid()) return 0;
+	if (isCluster(index)) return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+	return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+}
+
+void PeakTableModel::sortNode(Node* node, int column, Qt::SortOrder order, bool recursive,
+							  const QCollator& collator) const {
+	vector<Node*>& children = node->children;
+	if (children.size() > 1) {
+		//keys are computed once per row instead of once per comparison
+		vector<SortKey> keys(children.size());
+		bool byText = (column == 1);
+		for (unsigned int i = 0; i < children.size(); i++) {
+			keys[i].node = children[i];
+			if (byText) keys[i].text = text(children[i], column);
+			else keys[i].value = sortValue(children[i], column);
+		}
+
+		SortKeyLess less;
+		less.byText = byText;
+		less.ascending = (order == Qt::AscendingOrder);
+		less.collator = &collator;
+		std::stable_sort(keys.begin(), keys.end(), less);
+
+		for (unsigned int i = 0; i < keys.size(); i++) children[i] = keys[i].node;
+		renumber(node);
+	}
+
+	if (!recursive) return;
+	for (unsigned int i = 0; i < children.size(); i++) {
+		if (children[i]->childrenBuilt) sortNode(children[i], column, order, true, collator);
+	}
+}
+
+void PeakTableModel::updatePersistentIndexes(const QModelIndexList& before) {
+	QModelIndexList after;
+	Q_FOREACH(QModelIndex index, before) {
+		Node* node = nodeFor(index);
+		after << createIndex(node->row, index.column(), node);
+	}
+	changePersistentIndexList(before, after);
+}
+
+void PeakTableModel::sort(int column, Qt::SortOrder order) {
+	_sortColumn = column;
+	_sortOrder = order;
+	if (column < 0 || column >= _headers.size()) return;
+
+	QCollator collator;
+	collator.setNumericMode(true);
+
+	Q_EMIT layoutAboutToBeChanged();
+	QModelIndexList before = persistentIndexList();
+	sortNode(_root, column, order, true, collator);
+	updatePersistentIndexes(before);
+	Q_EMIT layoutChanged();
+}
+
+void PeakTableModel::sortChildren(const QModelIndex& parent, int column, Qt::SortOrder order) {
+	if (column < 0 || column >= _headers.size()) return;
+	Node* node = nodeFor(parent);
+	if (!node->childrenBuilt) return;
+
+	QCollator collator;
+	collator.setNumericMode(true);
+
+	Q_EMIT layoutAboutToBeChanged();
+	QModelIndexList before = persistentIndexList();
+	sortNode(node, column, order, false, collator);
+	updatePersistentIndexes(before);
+	Q_EMIT layoutChanged();
+}
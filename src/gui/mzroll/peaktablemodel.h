@@ -0,0 +1,169 @@
+#ifndef PEAKTABLEMODEL_H
+#define PEAKTABLEMODEL_H
+
+#include "stable.h"
+#include "mzSample.h"
+
+class TableDockWidget;
+
+/**
+ * @class PeakTableModel
+ * @ingroup mzroll
+ * @brief Virtual model over the groups of a TableDockWidget.
+ * @details Rows only hold a pointer to their group; text, icons and heatmap
+ * colors are computed when the view asks for them, i.e. for visible rows
+ * only. Top level rows are groups and "Cluster" rows, cluster members and
+ * isotope children are nested below them. Rows of children are created the
+ * first time a parent is expanded.
+ *
+ * Groups are owned by the table. Whenever groups are added, removed or moved
+ * in memory the model has to be told (appendGroup, removeGroup, deleteChild,
+ * rebuild) before any event reaches the view.
+ */
+class PeakTableModel : public QAbstractItemModel {
+Q_OBJECT
+
+public:
+	PeakTableModel(TableDockWidget* table);
+	~PeakTableModel();
+
+	/**
+	 * @brief set column titles
+	 * @param samples samples shown as intensity columns in peak view, empty
+	 * in group view
+	 */
+	void setColumns(const QStringList& headers, const vector<mzSample*>& samples);
+
+	/**
+	 * @brief recreate all rows from the groups of the table
+	 */
+	void rebuild();
+
+	/**
+	 * @brief drop all rows, call before the groups of the table are cleared
+	 */
+	void clear();
+
+	/**
+	 * @brief values of groups changed, rows stay the same
+	 */
+	void refresh();
+
+	/**
+	 * @brief values of one group changed
+	 */
+	void groupChanged(PeakGroup* group);
+
+	/**
+	 * @brief add a row for a group just appended to the table
+	 */
+	void appendGroup(PeakGroup* group);
+
+	/**
+	 * @brief remove the row of a top level group (or cluster member)
+	 * @details call before the group is erased from the table
+	 */
+	void removeGroup(PeakGroup* group);
+
+	/**
+	 * @brief delete a child group from its parent and update the rows
+	 * @details children are stored by value, so the rows of all siblings
+	 * are recreated
+	 * @return false if the child was not found in its parent
+	 */
+	bool deleteChild(PeakGroup* child);
+
+	/**
+	 * @brief sort the direct children of one row
+	 */
+	void sortChildren(const QModelIndex& parent, int column, Qt::SortOrder order);
+
+	/**
+	 * @return group shown in a row, NULL for cluster rows
+	 */
+	PeakGroup* groupAt(const QModelIndex& index) const;
+
+	/**
+	 * @return index of the row showing a group, invalid if it has no row
+	 */
+	QModelIndex indexOf(PeakGroup* group) const;
+
+	bool isCluster(const QModelIndex& index) const;
+
+	/**
+	 * @brief true if the last rebuild left out groups because of a filter
+	 */
+	bool isFiltered() const { return _filtered; }
+
+	QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+	QModelIndex parent(const QModelIndex& index) const;
+	int rowCount(const QModelIndex& parent = QModelIndex()) const;
+	int columnCount(const QModelIndex& parent = QModelIndex()) const;
+	bool hasChildren(const QModelIndex& parent = QModelIndex()) const;
+	QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+	bool setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role = Qt::EditRole);
+	Qt::ItemFlags flags(const QModelIndex& index) const;
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+	struct Node {
+		PeakGroup* group;		//NULL for cluster rows
+		int clusterId;
+		float clusterRt;
+		Node* parent;
+		int row;
+		bool childrenBuilt;
+		vector<Node*> children;
+
+		//peak view only, computed on first paint
+		unsigned int valuesGeneration;
+		vector<float> values;
+		vector<QColor> colors;
+
+		Node(PeakGroup* g, Node* p);
+		~Node();
+	};
+
+	struct SortKey {
+		Node* node;
+		double value;
+		QString text;
+	};
+
+	struct SortKeyLess {
+		bool byText;
+		bool ascending;
+		const QCollator* collator;
+		bool operator()(const SortKey& a, const SortKey& b) const;
+	};
+
+	TableDockWidget* _table;
+	Node* _root;
+	mutable QHash<PeakGroup*, Node*> _nodes;
+	QHash<int, Node*> _clusters;
+	QStringList _headers;
+	vector<mzSample*> _samples;
+	unsigned int _generation;
+	bool _filtered;
+	int _sortColumn;
+	Qt::SortOrder _sortOrder;
+
+	bool accepts(PeakGroup* group, bool topLevel) const;
+	Node* nodeFor(const QModelIndex& index) const;
+	QModelIndex indexOfNode(Node* node, int column = 0) const;
+	const vector<Node*>& childrenOf(Node* node) const;
+	void forget(Node* node);
+	void renumber(Node* node) const;
+	Node* addCluster(int clusterId, float rt);
+	Node* addNode(Node* parent, PeakGroup* group) const;
+	void sortNode(Node* node, int column, Qt::SortOrder order, bool recursive,
+				  const QCollator& collator) const;
+	void updatePersistentIndexes(const QModelIndexList& before);
+	void computeValues(Node* node) const;
+	double sortValue(const Node* node, int column) const;
+	QString text(const Node* node, int column) const;
+	QVariant background(Node* node, int column) const;
+};
+
+#endif
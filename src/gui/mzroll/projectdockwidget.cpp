@@ -1,5 +1,9 @@
 #include "projectdockwidget.h"
 
+#ifndef __APPLE__
+#include <omp.h>
+#endif
+
 ProjectDockWidget::ProjectDockWidget(QMainWindow *parent):
     QDockWidget("Samples", parent,Qt::Widget)
 {
@@ -659,12 +663,6 @@ void ProjectDockWidget::loadProject() {
 }
 
 void ProjectDockWidget::loadProject(QString fileName) {
-    int samplecount = 0;
-    QSettings* settings = _mainwindow->getSettings();
-
-    QFileInfo fileinfo(fileName);
-    QString projectPath = fileinfo.path();
-    QString projectName = fileinfo.fileName();
 
     QFile data(fileName);
     if ( !data.open(QFile::ReadOnly) ) {
@@ -673,50 +671,30 @@ void ProjectDockWidget::loadProject(QString fileName) {
         return;
     }
 
-    QXmlStreamReader xml(&data);
-    mzSample* currentSample=NULL;
-
-
-
+    //metadata pass: collect samples to load and their settings, load nothing yet
+    vector<ProjectSample> projectSamples;
+    QSet<QString> listedFiles;
+    Q_FOREACH(mzSample* loadedFile, _mainwindow->getSamples()) {
+        listedFiles.insert(QString(loadedFile->fileName.c_str()));
+    }
 
+    QXmlStreamReader xml(&data);
+    int currentSample = -1;
     QString projectDescription;
     QStringRef currentXmlElement;
 
-    int i=0;
-    while(!xml.atEnd()){
-        if (xml.isStartElement()) {
-         if (xml.name() == "sample") {
-        i++;}
-        }
-        xml.readNext();
-    }
-    data.seek(0);
-
-    xml.setDevice(xml.device());
-    QString progressText;
     while (!xml.atEnd()) {
         xml.readNext();
         if (xml.isStartElement()) {
             currentXmlElement = xml.name();
 
-
             if (xml.name() == "sample") {
+                currentSample = -1;
                 QString fname   = xml.attributes().value("filename").toString();
-                QString sname   = xml.attributes().value("name").toString();
-                QString setname   = xml.attributes().value("setName").toString();
-                QString sampleOrder   = xml.attributes().value("sampleOrder").toString();
-                QString isSelected   = xml.attributes().value("isSelected").toString();
-                //_mainwindow->setStatusText(tr("Loading sample: %1").arg(sname));
-                //_mainwindow->setProgressBar(tr("Loading Sample Number %1").arg(++currentSampleCount),currentSampleCount,currentSampleCount+1);
-
-                bool checkLoaded=false;
-                Q_FOREACH(mzSample* loadedFile, _mainwindow->getSamples()) {
-                    if (QString(loadedFile->fileName.c_str())== fname) checkLoaded=true;
-                }
 
-                if(checkLoaded == true) continue;  // skip files that have been loaded already
-                
-                samplecount++;
+                if (listedFiles.contains(fname)) continue;  // skip files that have been loaded already
+                listedFiles.insert(fname);
+
                 qDebug() << "Checking:" << fname;
                 QFileInfo sampleFile(fname);
                 if (!sampleFile.exists()) {
@@ -727,59 +705,104 @@ void ProjectDockWidget::loadProject(QString fileName) {
                         if (sampleFile.exists())  break;
                     }
                 }
-
-                QDir d = QFileInfo(fname).absoluteDir();
-                QString dStr = d.absolutePath();
-                progressText = "Importing files from " + dStr;
-
-                if ( !fname.isEmpty() ) {
-                    // mzFileIO* fileLoader = new mzFileIO(this);
-                    // fileLoader->setMainWindow(_mainwindow);
-                    // mzSample* sample = fileLoader->loadSample(fname);
-                    // delete(fileLoader);
-
-                    mzSample* sample = _mainwindow->fileLoader->loadSample(fname);
-                    if (sample) {
-                        _mainwindow->addSample(sample);
-                        currentSample=sample;
-                        if (!sname.isEmpty() )  		sample->sampleName = sname.toStdString();
-                        if (!setname.isEmpty() )  		sample->setSetName(setname.toStdString());
-                        if (!sampleOrder.isEmpty())     sample->setSampleOrder(sampleOrder.toInt());
-                        if (!isSelected.isEmpty()) 		sample->isSelected = isSelected.toInt();
-                    } else {
-                        currentSample=NULL;
-                    }
-                }
+                if (fname.isEmpty()) continue;
+
+                ProjectSample projectSample;
+                projectSample.fileName = fname;
+                projectSample.sampleName = xml.attributes().value("name").toString();
+                projectSample.setName = xml.attributes().value("setName").toString();
+                projectSample.sampleOrder = xml.attributes().value("sampleOrder").toString();
+                projectSample.isSelected = xml.attributes().value("isSelected").toString();
+                projectSample.hasColor = false;
+                projectSample.sample = NULL;
+                projectSamples.push_back(projectSample);
+                currentSample = projectSamples.size() - 1;
             }
 
-			//change sample color
-            if (xml.name() == "color" && currentSample) {
-                currentSample->color[0]   = xml.attributes().value("red").toString().toDouble();
-                currentSample->color[1]   = xml.attributes().value("blue").toString().toDouble();
-                currentSample->color[2]   = xml.attributes().value("green").toString().toDouble();
-                currentSample->color[3]  = xml.attributes().value("alpha").toString().toDouble();
+			//sample color
+            if (xml.name() == "color" && currentSample >= 0) {
+                ProjectSample& projectSample = projectSamples[currentSample];
+                projectSample.hasColor = true;
+                projectSample.color[0] = xml.attributes().value("red").toString().toDouble();
+                projectSample.color[1] = xml.attributes().value("blue").toString().toDouble();
+                projectSample.color[2] = xml.attributes().value("green").toString().toDouble();
+                projectSample.color[3] = xml.attributes().value("alpha").toString().toDouble();
             }
 
 			//polynomialAlignmentTransformation vector
-            if (xml.name() == "polynomialAlignmentTransformation" && currentSample) {
-				vector<double>transform;
+            if (xml.name() == "polynomialAlignmentTransformation" && currentSample >= 0) {
+				vector<double>& transform = projectSamples[currentSample].transform;
 				Q_FOREACH(QXmlStreamAttribute coef, xml.attributes() ) {
 					double coefValue =coef.value().toString().toDouble();
 					transform.push_back(coefValue);
 				}
-				qDebug() << "polynomialAlignmentTransformation: "; printF(transform);
-				currentSample->polynomialAlignmentTransformation = transform;
-				currentSample->saveOriginalRetentionTimes();
-				currentSample->applyPolynomialTransform();
 			}
         }
         if (xml.isCharacters() && currentXmlElement == "projectDescription") {
             projectDescription.append( xml.text() );
         }
-    sendBoostSignal(progressText.toStdString(), samplecount, i);
     }
     data.close();
 
+    //load stage: sample files are parsed in parallel, one worker per core
+    int total = projectSamples.size();
+    bool multiprocessing = _mainwindow->getSettings()->value("uploadMultiprocessing").toInt();
+    for (int i = 0; i < total; i++) {
+        //netCDF reading is not thread safe
+        QString fname = projectSamples[i].fileName;
+        if (fname.endsWith(".nc", Qt::CaseInsensitive) || fname.endsWith(".cdf", Qt::CaseInsensitive)) {
+            multiprocessing = false;
+            break;
+        }
+    }
+
+    int threads = 1;
+#ifndef __APPLE__
+    if (multiprocessing) threads = max(1, min(omp_get_num_procs(), total));
+#endif
+
+    int loaded = 0;
+#ifndef __APPLE__
+    #pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+    for (int i = 0; i < total; i++) {
+        projectSamples[i].sample = _mainwindow->fileLoader->loadSample(projectSamples[i].fileName);
+
+#ifndef __APPLE__
+        #pragma omp critical
+#endif
+        {
+            loaded++;
+            QString dStr = QFileInfo(projectSamples[i].fileName).absoluteDir().absolutePath();
+            QString progressText = "Importing files from " + dStr;
+            sendBoostSignal(progressText.toStdString(), loaded, total);
+        }
+    }
+
+    //apply stage: names, sets, order, colors and alignment, in project order
+    for (int i = 0; i < total; i++) {
+        ProjectSample& projectSample = projectSamples[i];
+        mzSample* sample = projectSample.sample;
+        if (sample == NULL) continue;
+        if (!_mainwindow->addSample(sample)) continue;
+
+        if (!projectSample.sampleName.isEmpty())   sample->sampleName = projectSample.sampleName.toStdString();
+        if (!projectSample.setName.isEmpty())      sample->setSetName(projectSample.setName.toStdString());
+        if (!projectSample.sampleOrder.isEmpty())  sample->setSampleOrder(projectSample.sampleOrder.toInt());
+        if (!projectSample.isSelected.isEmpty())   sample->isSelected = projectSample.isSelected.toInt();
+
+        if (projectSample.hasColor) {
+            for (int k = 0; k < 4; k++) sample->color[k] = projectSample.color[k];
+        }
+
+        if (projectSample.transform.size() > 0) {
+            qDebug() << "polynomialAlignmentTransformation: "; printF(projectSample.transform);
+            sample->polynomialAlignmentTransformation = projectSample.transform;
+            sample->saveOriginalRetentionTimes();
+            sample->applyPolynomialTransform();
+        }
+    }
+
     //setProjectDescription(projectDescription);
 
 // // update other widget
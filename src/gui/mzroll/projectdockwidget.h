@@ -9,6 +9,21 @@
 
 extern Database DB; 
 
+/**
+ * @brief a sample listed in a project file, with the settings to apply once it is loaded
+ */
+struct ProjectSample {
+    QString fileName;
+    QString sampleName;
+    QString setName;
+    QString sampleOrder;
+    QString isSelected;
+    bool hasColor;
+    double color[4];
+    vector<double> transform;   //polynomial alignment transformation
+    mzSample* sample;           //NULL until loaded
+};
+
 class ProjectDockWidget : public QDockWidget
 {
     Q_OBJECT
@@ -38,6 +38,7 @@ OptionsDialogSettings::OptionsDialogSettings(SettingsForm* dialog): sf(dialog)
     settings.insert("minIsotopicCorrelation", QVariant::fromValue(sf->minIsotopicCorrelation));
     settings.insert("maxIsotopeScanDiff", QVariant::fromValue(sf->maxIsotopeScanDiff));
     settings.insert("maxNaturalAbundanceErr", QVariant::fromValue(sf->maxNaturalAbundanceErr));
+    settings.insert("minIsotopicAbundance", QVariant::fromValue(sf->minIsotopicAbundance));
 
     settings.insert("eicType", QVariant::fromValue(sf->eicTypeComboBox));
     settings.insert("useOverlap", QVariant::fromValue(sf->useOverlap));
@@ -139,6 +140,7 @@ SettingsForm::SettingsForm(QSettings* s, MainWindow *w): QDialog(w) {
     connect(maxNaturalAbundanceErr, SIGNAL(valueChanged(double)), SLOT(recomputeIsotopes()));
     connect(minIsotopicCorrelation, SIGNAL(valueChanged(double)), SLOT(recomputeIsotopes()));
     connect(maxIsotopeScanDiff, SIGNAL(valueChanged(int)), SLOT(recomputeIsotopes()));
+    connect(minIsotopicAbundance, SIGNAL(valueChanged(double)), SLOT(recomputeIsotopes()));
 
     connect(eicTypeComboBox, SIGNAL(currentIndexChanged(int)), SLOT(recomputeEIC()));
 
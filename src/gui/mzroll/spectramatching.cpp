@@ -152,6 +152,8 @@ void SpectraMatching::doSearch() {
                score = matchPattern(scan);
             } else if ( _algorithm == "Fragment Search") {
                score = scoreScan(scan);
+            } else if ( _algorithm == "Library Search") {
+               score = searchLibraries(scan);
             }
 
             //update progress
@@ -259,6 +261,48 @@ double SpectraMatching::scoreScan(Scan* scan) {
    return score;
 }
 
+double SpectraMatching::searchLibraries(Scan* scan) {
+
+    if (scan->mslevel < 2 || scan->nobs() == 0) return 0;
+    if (_msScanType  > 0 && scan->mslevel != _msScanType) return 0;
+
+    float precursorMz = scan->precursorMz;
+    float precursorAmuToll = precursorMz * precursorPPM->value() / 1e6;
+    float productAmuToll = precursorMz * productPPM->value() / 1e6;
+    if (_precursorMz > 0 && abs(_precursorMz - precursorMz) > precursorAmuToll) return 0;
+
+    int minMatches = minPeakMatches->value();
+    Fragment query(scan, 0, 0, scan->nobs());
+
+    //best match over all libraries, only records near the precursor are read
+    SpectralLibrary* bestLibrary = NULL;
+    SpectralLibrary::Match best;
+    vector<SpectralLibrary*> libraries = mainwindow->fileLoader->spectralLibraries();
+    for(unsigned int l=0; l < libraries.size(); l++) {
+        vector<SpectralLibrary::Match> hits = libraries[l]->search(&query,
+                                                                   precursorMz - precursorAmuToll,
+                                                                   precursorMz + precursorAmuToll,
+                                                                   productAmuToll,
+                                                                   minMatches + 1);
+        if (hits.size() && (!bestLibrary || hits[0].score.cosine > best.score.cosine)) {
+            bestLibrary = libraries[l];
+            best = hits[0];
+        }
+    }
+    if (!bestLibrary || best.score.cosine <= 0) return 0;
+
+    QVector<double> mzs, ints;
+    for (unsigned int i = 0; i < bestLibrary->peakCount(best.record); i++) {
+        mzs << bestLibrary->mzs(best.record)[i];
+        ints << bestLibrary->intensities(best.record)[i];
+    }
+
+    QString sampleName(scan->sample->sampleName.c_str());
+    addHit(best.score.cosine, bestLibrary->precursorMz(best.record), sampleName, best.score.matchedPeaks, scan, mzs, ints);
+    matches.back().fragmentId = QString(bestLibrary->name(best.record).c_str());
+    return best.score.cosine;
+}
+
 double SpectraMatching::matchPattern(Scan* scan) {
 
    if (_msScanType  > 0 && scan->mslevel != _msScanType) return 0;
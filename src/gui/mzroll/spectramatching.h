@@ -21,6 +21,7 @@ class SpectraMatching : public QDialog, public Ui_SpectraMatchingForm
         void doSearch();
         void exportMatches();
         double scoreScan(Scan* scan);
+        double searchLibraries(Scan* scan);
         double matchPattern(Scan* scan);
 
 
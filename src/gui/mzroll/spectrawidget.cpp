@@ -188,7 +188,7 @@ void SpectraWidget::overlayPeptideFragmentation(QString peptideSeq,MassCutoff *p
 	if(peptideSeq.isEmpty()) return;
 
     Peptide record(peptideSeq.toStdString(),0,"");
-	vector<FragmentIon*>ions;
+    FragmentIonTable ions;
     record.generateFragmentIons(ions,"CID");
 
 	SpectralHit hit;
@@ -201,20 +201,19 @@ void SpectraWidget::overlayPeptideFragmentation(QString peptideSeq,MassCutoff *p
 	
     vector<bool>seen(_currentScan->nobs(),false);
 	for(unsigned int i=0; i < ions.size(); i++) {
-		FragmentIon* ion = ions[i];
-        int pos = _currentScan->findClosestHighestIntensityPos(ion->m_mz,productMassCutoff);
+        float ionMz = ions.ions[i].mz;
+        int pos = _currentScan->findClosestHighestIntensityPos(ionMz,productMassCutoff);
         if(pos != -1 and seen[pos] == false) {
-            ion->m_mzDiff = abs(_currentScan->mz[pos]-ion->m_mz);
-            qDebug() << "overlayPeptideFragmentation: IONS: " << ion->m_ion.c_str() << " ->" << "ionType" << " " << ion->m_mz << " mzdiff=" << ion->m_mzDiff;
+            string ionName = ions.ionName(i);
+            qDebug() << "overlayPeptideFragmentation: IONS: " << ionName.c_str() << " ->" << "ionType" << " " << ionMz << " mzdiff=" << abs(_currentScan->mz[pos]-ionMz);
 
             hit.mzList << _currentScan->mz[pos];
             hit.intensityList << _currentScan->intensity[pos];
-            hit.annotations << ion->m_ion.c_str();
+            hit.annotations << ionName.c_str();
             seen[pos]=true;
 		}
 	}
 
-	delete_all(ions);
     overlaySpectralHit(hit);
 }
 
@@ -13,10 +13,13 @@ TableDockWidget::TableDockWidget(MainWindow* mw, QString title, int numColms, in
 
     numColms=11;
     viewType = groupView;
+    focusedGroupsOnly = false;
 
-    treeWidget=new QTreeWidget(this);
+    peakTableModel = new PeakTableModel(this);
+    treeWidget=new QTreeView(this);
+    treeWidget->setModel(peakTableModel);
     treeWidget->setSortingEnabled(false);
-    treeWidget->setColumnCount(numColms);
+    treeWidget->setUniformRowHeights(true);
     treeWidget->setDragDropMode(QAbstractItemView::DragOnly);
     treeWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
     treeWidget->setAcceptDrops(false);    
@@ -35,13 +38,15 @@ TableDockWidget::TableDockWidget(MainWindow* mw, QString title, int numColms, in
     traindialog = new TrainDialog(this);
     connect(traindialog->saveButton,SIGNAL(clicked(bool)),SLOT(saveModel()));
     connect(traindialog->trainButton,SIGNAL(clicked(bool)),SLOT(Train()));
-    connect(treeWidget, SIGNAL(itemClicked(QTreeWidgetItem*, int)),SLOT(showSelectedGroup()));
-    connect(treeWidget, SIGNAL(itemSelectionChanged()),SLOT(showSelectedGroup()));
-    connect(treeWidget, SIGNAL(itemExpanded(QTreeWidgetItem * )),this,SLOT(sortChildrenAscending(QTreeWidgetItem*)));
+    connect(treeWidget, SIGNAL(clicked(const QModelIndex&)),SLOT(showSelectedGroup()));
+    connect(treeWidget->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),SLOT(showSelectedGroup()));
+    connect(treeWidget, SIGNAL(expanded(const QModelIndex&)),this,SLOT(sortChildrenAscending(const QModelIndex&)));
 
     clusterDialog = new ClusterDialog(this);
+    runningClustering = NULL;
     connect(clusterDialog->clusterButton,SIGNAL(clicked(bool)),SLOT(clusterGroups()));
     connect(clusterDialog->clearButton,SIGNAL(clicked(bool)),SLOT(clearClusters()));
+    connect(clusterDialog,SIGNAL(rejected()),SLOT(cancelClustering()));
 
     connect(this,SIGNAL(updateProgressBar(QString,int,int)), _mainwindow,SLOT(setProgressBar(QString, int,int)));
     //connect(btnGroupCSV, SIGNAL(clicked()), SLOT(exportGroupsToSpreadsheet()));
@@ -144,8 +149,8 @@ TableDockWidget::TableDockWidget(MainWindow* mw, QString title, int numColms, in
 TableDockWidget::~TableDockWidget() { 
     if(traindialog != NULL) delete traindialog;
 }
-void TableDockWidget::sortChildrenAscending(QTreeWidgetItem* item){
-    item->sortChildren(1, Qt::AscendingOrder);
+void TableDockWidget::sortChildrenAscending(const QModelIndex& index){
+    peakTableModel->sortChildren(index, 1, Qt::AscendingOrder);
 }
 void TableDockWidget::showLog() {
 }
@@ -218,6 +223,7 @@ void TableDockWidget::mergeGroupsIntoPeakTable(QAction* action) {
         allgroups[i].groupId = ++sz;
         peaksTableList[j-1]->allgroups.append(allgroups[i]);
     }
+    peaksTableList[j-1]->invalidateJournal();
     
     deleteAll();
     peaksTableList[j-1]->showAllGroups();
@@ -233,7 +239,6 @@ void TableDockWidget::sortBy(int col) {
 }
 
 void TableDockWidget::setIntensityColName() {
-    QTreeWidgetItem* header = treeWidget->headerItem();
     QString temp;
     PeakGroup::QType qtype = _mainwindow->getUserQuantType();
     switch(qtype) {
@@ -245,7 +250,7 @@ void TableDockWidget::setIntensityColName() {
         default: temp = _mainwindow->currentIntensityName; break;
     }
     _mainwindow->currentIntensityName = temp;
-    header->setText(9, temp);
+    peakTableModel->setHeaderData(9, Qt::Horizontal, temp);
 }
 
 void TableDockWidget::setupPeakTable() {
@@ -274,6 +279,7 @@ void TableDockWidget::setupPeakTable() {
 		colNames  << "changeFoldRatio";
 		*/
 
+    vector<mzSample*> vsamples;
     if (viewType == groupView) {
         
        //Add a coulmn to the Peaks Table
@@ -290,17 +296,15 @@ void TableDockWidget::setupPeakTable() {
         colNames << "Ratio Change";
         colNames << "P-value";
     } else if (viewType == peakView) {
-        vector<mzSample*> vsamples = _mainwindow->getVisibleSamples();
+        vsamples = _mainwindow->getVisibleSamples();
         sort(vsamples.begin(), vsamples.end(), mzSample::compSampleOrder);
         for(unsigned int i=0; i<vsamples.size(); i++ ) {
             colNames << QString(vsamples[i]->sampleName.c_str());
         }
     }
 
-    treeWidget->setColumnCount(colNames.size());
-    treeWidget->setHeaderLabels(colNames);
-    treeWidget->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    treeWidget->header()->adjustSize();
+    peakTableModel->setColumns(colNames, vsamples);
+    treeWidget->header()->setSectionResizeMode(QHeaderView::Interactive);
 
     treeWidget->setSortingEnabled(true);
 
@@ -309,194 +313,75 @@ void TableDockWidget::setupPeakTable() {
 }
 
 void TableDockWidget::updateTable() {
-    QTreeWidgetItemIterator it(treeWidget);
-    while (*it) {
-        updateItem(*it);
-        ++it;
-    }
-    updateStatus();
-}
-
-void TableDockWidget::updateItem(QTreeWidgetItem* item) {
-    QVariant v = item->data(0,Qt::UserRole);
-    PeakGroup*  group =  v.value<PeakGroup*>();
-    if ( group == NULL ) return;
-    heatmapBackground(item);
-
     //score peak quality
     Classifier* clsf = _mainwindow->getClassifier();
     if (clsf != NULL) {
-        clsf->classify(group);
-        group->updateQuality();
-        
-        if(viewType == groupView) item->setText(11,QString::number(group->maxQuality,'f',2));
-        item->setText(1,QString(group->getName().c_str()));
-    }
-
-    //Updating the peakid
-    item->setText(0,QString::number(group->groupId));
-
-    
-    if ( viewType == groupView && fabs(group->changeFoldRatio) >= 0 ) {
-        item->setText(13,QString::number(group->changeFoldRatio, 'f', 3));
-        item->setText(14,QString::number(group->changePValue,    'f', 6));
-    }
-
-    int good=0; int bad=0;
-    int total=group->peakCount();
-    for(int i=0; i < group->peakCount(); i++ ) {
-        group->peaks[i].quality > _mainwindow->mavenParameters->minQuality ? good++ : bad++;
-    }
-
-    QBrush brush=Qt::NoBrush;
-    if (good>0 && group->label == 'b' ) {
-        float incorrectFraction= ((float) good)/total;
-        brush  = QBrush(QColor::fromRgbF(0.8,0,0,incorrectFraction));
-    } else if(bad>0 && group->label == 'g') {
-        float incorrectFraction= ((float) bad)/total;
-        brush  = QBrush(QColor::fromRgbF(0.8,0,0,incorrectFraction));
+        bool changed = false;
+        for(int i=0; i < allgroups.size(); i++ ) {
+            if (classifyGroup(clsf, &allgroups[i])) changed = true;
+        }
+        //the journal does not record peak qualities
+        if (changed) {
+            invalidateJournal();
+            featureMatrix.invalidate();
+        }
     }
-    item->setBackground(0,brush);
-
-    if (group->label == 'g' ) item->setIcon(0,QIcon(":/images/good.png"));
-    if (group->label == 'b' ) item->setIcon(0,QIcon(":/images/bad.png"));
-
-    if (filtersDialog->isVisible()) {
-        float minG = sliders["GoodPeakCount"]->minBoundValue();
-        float maxG = sliders["GoodPeakCount"]->maxBoundValue();
 
-        if ( group->goodPeakCount < minG  || group->goodPeakCount > maxG ) {
-            item->setHidden(true);
-        } else {
-            item->setHidden(false);
-        }
+    if (filtersDialog->isVisible() || peakTableModel->isFiltered()) {
+        peakTableModel->rebuild();
+    } else {
+        peakTableModel->refresh();
     }
+    updateStatus();
 }
 
-void TableDockWidget::updateCompoundWidget() {
-
-    _mainwindow->ligandWidget->resetColor();
+bool TableDockWidget::classifyGroup(Classifier* clsf, PeakGroup* group) {
+    vector<float> quality(group->peaks.size());
+    for(unsigned int i=0; i < group->peaks.size(); i++ ) quality[i] = group->peaks[i].quality;
 
-    QTreeWidgetItemIterator itr(treeWidget);
-    while (*itr) {
-        QTreeWidgetItem* item =(*itr);
-        if (item) {
-            QVariant v = item->data(0,Qt::UserRole);
-            PeakGroup* group =  v.value<PeakGroup*>();
-            if ( group == NULL ) continue;
+    clsf->classify(group);
+    group->updateQuality();
 
-            _mainwindow->ligandWidget->markAsDone(group->compound);
-        }
-        ++itr;
+    bool changed = false;
+    for(unsigned int i=0; i < group->peaks.size(); i++ ) {
+        if (group->peaks[i].quality != quality[i]) changed = true;
+    }
+    for(int i=0; i < group->childCount(); i++ ) {
+        if (classifyGroup(clsf, &group->children[i])) changed = true;
     }
+    return changed;
 }
 
-void TableDockWidget::heatmapBackground(QTreeWidgetItem* item) {
-    if(viewType != peakView) return;
+void TableDockWidget::updateGroup(PeakGroup* group) {
+    if ( group == NULL ) return;
 
-    
-    int firstColumn=4;
-    StatisticsVector<float>values; float sum=0;
-    for(unsigned int i=firstColumn; i< item->columnCount(); i++) {
-          values.push_back(item->text(i).toFloat());
-    }
+    //score peak quality
+    Classifier* clsf = _mainwindow->getClassifier();
+    if (clsf != NULL) {
+        vector<float> quality(group->peaks.size());
+        for(unsigned int i=0; i < group->peaks.size(); i++ ) quality[i] = group->peaks[i].quality;
 
-    if (values.size()) {
-        //normalize
-        float mean = values.mean();
-        float sd  = values.stddev();
-        
-        float max = values.maximum();
-        float min = values.minimum();
-        float range = max-min;
+        clsf->classify(group);
+        group->updateQuality();
 
-        for(int i=0; i<values.size();i++) {
-            if(max!=0) values[i] = abs((max-values[i])/max); //Z-score
+        for(unsigned int i=0; i < group->peaks.size(); i++ ) {
+            if (group->peaks[i].quality != quality[i]) { invalidateJournal(); break; }
         }
-
-        //float maxValue=max(std::fabs(values.maximum()),fabs(values.minimum()));
-        QColor color = Qt::white;
-
-        float colorramp=0.5;
-        
-        for(int i=0; i<values.size();i++) {
-           float value=values[i];
-           float prob = value;
-           if(prob < 0 ) prob=0;
-           color.setHsvF(0.0,prob,1,1);
-           //qDebug() << value << " " << prob;
-
-           //float S=abs(cellValue/maxValue);
-           //if (S > 1) S=1;
-           //float H=0.67; if(cellValue<0) H=0;
-           // color.setHsvF(H,S,1,1);
-
-            //item->setText(firstColumn+i,QString::number(values[i])) ;
-            item->setBackgroundColor(firstColumn+i,color);
-       }
     }
+    int matrixRow = featureMatrix.row(group);
+    if (matrixRow >= 0) featureMatrix.update(matrixRow);
+    peakTableModel->groupChanged(group);
 }
 
-void TableDockWidget::addRow(PeakGroup* group, QTreeWidgetItem* root) { 
-
-    if (group == NULL) return;
-    if (group->peakCount() == 0 ) return;
-    if (group->meanMz <= 0 ) return;
-
-    NumericTreeWidgetItem *item = new NumericTreeWidgetItem(root,0);
-    item->setFlags(Qt::ItemIsSelectable |  Qt::ItemIsEnabled | Qt::ItemIsDragEnabled);
-    item->setData(0,Qt::UserRole,QVariant::fromValue(group));
-
-    item->setText(0,QString::number(group->groupId));
-    item->setText(1,QString(group->getName().c_str()));
-    item->setText(2,QString::number(group->meanMz, 'f', 4));
-    int charge = _mainwindow->mavenParameters->getCharge(group->compound);
-
-    if (group->getExpectedMz(charge) != -1) {
-        float mz = group->getExpectedMz(charge);
-
-        item->setText(3,QString::number(mz,'f', 4));
-    } else {
-        item->setText(3, "NA");
-    }
-
-    item->setText(4,QString::number(group->meanRt, 'f', 2));
-
-    if (group->label == 'g' ) item->setIcon(0,QIcon(":/images/good.png"));
-    if (group->label == 'b' ) item->setIcon(0,QIcon(":/images/bad.png"));
+void TableDockWidget::updateCompoundWidget() {
 
-    if (viewType == groupView) {
-        
-        item->setText(5,QString::number(group->expectedRtDiff,'f',2));
-        item->setText(6,QString::number(group->sampleCount));
-        item->setText(7,QString::number(group->goodPeakCount));
-        item->setText(8,QString::number(group->maxNoNoiseObs));
-        item->setText(9,QString::number(extractMaxIntensity(group),'g',2));
-        item->setText(10,QString::number(group->maxSignalBaselineRatio,'f',0));
-        item->setText(11,QString::number(group->maxQuality,'f',2));
-        item->setText(12,QString::number(group->groupRank,'e',6));
-
-        if ( group->changeFoldRatio != 0 ) {
-            
-            item->setText(13,QString::number(group->changeFoldRatio, 'f', 2));
-            item->setText(14,QString::number(group->changePValue,    'e', 4));
-        }
+    _mainwindow->ligandWidget->resetColor();
 
-    } else if ( viewType == peakView) {
-        vector<mzSample*> vsamples = _mainwindow->getVisibleSamples();
-        sort(vsamples.begin(), vsamples.end(), mzSample::compSampleOrder);
-        vector<float>yvalues = group->getOrderedIntensityVector(vsamples,_mainwindow->getUserQuantType());
-        for(unsigned int i=0; i<yvalues.size(); i++ ) {
-         
-         item->setText(5+i,QString::number(yvalues[i]));
+    for(int i=0; i < allgroups.size(); i++ ) {
+        _mainwindow->ligandWidget->markAsDone(allgroups[i].compound);
+        for(int j=0; j < allgroups[i].childCount(); j++ ) {
+            _mainwindow->ligandWidget->markAsDone(allgroups[i].children[j].compound);
         }
-        heatmapBackground(item);
-    }
-    if ( root == NULL ) treeWidget->addTopLevelItem(item);
-    updateItem(item);
-
-    if ( group->childCount() > 0 ) {
-        for( int i=0; i < group->childCount(); i++ ) addRow(&(group->children[i]), item);
     }
 }
 
@@ -563,40 +448,41 @@ bool TableDockWidget::hasPeakGroup(PeakGroup* group) {
         sameMzRtGroups[sameMzRtGroupIndexHash].append(compoundName);
     }
 
-    for(int i=0; i < allgroups.size(); i++ ) {
-        if ( &allgroups[i] == group ) return true;
-        if ((double) std::abs(group->meanMz - allgroups[i].meanMz) < 1e-5 && (double)
-            std::abs(group->meanRt-allgroups[i].meanRt) < 1e-5) {
-
-            addSameMzRtGroup=false;
-            if( !sameMzRtGroups[sameMzRtGroupIndexHash].contains(compoundName)){
-
-                showSameGroup(sameMzRtGroupIndexHash);
-                /**
-                 * if bookmarked list has group with same mz and rt, loop will hold the execution
-                 * of this method after showing the prompt dialog to choose whether to add this group
-                 * by above method <showSameGroup>.
-                */
-                QEventLoop loop;
-                connect(save,SIGNAL(clicked()),&loop,SLOT(quit()));
-                connect(cancel,SIGNAL(clicked()),&loop,SLOT(quit()));
-            }
-            if(addSameMzRtGroup){
-                /**
-                 * if user pressed <save> button <addSameMzRtGroup> will be set to true otherwise false.
-                 * if it is true, this groups corresponding compound name will we saved by an index of 
-                 * sameMzRtGroupIndexHash to show all these string next time if a group with same rt
-                 * and mz is encountered.
-                */
-                sameMzRtGroups[sameMzRtGroupIndexHash].append(compoundName);
-                /**
-                 * return false such that calling method will add this group to bookmarked group.
-                */
-                return false;
-            }
+    //groups appended from elsewhere (e.g. merged tables) are picked up here
+    if (groupIndex.size() != (unsigned int) allgroups.size()) rebuildGroupIndex();
+
+    if (groupIndex.contains(group)) return true;
+
+    if (groupIndex.find(group->meanMz, group->meanRt) != NULL) {
+
+        addSameMzRtGroup=false;
+        if( !sameMzRtGroups[sameMzRtGroupIndexHash].contains(compoundName)){
 
-            return true;
+            showSameGroup(sameMzRtGroupIndexHash);
+            /**
+             * if bookmarked list has group with same mz and rt, loop will hold the execution
+             * of this method after showing the prompt dialog to choose whether to add this group
+             * by above method <showSameGroup>.
+            */
+            QEventLoop loop;
+            connect(save,SIGNAL(clicked()),&loop,SLOT(quit()));
+            connect(cancel,SIGNAL(clicked()),&loop,SLOT(quit()));
         }
+        if(addSameMzRtGroup){
+            /**
+             * if user pressed <save> button <addSameMzRtGroup> will be set to true otherwise false.
+             * if it is true, this groups corresponding compound name will we saved by an index of 
+             * sameMzRtGroupIndexHash to show all these string next time if a group with same rt
+             * and mz is encountered.
+            */
+            sameMzRtGroups[sameMzRtGroupIndexHash].append(compoundName);
+            /**
+             * return false such that calling method will add this group to bookmarked group.
+            */
+            return false;
+        }
+
+        return true;
     }
 
     return false;
@@ -607,10 +493,15 @@ PeakGroup* TableDockWidget::addPeakGroup(PeakGroup* group) {
         allgroups.push_back(*group);
         if ( allgroups.size() > 0 ) {
             PeakGroup& g = allgroups[ allgroups.size()-1 ];
-            for (unsigned int i = 0; i <  allgroups.size(); i++) {
-                allgroups[i].groupId = i + 1;
+            g.groupId = allgroups.size();
+            groupIndex.insert(&g);
+            if (featureMatrix.rowCount() + 1 == (unsigned int) allgroups.size()) featureMatrix.append(&g);
+            if (journal.isStarted()) {
+                //bulk additions are cheaper to save in full
+                if (journal.size() > maxJournalSize) journal.stop();
+                else journal.logAdd(&g, _mainwindow->getSamples());
             }
-            //g.groupId = allgroups.size();
+            peakTableModel->appendGroup(&g);
             return &g;
         }
     }
@@ -628,9 +519,26 @@ QList<PeakGroup*> TableDockWidget::getGroups() {
     return groups;
 }
 
+bool TableDockWidget::holdsGroup(PeakGroup* group) {
+    for(int i=0; i < allgroups.size(); i++ ) {
+        if (&allgroups[i] == group) return true;
+    }
+    return false;
+}
+
+void TableDockWidget::rebuildGroupIndex() {
+    groupIndex.clear();
+    for(int i=0; i < allgroups.size(); i++ ) {
+        groupIndex.insert(&allgroups[i]);
+    }
+}
+
 void TableDockWidget::deleteAll() {
-    treeWidget->clear();
+    invalidateJournal();
+    peakTableModel->clear();
     allgroups.clear();
+    groupIndex.clear();
+    featureMatrix.clear();
      
     _mainwindow->removePeaksTable(this);
     _mainwindow->getEicWidget()->replotForced();
@@ -646,9 +554,10 @@ void TableDockWidget::deleteAll() {
 
 
 void TableDockWidget::showAllGroups() {
-    treeWidget->clear();
+    focusedGroupsOnly = false;
     setFocus();
     if (allgroups.size() == 0 ) {
+        peakTableModel->clear();
         if (viewType == groupView) setIntensityColName();
         setVisible(false);
         return;
@@ -658,28 +567,16 @@ void TableDockWidget::showAllGroups() {
 
     setupPeakTable();
     if (viewType == groupView) setIntensityColName();
-    
-    QMap<int,QTreeWidgetItem*> parents;
-    for(int i=0; i < allgroups.size(); i++ ) { 
-        int clusterId  = allgroups[i].clusterId;
-        if (clusterId && allgroups[i].meanMz > 0 && allgroups[i].peakCount()>0) {
-            if (!parents.contains(clusterId)) {
-                parents[clusterId]= new QTreeWidgetItem(treeWidget);
-                parents[clusterId]->setText(0,QString("Cluster ") + QString::number(clusterId));
-                parents[clusterId]->setText(5,QString::number(allgroups[i].meanRt,'f',2));
-                parents[clusterId]->setExpanded(true);
-            }
-            QTreeWidgetItem* parent = parents[ clusterId ];
-            addRow(&allgroups[i], parent); 
-        } else {
-            addRow(&allgroups[i], NULL);
-        }
-    }
 
-    QScrollBar* vScroll = treeWidget->verticalScrollBar();
-    if ( vScroll ) {
-        vScroll->setSliderPosition(vScroll->maximum());
+    peakTableModel->rebuild();
+    for(int i=0; i < peakTableModel->rowCount(); i++ ) {
+        QModelIndex index = peakTableModel->index(i, 0);
+        if (peakTableModel->isCluster(index)) treeWidget->setExpanded(index, true);
     }
+
+    //size columns once from the rows on screen
+    treeWidget->header()->resizeSections(QHeaderView::ResizeToContents);
+    treeWidget->scrollToBottom();
     treeWidget->setSortingEnabled(true);
     updateStatus();
     updateCompoundWidget();
@@ -708,6 +605,7 @@ void TableDockWidget::exportGroupsToSpreadsheet() {
     vector<mzSample*> samples = _mainwindow->getSamples();
     CSVReports* csvreports = new CSVReports(samples);
     csvreports->setMavenParameters(_mainwindow->mavenParameters);
+    csvreports->setFeatureMatrix(&getFeatureMatrix());
     if (allgroups.size() == 0 ) {
         QString msg = "Peaks Table is Empty";
         QMessageBox::warning(this, tr("Error"), msg);
@@ -797,6 +695,7 @@ void TableDockWidget::exportGroupsToSpreadsheet_polly(QString fileName) {
     vector<mzSample*> samples = _mainwindow->getSamples();
     CSVReports* csvreports = new CSVReports(samples);
     csvreports->setMavenParameters(_mainwindow->mavenParameters);
+    csvreports->setFeatureMatrix(&getFeatureMatrix());
 
     if (allgroups.size() == 0 ) {
         QString msg = "Peaks Table is Empty";
@@ -895,11 +794,10 @@ vector<EIC*> TableDockWidget::getEICs(float rtmin, float rtmax, PeakGroup& grp)
 void TableDockWidget::showSelectedGroup() { 
 
     //sortBy(treeWidget->header()->sortIndicatorSection());
-    QTreeWidgetItem *item = treeWidget->currentItem();
-    if (!item) return;
+    QModelIndex index = treeWidget->currentIndex();
+    if (!index.isValid()) return;
 
-    QVariant v = item->data(0,Qt::UserRole);
-    PeakGroup*  group =  v.value<PeakGroup*>();
+    PeakGroup*  group = peakTableModel->groupAt(index);
     _mainwindow->alignmentVizWidget->plotGraph(group);
     
     if ( group != NULL && _mainwindow != NULL) {
@@ -907,12 +805,10 @@ void TableDockWidget::showSelectedGroup() {
         // _mainwindow->rconsoleDockWidget->updateStatus();
     }
 
-    if ( item->childCount() > 0 ) {
+    if ( peakTableModel->hasChildren(index) ) {
         vector<PeakGroup*>children;
-        for(int i=0; i < item->childCount(); i++ ) {
-            QTreeWidgetItem* child = item->child(i);
-            QVariant data = child->data(0,Qt::UserRole);
-            PeakGroup*  group =  data.value<PeakGroup*>();
+        for(int i=0; i < peakTableModel->rowCount(index); i++ ) {
+            PeakGroup*  group = peakTableModel->groupAt(peakTableModel->index(i, 0, index));
             if(group) children.push_back(group);
         }
     
@@ -927,12 +823,9 @@ void TableDockWidget::showSelectedGroup() {
 
 QList<PeakGroup*> TableDockWidget::getSelectedGroups() {
     QList<PeakGroup*> selectedGroups;
-    Q_FOREACH(QTreeWidgetItem* item, treeWidget->selectedItems() ) {
-        if (item) {
-            QVariant v = item->data(0,Qt::UserRole);
-            PeakGroup*  group =  v.value<PeakGroup*>();
-            if ( group != NULL ) { selectedGroups.append(group); }
-        }
+    Q_FOREACH(QModelIndex index, treeWidget->selectionModel()->selectedRows() ) {
+        PeakGroup*  group = peakTableModel->groupAt(index);
+        if ( group != NULL ) { selectedGroups.append(group); }
     }
     return selectedGroups;
 }
@@ -940,22 +833,19 @@ QList<PeakGroup*> TableDockWidget::getSelectedGroups() {
 QList<PeakGroup*> TableDockWidget::getCustomGroups(peakTableSelectionType peakSelection) {
     QList<PeakGroup*> selectedGroups;
     peakTableSelectionType temppeakSelection = peakSelection;
-    Q_FOREACH(QTreeWidgetItem* item, treeWidget->selectedItems() ) {
-        if (item) {
-            QVariant v = item->data(0,Qt::UserRole);
-            PeakGroup*  group =  v.value<PeakGroup*>();
-            if ( group != NULL ) {
-                if (temppeakSelection == peakTableSelectionType::Good) {
-                    if (group->label == 'g') {
-                        selectedGroups.append(group);
-                    }
-                } else if (temppeakSelection == peakTableSelectionType::Bad) {
-                    if (group->label == 'b') {
-                        selectedGroups.append(group);
-                    }
-                } else {
+    Q_FOREACH(QModelIndex index, treeWidget->selectionModel()->selectedRows() ) {
+        PeakGroup*  group = peakTableModel->groupAt(index);
+        if ( group != NULL ) {
+            if (temppeakSelection == peakTableSelectionType::Good) {
+                if (group->label == 'g') {
                     selectedGroups.append(group);
                 }
+            } else if (temppeakSelection == peakTableSelectionType::Bad) {
+                if (group->label == 'b') {
+                    selectedGroups.append(group);
+                }
+            } else {
+                selectedGroups.append(group);
             }
         }
     }
@@ -965,25 +855,14 @@ QList<PeakGroup*> TableDockWidget::getCustomGroups(peakTableSelectionType peakSe
 //@author:Giridhari -- Refactored this function
 //TODO: To select one or more item in Qtreewidget in peaktable
 PeakGroup* TableDockWidget::getSelectedGroup() { 
-    QTreeWidgetItem *item = treeWidget->currentItem();
-    if (!item) return NULL;
-    QVariant v = item->data(0,Qt::UserRole);
-    PeakGroup*  group =  v.value<PeakGroup*>();
-    if ( group != NULL ) { return group; }
-    else
-    return NULL;
+    return peakTableModel->groupAt(treeWidget->currentIndex());
 }
 
 void TableDockWidget::setGroupLabel(char label) {
-    Q_FOREACH(QTreeWidgetItem* item, treeWidget->selectedItems() ) {
-        if (item) {
-            QVariant v = item->data(0,Qt::UserRole);
-            PeakGroup*  group =  v.value<PeakGroup*>();
-            if ( group != NULL ) {
-                 group->setLabel(label);
-            }
-            updateItem(item);
-        }
+    Q_FOREACH(PeakGroup* group, getSelectedGroups() ) {
+        group->setLabel(label);
+        logLabel(group);
+        updateGroup(group);
     }
     updateStatus();
 }
@@ -999,43 +878,30 @@ void TableDockWidget::deleteGroup(PeakGroup *groupX) {
     }
     if (pos == -1) return;
 
-    //qDebug() << "Delete pos=" << pos;
-    QTreeWidgetItemIterator it(treeWidget);
-    while (*it) {
-        QTreeWidgetItem* item = (*it);
-        if (item->isHidden()) { ++it; continue; }
-        QVariant v = item->data(0,Qt::UserRole);
-        PeakGroup*  group =  v.value<PeakGroup*>();
-        if ( group != NULL and group == groupX) {
-            item->setHidden(true);
-
-            //Deleteing
-            int posTree = treeWidget->indexOfTopLevelItem(item);
-            if (posTree != -1) treeWidget->takeTopLevelItem(posTree);
-
-            /**
-             * delete name of compound associated with this group stored in <sameMzRtGroups> with
-             * given mz and rt
-             */
-            int intMz=group->meanMz*1e5;
-            int intRt=group->meanRt*1e5;
-            QPair<int,int> sameMzRtGroupIndexHash(intMz,intRt);
-            QString compoundName=QString::fromStdString(groupX->getName());
-            if( sameMzRtGroups[sameMzRtGroupIndexHash].contains(compoundName)){
-                for(int i=0;i<sameMzRtGroups[sameMzRtGroupIndexHash].size();++i){
-                    if(sameMzRtGroups[sameMzRtGroupIndexHash][i]==compoundName){
-                        sameMzRtGroups[sameMzRtGroupIndexHash].removeAt(i);
-                        break;
-                    }
-                }
+    /**
+     * delete name of compound associated with this group stored in <sameMzRtGroups> with
+     * given mz and rt
+     */
+    int intMz=groupX->meanMz*1e5;
+    int intRt=groupX->meanRt*1e5;
+    QPair<int,int> sameMzRtGroupIndexHash(intMz,intRt);
+    QString compoundName=QString::fromStdString(groupX->getName());
+    if( sameMzRtGroups[sameMzRtGroupIndexHash].contains(compoundName)){
+        for(int i=0;i<sameMzRtGroups[sameMzRtGroupIndexHash].size();++i){
+            if(sameMzRtGroups[sameMzRtGroupIndexHash][i]==compoundName){
+                sameMzRtGroups[sameMzRtGroupIndexHash].removeAt(i);
+                break;
             }
-
-            allgroups.erase(allgroups.begin()+pos);
-            break;
         }
-        ++it;
     }
 
+    journal.logDelete(vector<int>(1, pos));
+    peakTableModel->removeGroup(groupX);
+    groupIndex.remove(groupX);
+    int matrixRow = featureMatrix.row(groupX);
+    if (matrixRow >= 0) featureMatrix.remove(matrixRow);
+    allgroups.erase(allgroups.begin()+pos);
+
     for(unsigned int i = 0; i < allgroups.size(); i++) {
         allgroups[i].groupId = i + 1;
     }
@@ -1045,54 +911,42 @@ void TableDockWidget::deleteGroup(PeakGroup *groupX) {
 
 void TableDockWidget::deleteGroups() {
 
-
-    QList<PeakGroup*> selectedGroups;
-    QTreeWidgetItem* nextItem;
-
-    if (treeWidget->selectedItems().size() == 0) {
+    QItemSelectionModel* selection = treeWidget->selectionModel();
+    QModelIndexList selectedRows = selection->selectedRows();
+    if (selectedRows.size() == 0) {
         return;
     }
 
-    Q_FOREACH(QTreeWidgetItem* item, treeWidget->selectedItems() ) {
-        if (item) {
-            nextItem = treeWidget->itemBelow(item);
-            QVariant v = item->data(0,Qt::UserRole);
-            PeakGroup*  group =  v.value<PeakGroup*>();
-            if ( group != NULL ) {
-                PeakGroup* parentGroup = group->parent;
-                int childrenNum = -1;
-                if ( parentGroup == NULL ) { //top level item
-                    
-                    if (nextItem) {
-                        QVariant vc = nextItem->data(0,Qt::UserRole);
-                        PeakGroup*  groupc =  vc.value<PeakGroup*>();
-                        if (groupc->tagString == "C12 PARENT") {
-                            nextItem = nextItem->parent();
-                        } else if ( groupc->isIsotope()){
-                            nextItem = nextItem->parent();
-                        }
-                    }
-                    deleteGroup(group);
-                } else if ( parentGroup && parentGroup->childCount() ) {	//this a child item
-                    childrenNum = parentGroup->childCount();
-                    if ( parentGroup->deleteChild(group) ) {
-                        QTreeWidgetItem* parentItem = item->parent();
-                        if ( parentItem ) {
-                            parentItem->removeChild(item);
-                            delete(item);
-                        }
-                    }
-                }
-                if (parentGroup != NULL) {
-                    if (childrenNum == parentGroup->childCount()) {
-                        deleteGroup(group);
-                        nextItem = treeWidget->itemBelow(item->parent());
-                    }
-                }
-             }
+    //the first row below the selection that survives the deletion
+    QModelIndex below = treeWidget->indexBelow(selectedRows.last());
+    while (below.isValid() && (selection->isSelected(below) || selection->isSelected(below.parent()))) {
+        below = treeWidget->indexBelow(below);
+    }
+    QPersistentModelIndex nextIndex(below);
+
+    QList<PeakGroup*> selectedGroups = getSelectedGroups();
+    vector<PeakGroup*> topLevel;
+    vector<PeakGroup*> children;
+    Q_FOREACH(PeakGroup* group, selectedGroups) {
+        PeakGroup* parentGroup = group->parent;
+        if ( parentGroup == NULL ) { //top level item
+            topLevel.push_back(group);
+        } else if ( !selectedGroups.contains(parentGroup) ) {	//this a child item
+            children.push_back(group);
         }
     }
-    if(nextItem) treeWidget->setCurrentItem(nextItem,0);
+
+    //children are stored by value, deleting later ones first keeps earlier pointers valid
+    sort(children.begin(), children.end(), std::greater<PeakGroup*>());
+    for(unsigned int i=0; i < children.size(); i++ ) {
+        journal.logDelete(GroupJournal::pathOf(allgroups, children[i]));
+        peakTableModel->deleteChild(children[i]);
+    }
+    for(unsigned int i=0; i < topLevel.size(); i++ ) {
+        deleteGroup(topLevel[i]);
+    }
+
+    if(nextIndex.isValid()) treeWidget->setCurrentIndex(nextIndex);
     _mainwindow->getEicWidget()->replotForced();
     showSelectedGroup();
     _mainwindow->getEicWidget()->addPeakPositions();
@@ -1164,32 +1018,31 @@ void TableDockWidget::markGroupIgnored() {
 
 void TableDockWidget::showPeakGroup(int row) {
 
-    QTreeWidgetItem *item = treeWidget->itemAt(row,0);
-    if ( item == NULL) return;
+    QModelIndex index = treeWidget->indexAt(QPoint(row,0));
+    if ( !index.isValid() ) return;
 
-    QVariant v = item->data(0,Qt::UserRole);
-    PeakGroup*  group =  v.value<PeakGroup*>();
+    PeakGroup*  group = peakTableModel->groupAt(index);
 
     if ( group != NULL ) {
-        treeWidget->setCurrentItem(item);
+        treeWidget->setCurrentIndex(index);
         _mainwindow->setPeakGroup(group);
     }
 }
 
 void TableDockWidget::showLastGroup() {
-    QTreeWidgetItem *item= treeWidget->currentItem();
-    if ( item != NULL )  {
-        treeWidget->setCurrentItem(treeWidget->itemAbove(item));
+    QModelIndex index = treeWidget->currentIndex();
+    if ( index.isValid() )  {
+        treeWidget->setCurrentIndex(treeWidget->indexAbove(index));
     }
 }
 
 void TableDockWidget::showNextGroup() {
 
-    QTreeWidgetItem *item= treeWidget->currentItem();
-    if ( item == NULL ) return;
+    QModelIndex index = treeWidget->currentIndex();
+    if ( !index.isValid() ) return;
 
-    QTreeWidgetItem* nextitem = treeWidget->itemBelow(item); //get next item
-    if ( nextitem != NULL )  treeWidget->setCurrentItem(nextitem);
+    QModelIndex nextIndex = treeWidget->indexBelow(index); //get next item
+    if ( nextIndex.isValid() )  treeWidget->setCurrentIndex(nextIndex);
 }
 
 void TableDockWidget::Train() {
@@ -1230,6 +1083,9 @@ void TableDockWidget::Train() {
 
     clsf->train(train_groups);
     clsf->classify(test_groups);
+    //qualities of the test groups changed
+    invalidateJournal();
+    featureMatrix.invalidate();
     showAccuracy(test_groups);
     updateTable();
 }
@@ -1237,59 +1093,59 @@ void TableDockWidget::Train() {
 void TableDockWidget::keyPressEvent(QKeyEvent *e ) {
     //cerr << "TableDockWidget::keyPressEvent()" << e->key() << endl;
 
-    QTreeWidgetItem *item = treeWidget->currentItem();
+    QModelIndex item = treeWidget->currentIndex();
     if (e->key() == Qt::Key_Delete ) {
-        QList<QTreeWidgetItem *> items = treeWidget->selectedItems();
+        QModelIndexList items = treeWidget->selectionModel()->selectedRows();
         if (items.size() > 0) {
             cerr << items.size() << endl;
             deleteGroups();
         }
     } else if ( e->key() == Qt::Key_T ) {
-        if (item) {
+        if (item.isValid()) {
             Train();
         }
     } else if ( e->key() == Qt::Key_G ) {
 
-        if (item) {
+        if (item.isValid()) {
             markGroupGood();
         }
     } else if ( e->key() == Qt::Key_B ) {
 
-        if (item) {
+        if (item.isValid()) {
             markGroupBad();
         }
     } else if ( e->key() == Qt::Key_Left ) {
 
-        if (treeWidget->currentItem()) {
-            if (treeWidget->currentItem()->parent()) {
-                treeWidget->collapseItem(treeWidget->currentItem()->parent());
-                treeWidget->setCurrentItem(treeWidget->currentItem()->parent());
+        if (item.isValid()) {
+            if (item.parent().isValid()) {
+                treeWidget->collapse(item.parent());
+                treeWidget->setCurrentIndex(item.parent());
             } else {
-                treeWidget->collapseItem(treeWidget->currentItem());
+                treeWidget->collapse(item);
             }
         }
     }  else if ( e->key() == Qt::Key_Right ) {
 
-        if (treeWidget->currentItem()) {
-            if (!treeWidget->currentItem()->isExpanded()) {
-                treeWidget->expandItem(treeWidget->currentItem());
+        if (item.isValid()) {
+            if (!treeWidget->isExpanded(item)) {
+                treeWidget->expand(item);
             }
         }
     } else if ( e->key() == Qt::Key_O ) {
-        if (treeWidget->currentItem()) {
-            if (treeWidget->currentItem()->isExpanded()) {
-                if (treeWidget->currentItem()->parent()) {
-                    treeWidget->collapseItem(treeWidget->currentItem()->parent());
-                    treeWidget->setCurrentItem(treeWidget->currentItem()->parent());
+        if (item.isValid()) {
+            if (treeWidget->isExpanded(item)) {
+                if (item.parent().isValid()) {
+                    treeWidget->collapse(item.parent());
+                    treeWidget->setCurrentIndex(item.parent());
                 } else {
-                    treeWidget->collapseItem(treeWidget->currentItem());
+                    treeWidget->collapse(item);
                 }
             } else {
-                treeWidget->expandItem(treeWidget->currentItem());
+                treeWidget->expand(item);
             }
         }
     } else if ( e->key() == Qt::Key_Down && e->modifiers()==Qt::ShiftModifier) {
-        if(treeWidget->itemBelow(item)) {
+        if(treeWidget->indexBelow(item).isValid()) {
             if (tableSelectionFlagDown) {
                 treeWidget->selectionModel()->setCurrentIndex( treeWidget->currentIndex(), QItemSelectionModel::Toggle| QItemSelectionModel::Rows);
                 tableSelectionFlagDown = false;
@@ -1299,7 +1155,7 @@ void TableDockWidget::keyPressEvent(QKeyEvent *e ) {
             tableSelectionFlagUp = true;
         }
     } else if ( e->key() == Qt::Key_Up && e->modifiers()==Qt::ShiftModifier) {
-        if (treeWidget->itemAbove(item)) {
+        if (treeWidget->indexAbove(item).isValid()) {
             if(tableSelectionFlagUp) {
                 treeWidget->selectionModel()->setCurrentIndex( treeWidget->currentIndex(), QItemSelectionModel::Toggle | QItemSelectionModel::Rows);
                 tableSelectionFlagUp = false;
@@ -1310,13 +1166,13 @@ void TableDockWidget::keyPressEvent(QKeyEvent *e ) {
         }
     }else if ( e->key() == Qt::Key_Down ) {
 
-        if(treeWidget->itemBelow(item)) {
-            treeWidget->setCurrentItem(treeWidget->itemBelow(item));
+        if(treeWidget->indexBelow(item).isValid()) {
+            treeWidget->setCurrentIndex(treeWidget->indexBelow(item));
         }
 	} else if ( e->key() == Qt::Key_Up ) {
 
-        if (treeWidget->itemAbove(item)) {
-            treeWidget->setCurrentItem(treeWidget->itemAbove(item));
+        if (treeWidget->indexAbove(item).isValid()) {
+            treeWidget->setCurrentIndex(treeWidget->indexAbove(item));
         }
 	} 
     QDockWidget::keyPressEvent(e);
@@ -1550,14 +1406,17 @@ void TableDockWidget::findMatchingCompounds() {
     //matching compounds
     MassCutoff *massCutoff = _mainwindow->getUserMassCutoff();
     float ionizationMode = _mainwindow->mavenParameters->ionizationMode;
+    bool changed = false;
     for(int i=0; i < allgroups.size(); i++ ) {
         PeakGroup& g = allgroups[i];
         int charge = _mainwindow->mavenParameters->getCharge(g.compound);
         QSet<Compound*>compounds = _mainwindow->massCalcWidget->findMathchingCompounds(g.meanMz, massCutoff, 
                     charge);
-        if (compounds.size() > 0 ) Q_FOREACH( Compound*c, compounds) { g.tagString += " |" + c->name; break; }
+        if (compounds.size() > 0 ) Q_FOREACH( Compound*c, compounds) { g.tagString += " |" + c->name; changed = true; break; }
         //cerr << g.meanMz << " " << compounds.size() << endl;
     }
+    //the journal does not record tags
+    if (changed) invalidateJournal();
     updateTable();
 }
 
@@ -1597,14 +1456,16 @@ void TableDockWidget::writeMascotGeneric(QString filename) {
     }
 
     QList<PeakGroup*>selected = getSelectedGroups();
+    vector<Scan*> consensus = PeakGroup::getAverageFragmenationScans(selected.toVector().toStdVector(),
+                                                                     _mainwindow->getUserMassCutoff());
     QTextStream out(&file);
     for(int i=0; i < selected.size(); i++ ) {
-        PeakGroup* g = selected[i];
-        Scan* cons = g->getAverageFragmenationScan(_mainwindow->getUserMassCutoff());
+        Scan* cons = consensus[i];
 
         if (cons) {
             string scandata = cons->toMGF();
             out << scandata.c_str();
+            delete cons;
         }
 
         /*
@@ -1750,6 +1611,9 @@ void TableDockWidget::align() {
         aligner.setMaxItterations(_mainwindow->alignmentDialog->maxItterations->value());
         aligner.setPolymialDegree(_mainwindow->alignmentDialog->polynomialDegree->value());
         aligner.doAlignment(groups);
+        //the journal does not record retention times
+        invalidateJournal();
+        featureMatrix.invalidate();
         _mainwindow->getEicWidget()->replotForced();
         showSelectedGroup();
     }
@@ -1870,9 +1734,19 @@ void TableDockWidget::savePeakTable() {
     QSettings* settings = _mainwindow->getSettings();
     if ( settings->contains("lastDir") ) dir = settings->value("lastDir").value<QString>();
 
+    QString selFilter;
+    QStringList filters;
+    filters << "Maven Project File(*.mzroll)"
+            << "Maven Binary Peak Table(*.mzrollb)";
+
     QString fileName = QFileDialog::getSaveFileName(this, tr("Save to Project File"),dir,
-            "Maven Project File(*.mzroll)");
+            filters.join(";;"), &selFilter);
     if (fileName.isEmpty()) return;
+    if (selFilter == filters[1] || fileName.endsWith(".mzrollb",Qt::CaseInsensitive)) {
+        if(!fileName.endsWith(".mzrollb",Qt::CaseInsensitive)) fileName = fileName + ".mzrollb";
+        savePeakTableBinary(fileName);
+        return;
+    }
     if(!fileName.endsWith(".mzroll",Qt::CaseInsensitive)) fileName = fileName + ".mzroll";
 
     _mainwindow->getProjectWidget()->saveProject(fileName,this);
@@ -1881,6 +1755,11 @@ void TableDockWidget::savePeakTable() {
 }
 
 void TableDockWidget::savePeakTable(QString fileName) {
+    if (fileName.endsWith(".mzrollb",Qt::CaseInsensitive)) {
+        savePeakTableBinary(fileName);
+        return;
+    }
+
     QFile file(fileName);
     if ( !file.open(QFile::WriteOnly) ) {
         QErrorMessage errDialog(this);
@@ -1903,6 +1782,7 @@ void TableDockWidget::loadPeakTable() {
     QString selFilter;
     QStringList filters;
     filters << "Maven Project File(*.mzroll)"
+            << "Maven Binary Peak Table(*.mzrollb)"
             << "mzPeaks XML(*.mzPeaks *.mzpeaks)"
             << "XCMS peakTable Tab Delimited(*.tab *.csv *.txt *.tsv)";
 
@@ -1912,7 +1792,7 @@ void TableDockWidget::loadPeakTable() {
                                                     filters.join(";;"),
                                                     &selFilter);
     if (fileName.isEmpty()) return;
-    if (selFilter == filters[2]) {
+    if (selFilter == filters[3]) {
         loadCSVFile(fileName,"\t");
     } else {
         loadPeakTable(fileName);
@@ -1989,8 +1869,137 @@ void TableDockWidget::markv_0_1_5mzroll(QString fileName){
    
     return;
 }
+void TableDockWidget::savePeakTableBinary(QString fileName) {
+    vector<PeakGroup*> groups;
+    for(int i=0; i < allgroups.size(); i++ ) groups.push_back(&allgroups[i]);
+
+    PeakTableFile peakTable;
+    if (!peakTable.write(fileName.toStdString(), groups, _mainwindow->getSamples())) {
+        QErrorMessage errDialog(this);
+        errDialog.showMessage(QString::fromStdString(peakTable.errorMessage));
+    }
+}
+
+/**
+ * goodPeakCount depends on the quality cut off, recount it if the table was
+ * saved with a different one
+ */
+static void applyMinQuality(PeakGroup& group, double minQuality) {
+    if (group.minQuality != minQuality) {
+        group.minQuality = minQuality;
+        group.goodPeakCount = 0;
+        for(unsigned int i=0; i < group.peaks.size(); i++ ) {
+            if (group.peaks[i].quality > minQuality) group.goodPeakCount++;
+        }
+    }
+    for(unsigned int i=0; i < group.children.size(); i++ ) applyMinQuality(group.children[i], minQuality);
+}
+
+static Compound* findCompound(const string& id, const string& name, const string& db) {
+    if (!name.empty() && !db.empty()) {
+        vector<Compound*> matches = DB.findSpeciesByName(name, db);
+        return matches.size() > 0 ? matches[0] : NULL;
+    }
+    return DB.findSpeciesById(id, DB.ANYDATABASE);
+}
+
+void TableDockWidget::loadPeakTableBinary(QString fileName) {
+    PeakTableFile peakTable;
+    peakTable.compoundResolver = findCompound;
+
+    vector<PeakGroup> groups;
+    if (!peakTable.read(fileName.toStdString(), _mainwindow->getSamples(), groups)) {
+        QErrorMessage errDialog(this);
+        errDialog.showMessage(QString::fromStdString(peakTable.errorMessage));
+        return;
+    }
+
+    //statistics were stored with the groups, no groupStatistics() needed
+    double minQuality = _mainwindow->mavenParameters->minQuality;
+    for(unsigned int i=0; i < groups.size(); i++ ) {
+        applyMinQuality(groups[i], minQuality);
+        addPeakGroup(&groups[i]);
+    }
+}
+
+static QString journalFileName(QString projectFile) {
+    return projectFile + ".journal";
+}
+
+bool TableDockWidget::saveJournal(QString projectFile) {
+    if (!journal.isStarted()) return false;
+    if (journal.fileName() != journalFileName(projectFile).toStdString()) return false;
+    if (journal.size() > maxJournalSize) return false;   //compact
+    return journal.flush();
+}
+
+void TableDockWidget::markJournal() {
+    journal.mark();
+}
+
+void TableDockWidget::startJournal(QString projectFile) {
+    if (!journal.start(journalFileName(projectFile).toStdString())) {
+        qDebug() << "Could not start journal for " << projectFile;
+    }
+}
+
+void TableDockWidget::invalidateJournal() {
+    journal.stop();
+}
+
+void TableDockWidget::logLabel(PeakGroup* group) {
+    if (!journal.isStarted()) return;
+    journal.logLabel(GroupJournal::pathOf(allgroups, group), group->label);
+}
+
+void TableDockWidget::replayJournal(QString projectFile, int firstGroup) {
+    QString fileName = journalFileName(projectFile);
+    if (!QFile::exists(fileName)) return;
+
+    vector<GroupJournal::Record> records;
+    if (!GroupJournal::read(fileName.toStdString(), _mainwindow->getSamples(), records, findCompound)) {
+        qDebug() << "Could not read journal " << fileName;
+        return;
+    }
+
+    double minQuality = _mainwindow->mavenParameters->minQuality;
+    for(unsigned int i=0; i < records.size(); i++ ) {
+        GroupJournal::Record& record = records[i];
+        if (record.operation == GroupJournal::Add) {
+            applyMinQuality(record.group, minQuality);
+            addPeakGroup(&record.group);
+            continue;
+        }
+
+        //paths count from the first group of the saved table
+        record.path[0] += firstGroup;
+        PeakGroup* group = GroupJournal::groupAt(allgroups, record.path);
+        if (!group) {
+            qDebug() << "Journal " << fileName << " does not match its project, stopped at record " << i;
+            break;
+        }
+
+        if (record.operation == GroupJournal::Label) {
+            group->setLabel(record.label);
+        } else if (record.operation == GroupJournal::Delete) {
+            if (group->parent) peakTableModel->deleteChild(group);
+            else deleteGroup(group);
+        }
+    }
+}
+
 void TableDockWidget::loadPeakTable(QString fileName) {
 
+    //loaded groups are not in the journal of the table
+    invalidateJournal();
+    int firstGroup = allgroups.size();
+
+    if (PeakTableFile::isPeakTableFile(fileName.toStdString())) {
+        loadPeakTableBinary(fileName);
+        replayJournal(fileName, firstGroup);
+        return;
+    }
+
     markv_0_1_5mzroll(fileName);    /**@brief- mark varible <mzrollv_0_1_5>*/
 
     QFile data(fileName);
@@ -2037,88 +2046,83 @@ void TableDockWidget::loadPeakTable(QString fileName) {
         allgroups[i].minQuality = _mainwindow->mavenParameters->minQuality;
         allgroups[i].groupStatistics();
     }
+    //groups got their peaks after they were added
+    featureMatrix.invalidate();
+    replayJournal(fileName, firstGroup);
 }
 
 void TableDockWidget::clearClusters() {
 
     for(unsigned int i=0; i<allgroups.size(); i++) allgroups[i].clusterId=0;
+    invalidateJournal();
     showAllGroups();
 }
 
 void TableDockWidget::clusterGroups() {
 
+    //a second click while clustering cancels the running job
+    if (runningClustering) {
+        cancelClustering();
+        return;
+    }
+
     sort(allgroups.begin(),allgroups.end(), PeakGroup::compRt);
+    invalidateJournal();
+    rebuildGroupIndex();
+    featureMatrix.clear();
+    peakTableModel->rebuild();
     qDebug() << "Clustering..";
-    int clusterId = 0;
 
-    QSettings* settings = _mainwindow->getSettings();
-    double maxRtDiff =  clusterDialog->maxRtDiff_2->value();
-    double minSampleCorrelation =  clusterDialog->minSampleCorr->value();
-    double minRtCorrelation = clusterDialog->minRt->value();
     MassCutoff* massCutoff	= _mainwindow->getUserMassCutoff();
-
     vector<mzSample*> samples = _mainwindow->getSamples();
 
-    //clear cluster information
-    for(unsigned int i=0; i<allgroups.size(); i++) allgroups[i].clusterId=0;
-    map<int,PeakGroup*>parentGroups;
-
-
-    for(unsigned int i=0; i<allgroups.size(); i++) {
-        PeakGroup& grup1 = allgroups[i];
-
-        if (grup1.clusterId == 0) {  //create new cluster
-            grup1.clusterId=++clusterId;
-            parentGroups[clusterId]=&grup1;
-        }
-
-        //cluster parent
-        PeakGroup* parent = parentGroups[ clusterId ];
-
-        mzSample* largestSample=NULL;
-        double maxIntensity=0; int countCheckRaghu=0;
-
-        for(int i=0; i < grup1.peakCount(); i++ ) {
-            mzSample* sample = grup1.peaks[i].getSample();
-            if ( grup1.peaks[i].peakIntensity > maxIntensity ) largestSample=sample;
-        }
-
-        if (largestSample == NULL ) continue;
-        vector<float>peakIntensityA = grup1.getOrderedIntensityVector(samples,PeakGroup::AreaTop);
-
-        for(unsigned int j=i+1; j<allgroups.size(); j++) {
-            PeakGroup& grup2 = allgroups[j];
-            if (grup2.clusterId > 0 ) continue;
-
-            //retention time distance
-            float rtdist  = abs(parent->meanRt-grup2.meanRt);
-            if (rtdist > maxRtDiff*2 ) continue;
-
-            //retention time overlap
-            float rtoverlap = mzUtils::checkOverlap(grup1.minRt, grup1.maxRt, grup2.minRt, grup2.maxRt );
-            if (rtoverlap < 0.1) continue;
-
-            //peak intensity correlation
-            vector<float>peakIntensityB = grup2.getOrderedIntensityVector(samples,PeakGroup::AreaTop);
-            float cor = correlation(peakIntensityA,peakIntensityB);
-            if (cor < minSampleCorrelation) continue;
-
-            //peak shape correlation
-            float cor2 = largestSample->correlation(grup1.meanMz,grup2.meanMz,massCutoff,grup1.minRt,grup1.maxRt,
-                                                    _mainwindow->mavenParameters->eicType,
-                                                    _mainwindow->mavenParameters->filterline);
-            if (cor2 < minRtCorrelation) continue;
+    GroupClustering clustering(massCutoff,
+                               _mainwindow->mavenParameters->eicType,
+                               _mainwindow->mavenParameters->filterline);
+    clustering.maxRtDiff = clusterDialog->maxRtDiff_2->value();
+    clustering.minSampleCorrelation = clusterDialog->minSampleCorr->value();
+    clustering.minRtCorrelation = clusterDialog->minRt->value();
+    clustering.boostSignal.connect(boost::bind(&TableDockWidget::clusteringProgress, this, _1, _2, _3));
+
+    vector<PeakGroup*> groups;
+    for(int i=0; i<allgroups.size(); i++) groups.push_back(&allgroups[i]);
+
+    //clustering holds pointers to the groups while clusteringProgress
+    //processes events, so only the cancel button may take input until it
+    //returns; closing the dialog cancels as well
+    setClusterDialogModal(true);
+    runningClustering = &clustering;
+    clusterDialog->clusterButton->setText("Cancel");
+    clustering.cluster(groups, samples, &getFeatureMatrix());
+    clusterDialog->clusterButton->setText("Cluster");
+    runningClustering = NULL;
+    setClusterDialogModal(false);
+
+    if (clustering.wasCancelled()) {
+        _mainwindow->setProgressBar("Clustering cancelled",allgroups.size(),allgroups.size());
+    } else {
+        _mainwindow->setProgressBar("Clustering., done!",allgroups.size(),allgroups.size());
+    }
+    showAllGroups();
+}
 
-            //passed all the filters.. group grup1 and grup2 into a single metagroup
-            //cerr << rtdist << " " << cor << " " << cor2 << endl;
-            grup2.clusterId = grup1.clusterId;
-        }
-        if (i%10==0) _mainwindow->setProgressBar("Clustering.,",i+1,allgroups.size());
+void TableDockWidget::cancelClustering() {
+    if (runningClustering) runningClustering->cancel();
+}
 
-    }
+void TableDockWidget::setClusterDialogModal(bool modal) {
+    //modality of a visible window only changes when it is shown again
+    bool visible = clusterDialog->isVisible();
+    clusterDialog->hide();
+    clusterDialog->setWindowModality(modal ? Qt::ApplicationModal : Qt::NonModal);
+    clusterDialog->clearButton->setEnabled(!modal);
+    if (visible || modal) clusterDialog->show();
+}
 
-    _mainwindow->setProgressBar("Clustering., done!",allgroups.size(),allgroups.size());
-    showAllGroups();
+void TableDockWidget::clusteringProgress(const string& progressText, unsigned int completed, int total) {
+    _mainwindow->setProgressBar(QString::fromStdString(progressText), completed, total);
+    //keeps the cancel button responsive, clustering reports between blocks only
+    QCoreApplication::processEvents();
 }
 
 void TableDockWidget::setupFiltersDialog() {
@@ -2163,23 +2167,8 @@ void TableDockWidget::filterPeakTable() {
 
 
 void TableDockWidget::showFocusedGroups() {
-    int N=treeWidget->topLevelItemCount();
-    for(int i=0; i < N; i++ ) {
-        QTreeWidgetItem* item = treeWidget->topLevelItem(i);
-        QVariant v = item->data(0,Qt::UserRole);
-        PeakGroup*  group =  v.value<PeakGroup*>();
-        if (group && group->isFocused) item->setHidden(false); else item->setHidden(true);
-       
-        if ( item->text(0).startsWith("Cluster") ) {
-            bool showParentFlag=false;
-            for(int j=0; j<item->childCount();j++) {
-                QVariant v = (item->child(j))->data(0,Qt::UserRole);
-                PeakGroup*  group =  v.value<PeakGroup*>();
-                if (group && group->isFocused) { item->setHidden(false); showParentFlag=true; } else item->setHidden(true);
-            }
-            if (showParentFlag) item->setHidden(false);
-        }
-    }
+    focusedGroupsOnly = true;
+    peakTableModel->rebuild();
 }
 
 void TableDockWidget::clearFocusedGroups() {
@@ -2190,11 +2179,8 @@ void TableDockWidget::clearFocusedGroups() {
 
 void TableDockWidget::unhideFocusedGroups() {
     clearFocusedGroups();
-    QTreeWidgetItemIterator it(treeWidget);
-    while (*it) {
-        (*it)->setHidden(false);
-        ++it;
-    }
+    focusedGroupsOnly = false;
+    peakTableModel->rebuild();
 }
 
 
@@ -2319,14 +2305,28 @@ MatrixXf TableDockWidget::getGroupMatrix() {
 MatrixXf TableDockWidget::getGroupMatrix(vector<mzSample*>& samples, PeakGroup::QType qtype) {
     MatrixXf X;  //matrix of floats
     X = MatrixXf::Zero(allgroups.size(),samples.size());
+    FeatureMatrix& matrix = getFeatureMatrix();
+    vector<int> columns = matrix.columns(samples);
     for(int i=0; i < allgroups.size(); i++ ) {
-            vector<float>values=allgroups[i].getOrderedIntensityVector(samples,qtype);
-            for(int j=0; j < values.size(); j++ ) {  X(i,j)=values[j];
+            const float* values = matrix.values(matrix.row(&allgroups[i]), qtype);
+            for(int j=0; j < columns.size(); j++ ) {
+                if (columns[j] >= 0) X(i,j)=values[columns[j]];
             }
     }
     return X;
 }
 
+FeatureMatrix& TableDockWidget::getFeatureMatrix() {
+    vector<mzSample*> samples = _mainwindow->getSamples();
+    if (featureMatrix.rowCount() != (unsigned int) allgroups.size() || featureMatrix.samples() != samples) {
+        vector<PeakGroup*> groups;
+        for(int i=0; i < allgroups.size(); i++) groups.push_back(&allgroups[i]);
+        featureMatrix.build(groups, samples);
+    }
+    featureMatrix.refreshNormalization();
+    return featureMatrix;
+}
+
 QWidget* TableToolBarWidgetAction::createWidget(QWidget *parent) {
 
 
@@ -2,6 +2,7 @@
 #define TABLEDOCKWIDGET_H
 
 #include <algorithm>
+#include <functional>
 #include "stable.h"
 #include "mainwindow.h"
 #include "alignmentvizwidget.h"
@@ -10,6 +11,12 @@
 #include "numeric_treewidgetitem.h"
 #include "QHistogramSlider.h"
 #include "saveJson.h"
+#include "groupClustering.h"
+#include "groupIndex.h"
+#include "featureMatrix.h"
+#include "peakTableFile.h"
+#include "groupJournal.h"
+#include "peaktablemodel.h"
 
 class MainWindow;
 class AlignmentVizWidget;
@@ -21,6 +28,7 @@ using namespace std;
 
 class TableDockWidget: public QDockWidget {
       Q_OBJECT
+      friend class PeakTableModel;
 
 public:
     /**
@@ -41,7 +49,8 @@ public:
     MainWindow* _mainwindow;
     QWidget 	*dockWidgetContents;
     QHBoxLayout *horizontalLayout;
-    QTreeWidget *treeWidget;
+    QTreeView *treeWidget;
+    PeakTableModel *peakTableModel;
     QToolButton *btnMerge;
     QMenu* btnMergeMenu;
     QLabel *titlePeakTable;
@@ -80,6 +89,11 @@ public:
     */
     bool hasPeakGroup(PeakGroup* group);
 	QList<PeakGroup*> getGroups();
+    /**
+     * @brief true if group points to one of the groups of this table
+     * @details compares addresses only, so group may already be freed
+     */
+    bool holdsGroup(PeakGroup* group);
     int tableId;
     /**< for making old mzroll compatible, this will act as a flag
     *whether loaded mzroll file is old or new one. this will be set by class
@@ -89,6 +103,11 @@ public:
     //Added when Merging to Maven776 - Kiran
     MatrixXf getGroupMatrix();
     MatrixXf getGroupMatrix(vector<mzSample*>& samples, PeakGroup::QType qtype);
+    /**
+     * @brief quantities of all groups of the table in all samples
+     * @details rebuilt when groups or samples changed since the last call
+     */
+    FeatureMatrix& getFeatureMatrix();
     void setTableId();
     void setIntensityColName();
     float extractMaxIntensity(PeakGroup* group);
@@ -103,7 +122,7 @@ public Q_SLOTS:
        */
       void updateCompoundWidget();
       PeakGroup* addPeakGroup(PeakGroup* group);
-      void sortChildrenAscending(QTreeWidgetItem* item);
+      void sortChildrenAscending(const QModelIndex& index);
 	  void setupPeakTable();
       void showLog();
 	  PeakGroup* getSelectedGroup();
@@ -115,12 +134,42 @@ public Q_SLOTS:
       //input from xml
           void loadPeakTable();
           void loadPeakTable(QString infile);
+          void loadPeakTableBinary(QString infile);
 
       //output to xml
 	  void savePeakTable();
           void savePeakTable(QString fileName);
 	  void writePeakTableXML(QXmlStreamWriter& stream);
 
+      //output to binary peak table, see PeakTableFile
+          void savePeakTableBinary(QString fileName);
+
+      //incremental autosave, see GroupJournal
+          /**
+           * @brief append edits since the last save to the journal of a project file
+           * @return false if the table has to be saved in full instead
+           */
+          bool saveJournal(QString projectFile);
+          /**
+           * @brief a full save of the table begins, edits from now on go to the
+           * journal startJournal() begins
+           */
+          void markJournal();
+          /**
+           * @brief the table was saved in full to a project file, journal edits from now on
+           */
+          void startJournal(QString projectFile);
+          /**
+           * @brief replay the journal of a project file over the groups loaded from it
+           * @param firstGroup index in allgroups of the first group loaded from the file
+           */
+          void replayJournal(QString projectFile, int firstGroup);
+          /**
+           * @brief groups changed in a way the journal can not record, next save is a full one
+           */
+          void invalidateJournal();
+          void logLabel(PeakGroup* group);
+
       //output to csv file
       //Added when Merging to Maven776 - Kiran
       void exportGroupsToSpreadsheet();
@@ -168,7 +217,7 @@ public Q_SLOTS:
 	  void saveModel();
 	  void printPdfReport();
 	  void updateTable();
-	  void updateItem(QTreeWidgetItem* item);
+	  void updateGroup(PeakGroup* group);
 	  void updateStatus();
         //   void runScript();
 
@@ -200,6 +249,7 @@ public Q_SLOTS:
 	  void align();
 	  void deleteAll();
           void clusterGroups();
+          void cancelClustering();
 	  void findMatchingCompounds();
       void showFiltersDialog();
       void filterPeakTable();
@@ -236,8 +286,8 @@ private:
     QPalette pal;    
     void showSameGroup(QPair<int, int> sameMzRtGroupIndexHash);
           void deletePeaks();
-          void addRow(PeakGroup* group, QTreeWidgetItem* root);
-          void heatmapBackground(QTreeWidgetItem* item);
+          //true if the quality of a peak of the group or its children changed
+          bool classifyGroup(Classifier* clsf, PeakGroup* group);
 	  PeakGroup* readGroupXML(QXmlStreamReader& xml,PeakGroup* parent);
           void writeGroupXML(QXmlStreamWriter& stream, PeakGroup* g);
       void readPeakXML(QXmlStreamReader& xml,PeakGroup* parent);
@@ -255,15 +305,26 @@ private:
     */
     void markv_0_1_5mzroll(QString fileName);
 	  void setupFiltersDialog();
+          void clusteringProgress(const string& progressText, unsigned int completed, int total);
+          void setClusterDialogModal(bool modal);
+
+          void rebuildGroupIndex();
 
           QList<PeakGroup>allgroups;
+          GroupIndex groupIndex;
+          FeatureMatrix featureMatrix;
+          GroupJournal journal;
+          //journals larger than this are compacted by a full save
+          static const unsigned long maxJournalSize = 16 * 1024 * 1024;
 
           TrainDialog* traindialog;
           ClusterDialog*       clusterDialog;
+          GroupClustering*     runningClustering;
           QDialog* 	 filtersDialog;
           QMap<QString, QHistogramSlider*> sliders;
         float rtWindow=2;
           tableViewType viewType;
+          bool focusedGroupsOnly;
           peakTableSelectionType peakTableSelection;
           QList<PeakGroup*> getCustomGroups(peakTableSelectionType peakSelection);
           bool tableSelectionFlagUp;
@@ -47,6 +47,16 @@ HEADERS += \
     testSRMList.h \
     testGroupFiltering.h \
     testIsotopeLogic.h \
+    testFragment.h \
+    testSpectralLibrary.h \
+    testFeatureMatrix.h \
+    testCompareSamples.h \
+    testEicService.h \
+    testGroupClustering.h \
+    testGroupIndex.h \
+    testGroupJournal.h \
+    testMS2Index.h \
+    testPeptide.h \
     $$top_srcdir/src/cli/peakdetector/PeakDetectorCLI.h \
     $$top_srcdir/src/core/libmaven/classifier.h \
     $$top_srcdir/src/core/libmaven/classifierNeuralNet.h \
@@ -71,6 +81,16 @@ SOURCES += \
     testSRMList.cpp \
     testGroupFiltering.cpp \
     testIsotopeLogic.cpp \
+    testFragment.cpp \
+    testSpectralLibrary.cpp \
+    testFeatureMatrix.cpp \
+    testCompareSamples.cpp \
+    testEicService.cpp \
+    testGroupClustering.cpp \
+    testGroupIndex.cpp \
+    testGroupJournal.cpp \
+    testMS2Index.cpp \
+    testPeptide.cpp \
     main.cpp \
     $$top_srcdir/src/cli/peakdetector/PeakDetectorCLI.cpp  \
     $$top_srcdir/src/cli/peakdetector/options.cpp \
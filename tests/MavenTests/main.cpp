@@ -15,6 +15,16 @@
 #include "testCharge.h"
 #include "testSRMList.h"
 #include "testIsotopeLogic.h"
+#include "testFragment.h"
+#include "testSpectralLibrary.h"
+#include "testFeatureMatrix.h"
+#include "testCompareSamples.h"
+#include "testEicService.h"
+#include "testGroupClustering.h"
+#include "testGroupIndex.h"
+#include "testGroupJournal.h"
+#include "testMS2Index.h"
+#include "testPeptide.h"
 
 int readLog(QString);
 
@@ -79,6 +89,46 @@ int main(int argc, char** argv) {
         result |= QTest::qExec(new TestIsotopeLogic, argc, argv);
     result|=readLog("testIsotopeLogic.xml");
 
+    if (freopen("testFragment.xml", "w", stdout))
+        result |= QTest::qExec(new TestFragment, argc, argv);
+    result|=readLog("testFragment.xml");
+
+    if (freopen("testSpectralLibrary.xml", "w", stdout))
+        result |= QTest::qExec(new TestSpectralLibrary, argc, argv);
+    result|=readLog("testSpectralLibrary.xml");
+
+    if (freopen("testFeatureMatrix.xml", "w", stdout))
+        result |= QTest::qExec(new TestFeatureMatrix, argc, argv);
+    result|=readLog("testFeatureMatrix.xml");
+
+    if (freopen("testCompareSamples.xml", "w", stdout))
+        result |= QTest::qExec(new TestCompareSamples, argc, argv);
+    result|=readLog("testCompareSamples.xml");
+
+    if (freopen("testEicService.xml", "w", stdout))
+        result |= QTest::qExec(new TestEicService, argc, argv);
+    result|=readLog("testEicService.xml");
+
+    if (freopen("testGroupClustering.xml", "w", stdout))
+        result |= QTest::qExec(new TestGroupClustering, argc, argv);
+    result|=readLog("testGroupClustering.xml");
+
+    if (freopen("testGroupIndex.xml", "w", stdout))
+        result |= QTest::qExec(new TestGroupIndex, argc, argv);
+    result|=readLog("testGroupIndex.xml");
+
+    if (freopen("testGroupJournal.xml", "w", stdout))
+        result |= QTest::qExec(new TestGroupJournal, argc, argv);
+    result|=readLog("testGroupJournal.xml");
+
+    if (freopen("testMS2Index.xml", "w", stdout))
+        result |= QTest::qExec(new TestMS2Index, argc, argv);
+    result|=readLog("testMS2Index.xml");
+
+    if (freopen("testPeptide.xml", "w", stdout))
+        result |= QTest::qExec(new TestPeptide, argc, argv);
+    result|=readLog("testPeptide.xml");
+
     return result;
 }
 
@@ -178,6 +178,27 @@ void TestCLI::testWriteReport() {
         QFileInfo mzrollFile(QString::fromStdString(peakdetectorCLI->mavenParameters->outputdir + "testmzRoll" + ".mzroll"));
         QVERIFY(mzrollFile.exists() && mzrollFile.isFile());
 
+        string binaryFile = peakdetectorCLI->mavenParameters->outputdir + "testmzRoll" + ".mzrollb";
+        peakdetectorCLI->writePeakTableBinary(binaryFile);
+        QVERIFY(PeakTableFile::isPeakTableFile(binaryFile));
+
+        PeakTableFile peakTable;
+        vector<PeakGroup> groups;
+        QVERIFY(peakTable.read(binaryFile, peakdetectorCLI->mavenParameters->samples, groups));
+        QVERIFY(groups.size() == peakdetectorCLI->mavenParameters->allgroups.size());
+        for (unsigned int i = 0; i < groups.size(); i++) {
+            PeakGroup& saved = peakdetectorCLI->mavenParameters->allgroups[i];
+            QVERIFY(groups[i].peaks.size() == saved.peaks.size());
+            QVERIFY(groups[i].children.size() == saved.children.size());
+            QVERIFY(groups[i].meanMz == saved.meanMz && groups[i].meanRt == saved.meanRt);
+            QVERIFY(groups[i].maxIntensity == saved.maxIntensity);
+            QVERIFY(groups[i].goodPeakCount == saved.goodPeakCount);
+            for (unsigned int j = 0; j < groups[i].peaks.size(); j++) {
+                QVERIFY(groups[i].peaks[j].getSample() == saved.peaks[j].getSample());
+                QVERIFY(groups[i].peaks[j].peakAreaTopCorrected == saved.peaks[j].peakAreaTopCorrected);
+            }
+        }
+
         peakdetectorCLI->saveCSV("testcsv");
         QFileInfo csvFile(QString::fromStdString(peakdetectorCLI->mavenParameters->outputdir + "testcsv" + ".csv"));
         QVERIFY(csvFile.exists() && csvFile.isFile());
@@ -0,0 +1,96 @@
+#include "testCompareSamples.h"
+#include <algorithm>
+
+
+TestCompareSamples::TestCompareSamples() {
+}
+
+void TestCompareSamples::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+    groups = common::getGroupsFromProcessCompounds();
+    for (unsigned int i = 0; i < groups.size(); i++) {
+        vector<Peak>& peaks = groups[i].getPeaks();
+        for (unsigned int j = 0; j < peaks.size(); j++) {
+            mzSample* sample = peaks[j].getSample();
+            if (find(samples.begin(), samples.end(), sample) == samples.end())
+                samples.push_back(sample);
+        }
+    }
+}
+
+void TestCompareSamples::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestCompareSamples::init() {
+    // This function is executed before each test
+}
+
+void TestCompareSamples::cleanup() {
+    // This function is executed after each test
+}
+
+void TestCompareSamples::testComputeStats() {
+    QVERIFY(samples.size() > 1);
+    vector<mzSample*> sset1(1, samples[0]);
+    vector<mzSample*> sset2(1, samples[1]);
+
+    QList<PeakGroup*> allgroups;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        allgroups.push_back(&groups[i]);
+
+    CompareSamplesLogic compareLogic;
+    compareLogic.permutations = 200;
+    compareLogic.computeStats(allgroups, sset1, sset2, 1);
+
+    vector<float> pValues;
+    for (unsigned int i = 0; i < groups.size(); i++) {
+        PeakGroup& group = groups[i];
+        vector<float> y = group.getOrderedIntensityVector(samples, PeakGroup::AreaTop);
+        float meanA = max(y[0], 1.0f);
+        float meanB = max(y[1], 1.0f);
+        QVERIFY(common::floatCompare(group.changeFoldRatio, log2(meanA / meanB)));
+        QVERIFY(group.changePValue >= 0 && group.changePValue <= 1);
+        if (group.changeFoldRatio == 0)
+            QVERIFY(group.changePValue == 1);
+        pValues.push_back(group.changePValue);
+    }
+
+    //same seed gives the same p-values, also when reading a feature matrix
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        rows.push_back(&groups[i]);
+    FeatureMatrix featureMatrix;
+    featureMatrix.build(rows, samples);
+    compareLogic.computeStats(allgroups, sset1, sset2, 1, &featureMatrix);
+    for (unsigned int i = 0; i < groups.size(); i++)
+        QVERIFY(groups[i].changePValue == pValues[i]);
+}
+
+void TestCompareSamples::testFDRCorrection() {
+    float p[] = { 0.01, 0.04, 0.035, 0.005, 0.5 };
+    vector<PeakGroup> tested(6);
+    QList<PeakGroup*> allgroups;
+    for (unsigned int i = 0; i < tested.size(); i++) {
+        tested[i].changeFoldRatio = i < 5 ? 1 : 0;
+        tested[i].changePValue = i < 5 ? p[i] : 1;
+        allgroups.push_back(&tested[i]);
+    }
+
+    //Benjamini-Hochberg, 0.04 * 5 / 4 also bounds the adjusted 0.035
+    CompareSamplesLogic compareLogic;
+    compareLogic.FDRCorrection(allgroups, 3);
+    float bh[] = { 0.025, 0.05, 0.05, 0.025, 0.5 };
+    for (unsigned int i = 0; i < 5; i++)
+        QVERIFY(common::floatCompare(tested[i].changePValue, bh[i]));
+    QVERIFY(tested[5].changePValue == 1);
+
+    //Holm, 0.035 * 3 also bounds the adjusted 0.04 from below
+    for (unsigned int i = 0; i < 5; i++)
+        tested[i].changePValue = p[i];
+    compareLogic.FDRCorrection(allgroups, 2);
+    float holm[] = { 0.04, 0.105, 0.105, 0.025, 0.5 };
+    for (unsigned int i = 0; i < 5; i++)
+        QVERIFY(common::floatCompare(tested[i].changePValue, holm[i]));
+}
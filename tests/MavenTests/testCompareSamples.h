@@ -0,0 +1,35 @@
+#ifndef TESTCOMPARESAMPLES_H
+#define TESTCOMPARESAMPLES_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "comparesampleslogic.h"
+#include "PeakGroup.h"
+
+
+class TestCompareSamples : public QObject {
+    Q_OBJECT
+
+    public:
+        TestCompareSamples();
+    private:
+        vector<PeakGroup> groups;
+        vector<mzSample*> samples;
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testComputeStats();
+        void testFDRCorrection();
+};
+
+#endif // TESTCOMPARESAMPLES_H
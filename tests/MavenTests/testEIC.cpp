@@ -38,6 +38,47 @@ void TestEIC::testgetEIC() {
     QVERIFY(e.intensity.size() == numberOfScans && status);
 }
 
+void TestEIC::testgetEICs() {
+    mzSample* mzsample = new mzSample();
+    mzsample->loadSample(loadGoodSample);
+
+    //overlapping, nested, unsorted and out of range windows
+    vector<mzSlice> slices;
+    slices.push_back(mzSlice(402.9929, 402.9969, 12.0, 16.0));
+    slices.push_back(mzSlice(180.002, 180.004, 0, 2));
+    slices.push_back(mzSlice(402.99, 403.01, 0, 30));
+    slices.push_back(mzSlice(402.9949, 402.9959, 14.0, 15.0));
+    slices.push_back(mzSlice(150.0, 450.0, 10.0, 10.5));
+    slices.push_back(mzSlice(5000.0, 5001.0, 0, 30));
+
+    for (int eicType = 0; eicType <= 1; eicType++) {
+        vector<EIC*> eics = mzsample->getEICs(slices, 1, eicType, "");
+        QVERIFY(eics.size() == slices.size());
+
+        for (unsigned int i = 0; i < slices.size(); i++) {
+            EIC* e = mzsample->getEIC(slices[i].mzmin, slices[i].mzmax,
+                                      slices[i].rtmin, slices[i].rtmax,
+                                      1, eicType, "");
+            QVERIFY(eics[i]->scannum == e->scannum);
+            QVERIFY(eics[i]->rt == e->rt);
+            //summed windows without signal have a nan m/z in both
+            QVERIFY(eics[i]->mz.size() == e->mz.size());
+            for (unsigned int j = 0; j < e->mz.size(); j++) {
+                QVERIFY(eics[i]->mz[j] == e->mz[j]
+                        || (std::isnan(eics[i]->mz[j]) && std::isnan(e->mz[j])));
+            }
+            QVERIFY(eics[i]->intensity == e->intensity);
+            QVERIFY(eics[i]->mzmin == e->mzmin && eics[i]->mzmax == e->mzmax);
+            QVERIFY(eics[i]->rtmin == e->rtmin && eics[i]->rtmax == e->rtmax);
+            QVERIFY(eics[i]->maxIntensity == e->maxIntensity);
+            QVERIFY(eics[i]->totalIntensity == e->totalIntensity);
+            delete e;
+            delete eics[i];
+        }
+    }
+    delete mzsample;
+}
+
 void TestEIC::testgetEICms2() {
     mzSample* mzsample = new mzSample();
     mzSample* mzsample_2 = new mzSample();
@@ -327,3 +368,158 @@ void TestEIC:: testeicMerge() {
     QVERIFY(17.039 < m->rtmax < 17.040);
 }
 
+void TestEIC::testvisiblePoints() {
+    mzSample* mzsample = new mzSample();
+    mzsample->loadSample(loadFile);
+    EIC e;
+    e.makeEICSlice(mzsample, 180.002,180.004, 0, 2, 1, 0, "");
+
+    float rtmin = e.rt[10];
+    float rtmax = e.rt[e.size() - 10];
+    vector<unsigned int> visible;
+
+    //enough resolution: every point in range is kept
+    e.visiblePoints(rtmin, rtmax, e.size(), false, visible);
+    QVERIFY(visible.size() == e.size() - 19);
+    QVERIFY(visible.front() == 10 && visible.back() == e.size() - 10);
+
+    //decimated: bounded, ordered, in range and keeps the apex
+    e.visiblePoints(rtmin, rtmax, 40, false, visible);
+    QVERIFY(visible.size() <= 40);
+    float maxInRange = 0;
+    for (unsigned int i = 10; i <= e.size() - 10; i++)
+        maxInRange = max(maxInRange, e.intensity[i]);
+    float maxVisible = 0;
+    for (unsigned int i = 0; i < visible.size(); i++) {
+        QVERIFY(e.rt[visible[i]] >= rtmin && e.rt[visible[i]] <= rtmax);
+        if (i > 0) QVERIFY(visible[i] > visible[i - 1]);
+        maxVisible = max(maxVisible, e.intensity[visible[i]]);
+    }
+    QVERIFY(maxVisible == maxInRange);
+}
+
+void TestEIC::testCorrelations() {
+    mzSample* mzsample = new mzSample();
+    mzsample->loadSample(loadFile);
+    MassCutoff* massCutoff = new MassCutoff();
+    massCutoff->setMassCutoffAndType(10, "ppm");
+
+    vector<float> mzs;
+    mzs.push_back(180.0034);
+    mzs.push_back(181.0068);
+    mzs.push_back(202.9853);
+    mzs.push_back(664.1182);
+    float rtmin = 0, rtmax = 3;
+
+    //every element matches a correlation of two freshly pulled EICs
+    vector<vector<float> > matrix = mzsample->correlations(mzs, massCutoff, rtmin, rtmax, 0, "");
+    QVERIFY(matrix.size() == mzs.size());
+    for (unsigned int i = 0; i < mzs.size(); i++) {
+        float w1 = massCutoff->massCutoffValue(mzs[i]);
+        EIC* e1 = mzsample->getEIC(mzs[i] - w1, mzs[i] + w1, rtmin, rtmax, 1, 0, "");
+        for (unsigned int j = 0; j < mzs.size(); j++) {
+            float w2 = massCutoff->massCutoffValue(mzs[j]);
+            EIC* e2 = mzsample->getEIC(mzs[j] - w2, mzs[j] + w2, rtmin, rtmax, 1, 0, "");
+            float expected = mzUtils::correlation(e1->intensity, e2->intensity);
+            QVERIFY(fabs(matrix[i][j] - expected) < 1e-5);
+            QVERIFY(matrix[i][j] == matrix[j][i]);
+            delete e2;
+        }
+        delete e1;
+    }
+
+    //pairs are served from the traces cached above
+    unsigned long cached = mzsample->traceCache.size();
+    QVERIFY(cached > 0);
+    QVERIFY(fabs(mzsample->correlation(mzs[0], mzs[1], massCutoff, rtmin, rtmax, 0, "")
+                 - matrix[0][1]) < 1e-6);
+    QVERIFY(mzsample->traceCache.size() == cached);
+
+    //a new normalization constant empties the cache
+    mzsample->setNormalizationConstant(2);
+    mzsample->correlation(mzs[0], mzs[1], massCutoff, rtmin, rtmax, 0, "");
+    QVERIFY(mzsample->traceCache.size() < cached);
+
+    delete massCutoff;
+    delete mzsample;
+}
+
+//sigma search used before the closed form fit, kept as the golden reference
+static void referenceGaussFit(const vector<float>& ycoord, float* sigma, float* R2) {
+    float s = 20;
+    float min_s = 0;
+    float minR = 1e99;
+
+    if (ycoord.size() < 3) return;
+    vector<float> yobs = ycoord;
+    int ysize = yobs.size();
+    int midpoint = int(ysize / 2);
+    float ymax = max(max(yobs[midpoint], yobs[midpoint - 1]), yobs[midpoint + 1]);
+    float ymin = min(yobs[0], yobs[ysize - 1]);
+
+    int xinit = int(ysize / 2) * -1;
+    vector<float> x(ysize, 0);
+    int greaterZeroCount = 0;
+    for (int i = 0; i < ysize; i++) {
+        x[i] = xinit + i;
+        if (yobs[i] > ymin) greaterZeroCount++;
+        yobs[i] = (yobs[i] - ymin) / (ymax - ymin);
+        if (yobs[i] < 0) yobs[i] = 0;
+    }
+
+    if (greaterZeroCount <= 3) return;
+    for (int ittr = 0; ittr <= 20; ittr++) {
+        float Rsqr = 0;
+        for (int i = 0; i < ysize; i++)
+            Rsqr += POW2(exp(-0.5 * POW2(x[i] / s)) - yobs[i]);
+        if (Rsqr < minR) { minR = Rsqr; min_s = s; }
+        else if (Rsqr >= minR) break;
+        s /= 1.25;
+    }
+
+    *sigma = min_s;
+    *R2 = minR / (ysize * ysize);
+}
+
+void TestEIC::testGaussFit() {
+    mzSample* mzsample = new mzSample();
+    mzsample->loadSample(loadGoodSample);
+
+    int fitted = 0;
+    int sameSigma = 0;
+    for (float mz = 100; mz < 1000; mz += 7.5) {
+        EIC* e = mzsample->getEIC(mz - 0.005, mz + 0.005, mzsample->minRt, mzsample->maxRt, 1, 0, "");
+        e->setSmootherType(EIC::GAUSSIAN);
+        e->setBaselineSmoothingWindow(5);
+        e->setBaselineDropTopX(80);
+        e->setFilterSignalBaselineDiff(0);
+        e->getPeakPositions(10);
+
+        for (unsigned int p = 0; p < e->peaks.size(); p++) {
+            Peak& peak = e->peaks[p];
+            int pos = peak.pos;
+            int moves = min(pos - (int)peak.minpos, (int)peak.maxpos - pos);
+            if (moves < 3 || pos - moves < 1 || pos + moves >= (int)e->size())
+                continue;
+
+            vector<float> pints(e->intensity.begin() + pos - moves,
+                                e->intensity.begin() + pos + moves + 1);
+            float sigma = 0, R2 = 0.03;
+            referenceGaussFit(pints, &sigma, &R2);
+
+            //same grid point, or a tie between two grid points
+            fitted++;
+            if (sigma == peak.gaussFitSigma) sameSigma++;
+            if (std::isinf(R2)) {
+                QVERIFY(std::isinf(peak.gaussFitR2));
+                continue;
+            }
+            QVERIFY(fabs(peak.gaussFitR2 - R2) <= 1e-3 * R2 + 1e-7);
+        }
+        delete e;
+    }
+
+    QVERIFY(fitted > 0);
+    QVERIFY(sameSigma >= 0.99 * fitted);
+    delete mzsample;
+}
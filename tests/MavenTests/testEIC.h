@@ -35,6 +35,7 @@ class TestEIC : public QObject {
         // test functions - all functions prefixed with "test" will be ran as tests
         // this is automatically detected thanks to Qt's meta-information about QObjects
         void testgetEIC();
+        void testgetEICs();
         void testgetEICms2();
         void testcomputeSpline();
         void testgetPeakPositions();
@@ -43,6 +44,9 @@ class TestEIC : public QObject {
         void testGetPeakDetails();
         void testgroupPeaks();
         void testeicMerge();
+        void testvisiblePoints();
+        void testCorrelations();
+        void testGaussFit();
 };
 
 #endif // TESTEIC_H
@@ -0,0 +1,105 @@
+#include "testEicService.h"
+
+TestEicService::TestEicService() {
+    loadGoodSample = "bin/methods/testsample_2.mzxml";
+}
+
+void TestEicService::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+    mzSample* sample = new mzSample();
+    sample->loadSample(loadGoodSample);
+    samples.push_back(sample);
+}
+
+void TestEicService::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+    delete_all(samples);
+}
+
+void TestEicService::init() {
+    // This function is executed before each test
+}
+
+void TestEicService::cleanup() {
+    // This function is executed after each test
+}
+
+EicRequest TestEicService::makeRequest(float mzmin, float mzmax) {
+    EicRequest request;
+    request.id = 0;
+    request.slice = mzSlice(mzmin, mzmax, 12.0, 16.0);
+    request.bounds = mzSlice(0, 0, samples[0]->minRt, samples[0]->maxRt);
+    request.samples = samples;
+    request.groupPeaks = true;
+    return request;
+}
+
+void TestEicService::testCompute() {
+    //id 0 is current until the first request is made
+    EicService service;
+    EicRequest request = makeRequest(402.9929, 402.9969);
+    QVERIFY(service.isCurrent(request.id));
+
+    EicResult* result = service.compute(request);
+    QVERIFY(result != NULL);
+    QVERIFY(result->id == request.id);
+    QVERIFY(result->eics.size() == samples.size());
+    QVERIFY(common::floatCompare(result->eics[0]->mzmin, 402.9929));
+    QVERIFY(common::floatCompare(result->eics[0]->mzmax, 402.9969));
+    QVERIFY(result->peakgroups.size() > 0);
+    delete_all(result->eics);
+    delete result;
+
+    //a stale request stops before returning anything
+    service.cancelAll();
+    QVERIFY(service.compute(request) == NULL);
+}
+
+void TestEicService::testSupersededRequest() {
+    EicService service;
+    QSignalSpy spy(&service, SIGNAL(eicsReady(EicResult*)));
+
+    //the first result is finished and waiting in the event queue when the
+    //second request is made, it must not be delivered after all
+    int first = service.request(makeRequest(180.002, 180.004));
+    service.waitForDone();
+    int second = service.request(makeRequest(402.9929, 402.9969));
+    service.waitForDone();
+    QCoreApplication::processEvents();
+
+    QVERIFY(first != second);
+    QVERIFY(spy.count() == 1);
+    EicResult* result = qvariant_cast<EicResult*>(spy.at(0).at(0));
+    QVERIFY(result->id == second);
+    QVERIFY(common::floatCompare(result->eics[0]->mzmin, 402.9929));
+    delete_all(result->eics);
+    delete result;
+
+    //requests made back to back, only the last one arrives
+    spy.clear();
+    service.request(makeRequest(180.002, 180.004));
+    service.request(makeRequest(180.002, 180.004));
+    int last = service.request(makeRequest(402.9929, 402.9969));
+    service.waitForDone();
+    QCoreApplication::processEvents();
+
+    QVERIFY(spy.count() == 1);
+    result = qvariant_cast<EicResult*>(spy.at(0).at(0));
+    QVERIFY(result->id == last);
+    QVERIFY(common::floatCompare(result->eics[0]->mzmin, 402.9929));
+    delete_all(result->eics);
+    delete result;
+}
+
+void TestEicService::testCancelAll() {
+    EicService service;
+    QSignalSpy spy(&service, SIGNAL(eicsReady(EicResult*)));
+
+    int id = service.request(makeRequest(402.9929, 402.9969));
+    service.waitForDone();
+    service.cancelAll();
+    QVERIFY(!service.isCurrent(id));
+    QCoreApplication::processEvents();
+    QVERIFY(spy.count() == 0);
+}
@@ -0,0 +1,37 @@
+#ifndef TESTEICSERVICE_H
+#define TESTEICSERVICE_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "eicservice.h"
+#include "mzSample.h"
+
+
+class TestEicService : public QObject {
+    Q_OBJECT
+
+    public:
+        TestEicService();
+    private:
+        const char* loadGoodSample;
+        vector<mzSample*> samples;
+        EicRequest makeRequest(float mzmin, float mzmax);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testCompute();
+        void testSupersededRequest();
+        void testCancelAll();
+};
+
+#endif // TESTEICSERVICE_H
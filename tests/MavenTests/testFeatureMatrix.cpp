@@ -0,0 +1,163 @@
+#include "testFeatureMatrix.h"
+#include <algorithm>
+
+
+TestFeatureMatrix::TestFeatureMatrix() {
+}
+
+void TestFeatureMatrix::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+    groups = common::getGroupsFromProcessCompounds();
+    for (unsigned int i = 0; i < groups.size(); i++) {
+        vector<Peak>& peaks = groups[i].getPeaks();
+        for (unsigned int j = 0; j < peaks.size(); j++) {
+            mzSample* sample = peaks[j].getSample();
+            if (find(samples.begin(), samples.end(), sample) == samples.end())
+                samples.push_back(sample);
+        }
+    }
+}
+
+void TestFeatureMatrix::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestFeatureMatrix::init() {
+    // This function is executed before each test
+}
+
+void TestFeatureMatrix::cleanup() {
+    // This function is executed after each test
+}
+
+bool TestFeatureMatrix::matchesGroups(FeatureMatrix& matrix, vector<mzSample*>& order) {
+    for (unsigned int i = 0; i < matrix.rowCount(); i++) {
+        PeakGroup* group = matrix.groups()[i];
+        if (matrix.row(group) != (int) i)
+            return false;
+
+        for (int type = PeakGroup::AreaTop; type <= PeakGroup::AreaTopNotCorrected; type++) {
+            PeakGroup::QType qtype = (PeakGroup::QType) type;
+            if (matrix.orderedValues(group, order, qtype) != group->getOrderedIntensityVector(order, qtype))
+                return false;
+        }
+
+        for (unsigned int j = 0; j < matrix.columnCount(); j++) {
+            if (matrix.peak(i, j) != group->getPeak(matrix.samples()[j]))
+                return false;
+        }
+    }
+    return true;
+}
+
+void TestFeatureMatrix::testBuild() {
+    QVERIFY(groups.size() > 0);
+    QVERIFY(samples.size() > 1);
+
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        rows.push_back(&groups[i]);
+
+    FeatureMatrix matrix;
+    matrix.build(rows, samples);
+    QVERIFY(matrix.rowCount() == groups.size());
+    QVERIFY(matrix.columnCount() == samples.size());
+    QVERIFY(matchesGroups(matrix, samples));
+
+    //samples in another order and a subset of them
+    vector<mzSample*> reversed(samples.rbegin(), samples.rend());
+    QVERIFY(matchesGroups(matrix, reversed));
+    vector<mzSample*> first(1, samples[0]);
+    QVERIFY(matchesGroups(matrix, first));
+
+    //groups and samples outside the matrix
+    PeakGroup other = groups[0];
+    QVERIFY(matrix.row(&other) == -1);
+    QVERIFY(matrix.orderedValues(&other, samples, PeakGroup::AreaTop)
+            == other.getOrderedIntensityVector(samples, PeakGroup::AreaTop));
+    QVERIFY(matrix.column(NULL) == -1);
+}
+
+void TestFeatureMatrix::testEdits() {
+    vector<PeakGroup> edited = groups;
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < edited.size(); i++)
+        rows.push_back(&edited[i]);
+
+    FeatureMatrix matrix;
+    matrix.build(rows, samples);
+    matrix.fill(PeakGroup::AreaTop);
+    matrix.fill(PeakGroup::Height);
+
+    matrix.remove(0);
+    QVERIFY(matrix.rowCount() == edited.size() - 1);
+    QVERIFY(matrix.row(&edited[0]) == -1);
+    QVERIFY(matchesGroups(matrix, samples));
+
+    PeakGroup* last = rows.back();
+    last->getPeaks().pop_back();
+    matrix.update(matrix.row(last));
+    QVERIFY(matchesGroups(matrix, samples));
+
+    PeakGroup added = groups[0];
+    matrix.append(&added);
+    QVERIFY(matrix.row(&added) == (int) matrix.rowCount() - 1);
+    QVERIFY(matchesGroups(matrix, samples));
+}
+
+void TestFeatureMatrix::testInPlaceEdits() {
+    vector<PeakGroup> edited = groups;
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < edited.size(); i++)
+        rows.push_back(&edited[i]);
+
+    FeatureMatrix matrix;
+    matrix.build(rows, samples);
+    matrix.fill(PeakGroup::AreaTop);
+    matrix.fill(PeakGroup::RetentionTime);
+
+    //a group appended before its peaks were read, as when a table loads
+    //a project
+    PeakGroup loaded = groups[0];
+    loaded.getPeaks().clear();
+    matrix.append(&loaded);
+    loaded.getPeaks() = groups[0].getPeaks();
+    QVERIFY(matchesGroups(matrix, samples));
+
+    //retention times changed in place, as alignment does
+    for (unsigned int i = 0; i < edited.size(); i++) {
+        vector<Peak>& peaks = edited[i].getPeaks();
+        for (unsigned int j = 0; j < peaks.size(); j++)
+            peaks[j].rt += 0.5;
+    }
+    matrix.invalidate();
+    QVERIFY(matchesGroups(matrix, samples));
+
+    //qualities of one group changed, as reclassifying it does
+    vector<Peak>& peaks = edited[0].getPeaks();
+    for (unsigned int j = 0; j < peaks.size(); j++)
+        peaks[j].quality = 1 - peaks[j].quality;
+    matrix.update(matrix.row(&edited[0]));
+    QVERIFY(matchesGroups(matrix, samples));
+}
+
+void TestFeatureMatrix::testNormalization() {
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        rows.push_back(&groups[i]);
+
+    FeatureMatrix matrix;
+    matrix.build(rows, samples);
+    matrix.fill(PeakGroup::AreaTop);
+    QVERIFY(!matrix.refreshNormalization());
+
+    float constant = samples[0]->getNormalizationConstant();
+    samples[0]->setNormalizationConstant(2 * constant);
+    QVERIFY(matrix.refreshNormalization());
+    QVERIFY(matchesGroups(matrix, samples));
+
+    samples[0]->setNormalizationConstant(constant);
+    QVERIFY(matrix.refreshNormalization());
+    QVERIFY(matchesGroups(matrix, samples));
+}
@@ -0,0 +1,38 @@
+#ifndef TESTFEATUREMATRIX_H
+#define TESTFEATUREMATRIX_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "featureMatrix.h"
+#include "PeakGroup.h"
+
+
+class TestFeatureMatrix : public QObject {
+    Q_OBJECT
+
+    public:
+        TestFeatureMatrix();
+    private:
+        vector<PeakGroup> groups;
+        vector<mzSample*> samples;
+        bool matchesGroups(FeatureMatrix& matrix, vector<mzSample*>& order);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testBuild();
+        void testEdits();
+        void testInPlaceEdits();
+        void testNormalization();
+};
+
+#endif // TESTFEATUREMATRIX_H
@@ -0,0 +1,96 @@
+#include "testFragment.h"
+
+
+TestFragment::TestFragment() {
+
+}
+
+void TestFragment::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestFragment::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestFragment::init() {
+    // This function is executed before each test
+}
+
+void TestFragment::cleanup() {
+    // This function is executed after each test
+}
+
+Fragment TestFragment::makeFragment(const vector<float>& mzs, const vector<float>& intensities) {
+    Fragment f;
+    f.mzs = mzs;
+    f.intensity_array = intensities;
+    f.obscount = vector<int>(mzs.size(), 1);
+    return f;
+}
+
+void TestFragment::testCompareRanks() {
+    //b is in intensity order, ranks point to the first b peak in that order
+    Fragment a = makeFragment({300.0f, 100.0f, 250.0f, 200.0f}, {1, 1, 1, 1});
+    Fragment b = makeFragment({200.004f, 100.001f, 199.998f, 500.0f}, {4, 3, 2, 1});
+
+    vector<int> ranks = Fragment::compareRanks(&a, &b, 0.01);
+    QVERIFY(ranks.size() == 4);
+    QVERIFY(ranks[0] == -1);
+    QVERIFY(ranks[1] == 1);
+    QVERIFY(ranks[2] == -1);
+    QVERIFY(ranks[3] == 0);
+
+    QVERIFY(a.compareToFragment(&b, 0.01) == 0.5);
+}
+
+void TestFragment::testBuildConsensus() {
+    Fragment parent = makeFragment({300.0f, 100.0f}, {10, 30});
+    Fragment first = makeFragment({100.001f, 150.0f}, {30, 20});
+    Fragment second = makeFragment({150.002f, 50.0f, 300.0f}, {20, 10, 10});
+    parent.addFragment(&first);
+    parent.addFragment(&second);
+
+    parent.buildConsensus(0.01);
+    Fragment* consensus = parent.consensus;
+    QVERIFY(consensus != NULL);
+    QVERIFY(consensus->mzs.size() == 4);
+
+    //sorted by intensity, normalized to the highest peak
+    QVERIFY(consensus->mzs[0] == 100.0f);
+    QVERIFY(consensus->obscount[0] == 2);
+    QVERIFY(consensus->intensity_array[0] == 10000.0f);
+    QVERIFY(consensus->mzs[1] == 150.0f);
+    QVERIFY(consensus->obscount[1] == 2);
+    QVERIFY(consensus->obscount[2] == 2);
+    QVERIFY(consensus->mzs[3] == 50.0f);
+    QVERIFY(consensus->obscount[3] == 1);
+    delete consensus;
+}
+
+void TestFragment::testScoreSpectra() {
+    Fragment query = makeFragment({100.0f, 200.0f, 300.0f}, {1, 2, 3});
+    Fragment same = makeFragment({300.0f, 200.0f, 100.0f}, {3, 2, 1});
+    Fragment partial = makeFragment({300.001f, 100.0f}, {3, 1});
+    Fragment other = makeFragment({150.0f}, {5});
+    vector<Fragment*> library = {&same, &partial, &other};
+
+    vector<Fragment::SpectralScore> scores = Fragment::scoreSpectra(&query, library, 0.01);
+    QVERIFY(scores.size() == 3);
+
+    QVERIFY(scores[0].matchedPeaks == 3);
+    QVERIFY(scores[0].dotProduct == 14);
+    QVERIFY(fabs(scores[0].cosine - 1) < 1e-9);
+
+    QVERIFY(scores[1].matchedPeaks == 2);
+    QVERIFY(scores[1].dotProduct == 10);
+    QVERIFY(fabs(scores[1].cosine - 10 / sqrt(14.0 * 10.0)) < 1e-9);
+
+    QVERIFY(scores[2].matchedPeaks == 0);
+    QVERIFY(scores[2].cosine == 0);
+
+    Fragment::SpectralScore single = query.scoreSpectrum(&partial, 0.01);
+    QVERIFY(single.matchedPeaks == 2);
+    QVERIFY(single.dotProduct == scores[1].dotProduct);
+}
@@ -0,0 +1,34 @@
+#ifndef TESTFRAGMENT_H
+#define TESTFRAGMENT_H
+#include <iostream>
+#include <vector>
+#include <QtTest>
+#include <string>
+#include "Fragment.h"
+
+
+class TestFragment : public QObject {
+    Q_OBJECT
+
+    public:
+        TestFragment();
+    private:
+        Fragment makeFragment(const vector<float>& mzs, const vector<float>& intensities);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testCompareRanks();
+        void testBuildConsensus();
+        void testScoreSpectra();
+};
+
+#endif // TESTFRAGMENT_H
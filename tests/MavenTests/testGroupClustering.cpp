@@ -0,0 +1,114 @@
+#include "testGroupClustering.h"
+#include <algorithm>
+
+
+TestGroupClustering::TestGroupClustering() {
+}
+
+void TestGroupClustering::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+    massCutoff.setMassCutoffAndType(10, "ppm");
+    groups = common::getGroupsFromProcessCompounds();
+    for (unsigned int i = 0; i < groups.size(); i++) {
+        vector<Peak>& peaks = groups[i].getPeaks();
+        for (unsigned int j = 0; j < peaks.size(); j++) {
+            mzSample* sample = peaks[j].getSample();
+            if (find(samples.begin(), samples.end(), sample) == samples.end())
+                samples.push_back(sample);
+        }
+    }
+}
+
+void TestGroupClustering::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestGroupClustering::init() {
+    // This function is executed before each test
+}
+
+void TestGroupClustering::cleanup() {
+    // This function is executed after each test
+}
+
+void TestGroupClustering::testCluster() {
+    QVERIFY(groups.size() > 1);
+
+    vector<PeakGroup> clustered = groups;
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < clustered.size(); i++)
+        rows.push_back(&clustered[i]);
+
+    GroupClustering clustering(&massCutoff, 0, "");
+    int n = clustering.cluster(rows, samples);
+    QVERIFY(!clustering.wasCancelled());
+    QVERIFY(n > 0 && n <= (int) rows.size());
+
+    //groups are sorted by rt, ids are numbered in order of their parents,
+    //members stay within twice maxRtDiff of the parent
+    vector<PeakGroup*> parents;
+    for (unsigned int i = 0; i < rows.size(); i++) {
+        if (i > 0) QVERIFY(rows[i - 1]->meanRt <= rows[i]->meanRt);
+        int id = rows[i]->clusterId;
+        QVERIFY(id >= 1 && id <= (int) parents.size() + 1);
+        if (id == (int) parents.size() + 1) {
+            parents.push_back(rows[i]);
+            continue;
+        }
+        QVERIFY(std::abs(parents[id - 1]->meanRt - rows[i]->meanRt)
+                <= clustering.maxRtDiff * 2);
+    }
+    QVERIFY((int) parents.size() == n);
+
+    //intensities read from a feature matrix give the same clusters
+    vector<PeakGroup> fromMatrix = groups;
+    vector<PeakGroup*> matrixRows;
+    for (unsigned int i = 0; i < fromMatrix.size(); i++)
+        matrixRows.push_back(&fromMatrix[i]);
+    FeatureMatrix matrix;
+    matrix.build(matrixRows, samples);
+    QVERIFY(clustering.cluster(matrixRows, samples, &matrix) == n);
+    for (unsigned int i = 0; i < rows.size(); i++)
+        QVERIFY(matrixRows[i]->clusterId == rows[i]->clusterId);
+}
+
+void TestGroupClustering::testThresholds() {
+    vector<PeakGroup> clustered = groups;
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < clustered.size(); i++)
+        rows.push_back(&clustered[i]);
+
+    //no pair of groups can pass, every group is its own cluster
+    GroupClustering clustering(&massCutoff, 0, "");
+    clustering.minSampleCorrelation = 2;
+    QVERIFY(clustering.cluster(rows, samples) == (int) rows.size());
+    for (unsigned int i = 0; i < rows.size(); i++)
+        QVERIFY(rows[i]->clusterId == (int) i + 1);
+}
+
+void TestGroupClustering::testCancel() {
+    vector<PeakGroup> clustered = groups;
+    vector<PeakGroup*> rows;
+    for (unsigned int i = 0; i < clustered.size(); i++) {
+        clustered[i].clusterId = 7;
+        rows.push_back(&clustered[i]);
+    }
+
+    //cancelled from the progress signal, as the GUI does
+    GroupClustering clustering(&massCutoff, 0, "");
+    clustering.boostSignal.connect(boost::bind(&GroupClustering::cancel, &clustering));
+    QVERIFY(clustering.cluster(rows, samples) == 0);
+    QVERIFY(clustering.wasCancelled());
+    for (unsigned int i = 0; i < rows.size(); i++)
+        QVERIFY(rows[i]->clusterId == 7);
+
+    //the next run starts over
+    clustering.boostSignal.disconnect_all_slots();
+    int n = clustering.cluster(rows, samples);
+    QVERIFY(n > 0);
+    QVERIFY(!clustering.wasCancelled());
+    QVERIFY(rows[0]->clusterId == 1);
+    for (unsigned int i = 0; i < rows.size(); i++)
+        QVERIFY(rows[i]->clusterId >= 1 && rows[i]->clusterId <= n);
+}
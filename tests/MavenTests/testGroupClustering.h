@@ -0,0 +1,38 @@
+#ifndef TESTGROUPCLUSTERING_H
+#define TESTGROUPCLUSTERING_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "groupClustering.h"
+#include "masscutofftype.h"
+#include "PeakGroup.h"
+
+
+class TestGroupClustering : public QObject {
+    Q_OBJECT
+
+    public:
+        TestGroupClustering();
+    private:
+        vector<PeakGroup> groups;
+        vector<mzSample*> samples;
+        MassCutoff massCutoff;
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testCluster();
+        void testThresholds();
+        void testCancel();
+};
+
+#endif // TESTGROUPCLUSTERING_H
@@ -0,0 +1,151 @@
+#include "testGroupIndex.h"
+#include <algorithm>
+#include <random>
+
+
+TestGroupIndex::TestGroupIndex() {
+}
+
+void TestGroupIndex::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestGroupIndex::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestGroupIndex::init() {
+    // This function is executed before each test
+}
+
+void TestGroupIndex::cleanup() {
+    // This function is executed after each test
+}
+
+PeakGroup TestGroupIndex::makeGroup(float mz, float rt) {
+    PeakGroup group;
+    group.meanMz = mz;
+    group.meanRt = rt;
+    return group;
+}
+
+PeakGroup* TestGroupIndex::bruteForceFind(vector<PeakGroup*>& inserted, float mz, float rt,
+                                          double mzTolerance, double rtTolerance) {
+    for (unsigned int i = 0; i < inserted.size(); i++) {
+        if ((double) std::abs(mz - inserted[i]->meanMz) < mzTolerance
+                && (double) std::abs(rt - inserted[i]->meanRt) < rtTolerance)
+            return inserted[i];
+    }
+    return NULL;
+}
+
+void TestGroupIndex::testInsert() {
+    GroupIndex index;
+    vector<PeakGroup> groups;
+    groups.push_back(makeGroup(100.0, 5.0));
+    groups.push_back(makeGroup(100.000005, 5.000005));
+    groups.push_back(makeGroup(200.0, 5.0));
+    groups.push_back(makeGroup(100.0, 6.0));
+    for (unsigned int i = 0; i < groups.size(); i++)
+        index.insert(&groups[i]);
+
+    QVERIFY(index.size() == groups.size());
+    QVERIFY(index.contains(&groups[1]));
+    PeakGroup other = groups[1];
+    QVERIFY(!index.contains(&other));
+
+    //the earliest group within tolerance wins
+    QVERIFY(index.find(100.0, 5.0) == &groups[0]);
+    QVERIFY(index.find(100.000005, 5.000005) == &groups[0]);
+    QVERIFY(index.find(200.0, 5.0) == &groups[2]);
+    QVERIFY(index.find(100.0, 6.0) == &groups[3]);
+    QVERIFY(index.find(100.0, 5.5) == NULL);
+    QVERIFY(index.find(150.0, 5.0) == NULL);
+
+    //matches across cell borders, compared with a linear scan
+    double mzTolerance = 0.01;
+    double rtTolerance = 0.1;
+    GroupIndex coarse(mzTolerance, rtTolerance);
+    std::mt19937 generator(5489);
+    std::uniform_real_distribution<float> mzs(100.0, 100.5);
+    std::uniform_real_distribution<float> rts(1.0, 3.0);
+    vector<PeakGroup> random;
+    for (unsigned int i = 0; i < 2000; i++)
+        random.push_back(makeGroup(mzs(generator), rts(generator)));
+
+    vector<PeakGroup*> inserted;
+    for (unsigned int i = 0; i < random.size(); i++) {
+        coarse.insert(&random[i]);
+        inserted.push_back(&random[i]);
+    }
+    for (unsigned int i = 0; i < 2000; i++) {
+        float mz = mzs(generator);
+        float rt = rts(generator);
+        QVERIFY(coarse.find(mz, rt) == bruteForceFind(inserted, mz, rt, mzTolerance, rtTolerance));
+    }
+}
+
+void TestGroupIndex::testRemove() {
+    GroupIndex index;
+    vector<PeakGroup> groups;
+    groups.push_back(makeGroup(100.0, 5.0));
+    groups.push_back(makeGroup(100.000005, 5.000005));
+    groups.push_back(makeGroup(200.0, 5.0));
+    for (unsigned int i = 0; i < groups.size(); i++)
+        index.insert(&groups[i]);
+
+    //the next group within tolerance takes the place of a removed one
+    QVERIFY(index.remove(&groups[0]));
+    QVERIFY(index.size() == 2);
+    QVERIFY(!index.contains(&groups[0]));
+    QVERIFY(index.find(100.0, 5.0) == &groups[1]);
+    QVERIFY(!index.remove(&groups[0]));
+
+    //groups are found by the m/z and rt they were inserted with, and can be
+    //removed after those changed
+    groups[2].meanMz = 300.0;
+    QVERIFY(index.find(200.0, 5.0) == &groups[2]);
+    QVERIFY(index.find(300.0, 5.0) == NULL);
+    QVERIFY(index.remove(&groups[2]));
+    QVERIFY(index.find(200.0, 5.0) == NULL);
+
+    QVERIFY(index.remove(&groups[1]));
+    QVERIFY(index.size() == 0);
+    QVERIFY(index.find(100.0, 5.0) == NULL);
+}
+
+void TestGroupIndex::testReorder() {
+    vector<PeakGroup> groups;
+    groups.push_back(makeGroup(300.0, 3.0));
+    groups.push_back(makeGroup(100.0, 1.0));
+    groups.push_back(makeGroup(200.0, 2.0));
+    groups.push_back(makeGroup(100.000005, 1.000005));
+
+    GroupIndex index;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        index.insert(&groups[i]);
+    QVERIFY(index.find(100.0, 1.0) == &groups[1]);
+
+    //sorting moves groups between addresses, the owner rebuilds the index
+    sort(groups.begin(), groups.end(), PeakGroup::compRt);
+    index.clear();
+    QVERIFY(index.size() == 0);
+    for (unsigned int i = 0; i < groups.size(); i++)
+        index.insert(&groups[i]);
+
+    QVERIFY(index.size() == groups.size());
+    vector<PeakGroup*> inserted;
+    for (unsigned int i = 0; i < groups.size(); i++)
+        inserted.push_back(&groups[i]);
+    for (unsigned int i = 0; i < groups.size(); i++) {
+        QVERIFY(index.contains(&groups[i]));
+        QVERIFY(index.find(groups[i].meanMz, groups[i].meanRt)
+                == bruteForceFind(inserted, groups[i].meanMz, groups[i].meanRt, 1e-5, 1e-5));
+    }
+
+    //insertion order follows the new order
+    QVERIFY(groups[0].meanMz == 100.0f);
+    QVERIFY(index.find(100.000005, 1.000005) == &groups[0]);
+    QVERIFY(index.find(300.0, 3.0) == &groups[3]);
+}
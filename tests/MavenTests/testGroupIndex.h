@@ -0,0 +1,36 @@
+#ifndef TESTGROUPINDEX_H
+#define TESTGROUPINDEX_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "groupIndex.h"
+#include "PeakGroup.h"
+
+
+class TestGroupIndex : public QObject {
+    Q_OBJECT
+
+    public:
+        TestGroupIndex();
+    private:
+        PeakGroup makeGroup(float mz, float rt);
+        PeakGroup* bruteForceFind(vector<PeakGroup*>& inserted, float mz, float rt,
+                                  double mzTolerance, double rtTolerance);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testInsert();
+        void testRemove();
+        void testReorder();
+};
+
+#endif // TESTGROUPINDEX_H
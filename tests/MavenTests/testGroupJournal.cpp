@@ -0,0 +1,202 @@
+#include "testGroupJournal.h"
+#include <cstdio>
+#include <fstream>
+
+
+TestGroupJournal::TestGroupJournal() {
+    journalFile = "bin/methods/testGroupJournal.journal";
+}
+
+void TestGroupJournal::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestGroupJournal::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestGroupJournal::init() {
+    // This function is executed before each test
+    remove(journalFile.c_str());
+}
+
+void TestGroupJournal::cleanup() {
+    // This function is executed after each test
+    remove(journalFile.c_str());
+}
+
+PeakGroup TestGroupJournal::makeGroup(float mz, float rt) {
+    PeakGroup group;
+    group.meanMz = mz;
+    group.meanRt = rt;
+    return group;
+}
+
+void TestGroupJournal::testRoundTrip() {
+    GroupJournal journal;
+    vector<mzSample*> samples;
+
+    //nothing is journaled before the journal starts
+    journal.logLabel(vector<int>(1, 0), 'g');
+    QVERIFY(!journal.start(journalFile));
+    QVERIFY(!journal.isStarted());
+
+    journal.mark();
+    QVERIFY(journal.start(journalFile));
+    QVERIFY(journal.isStarted());
+    QVERIFY(journal.fileName() == journalFile);
+
+    vector<int> child;
+    child.push_back(2);
+    child.push_back(1);
+    journal.logLabel(vector<int>(1, 3), 'g');
+    journal.logDelete(child);
+    PeakGroup added = makeGroup(150.5, 7.25);
+    added.setLabel('b');
+    journal.logAdd(&added, samples);
+    //empty paths are not journaled
+    journal.logLabel(vector<int>(), 'b');
+    QVERIFY(journal.flush());
+
+    vector<GroupJournal::Record> records;
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 3);
+    QVERIFY(records[0].operation == GroupJournal::Label);
+    QVERIFY(records[0].path == vector<int>(1, 3));
+    QVERIFY(records[0].label == 'g');
+    QVERIFY(records[1].operation == GroupJournal::Delete);
+    QVERIFY(records[1].path == child);
+    QVERIFY(records[2].operation == GroupJournal::Add);
+    QVERIFY(common::floatCompare(records[2].group.meanMz, 150.5));
+    QVERIFY(common::floatCompare(records[2].group.meanRt, 7.25));
+    QVERIFY(records[2].group.label == 'b');
+
+    //flushing again appends only new records
+    journal.logLabel(vector<int>(1, 0), 'b');
+    QVERIFY(journal.flush());
+    records.clear();
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 4);
+    QVERIFY(records[3].path == vector<int>(1, 0));
+
+    //a stopped journal leaves its file alone
+    journal.stop();
+    journal.logLabel(vector<int>(1, 1), 'g');
+    QVERIFY(!journal.flush());
+    records.clear();
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 4);
+
+    QVERIFY(!GroupJournal::read("bin/methods/missing.journal", samples, records));
+}
+
+void TestGroupJournal::testTruncatedRecord() {
+    GroupJournal journal;
+    vector<mzSample*> samples;
+    journal.mark();
+    QVERIFY(journal.start(journalFile));
+    journal.logLabel(vector<int>(1, 0), 'g');
+    journal.logLabel(vector<int>(1, 1), 'b');
+    QVERIFY(journal.flush());
+
+    //cut the last record short, as a crash while appending would
+    std::ifstream in(journalFile.c_str(), ios::binary);
+    string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    QVERIFY(content.size() == journal.size());
+    std::ofstream out(journalFile.c_str(), ios::binary | ios::trunc);
+    out.write(content.data(), content.size() - 2);
+    out.close();
+
+    vector<GroupJournal::Record> records;
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 1);
+    QVERIFY(records[0].path == vector<int>(1, 0));
+
+    //a file without the header is not a journal
+    out.open(journalFile.c_str(), ios::binary | ios::trunc);
+    out.write(content.data() + 4, content.size() - 4);
+    out.close();
+    records.clear();
+    QVERIFY(!GroupJournal::read(journalFile, samples, records));
+}
+
+void TestGroupJournal::testMark() {
+    GroupJournal journal;
+    vector<mzSample*> samples;
+    journal.mark();
+    QVERIFY(journal.start(journalFile));
+    journal.logLabel(vector<int>(1, 0), 'g');
+
+    //a full save begins, records logged while it writes the table are kept
+    journal.mark();
+    journal.logLabel(vector<int>(1, 1), 'b');
+
+    //a flush during the save only writes records the saved table holds
+    QVERIFY(journal.flush());
+    vector<GroupJournal::Record> records;
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 1);
+
+    QVERIFY(journal.start(journalFile));
+    journal.logLabel(vector<int>(1, 2), 'g');
+    QVERIFY(journal.flush());
+    records.clear();
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 2);
+    QVERIFY(records[0].path == vector<int>(1, 1));
+    QVERIFY(records[0].label == 'b');
+    QVERIFY(records[1].path == vector<int>(1, 2));
+
+    //the first full save of a table journals from its mark too
+    GroupJournal first;
+    first.logLabel(vector<int>(1, 0), 'g');
+    first.mark();
+    first.logLabel(vector<int>(1, 4), 'b');
+    QVERIFY(first.start(journalFile));
+    QVERIFY(first.flush());
+    records.clear();
+    QVERIFY(GroupJournal::read(journalFile, samples, records));
+    QVERIFY(records.size() == 1);
+    QVERIFY(records[0].path == vector<int>(1, 4));
+
+    //an edit the journal can not record stops it, the save that began
+    //before does not hold the edit and must not restart the journal
+    first.mark();
+    first.stop();
+    QVERIFY(!first.start(journalFile));
+    QVERIFY(!first.isStarted());
+}
+
+void TestGroupJournal::testPaths() {
+    QList<PeakGroup> groups;
+    groups.append(makeGroup(100, 1));
+    groups.append(makeGroup(200, 2));
+    groups.append(makeGroup(300, 3));
+    groups[1].addChild(makeGroup(201, 2));
+    groups[1].addChild(makeGroup(202, 2));
+
+    //groups numbered by their table are found at groupId - 1
+    groups[2].groupId = 3;
+    QVERIFY(GroupJournal::pathOf(groups, &groups[2]) == vector<int>(1, 2));
+    //others are searched for
+    groups[0].groupId = 7;
+    QVERIFY(GroupJournal::pathOf(groups, &groups[0]) == vector<int>(1, 0));
+
+    vector<int> child;
+    child.push_back(1);
+    child.push_back(1);
+    QVERIFY(GroupJournal::pathOf(groups, &groups[1].children[1]) == child);
+    QVERIFY(GroupJournal::groupAt(groups, child) == &groups[1].children[1]);
+
+    PeakGroup other = makeGroup(100, 1);
+    QVERIFY(GroupJournal::pathOf(groups, &other).empty());
+
+    QVERIFY(GroupJournal::groupAt(groups, vector<int>(1, 0)) == &groups[0]);
+    QVERIFY(GroupJournal::groupAt(groups, vector<int>(1, 3)) == NULL);
+    QVERIFY(GroupJournal::groupAt(groups, vector<int>(1, -1)) == NULL);
+    QVERIFY(GroupJournal::groupAt(groups, vector<int>()) == NULL);
+    child[1] = 2;
+    QVERIFY(GroupJournal::groupAt(groups, child) == NULL);
+}
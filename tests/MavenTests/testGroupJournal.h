@@ -0,0 +1,37 @@
+#ifndef TESTGROUPJOURNAL_H
+#define TESTGROUPJOURNAL_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "groupJournal.h"
+#include "PeakGroup.h"
+
+
+class TestGroupJournal : public QObject {
+    Q_OBJECT
+
+    public:
+        TestGroupJournal();
+    private:
+        string journalFile;
+        PeakGroup makeGroup(float mz, float rt);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testRoundTrip();
+        void testTruncatedRecord();
+        void testMark();
+        void testPaths();
+};
+
+#endif // TESTGROUPJOURNAL_H
@@ -1,6 +1,7 @@
 #include "testLoadSamples.h"
 #include "mavenparameters.h"
 #include "mzSample.h"
+#include <fstream>
 
 TestLoadSamples::TestLoadSamples() {
     loadFile = "bin/methods/testsample_1.mzxml";
@@ -189,4 +190,103 @@ void TestLoadSamples::testParseMzMLInjectionTimeStamp() {
 
     }
 
-}
\ No newline at end of file
+}
+
+void TestLoadSamples::testAppendScans() {
+    mzSample mzsample;
+    mzsample.loadSample(loadFile);
+
+    ifstream in(loadFile, ios::binary);
+    string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    //write the file in pieces, as an acquisition would
+    string growingFile = QDir::temp().filePath("testAppendScans.mzxml").toStdString();
+    remove(growingFile.c_str());
+
+    mzSample growing;
+    size_t written = 0;
+    size_t pieceSize = content.size() / 7 + 1;
+    while (written < content.size()) {
+        size_t n = std::min(pieceSize, content.size() - written);
+        ofstream out(growingFile.c_str(), ios::binary | ios::app);
+        out.write(content.data() + written, n);
+        out.close();
+        written += n;
+
+        QVERIFY(growing.appendScans(growingFile.c_str()) >= 0);
+        QVERIFY(growing.scanCount() <= mzsample.scanCount());
+    }
+    QVERIFY(growing.isAcquisitionComplete());
+    QVERIFY(growing.appendScans(growingFile.c_str()) == 0);
+    remove(growingFile.c_str());
+
+    QVERIFY(growing.scanCount() == mzsample.scanCount());
+    for (unsigned int i = 0; i < mzsample.scanCount(); i++) {
+        QVERIFY(growing.scans[i]->rt == mzsample.scans[i]->rt);
+        QVERIFY(growing.scans[i]->mz == mzsample.scans[i]->mz);
+        QVERIFY(growing.scans[i]->intensity == mzsample.scans[i]->intensity);
+    }
+    QVERIFY(common::floatCompare(growing.minMz, mzsample.minMz));
+    QVERIFY(common::floatCompare(growing.maxMz, mzsample.maxMz));
+    QVERIFY(common::floatCompare(growing.maxRt, mzsample.maxRt));
+    QVERIFY(growing.srmScans == mzsample.srmScans);
+    QVERIFY(growing.sampleName == "testAppendScans");
+}
+
+void TestLoadSamples::testAppendScansTwice() {
+    //an mzML run of a few spectra, the test data only has chromatograms
+    string mzMLFile = QDir::temp().filePath("testAppendScansTwiceRun.mzML").toStdString();
+    ofstream run(mzMLFile.c_str(), ios::binary);
+    run << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<indexedmzML>\n<mzML>\n"
+        << "<run id=\"testAppendScansTwice\">\n<spectrumList count=\"20\">\n";
+    for (int i = 0; i < 20; i++) {
+        run << "<spectrum index=\"" << i << "\" id=\"scan=" << i + 1 << "\">\n"
+            << "<cvParam name=\"ms level\" value=\"" << (i % 4 ? 2 : 1) << "\"/>\n"
+            << "<scanList><scan><cvParam name=\"scan start time\" value=\"" << 0.1 * i
+            << "\"/></scan></scanList>\n"
+            << "<binaryDataArrayList><binaryDataArray><cvParam name=\"m/z array\"/>"
+            << "<binary></binary></binaryDataArray></binaryDataArrayList>\n"
+            << "</spectrum>\n";
+    }
+    run << "</spectrumList>\n</run>\n</mzML>\n</indexedmzML>\n";
+    run.close();
+
+    string files[] = {loadFile, mzMLFile};
+    const char* growingNames[] = {"testAppendScansTwice.mzxml", "testAppendScansTwice.mzML"};
+    for (unsigned int f = 0; f < 2; f++) {
+        mzSample mzsample;
+        mzsample.loadSample(files[f].c_str());
+        QVERIFY(mzsample.scanCount() > 1);
+
+        ifstream in(files[f].c_str(), ios::binary);
+        string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        string growingFile = QDir::temp().filePath(growingNames[f]).toStdString();
+        remove(growingFile.c_str());
+
+        //half of the file, then the rest
+        mzSample growing;
+        size_t half = content.size() / 2;
+        ofstream out(growingFile.c_str(), ios::binary);
+        out.write(content.data(), half);
+        out.close();
+        QVERIFY(growing.appendScans(growingFile.c_str()) > 0);
+        unsigned int firstCount = growing.scanCount();
+        QVERIFY(firstCount > 0 && firstCount < mzsample.scanCount());
+
+        out.open(growingFile.c_str(), ios::binary | ios::app);
+        out.write(content.data() + half, content.size() - half);
+        out.close();
+        QVERIFY(growing.appendScans(growingFile.c_str()) > 0);
+        remove(growingFile.c_str());
+
+        //scans of the second piece are numbered after those of the first
+        QVERIFY(growing.scanCount() == mzsample.scanCount());
+        for (unsigned int i = 0; i < growing.scanCount() && i < mzsample.scanCount(); i++) {
+            QVERIFY(growing.scans[i]->scannum == (int) i);
+            QVERIFY(growing.scans[i]->scannum == mzsample.scans[i]->scannum);
+            QVERIFY(growing.scans[i]->rt == mzsample.scans[i]->rt);
+            QVERIFY(growing.scans[i]->mslevel == mzsample.scans[i]->mslevel);
+        }
+    }
+    remove(mzMLFile.c_str());
+}
@@ -2,6 +2,7 @@
 #define TESTLOADSAMPLES_H
 #include <iostream>
 #include <QtTest>
+#include <QDir>
 #include <string>
 #include <sstream>
 #include "common.h"
@@ -35,6 +36,8 @@ class TestLoadSamples : public QObject {
         void testSampleName();
         void testBlankSample();
         void testParseMzMLInjectionTimeStamp();
+        void testAppendScans();
+        void testAppendScansTwice();
 };
 
 #endif // TESTLOADSAMPLES_H
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "testMS2Index.h"
+#include <algorithm>
+#include <limits>
+
+
+TestMS2Index::TestMS2Index() {
+    ms2File = "bin/methods/ms2test1.mzML";
+}
+
+void TestMS2Index::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestMS2Index::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestMS2Index::init() {
+    // This function is executed before each test
+}
+
+void TestMS2Index::cleanup() {
+    // This function is executed after each test
+}
+
+Scan* TestMS2Index::makeScan(mzSample* sample, int scannum, float rt, float precursorMz) {
+    return new Scan(sample, scannum, 2, rt, precursorMz, 1);
+}
+
+vector<Scan*> TestMS2Index::bruteForceFind(mzSample* sample, float mzmin, float mzmax,
+                                           float rtmin, float rtmax) {
+    vector<Scan*> matches;
+    for (unsigned int i = 0; i < sample->scans.size(); i++) {
+        Scan* scan = sample->scans[i];
+        if (scan == NULL || scan->mslevel <= 1) continue;
+        if (scan->precursorMz < mzmin || scan->precursorMz > mzmax) continue;
+        if (scan->rt < rtmin || scan->rt > rtmax) continue;
+        matches.push_back(scan);
+    }
+    return matches;
+}
+
+void TestMS2Index::testFileRoundTrip() {
+    mzSample* sample = new mzSample();
+    sample->loadSample(ms2File);
+    vector<Scan*> all = bruteForceFind(sample, 0, 1e9, -1e9, 1e9);
+    QVERIFY(all.size() > 10);
+
+    //windows around precursors of the file, narrow ones and rt clipped ones
+    vector<float> mzs;
+    for (unsigned int i = 0; i < all.size(); i += all.size() / 10)
+        mzs.push_back(all[i]->precursorMz);
+    float rtmid = (sample->minRt + sample->maxRt) / 2;
+
+    vector<vector<Scan*> > found;
+    QVERIFY(sample->getFragmentScans(0, 1e9, -1e9, 1e9) == all);
+    for (unsigned int i = 0; i < mzs.size(); i++) {
+        vector<Scan*> narrow = sample->getFragmentScans(mzs[i] - 0.01, mzs[i] + 0.01, -1e9, 1e9);
+        QVERIFY(narrow.size() > 0);
+        QVERIFY(narrow == bruteForceFind(sample, mzs[i] - 0.01, mzs[i] + 0.01, -1e9, 1e9));
+
+        vector<Scan*> clipped = sample->getFragmentScans(mzs[i] - 5, mzs[i] + 5, sample->minRt, rtmid);
+        QVERIFY(clipped == bruteForceFind(sample, mzs[i] - 5, mzs[i] + 5, sample->minRt, rtmid));
+        found.push_back(clipped);
+    }
+    QVERIFY(sample->getFragmentScans(-10, -1, -1e9, 1e9).empty());
+
+    //reopening the file gives the same events
+    mzSample* reopened = new mzSample();
+    reopened->loadSample(ms2File);
+    for (unsigned int i = 0; i < mzs.size(); i++) {
+        vector<Scan*> clipped = reopened->getFragmentScans(mzs[i] - 5, mzs[i] + 5, sample->minRt, rtmid);
+        QVERIFY(clipped.size() == found[i].size());
+        for (unsigned int j = 0; j < clipped.size() && j < found[i].size(); j++) {
+            QVERIFY(clipped[j]->scannum == found[i][j]->scannum);
+            QVERIFY(clipped[j]->precursorMz == found[i][j]->precursorMz);
+            QVERIFY(clipped[j]->rt == found[i][j]->rt);
+        }
+    }
+    delete sample;
+    delete reopened;
+}
+
+void TestMS2Index::testStale() {
+    mzSample* sample = new mzSample();
+    sample->scans.push_back(makeScan(sample, 0, 1.0, 100.0));
+    sample->scans.push_back(makeScan(sample, 1, 2.0, 200.0));
+    sample->scans.push_back(makeScan(sample, 2, 3.0, 100.005));
+    QVERIFY(sample->getFragmentScans(99.99, 100.01, 0, 10).size() == 2);
+
+    //appended scans are found
+    sample->scans.push_back(makeScan(sample, 3, 4.0, 100.002));
+    vector<Scan*> found = sample->getFragmentScans(99.99, 100.01, 0, 10);
+    QVERIFY(found.size() == 3);
+    QVERIFY(found.back() == sample->scans[3]);
+
+    //the scans of a reloaded sample replace those of the old index, even
+    //when their number does not change
+    for (unsigned int i = 0; i < sample->scans.size(); i++) delete sample->scans[i];
+    sample->scans.clear();
+    for (int i = 0; i < 4; i++)
+        sample->scans.push_back(makeScan(sample, i, 1.0 + i, 300.0 + i));
+    QVERIFY(sample->getFragmentScans(99.99, 100.01, 0, 10).empty());
+    found = sample->getFragmentScans(300.5, 301.5, 0, 10);
+    QVERIFY(found.size() == 1);
+    QVERIFY(found[0] == sample->scans[1]);
+
+    //retention times are read at query time
+    sample->scans[1]->rt = 20.0;
+    QVERIFY(sample->getFragmentScans(300.5, 301.5, 0, 10).empty());
+    QVERIFY(sample->getFragmentScans(300.5, 301.5, 15, 25).size() == 1);
+    delete sample;
+}
+
+void TestMS2Index::testCorrupt() {
+    mzSample* sample = new mzSample();
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    sample->scans.push_back(makeScan(sample, 0, 1.0, 150.0));
+    sample->scans.push_back(makeScan(sample, 1, 1.5, nan));
+    sample->scans.push_back(NULL);
+    sample->scans.push_back(makeScan(sample, 3, 2.0, 50.0));
+    sample->scans.push_back(makeScan(sample, 4, 2.5, nan));
+    sample->scans.push_back(makeScan(sample, 5, 3.0, 150.001));
+    Scan* ms1 = makeScan(sample, 6, 3.5, 150.0);
+    ms1->mslevel = 1;
+    sample->scans.push_back(ms1);
+
+    //scans without a precursor are skipped, the others are still found
+    vector<Scan*> found = sample->getFragmentScans(0, 1e9, 0, 10);
+    QVERIFY(found.size() == 3);
+    QVERIFY(found[0] == sample->scans[0]);
+    QVERIFY(found[1] == sample->scans[3]);
+    QVERIFY(found[2] == sample->scans[5]);
+
+    found = sample->getFragmentScans(149.99, 150.01, 0, 10);
+    QVERIFY(found.size() == 2);
+    QVERIFY(sample->getFragmentScans(49.99, 50.01, 0, 10).size() == 1);
+    delete sample;
+}
@@ -0,0 +1,38 @@
+#ifndef TESTMS2INDEX_H
+#define TESTMS2INDEX_H
+#include <iostream>
+#include <QtTest>
+#include <string>
+#include "common.h"
+#include "ms2Index.h"
+#include "mzSample.h"
+
+
+class TestMS2Index : public QObject {
+    Q_OBJECT
+
+    public:
+        TestMS2Index();
+    private:
+        const char* ms2File;
+        Scan* makeScan(mzSample* sample, int scannum, float rt, float precursorMz);
+        vector<Scan*> bruteForceFind(mzSample* sample, float mzmin, float mzmax,
+                                     float rtmin, float rtmax);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testFileRoundTrip();
+        void testStale();
+        void testCorrupt();
+};
+
+#endif // TESTMS2INDEX_H
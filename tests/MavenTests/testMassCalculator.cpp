@@ -1,6 +1,8 @@
 #include "testMassCalculator.h"
 #include "mzMassCalculator.h"
 #include "mzSample.h"
+#include "constants.h"
+#include "mavenparameters.h"
 
 TestMassCalculator::TestMassCalculator() {
 
@@ -133,6 +135,77 @@ void TestMassCalculator::testComputeIsotopes() {
 
 }
 
+void TestMassCalculator::testComputeIsotopePattern() {
+    string formula = "C12H18N4O4PS";
+
+    //no threshold keeps every isotopologue
+    vector<Isotope> pattern = MassCalculator::computeIsotopePattern(
+        formula, +1, true, true, true, true, 0);
+    QVERIFY(pattern.size() == 312);
+
+    //parent is the lightest species and the list is sorted by mass
+    QVERIFY(pattern[0].name == C12_PARENT_LABEL);
+    for (unsigned int i = 1; i < pattern.size(); i++)
+        QVERIFY(pattern[i - 1].mass <= pattern[i].mass);
+
+    //binomial abundances worked out by hand from the abundances in constants.h
+    map<string, double> expected;
+    expected[C12_PARENT_LABEL] = 0.8175750703;
+    expected[C13_LABEL + "1"] = 0.1098224064;
+    expected[C13_LABEL + "2"] = 0.006761385753;
+    expected[N15_LABEL + "1"] = 0.01202315073;
+    expected[S34_LABEL + "1"] = 0.03622385862;
+    expected[H2_LABEL + "1"] = 0.001692575042;
+    expected[C13N15_LABEL + "1-1"] = 0.001615033767;
+    expected[C13S34_LABEL + "1-1"] = 0.004865842253;
+    expected[C13H2_LABEL + "1-1"] = 0.0002273585274;
+
+    vector<Isotope> pruned = MassCalculator::computeIsotopePattern(
+        formula, +1, true, true, true, true, 1e-6);
+    QVERIFY(pruned.size() == 19);
+
+    unsigned int matched = 0;
+    for (unsigned int i = 0; i < pruned.size(); i++) {
+        QVERIFY(pruned[i].abundance >= 1e-6);
+        map<string, double>::iterator itr = expected.find(pruned[i].name);
+        if (itr == expected.end()) continue;
+        QVERIFY(fabs(pruned[i].abundance - itr->second) < 1e-8 * itr->second);
+        matched++;
+    }
+    QVERIFY(matched == expected.size());
+
+    //labels of elements missing from the formula give no species
+    vector<Isotope> glucose = MassCalculator::computeIsotopePattern(
+        "C6H12O6", 0, true, true, true, false, 0);
+    QVERIFY(glucose.size() == 7);
+    for (unsigned int i = 1; i < glucose.size(); i++)
+        QVERIFY(glucose[i].name == C13_LABEL + mzUtils::integer2string(glucose[i].C13));
+}
+
+void TestMassCalculator::testLabelledWithDefaults() {
+    //fully labelled tracers are far below any natural-abundance floor,
+    //the default threshold has to keep them
+    MavenParameters mavenparameters;
+    double minAbundance = mavenparameters.minIsotopicAbundance;
+
+    vector<Isotope> glucose = MassCalculator::computeIsotopePattern(
+        "C6H12O6", 0, true, false, false, false, minAbundance);
+    QVERIFY(glucose.size() == 7);
+    QVERIFY(glucose.back().name == C13_LABEL + "6");
+    QVERIFY(glucose.back().abundance < 1e-11);
+
+    vector<Isotope> glutamate = MassCalculator::computeIsotopePattern(
+        "C5H9NO4", 0, true, true, false, false, minAbundance);
+    bool found = false;
+    for (unsigned int i = 0; i < glutamate.size(); i++) {
+        if (glutamate[i].name != C13N15_LABEL + "5-1") continue;
+        QVERIFY(glutamate[i].C13 == 5 && glutamate[i].N15 == 1);
+        found = true;
+    }
+    QVERIFY(found);
+    QVERIFY(glutamate.size() == 1 + 5 + 1 + 5);
+}
+
 void TestMassCalculator::testenumerateMasses() {
     //TODO: have to add a test case for ennumurate mass
     // MassCalculator masCal;
@@ -31,6 +31,8 @@ class TestMassCalculator : public QObject {
         void testNeutralMass();
         void testComputeMass();
         void testComputeIsotopes();
+        void testComputeIsotopePattern();
+        void testLabelledWithDefaults();
         void testenumerateMasses();
 };
 
@@ -228,3 +228,135 @@ void TestPeakDetection::testpullIsotopes() {
     QVERIFY(D2_BPE == 0);
     QVERIFY(C13_BPE > 0);
 }
+
+void TestPeakDetection::testProcessNewScans() {
+    const char* sampleFile = "bin/methods/testsample_2.mzxml";
+    ClassifierNeuralNet* clsf = new ClassifierNeuralNet();
+    clsf->loadModel("bin/default.model");
+
+    mzSample* sample = new mzSample();
+    sample->loadSample(sampleFile);
+    MavenParameters* mavenparameters = new MavenParameters();
+    mavenparameters->clsf = clsf;
+    mavenparameters->samples.push_back(sample);
+    PeakDetector peakDetector(mavenparameters);
+    peakDetector.processMassSlices();
+
+    ifstream in(sampleFile, ios::binary);
+    string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    string growingFile = QDir::temp().filePath("testProcessNewScans.mzxml").toStdString();
+    remove(growingFile.c_str());
+
+    mzSample* growing = new mzSample();
+    MavenParameters* liveParameters = new MavenParameters();
+    liveParameters->clsf = clsf;
+    liveParameters->samples.push_back(growing);
+    PeakDetector liveDetector(liveParameters);
+    int updates = 0;
+    liveDetector.groupsUpdated.connect([&updates](const vector<PeakGroup>&) { updates++; });
+
+    //detect after every piece of the file, as it is acquired
+    size_t written = 0;
+    size_t pieceSize = content.size() / 5 + 1;
+    while (written < content.size()) {
+        size_t n = std::min(pieceSize, content.size() - written);
+        ofstream out(growingFile.c_str(), ios::binary | ios::app);
+        out.write(content.data() + written, n);
+        out.close();
+        written += n;
+
+        growing->appendScans(growingFile.c_str());
+        liveDetector.processNewScans();
+    }
+    remove(growingFile.c_str());
+
+    QVERIFY(updates > 1);
+    QVERIFY(liveParameters->allgroups.size() > 0);
+
+    //nothing new, nothing to detect
+    QVERIFY(liveDetector.processNewScans() == 0);
+
+    //every group of the finished sample is found while it is acquired
+    for (unsigned int i = 0; i < mavenparameters->allgroups.size(); i++) {
+        PeakGroup& group = mavenparameters->allgroups[i];
+        bool found = false;
+        for (unsigned int j = 0; j < liveParameters->allgroups.size() && !found; j++) {
+            PeakGroup& liveGroup = liveParameters->allgroups[j];
+            found = common::floatCompare(group.meanMz, liveGroup.meanMz)
+                    && common::floatCompare(group.meanRt, liveGroup.meanRt);
+        }
+        QVERIFY(found);
+    }
+}
+
+void TestPeakDetection::testProcessNewScansStopped() {
+    const char* sampleFile = "bin/methods/testsample_2.mzxml";
+    ClassifierNeuralNet* clsf = new ClassifierNeuralNet();
+    clsf->loadModel("bin/default.model");
+
+    ifstream in(sampleFile, ios::binary);
+    string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    string growingFile = QDir::temp().filePath("testProcessNewScansStopped.mzxml").toStdString();
+    remove(growingFile.c_str());
+
+    mzSample* growing = new mzSample();
+    MavenParameters* liveParameters = new MavenParameters();
+    liveParameters->clsf = clsf;
+    liveParameters->samples.push_back(growing);
+    liveParameters->checkConvergance = true;
+    PeakDetector liveDetector(liveParameters);
+
+    size_t half = content.size() / 2;
+    ofstream out(growingFile.c_str(), ios::binary);
+    out.write(content.data(), half);
+    out.close();
+    growing->appendScans(growingFile.c_str());
+    QVERIFY(liveDetector.processNewScans() > 0);
+    QVERIFY(liveParameters->checkConvergance);
+    vector<PeakGroup> before = liveParameters->allgroups;
+    QVERIFY(before.size() > 0);
+
+    //stopped before the new scans are sliced, no group is lost
+    out.open(growingFile.c_str(), ios::binary | ios::app);
+    out.write(content.data() + half, content.size() - half);
+    out.close();
+    growing->appendScans(growingFile.c_str());
+    remove(growingFile.c_str());
+    liveParameters->stop = true;
+    QVERIFY(liveDetector.processNewScans() == 0);
+    QVERIFY(liveParameters->allgroups.size() == before.size());
+    for (unsigned int i = 0; i < before.size() && i < liveParameters->allgroups.size(); i++) {
+        QVERIFY(liveParameters->allgroups[i].meanMz == before[i].meanMz);
+        QVERIFY(liveParameters->allgroups[i].meanRt == before[i].meanRt);
+    }
+    liveParameters->stop = false;
+
+    //the group limit ends detection after a few slices, the slices left
+    //are detected by the next calls without new scans
+    int limitGroupCount = liveParameters->limitGroupCount;
+    liveParameters->limitGroupCount = liveParameters->allgroups.size();
+    QVERIFY(liveDetector.processNewScans() > 0);
+    liveParameters->limitGroupCount = limitGroupCount;
+    QVERIFY(liveDetector.processNewScans() > 0);
+    QVERIFY(liveDetector.processNewScans() == 0);
+    QVERIFY(liveParameters->checkConvergance);
+
+    //same groups as detecting without the stop
+    mzSample* sample = new mzSample();
+    sample->loadSample(sampleFile);
+    MavenParameters* mavenparameters = new MavenParameters();
+    mavenparameters->clsf = clsf;
+    mavenparameters->samples.push_back(sample);
+    PeakDetector peakDetector(mavenparameters);
+    peakDetector.processMassSlices();
+    for (unsigned int i = 0; i < mavenparameters->allgroups.size(); i++) {
+        PeakGroup& group = mavenparameters->allgroups[i];
+        bool found = false;
+        for (unsigned int j = 0; j < liveParameters->allgroups.size() && !found; j++) {
+            PeakGroup& liveGroup = liveParameters->allgroups[j];
+            found = common::floatCompare(group.meanMz, liveGroup.meanMz)
+                    && common::floatCompare(group.meanRt, liveGroup.meanRt);
+        }
+        QVERIFY(found);
+    }
+}
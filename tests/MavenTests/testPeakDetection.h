@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <QtTest>
+#include <QDir>
 #include <string>
 #include <sstream>
 
@@ -39,6 +40,8 @@ class TestPeakDetection : public QObject {
         void testPullEICs();
         void testprocessSlices();
         void testpullIsotopes();
+        void testProcessNewScans();
+        void testProcessNewScansStopped();
 };
 
 #endif // TESTPEAKDETECTION_H
@@ -0,0 +1,178 @@
+#include "testPeptide.h"
+#include <cctype>
+#include <cmath>
+
+
+TestPeptide::TestPeptide() {
+}
+
+void TestPeptide::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestPeptide::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+}
+
+void TestPeptide::init() {
+    // This function is executed before each test
+}
+
+void TestPeptide::cleanup() {
+    // This function is executed after each test
+}
+
+bool TestPeptide::isBackboneIon(const string& name) {
+    //b, y, c or z ion without neutral loss, e.g. y7 or y7^2
+    if (name.size() < 2 || string("bycz").find(name[0]) == string::npos) return false;
+    unsigned int i = 1;
+    while (i < name.size() && isdigit(name[i])) i++;
+    if (i == 1) return false;
+    if (i == name.size()) return true;
+    return i + 2 == name.size() && name[i] == '^' && isdigit(name[i + 1]);
+}
+
+void TestPeptide::compareIons(string peptide, int charge, string fragmentationType,
+                              unsigned int ionCount, const BaselineIon* baseline,
+                              unsigned int baselineCount) {
+    Peptide record(peptide, charge);
+    FragmentIonTable table;
+    record.generateFragmentIons(table, fragmentationType);
+    vector<FragmentIon*> ions;
+    record.generateFragmentIons(ions, fragmentationType);
+    QVERIFY(table.size() == ionCount);
+    QVERIFY(ions.size() == ionCount);
+
+    //both interfaces give the same ions in the same order
+    for (unsigned int i = 0; i < table.size() && i < ions.size(); i++) {
+        QVERIFY(table.ionName(i) == ions[i]->m_ion);
+        QVERIFY(table.ions[i].mz == ions[i]->m_mz);
+    }
+
+    //masses are summed in another order than they used to be, so they may
+    //differ from the baseline in the last digits
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < table.size(); i++) {
+        string name = table.ionName(i);
+        if (!isBackboneIon(name)) continue;
+        QVERIFY(n < baselineCount);
+        if (n >= baselineCount) break;
+        QVERIFY(name == baseline[n].name);
+        QVERIFY(std::abs(table.ions[i].mz - baseline[n].mz) < 1e-5);
+        n++;
+    }
+    QVERIFY(n == baselineCount);
+
+    for (unsigned int i = 0; i < ions.size(); i++) delete ions[i];
+}
+
+void TestPeptide::testFragmentIons() {
+    //b/y and c/z ions of the generator before masses were prefix summed,
+    //in the order it generated them
+    //PEPTIDE, charge 1, CID: 81 ions in all
+    const BaselineIon ions0[] = {
+        {"y1", 148.060430}, {"y2", 263.087370}, {"y3", 376.171430}, {"y4", 477.219110},
+        {"y5", 574.271870}, {"b1", 98.060040}, {"b2", 227.102630}, {"b3", 324.155390},
+        {"b4", 425.203070}, {"b5", 538.287130}, {"y6", 703.314460}, {"b6", 653.314070},
+    };
+    compareIons("PEPTIDE", 1, "CID", 81, ions0, sizeof(ions0) / sizeof(BaselineIon));
+
+    //PEPTIDE, charge 1, ETD: 17 ions in all
+    const BaselineIon ions1[] = {
+        {"c1", 115.086589}, {"c2", 244.129179}, {"c3", 341.181939}, {"c4", 442.229619},
+        {"c5", 555.313679}, {"c6", 670.340619}, {"b1", 98.060040}, {"b2", 227.102630},
+        {"b3", 324.155390}, {"b4", 425.203070}, {"b5", 538.287130}, {"b6", 653.314070},
+    };
+    compareIons("PEPTIDE", 1, "ETD", 17, ions1, sizeof(ions1) / sizeof(BaselineIon));
+
+    //SAMPLER, charge 2, CID: 170 ions in all
+    const BaselineIon ions2[] = {
+        {"y1", 175.118950}, {"y2", 304.161540}, {"y3", 417.245600}, {"y4", 514.298360},
+        {"y5", 645.338850}, {"y6", 716.375960}, {"y1^2", 88.063115}, {"y2^2", 152.584410},
+        {"y3^2", 209.126440}, {"y4^2", 257.652820}, {"y5^2", 323.173065}, {"b1", 88.039310},
+        {"b2", 159.076420}, {"b3", 290.116910}, {"b4", 387.169670}, {"b5", 500.253730},
+        {"b6", 629.296320}, {"b1^2", 44.523295}, {"b2^2", 80.041850}, {"b3^2", 145.562095},
+        {"b4^2", 194.088475}, {"b5^2", 250.630505}, {"y6^2", 358.691620}, {"b6^2", 315.151800},
+    };
+    compareIons("SAMPLER", 2, "CID", 170, ions2, sizeof(ions2) / sizeof(BaselineIon));
+
+    //SAMPLER, charge 2, ETD: 50 ions in all
+    const BaselineIon ions3[] = {
+        {"c1", 105.065859}, {"c2", 176.102969}, {"c3", 307.143459}, {"c4", 404.196219},
+        {"c5", 517.280279}, {"c6", 646.322869}, {"z1", 159.099681}, {"z2", 288.142271},
+        {"z3", 401.226331}, {"z4", 498.279091}, {"z5", 629.319581}, {"z6", 700.356691},
+        {"c1^2", 53.036570}, {"c2^2", 88.555125}, {"c3^2", 154.075369}, {"c4^2", 202.601750},
+        {"c5^2", 259.143780}, {"c6^2", 323.665075}, {"y1", 175.118950}, {"y2", 304.161540},
+        {"y3", 417.245600}, {"y4", 514.298360}, {"y5", 645.338850}, {"y6", 716.375960},
+        {"b1", 88.039310}, {"b2", 159.076420}, {"b3", 290.116910}, {"b4", 387.169670},
+        {"b5", 500.253730}, {"b6", 629.296320}, {"b1^2", 44.523295}, {"b2^2", 80.041850},
+        {"b3^2", 145.562095}, {"b4^2", 194.088475}, {"b5^2", 250.630505}, {"b6^2", 315.151800},
+    };
+    compareIons("SAMPLER", 2, "ETD", 50, ions3, sizeof(ions3) / sizeof(BaselineIon));
+
+    //AC[160]DEFGHIK, charge 3, CID: 359 ions in all
+    const BaselineIon ions4[] = {
+        {"b7", 817.293354}, {"b8", 930.377414}, {"y1", 147.112800}, {"y2", 260.196860},
+        {"y3", 397.255770}, {"y4", 454.277230}, {"y5", 601.345640}, {"y6", 730.388230},
+        {"y7", 845.415170}, {"y8", 1005.445824}, {"b7^2", 409.150317}, {"b8^2", 465.692347},
+        {"y1^2", 74.060040}, {"y2^2", 130.602070}, {"y3^2", 199.131525}, {"y4^2", 227.642255},
+        {"y5^2", 301.176460}, {"y6^2", 365.697755}, {"y7^2", 423.211225}, {"y8^2", 503.226552},
+        {"y1^3", 49.709120}, {"y2^3", 87.403807}, {"y3^3", 133.090110}, {"y4^3", 152.097263},
+        {"y5^3", 201.120067}, {"y6^3", 244.134263}, {"b1", 72.044390}, {"b2", 232.075044},
+        {"b3", 347.101984}, {"b4", 476.144574}, {"b5", 623.212984}, {"b6", 680.234444},
+        {"b1^2", 36.525835}, {"b2^2", 116.541162}, {"b3^2", 174.054632}, {"b4^2", 238.575927},
+        {"b5^2", 312.110132}, {"b6^2", 340.620862}, {"b1^3", 24.686317}, {"b2^3", 78.029868},
+        {"b3^3", 116.372181}, {"b4^3", 159.386378}, {"b5^3", 208.409181}, {"b6^3", 227.416335},
+        {"b7^3", 273.102638}, {"b8^3", 310.797325}, {"y7^3", 282.476577}, {"y8^3", 335.820128},
+    };
+    compareIons("AC[160]DEFGHIK", 3, "CID", 359, ions4, sizeof(ions4) / sizeof(BaselineIon));
+
+    //AC[160]DEFGHIK, charge 3, ETD: 104 ions in all
+    const BaselineIon ions5[] = {
+        {"c1", 89.070939}, {"c2", 249.101593}, {"c3", 364.128533}, {"c4", 493.171123},
+        {"c5", 640.239533}, {"c6", 697.260993}, {"c7", 834.319903}, {"c8", 947.403963},
+        {"z1", 131.093531}, {"z2", 244.177591}, {"z3", 381.236501}, {"z4", 438.257961},
+        {"z5", 585.326371}, {"z6", 714.368961}, {"z7", 829.395901}, {"z8", 989.426555},
+        {"c1^2", 45.039110}, {"c2^2", 125.054436}, {"c3^2", 182.567906}, {"c4^2", 247.089201},
+        {"c5^2", 320.623406}, {"c6^2", 349.134137}, {"c7^2", 417.663591}, {"c8^2", 474.205622},
+        {"z1^2", 66.050405}, {"z2^2", 122.592435}, {"z3^2", 191.121890}, {"z4^2", 219.632620},
+        {"z5^2", 293.166825}, {"z6^2", 357.688120}, {"z7^2", 415.201590}, {"z8^2", 495.216917},
+        {"c1^3", 30.361833}, {"c2^3", 83.705384}, {"c3^3", 122.047698}, {"c4^3", 165.061894},
+        {"c5^3", 214.084698}, {"c6^3", 233.091851}, {"c7^3", 278.778154}, {"c8^3", 316.472841},
+        {"y1", 147.112800}, {"y2", 260.196860}, {"y3", 397.255770}, {"y4", 454.277230},
+        {"y5", 601.345640}, {"y6", 730.388230}, {"y7", 845.415170}, {"y8", 1005.445824},
+        {"y1^2", 74.060040}, {"y2^2", 130.602070}, {"y3^2", 199.131525}, {"y4^2", 227.642255},
+        {"y5^2", 301.176460}, {"y6^2", 365.697755}, {"y7^2", 423.211225}, {"y8^2", 503.226552},
+        {"b1", 72.044390}, {"b2", 232.075044}, {"b3", 347.101984}, {"b4", 476.144574},
+        {"b5", 623.212984}, {"b6", 680.234444}, {"b7", 817.293354}, {"b8", 930.377414},
+        {"b1^2", 36.525835}, {"b2^2", 116.541162}, {"b3^2", 174.054632}, {"b4^2", 238.575927},
+        {"b5^2", 312.110132}, {"b6^2", 340.620862}, {"b7^2", 409.150317}, {"b8^2", 465.692347},
+        {"b1^3", 24.686317}, {"b2^3", 78.029868}, {"b3^3", 116.372181}, {"b4^3", 159.386378},
+        {"b5^3", 208.409181}, {"b6^3", 227.416335}, {"b7^3", 273.102638}, {"b8^3", 310.797325},
+    };
+    compareIons("AC[160]DEFGHIK", 3, "ETD", 104, ions5, sizeof(ions5) / sizeof(BaselineIon));
+
+    //K.LLEQMK.A, charge 2, CID: 149 ions in all
+    const BaselineIon ions6[] = {
+        {"y1", 147.112800}, {"y2", 278.153290}, {"y3", 406.211870}, {"y4", 535.254460},
+        {"y5", 648.338520}, {"y1^2", 74.060040}, {"y2^2", 139.580285}, {"y3^2", 203.609575},
+        {"y4^2", 268.130870}, {"b1", 114.091340}, {"b2", 227.175400}, {"b3", 356.217990},
+        {"b4", 484.276570}, {"b5", 615.317060}, {"b1^2", 57.549310}, {"b2^2", 114.091340},
+        {"b3^2", 178.612635}, {"b4^2", 242.641925}, {"y5^2", 324.672900}, {"b5^2", 308.162170},
+    };
+    compareIons("K.LLEQMK.A", 2, "CID", 149, ions6, sizeof(ions6) / sizeof(BaselineIon));
+
+    //K.LLEQMK.A, charge 2, ETD: 46 ions in all
+    const BaselineIon ions7[] = {
+        {"c1", 131.117889}, {"c2", 244.201949}, {"c3", 373.244539}, {"c4", 501.303119},
+        {"c5", 632.343609}, {"z1", 131.093531}, {"z2", 262.134021}, {"z3", 390.192601},
+        {"z4", 519.235191}, {"z5", 632.319251}, {"c1^2", 66.062584}, {"c2^2", 122.604614},
+        {"c3^2", 187.125910}, {"c4^2", 251.155200}, {"c5^2", 316.675445}, {"y1", 147.112800},
+        {"y2", 278.153290}, {"y3", 406.211870}, {"y4", 535.254460}, {"y5", 648.338520},
+        {"b1", 114.091340}, {"b2", 227.175400}, {"b3", 356.217990}, {"b4", 484.276570},
+        {"b5", 615.317060}, {"b1^2", 57.549310}, {"b2^2", 114.091340}, {"b3^2", 178.612635},
+        {"b4^2", 242.641925}, {"b5^2", 308.162170},
+    };
+    compareIons("K.LLEQMK.A", 2, "ETD", 46, ions7, sizeof(ions7) / sizeof(BaselineIon));
+}
@@ -0,0 +1,39 @@
+#ifndef TESTPEPTIDE_H
+#define TESTPEPTIDE_H
+#include <iostream>
+#include <vector>
+#include <QtTest>
+#include <string>
+#include "Peptide.hpp"
+
+
+class TestPeptide : public QObject {
+    Q_OBJECT
+
+    public:
+        TestPeptide();
+    private:
+        struct BaselineIon {
+            const char* name;
+            double mz;
+        };
+        bool isBackboneIon(const string& name);
+        void compareIons(string peptide, int charge, string fragmentationType,
+                         unsigned int ionCount, const BaselineIon* baseline,
+                         unsigned int baselineCount);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testFragmentIons();
+};
+
+#endif // TESTPEPTIDE_H
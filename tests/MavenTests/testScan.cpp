@@ -202,6 +202,24 @@ void TestScan::testchargeSeries() {
     QVERIFY(common::floatCompare(chargeStates[22],1.422727227211));
 }
 
+void TestScan::testassignCharges() {
+    Scan* scan=new Scan (sample,1,2,3.3,4.4,1);
+
+    //a singly charged and a doubly charged isotope series
+    float mzarr[9]={100.0,200.0,201.00335,202.0067,399.49832,400.0,400.50168,401.00335,401.50503};
+    float intensityarr[9]={50,1000,600,300,200,2000,1200,600,250};
+    scan->mz.assign(mzarr,mzarr+9);
+    scan->intensity.assign(intensityarr,intensityarr+9);
+
+    MassCutoff* massCutoff=new MassCutoff();
+    massCutoff->setMassCutoffAndType(10,"ppm");
+    vector<int> charges=scan->assignCharges(massCutoff);
+    int expected[9]={0,1,0,0,0,2,0,0,0};
+    QVERIFY(charges.size()==9);
+    for(unsigned int i=0; i < charges.size(); i++)
+        QVERIFY(charges[i]==expected[i]);
+}
+
 void TestScan::testdeconvolute() {
 
     Scan* scan=new Scan (sample,1,2,3.3,4.4,1);
@@ -307,3 +325,44 @@ void TestScan::testgetTopPeaks() {
     QVERIFY(common::floatCompare(selected[0].second,(float) 2.06999993));
     QVERIFY(common::floatCompare(selected[1].second,(float) 8.8000001));
 }
+
+void TestScan::testScanAverager() {
+    Scan* first=new Scan (sample,1,2,3.3,4.4,1);
+    first->mz = {100.000, 200.000};
+    first->intensity = {10, 20};
+
+    //out of m/z order on purpose
+    Scan* second=new Scan (sample,2,2,3.4,4.4,1);
+    second->mz = {200.004, 100.002, 300.000};
+    second->intensity = {20, 30, 5};
+
+    vector<Scan*> scans = {first, NULL, second};
+    MassCutoff massCutoff;
+    massCutoff.setMassCutoffAndType(5, "mDa");
+    vector<float> mzs, intensities;
+
+    ScanAverager byScan(&massCutoff, ScanAverager::ScanCount);
+    byScan.average(scans, mzs, intensities);
+    QVERIFY(mzs.size()==3);
+    QVERIFY(intensities.size()==3);
+    QVERIFY(common::floatCompare(mzs[0],100.0015));
+    QVERIFY(common::floatCompare(mzs[1],200.002));
+    QVERIFY(common::floatCompare(mzs[2],300.000));
+    QVERIFY(common::floatCompare(intensities[0],20));
+    QVERIFY(common::floatCompare(intensities[1],20));
+    QVERIFY(common::floatCompare(intensities[2],2.5));
+
+    ScanAverager byPeak(&massCutoff, ScanAverager::PeakCount);
+    byPeak.average(scans, mzs, intensities);
+    QVERIFY(mzs.size()==3);
+    QVERIFY(common::floatCompare(intensities[0],20));
+    QVERIFY(common::floatCompare(intensities[2],5));
+
+    //peaks 4 mDa apart stay apart with a 1 mDa cutoff
+    massCutoff.setMassCutoffAndType(1, "mDa");
+    byScan.average(scans, mzs, intensities);
+    QVERIFY(mzs.size()==5);
+
+    delete first;
+    delete second;
+}
@@ -9,6 +9,7 @@
 #include <string.h>
 #include "common.h"
 #include "mzSample.h"
+#include "scanAverager.h"
 
 
 class TestScan : public QObject {
@@ -38,8 +39,10 @@ class TestScan : public QObject {
         void testsimpleCentroid();
         void testhasMz();
         void testchargeSeries();
+        void testassignCharges();
         void testdeconvolute();
         void testgetTopPeaks();
+        void testScanAverager();
 
 };
 
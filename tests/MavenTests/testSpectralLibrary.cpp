@@ -0,0 +1,197 @@
+#include "testSpectralLibrary.h"
+#include <fstream>
+
+
+TestSpectralLibrary::TestSpectralLibrary() {
+    nistFile = QDir::temp().filePath("testSpectralLibrary.msp").toStdString();
+    massBankFile = QDir::temp().filePath("testSpectralLibrary.massbank").toStdString();
+}
+
+void TestSpectralLibrary::initTestCase() {
+    // This function is being executed at the beginning of each test suite
+    // That is - before other tests from this class run
+}
+
+void TestSpectralLibrary::cleanupTestCase() {
+    // Similarly to initTestCase(), this function is executed at the end of test suite
+    QFile::remove(QString::fromStdString(nistFile));
+    QFile::remove(QString::fromStdString(SpectralLibrary::indexFileName(nistFile)));
+    QFile::remove(QString::fromStdString(massBankFile));
+    QFile::remove(QString::fromStdString(SpectralLibrary::indexFileName(massBankFile)));
+}
+
+void TestSpectralLibrary::init() {
+    // This function is executed before each test
+    writeFile(nistFile,
+              "Name: DGDG 8:0; [M-H]-\n"
+              "MW: 555.22888\n"
+              "PRECURSORMZ: 555.22888\n"
+              "Comment: Parent=555.22888 Formula=C23H40O15 AvgRt=4.5\n"
+              "Num Peaks: 3\n"
+              "115.07586 999 \"sn2 FA\"\n"
+              "59.01330 500 \"sn1 FA\"\n"
+              "253.1 10\n"
+              "\n"
+              "Name: Alanine\n"
+              "MW: 89.047\n"
+              "Comment: Formula=C3H7NO2\n"
+              "Num Peaks: 2\n"
+              "44.05 999\n"
+              "28.03 200\n"
+              "\n"
+              "Name: Glucose\n"
+              "MW: 180.063\n"
+              "PRECURSORMZ: 179.056\n"
+              "Num Peaks: 2\n"
+              "89.02 999\n"
+              "59.01 300\n");
+
+    writeFile(massBankFile,
+              "ACCESSION: PR100458\n"
+              "RECORD_TITLE: Cy 3-Soph; LC-ESI-QTOF; MS2; [M]+\n"
+              "CH$NAME: Cyanidin-3-sophoroside\n"
+              "CH$NAME: Cy 3-Soph\n"
+              "CH$COMPOUND_CLASS: Anthocyanidin\n"
+              "CH$FORMULA: C27H31O16\n"
+              "CH$EXACT_MASS: 611.16121\n"
+              "PK$NUM_PEAK: 2\n"
+              "PK$PEAK: m/z int. rel.int.\n"
+              "  287.0564 4418 999\n"
+              "  213.0567 47.98 11\n"
+              "//\n");
+}
+
+void TestSpectralLibrary::cleanup() {
+    // This function is executed after each test
+}
+
+void TestSpectralLibrary::writeFile(string filename, string content) {
+    ofstream out(filename.c_str(), ios::binary | ios::trunc);
+    out << content;
+}
+
+void TestSpectralLibrary::testLoadNIST() {
+    SpectralLibrary library;
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    QVERIFY(library.size() == 3);
+
+    //records in increasing precursor m/z, molecular weight without one
+    QVERIFY(library.name(0) == "Alanine");
+    QVERIFY(library.name(1) == "Glucose");
+    QVERIFY(library.name(2) == "DGDG 8:0; [M-H]-");
+    QVERIFY(common::floatCompare(library.precursorMz(0), 89.047));
+    QVERIFY(common::floatCompare(library.precursorMz(1), 179.056));
+
+    //peaks sorted by m/z
+    QVERIFY(library.peakCount(2) == 3);
+    QVERIFY(common::floatCompare(library.mzs(2)[0], 59.0133));
+    QVERIFY(common::floatCompare(library.intensities(2)[0], 500));
+    QVERIFY(common::floatCompare(library.mzs(2)[2], 253.1));
+
+    Compound* dgdg = library.compound(2, "lipids");
+    QVERIFY(dgdg->id == "DGDG 8:0; [M-H]-");
+    QVERIFY(dgdg->formula == "C23H40O15");
+    QVERIFY(dgdg->db == "lipids");
+    QVERIFY(common::floatCompare(dgdg->mass, 555.22888));
+    QVERIFY(common::floatCompare(dgdg->precursorMz, 555.22888));
+    QVERIFY(common::floatCompare(dgdg->expectedRt, 4.5));
+    QVERIFY(dgdg->fragment_mzs.size() == 3);
+    delete dgdg;
+
+    Compound* alanine = library.compound(0, "lipids");
+    QVERIFY(common::floatCompare(alanine->mass, 89.047));
+    QVERIFY(alanine->precursorMz == 0);
+    delete alanine;
+}
+
+void TestSpectralLibrary::testLoadMassBank() {
+    SpectralLibrary library;
+    QVERIFY(library.load(massBankFile, SpectralLibrary::MassBank));
+    QVERIFY(library.size() == 1);
+
+    Compound* cpd = library.compound(0, "massbank");
+    QVERIFY(cpd->id == "PR100458");
+    QVERIFY(cpd->name == "Cyanidin-3-sophoroside");
+    QVERIFY(cpd->formula == "C27H31O16");
+    QVERIFY(common::floatCompare(cpd->precursorMz, 611.16121));
+    QVERIFY(cpd->category.size() == 1 && cpd->category[0] == "Anthocyanidin");
+    QVERIFY(cpd->fragment_mzs.size() == 2);
+    QVERIFY(common::floatCompare(cpd->fragment_mzs[0], 213.0567));
+    QVERIFY(common::floatCompare(cpd->fragment_intensity[1], 4418));
+    delete cpd;
+}
+
+void TestSpectralLibrary::testSearch() {
+    SpectralLibrary library;
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+
+    pair<unsigned int, unsigned int> records = library.find(170, 600);
+    QVERIFY(records.first == 1 && records.second == 3);
+    records = library.find(600, 700);
+    QVERIFY(records.first == records.second);
+
+    //a copy of a record is its own best match
+    Fragment* query = library.fragment(1);
+    vector<SpectralLibrary::Match> matches = library.search(query, 0, 1000, 0.01);
+    QVERIFY(matches.size() == 2);
+    QVERIFY(matches[0].record == 1);
+    QVERIFY(matches[0].score.matchedPeaks == 2);
+    QVERIFY(common::floatCompare(matches[0].score.cosine, 1));
+    QVERIFY(matches[1].record == 2);
+    QVERIFY(matches[1].score.cosine < matches[0].score.cosine);
+
+    //only records in the precursor window are scored
+    matches = library.search(query, 170, 190, 0.01);
+    QVERIFY(matches.size() == 1);
+    delete query;
+}
+
+void TestSpectralLibrary::testRebuild() {
+    SpectralLibrary library;
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    string indexFile = SpectralLibrary::indexFileName(nistFile);
+    QVERIFY(SpectralLibrary::isIndexCurrent(nistFile, SpectralLibrary::NIST, indexFile));
+    QVERIFY(!SpectralLibrary::isIndexCurrent(nistFile, SpectralLibrary::MassBank, indexFile));
+    library.close();
+
+    //a changed library is imported again
+    ofstream out(nistFile.c_str(), ios::app);
+    out << "\nName: Serine\nMW: 105.043\nNum Peaks: 1\n60.04 999\n";
+    out.close();
+    QVERIFY(!SpectralLibrary::isIndexCurrent(nistFile, SpectralLibrary::NIST, indexFile));
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    QVERIFY(library.size() == 4);
+    QVERIFY(library.name(1) == "Serine");
+}
+
+void TestSpectralLibrary::testDamagedIndex() {
+    SpectralLibrary library;
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    library.close();
+    string indexFile = SpectralLibrary::indexFileName(nistFile);
+
+    //text of the last record loses its terminator, the header stays intact
+    fstream index(indexFile.c_str(), ios::in | ios::out | ios::binary);
+    index.seekp(-1, ios::end);
+    index.put('x');
+    index.close();
+    QVERIFY(SpectralLibrary::isIndexCurrent(nistFile, SpectralLibrary::NIST, indexFile));
+    QVERIFY(!library.open(indexFile));
+
+    //a damaged index is rebuilt on load
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    QVERIFY(library.size() == 3);
+    QVERIFY(library.formula(2) == "C23H40O15");
+    library.close();
+
+    //peaks of the first record run past the file: the 64 byte header is
+    //followed by the records, whose peak count is at byte 20
+    index.open(indexFile.c_str(), ios::in | ios::out | ios::binary);
+    index.seekp(64 + 20);
+    uint32_t peakCount = 1 << 30;
+    index.write((const char*) &peakCount, sizeof(peakCount));
+    index.close();
+    QVERIFY(!library.open(indexFile));
+    QVERIFY(library.load(nistFile, SpectralLibrary::NIST));
+    QVERIFY(library.peakCount(0) == 2);
+}
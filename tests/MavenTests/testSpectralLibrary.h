@@ -0,0 +1,40 @@
+#ifndef TESTSPECTRALLIBRARY_H
+#define TESTSPECTRALLIBRARY_H
+#include <iostream>
+#include <QtTest>
+#include <QDir>
+#include <string>
+#include "common.h"
+#include "spectralLibrary.h"
+#include "Compound.h"
+
+
+class TestSpectralLibrary : public QObject {
+    Q_OBJECT
+
+    public:
+        TestSpectralLibrary();
+    private:
+        string nistFile;
+        string massBankFile;
+        void writeFile(string filename, string content);
+
+    private Q_SLOTS:
+        // functions executed by QtTest before and after test suite
+        void initTestCase();
+        void cleanupTestCase();
+
+        // functions executed by QtTest before and after each test
+        void init();
+        void cleanup();
+
+        // test functions - all functions prefixed with "test" will be ran as tests
+        // this is automatically detected thanks to Qt's meta-information about QObjects
+        void testLoadNIST();
+        void testLoadMassBank();
+        void testSearch();
+        void testRebuild();
+        void testDamagedIndex();
+};
+
+#endif // TESTSPECTRALLIBRARY_H